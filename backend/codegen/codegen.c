@@ -1,6 +1,6 @@
 /**
  * bit(N) Compiler - C Code Generator Implementation
- * Quick fix version - minimal implementation that compiles
+ * Emits a device header: peripheral structs and per-field accessors
  */
 
 #include "codegen.h"
@@ -8,59 +8,171 @@
 #include <string.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-CodegenContext* codegen_init(const char *output_file, const char *target) {
+#define CODEGEN_INITIAL_CAPACITY (64 * 1024)
+#define CODEGEN_FLUSH_THRESHOLD  (256 * 1024)   // File mode writes out in chunks this size
+
+/* Enough spaces for 16 levels; deeper indentation is copied in pieces. */
+static const char codegen_spaces[] =
+    "                                                                ";
+
+static CodegenContext* codegen_create(int fd, const char *target) {
     CodegenContext *ctx = malloc(sizeof(CodegenContext));
     if (!ctx) return NULL;
     
-    ctx->output = fopen(output_file, "w");
-    if (!ctx->output) {
-        free(ctx);
-        return NULL;
-    }
-    
+    ctx->fd = fd;
+    ctx->buffer = malloc(CODEGEN_INITIAL_CAPACITY);
+    ctx->buffer_length = 0;
+    ctx->buffer_capacity = CODEGEN_INITIAL_CAPACITY;
+    ctx->scratch = NULL;
+    ctx->scratch_capacity = 0;
+    ctx->error = !ctx->buffer;
+    ctx->errors = stderr;
     ctx->indent_level = 0;
     ctx->target_arch = malloc(strlen(target) + 1);
     strcpy(ctx->target_arch, target);
     ctx->target_abi = "eabi";
     ctx->use_volatile = 1;
     ctx->inline_asm = 1;
+    ctx->atomic_aliases = strcmp(target, "rp2040") == 0;
     
     return ctx;
 }
 
+CodegenContext* codegen_init(const char *output_file, const char *target) {
+    int fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return NULL;
+    
+    CodegenContext *ctx = codegen_create(fd, target);
+    if (!ctx) close(fd);
+    return ctx;
+}
+
+/* Generate into memory; fetch the result with codegen_buffer(). */
+CodegenContext* codegen_init_buffer(const char *target) {
+    return codegen_create(-1, target);
+}
+
+const char* codegen_buffer(CodegenContext *ctx, size_t *length) {
+    if (!ctx || ctx->error || ctx->fd >= 0) return NULL;
+    *length = ctx->buffer_length;
+    return ctx->buffer;
+}
+
+/* Write out everything buffered so far (file mode only). */
+int codegen_flush(CodegenContext *ctx) {
+    if (ctx->error) return -1;
+    if (ctx->fd < 0) return 0;
+    
+    size_t written = 0;
+    while (written < ctx->buffer_length) {
+        ssize_t n = write(ctx->fd, ctx->buffer + written, ctx->buffer_length - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ctx->error = 1;
+            return -1;
+        }
+        written += (size_t)n;
+    }
+    ctx->buffer_length = 0;
+    return 0;
+}
+
+/* Make room for extra more bytes in the output buffer. */
+static int codegen_reserve(CodegenContext *ctx, size_t extra) {
+    if (ctx->error) return -1;
+    if (ctx->buffer_capacity - ctx->buffer_length >= extra) return 0;
+    
+    size_t capacity = ctx->buffer_capacity;
+    while (capacity - ctx->buffer_length < extra) capacity *= 2;
+    
+    char *grown = realloc(ctx->buffer, capacity);
+    if (!grown) {
+        ctx->error = 1;
+        return -1;
+    }
+    ctx->buffer = grown;
+    ctx->buffer_capacity = capacity;
+    return 0;
+}
+
+static void codegen_append(CodegenContext *ctx, const char *data, size_t length) {
+    if (codegen_reserve(ctx, length) != 0) return;
+    memcpy(ctx->buffer + ctx->buffer_length, data, length);
+    ctx->buffer_length += length;
+}
+
 void codegen_indent(CodegenContext *ctx) {
-    for (int i = 0; i < ctx->indent_level * 4; i++) {
-        fputc(' ', ctx->output);
+    size_t width = (size_t)ctx->indent_level * 4;
+    while (width > 0) {
+        size_t chunk = width < sizeof(codegen_spaces) - 1 ? width : sizeof(codegen_spaces) - 1;
+        codegen_append(ctx, codegen_spaces, chunk);
+        width -= chunk;
     }
 }
 
 void codegen_write(CodegenContext *ctx, const char *fmt, ...) {
+    if (ctx->error) return;
+    
+    /* Measure, then format into scratch space that is at least that large. */
     va_list args;
     va_start(args, fmt);
-    
-    char buffer[4096];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    int needed = vsnprintf(ctx->scratch, ctx->scratch_capacity, fmt, args);
     va_end(args);
+    if (needed < 0) {
+        ctx->error = 1;
+        return;
+    }
     
-    const char *ptr = buffer;
-    int at_line_start = 1;
-    
-    while (*ptr) {
-        if (at_line_start && *ptr != '\n' && *ptr != '\0') {
-            codegen_indent(ctx);
-            at_line_start = 0;
+    size_t length = (size_t)needed;
+    if (length >= ctx->scratch_capacity) {
+        size_t capacity = ctx->scratch_capacity ? ctx->scratch_capacity : 256;
+        while (capacity <= length) capacity *= 2;
+        char *grown = realloc(ctx->scratch, capacity);
+        if (!grown) {
+            ctx->error = 1;
+            return;
         }
+        ctx->scratch = grown;
+        ctx->scratch_capacity = capacity;
         
-        if (*ptr == '\n') {
-            at_line_start = 1;
+        va_start(args, fmt);
+        vsnprintf(ctx->scratch, ctx->scratch_capacity, fmt, args);
+        va_end(args);
+    }
+    
+    /* Copy line by line, indenting every non-empty line. */
+    const char *ptr = ctx->scratch;
+    const char *end = ptr + length;
+    while (ptr < end) {
+        const char *newline = memchr(ptr, '\n', (size_t)(end - ptr));
+        const char *line_end = newline ? newline + 1 : end;
+        if (*ptr != '\n') {
+            codegen_indent(ctx);
         }
-        
-        fputc(*ptr, ctx->output);
-        ptr++;
+        codegen_append(ctx, ptr, (size_t)(line_end - ptr));
+        ptr = line_end;
+    }
+    
+    if (ctx->fd >= 0 && ctx->buffer_length >= CODEGEN_FLUSH_THRESHOLD) {
+        codegen_flush(ctx);
     }
 }
 
+/* Report a problem with the device description and fail the generation. */
+void codegen_error(CodegenContext *ctx, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(ctx->errors, "Codegen error: ");
+    vfprintf(ctx->errors, fmt, args);
+    fprintf(ctx->errors, "\n");
+    va_end(args);
+    ctx->error = 1;
+}
+
 char* sanitize_identifier(const char *name) {
     char *safe = malloc(strlen(name) + 1);
     int j = 0;
@@ -87,97 +199,787 @@ static void codegen_file_header(CodegenContext *ctx, const char *source_file) {
     codegen_write(ctx,
         "#ifndef __BITN_GENERATED_H\n"
         "#define __BITN_GENERATED_H\n\n"
+        "#include <stddef.h>\n"
         "#include <stdint.h>\n"
         "#include <stdbool.h>\n\n");
     
-    if (ctx->use_volatile) {
-        codegen_write(ctx, "#define MMIO_REG volatile uint32_t\n\n");
-    } else {
-        codegen_write(ctx, "#define MMIO_REG uint32_t\n\n");
-    }
+    // One storage type per declared register width; MMIO_REG is the 32-bit one.
+    const char *qualifier = ctx->use_volatile ? "volatile " : "";
+    codegen_write(ctx,
+        "#define MMIO_REG8  %suint8_t\n"
+        "#define MMIO_REG16 %suint16_t\n"
+        "#define MMIO_REG   %suint32_t\n"
+        "#define MMIO_REG64 %suint64_t\n\n",
+        qualifier, qualifier, qualifier, qualifier);
 }
 
 static void codegen_file_footer(CodegenContext *ctx) {
     codegen_write(ctx, "\n#endif // __BITN_GENERATED_H\n");
 }
 
-int codegen_peripheral(CodegenContext *ctx, ASTPeripheral *periph) {
-    if (!periph || !periph->name) return -1;
+/* Join sanitized name parts with '_' (e.g. UART0_UARTCR_UARTEN). */
+static char* codegen_join(const char *a, const char *b, const char *c) {
+    size_t length = strlen(a) + strlen(b) + (c ? strlen(c) + 1 : 0) + 2;
+    char *joined = malloc(length);
+    if (!joined) return NULL;
     
-    char *safe_name = sanitize_identifier(periph->name);
+    if (c) {
+        snprintf(joined, length, "%s_%s_%s", a, b, c);
+    } else {
+        snprintf(joined, length, "%s_%s", a, b);
+    }
     
-    codegen_write(ctx, "// Peripheral: %s\n", periph->name);
-    codegen_write(ctx, "// Base Address: 0x%08lx\n", periph->base_address);
-    /* Note: periph->size field may not exist in your AST */
+    char *safe = sanitize_identifier(joined);
+    free(joined);
+    return safe;
+}
+
+typedef struct {
+    unsigned pos;
+    unsigned width;
+    uint64_t mask;
+} CodegenFieldBits;
+
+/* Field ranges are written [msb:lsb] but accept either order. */
+static CodegenFieldBits codegen_field_bits(const ASTField *field) {
+    unsigned lo = field->start_bit < field->end_bit ? field->start_bit : field->end_bit;
+    unsigned hi = field->start_bit < field->end_bit ? field->end_bit : field->start_bit;
     
-    codegen_write(ctx, "typedef struct {\n");
-    ctx->indent_level++;
+    CodegenFieldBits bits;
+    bits.pos = lo;
+    bits.width = hi - lo + 1;
+    bits.mask = bits.width >= 64 ? ~0ull : ((1ull << bits.width) - 1) << lo;
+    return bits;
+}
+
+/*
+ * RP2040 APB and AHB-lite peripherals decode writes at +0x1000 (XOR),
+ * +0x2000 (SET) and +0x3000 (CLR) as atomic bit operations. SIO at
+ * 0xd0000000 has no aliases.
+ */
+#define RP2040_ALIAS_XOR 0x1000u
+#define RP2040_ALIAS_SET 0x2000u
+#define RP2040_ALIAS_CLR 0x3000u
+
+static int codegen_has_aliases(CodegenContext *ctx, const ASTPeripheral *periph) {
+    return ctx->atomic_aliases &&
+           periph->base_address >= 0x40000000u && periph->base_address < 0x60000000u;
+}
+
+/*
+ * Storage for a register's declared type. Narrow registers get narrow
+ * members so the access is a byte/halfword load or store; their values
+ * are shifted as uint32_t, 64-bit ones as uint64_t.
+ */
+typedef struct {
+    uint32_t size;
+    const char *ctype;       // Value type of accessors (uint16_t)
+    const char *mmio;        // Struct member type (MMIO_REG16)
+    const char *wide;        // Type val is shifted in (uint32_t)
+} CodegenRegWidth;
+
+static CodegenRegWidth codegen_register_width(const ASTRegister *reg) {
+    CodegenRegWidth w = { 4, "uint32_t", "MMIO_REG", "uint32_t" };
+    switch (reg->type ? reg->type->kind : TYPE_U32) {
+        case TYPE_U8:
+        case TYPE_I8:
+            w.size = 1; w.ctype = "uint8_t"; w.mmio = "MMIO_REG8";
+            break;
+        case TYPE_U16:
+        case TYPE_I16:
+            w.size = 2; w.ctype = "uint16_t"; w.mmio = "MMIO_REG16";
+            break;
+        case TYPE_U64:
+        case TYPE_I64:
+            w.size = 8; w.ctype = "uint64_t"; w.mmio = "MMIO_REG64"; w.wide = "uint64_t";
+            break;
+        default:
+            break;
+    }
+    return w;
+}
+
+/* 64-bit registers always get ULL masks so ~Msk keeps the upper word. */
+static void codegen_mask_literal(char *buffer, size_t size, uint64_t mask, int wide) {
+    if (wide || mask > 0xFFFFFFFFull) {
+        snprintf(buffer, size, "0x%016llXULL", (unsigned long long)mask);
+    } else {
+        snprintf(buffer, size, "0x%08llXU", (unsigned long long)mask);
+    }
+}
+
+/*
+ * Where a register lives: P->R for a plain register, P->C[n].R for one
+ * inside a cluster, whose accessors then take the element index first.
+ */
+typedef struct {
+    char *prefix;            // Name prefix for constants and accessors (P_R, P_C_R)
+    char *periph;            // Sanitized peripheral name
+    char *member;            // Member path after "->" (R, C[n].R)
+    const char *index_arg;   // "unsigned n, " or ""
+    const char *index_only;  // "unsigned n" or "void"
+    CodegenRegWidth width;
+    const char *promote;     // Cast applied to val before shifting, "" for 32/64-bit
+    char narrow[16];         // "(uint8_t)(" around results stored narrow, else ""
+    const char *narrow_end;
+    int has_w1c;             // Some field is write-1-to-clear: RMW must not write it back
+    int has_rw;              // Some field is rw: plain stores would zero it
+} CodegenRegSite;
+
+static int codegen_site_init(CodegenRegSite *site, const ASTPeripheral *periph,
+                             const ASTCluster *cluster, const ASTRegister *reg) {
+    const char *reg_name = atom_name(reg->name);
+    site->periph = sanitize_identifier(atom_name(periph->name));
+    site->prefix = NULL;
+    site->member = NULL;
+    site->width = codegen_register_width(reg);
+    site->promote = site->width.size < 4 ? "(uint32_t)" : "";
+    site->has_w1c = 0;
+    site->has_rw = 0;
+    for (size_t i = 0; i < reg->field_count; i++) {
+        if (reg->fields[i]->access == ACCESS_W1C) site->has_w1c = 1;
+        if (reg->fields[i]->access == ACCESS_RW) site->has_rw = 1;
+    }
+    site->narrow[0] = '\0';
+    site->narrow_end = "";
+    if (site->width.size < 4) {
+        snprintf(site->narrow, sizeof(site->narrow), "(%s)(", site->width.ctype);
+        site->narrow_end = ")";
+    }
     
-    if (periph->registers) {
-        for (size_t i = 0; i < periph->register_count; i++) {
-            ASTRegister *reg = periph->registers[i];
-            codegen_write(ctx, "MMIO_REG %s; // @ offset 0x%lx\n",
-                sanitize_identifier(reg->name), reg->offset);
+    if (cluster) {
+        char *group = codegen_join(site->periph, atom_name(cluster->name), NULL);
+        if (group) {
+            site->prefix = codegen_join(group, reg_name, NULL);
+            size_t length = strlen(atom_name(cluster->name)) + strlen(reg_name) + 6;
+            site->member = malloc(length);
+            if (site->member) {
+                snprintf(site->member, length, "%s[n].%s", atom_name(cluster->name), reg_name);
+            }
         }
+        free(group);
+        site->index_arg = "unsigned n, ";
+        site->index_only = "unsigned n";
+    } else {
+        site->prefix = codegen_join(site->periph, reg_name, NULL);
+        site->member = sanitize_identifier(reg_name);
+        site->index_arg = "";
+        site->index_only = "void";
     }
     
-    ctx->indent_level--;
-    codegen_write(ctx, "} %s_t;\n\n", safe_name);
+    return site->prefix && site->member ? 0 : -1;
+}
+
+static void codegen_site_free(CodegenRegSite *site) {
+    free(site->prefix);
+    free(site->periph);
+    free(site->member);
+}
+
+/* A struct member: a register, or a whole cluster array. */
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t align;
+    const char *name;
+    ASTRegister *reg;
+    ASTCluster *cluster;
+    size_t order;            // Declaration order, breaks offset ties
+} CodegenMember;
+
+static int codegen_member_cmp(const void *a, const void *b) {
+    const CodegenMember *x = (const CodegenMember *)a;
+    const CodegenMember *y = (const CodegenMember *)b;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+static uint32_t codegen_register_size(const ASTRegister *reg) {
+    return codegen_register_width(reg).size;
+}
+
+/* A cluster element is aligned like its widest register. */
+static uint32_t codegen_cluster_align(const ASTCluster *cluster) {
+    uint32_t align = 1;
+    for (size_t i = 0; i < cluster->register_count; i++) {
+        uint32_t size = codegen_register_size(cluster->registers[i]);
+        if (size > align) align = size;
+    }
+    return align;
+}
+
+static void codegen_add_register_member(CodegenMember *members, size_t *count, ASTRegister *reg) {
+    CodegenMember *m = &members[*count];
+    m->offset = reg->offset;
+    m->size = codegen_register_size(reg);
+    m->align = m->size;
+    m->name = atom_name(reg->name);
+    m->reg = reg;
+    m->cluster = NULL;
+    m->order = (*count)++;
+}
+
+/*
+ * Emit members in offset order with RESERVEDn byte arrays filling the gaps,
+ * then pad to size (0 = no tail padding). Overlapping members, or members
+ * that run past size, are reported and fail the layout.
+ */
+static int codegen_struct_body(CodegenContext *ctx, const char *owner, const char *type_prefix,
+                               CodegenMember *members, size_t count, uint32_t size) {
+    qsort(members, count, sizeof(CodegenMember), codegen_member_cmp);
     
-    codegen_write(ctx, "#define %s ((volatile %s_t *)0x%08lx)\n\n",
-        safe_name, safe_name, periph->base_address);
+    uint64_t cursor = 0;
+    unsigned reserved = 0;
+    const char *previous = NULL;
     
-    free(safe_name);
+    for (size_t i = 0; i < count; i++) {
+        CodegenMember *m = &members[i];
+        if (m->offset < cursor) {
+            codegen_error(ctx, "%s.%s at offset 0x%x overlaps %s.%s",
+                          owner, m->name, m->offset, owner, previous);
+            return -1;
+        }
+        if (m->offset % m->align != 0) {
+            codegen_error(ctx, "%s.%s at offset 0x%x is not %u-byte aligned",
+                          owner, m->name, m->offset, m->align);
+            return -1;
+        }
+        if (m->offset > cursor) {
+            codegen_write(ctx, "uint8_t RESERVED%u[0x%llx];\n",
+                          reserved++, (unsigned long long)(m->offset - cursor));
+        }
+        
+        char *safe = sanitize_identifier(m->name);
+        if (m->reg) {
+            codegen_write(ctx, "%s %s; // @ offset 0x%x\n",
+                          codegen_register_width(m->reg).mmio, safe, m->offset);
+        } else {
+            char *type = codegen_join(type_prefix, m->name, NULL);
+            codegen_write(ctx, "%s_t %s[%u]; // @ offset 0x%x, stride 0x%x\n",
+                          type, safe, m->cluster->count, m->offset, m->cluster->stride);
+            free(type);
+        }
+        free(safe);
+        
+        cursor = (uint64_t)m->offset + m->size;
+        previous = m->name;
+    }
+    
+    if (size && cursor > size) {
+        codegen_error(ctx, "%s.%s runs past the 0x%x byte stride", owner, previous, size);
+        return -1;
+    }
+    if (size && cursor < size) {
+        codegen_write(ctx, "uint8_t RESERVED%u[0x%llx];\n",
+                      reserved, (unsigned long long)(size - cursor));
+    }
     return 0;
 }
 
-int codegen_register(CodegenContext *ctx, ASTRegister *reg) {
-    if (!reg || !reg->name) return -1;
+/* Pin the layout so a compiler disagreeing with the register map fails to build. */
+static void codegen_struct_asserts(CodegenContext *ctx, const char *type, const char *owner,
+                                   const CodegenMember *members, size_t count, uint32_t size) {
+    for (size_t i = 0; i < count; i++) {
+        char *safe = sanitize_identifier(members[i].name);
+        codegen_write(ctx, "_Static_assert(offsetof(%s_t, %s) == 0x%x, \"%s.%s offset\");\n",
+                      type, safe, members[i].offset, owner, safe);
+        free(safe);
+    }
+    if (size) {
+        codegen_write(ctx, "_Static_assert(sizeof(%s_t) == 0x%x, \"%s size\");\n", type, size, owner);
+    }
+    codegen_write(ctx, "\n");
+}
+
+/* Element type for one cluster, exactly stride bytes long. */
+static int codegen_cluster_type(CodegenContext *ctx, const char *safe_periph, ASTCluster *cluster) {
+    CodegenMember *members = malloc((cluster->register_count + 1) * sizeof(CodegenMember));
+    char *type = codegen_join(safe_periph, atom_name(cluster->name), NULL);
+    char *owner = type ? malloc(strlen(type) + 4) : NULL;
+    int result = -1;
     
-    char *safe_reg_name = sanitize_identifier(reg->name);
+    uint32_t align = codegen_cluster_align(cluster);
+    if (members && owner && cluster->stride % align != 0) {
+        snprintf(owner, strlen(type) + 4, "%s[]", type);
+        codegen_error(ctx, "%s stride 0x%x is not a multiple of its %u-byte alignment",
+                      owner, cluster->stride, align);
+    } else if (members && owner) {
+        snprintf(owner, strlen(type) + 4, "%s[]", type);
+        size_t count = 0;
+        for (size_t i = 0; i < cluster->register_count; i++) {
+            codegen_add_register_member(members, &count, cluster->registers[i]);
+        }
+        
+        codegen_write(ctx, "typedef struct {\n");
+        ctx->indent_level++;
+        result = codegen_struct_body(ctx, owner, type, members, count, cluster->stride);
+        ctx->indent_level--;
+        codegen_write(ctx, "} %s_t;\n", type);
+        if (result == 0) {
+            codegen_struct_asserts(ctx, type, owner, members, count, cluster->stride);
+        }
+    }
     
-    codegen_write(ctx, "// Register: %s (Offset: 0x%lx)\n", reg->name, reg->offset);
-    codegen_write(ctx, "// Fields: %zu\n", reg->field_count);
+    free(owner);
+    free(type);
+    free(members);
+    return result;
+}
 
+/* One register's accessor prefix, and where it was declared for diagnostics. */
+typedef struct {
+    char *prefix;
+    const ASTCluster *cluster;
+    const ASTRegister *reg;
+} CodegenPrefix;
+
+/* Add reg's prefix to the list, reporting a register that already has it. */
+static int codegen_add_prefix(CodegenContext *ctx, CodegenPrefix *prefixes, size_t *count,
+                              const ASTPeripheral *periph, const ASTCluster *cluster,
+                              const ASTRegister *reg) {
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, cluster, reg);
+    
+    for (size_t i = 0; result == 0 && i < *count; i++) {
+        const CodegenPrefix *other = &prefixes[i];
+        if (strcmp(other->prefix, site.prefix) != 0) continue;
+        codegen_error(ctx, "%s.%s%s%s and %s.%s%s%s both define %s accessors",
+                      site.periph, other->cluster ? atom_name(other->cluster->name) : "",
+                      other->cluster ? "[]." : "", atom_name(other->reg->name),
+                      site.periph, cluster ? atom_name(cluster->name) : "",
+                      cluster ? "[]." : "", atom_name(reg->name), site.prefix);
+        result = -1;
+    }
+    
+    if (result == 0) {
+        prefixes[*count].prefix = site.prefix;
+        prefixes[*count].cluster = cluster;
+        prefixes[*count].reg = reg;
+        (*count)++;
+        site.prefix = NULL;
+    }
+    codegen_site_free(&site);
+    return result;
+}
+
+/*
+ * Accessor prefixes are P_R for a plain register and P_C_R inside cluster
+ * C, so register C_R and cluster C's R would define the same names twice.
+ * Report any two registers of the peripheral that share a prefix.
+ */
+static int codegen_check_prefixes(CodegenContext *ctx, const ASTPeripheral *periph) {
+    size_t total = periph->register_count;
+    for (size_t c = 0; c < periph->cluster_count; c++) {
+        total += periph->clusters[c]->register_count;
+    }
+    
+    CodegenPrefix *prefixes = malloc((total + 1) * sizeof(CodegenPrefix));
+    if (!prefixes) return -1;
+    
+    size_t count = 0;
+    int result = 0;
+    for (size_t r = 0; result == 0 && r < periph->register_count; r++) {
+        result = codegen_add_prefix(ctx, prefixes, &count, periph, NULL, periph->registers[r]);
+    }
+    for (size_t c = 0; result == 0 && c < periph->cluster_count; c++) {
+        const ASTCluster *cluster = periph->clusters[c];
+        for (size_t r = 0; result == 0 && r < cluster->register_count; r++) {
+            result = codegen_add_prefix(ctx, prefixes, &count, periph, cluster, cluster->registers[r]);
+        }
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        free(prefixes[i].prefix);
+    }
+    free(prefixes);
+    return result;
+}
+
+int codegen_peripheral(CodegenContext *ctx, ASTPeripheral *periph) {
+    if (!periph || periph->name == ATOM_NONE) return -1;
+    
+    if (codegen_check_prefixes(ctx, periph) != 0) return -1;
+    
+    char *safe_name = sanitize_identifier(atom_name(periph->name));
+    
+    codegen_write(ctx, "// Peripheral: %s\n", atom_name(periph->name));
+    codegen_write(ctx, "// Base Address: 0x%08x\n", periph->base_address);
+    
+    for (size_t c = 0; c < periph->cluster_count; c++) {
+        if (codegen_cluster_type(ctx, safe_name, periph->clusters[c]) != 0) {
+            free(safe_name);
+            return -1;
+        }
+    }
+    
+    size_t count = 0;
+    CodegenMember *members = malloc((periph->register_count + periph->cluster_count + 1) *
+                                    sizeof(CodegenMember));
+    if (!members) {
+        free(safe_name);
+        return -1;
+    }
+    for (size_t r = 0; r < periph->register_count; r++) {
+        codegen_add_register_member(members, &count, periph->registers[r]);
+    }
+    for (size_t c = 0; c < periph->cluster_count; c++) {
+        ASTCluster *cluster = periph->clusters[c];
+        CodegenMember *m = &members[count];
+        m->offset = cluster->offset;
+        m->size = cluster->count * cluster->stride;
+        m->align = codegen_cluster_align(cluster);
+        m->name = atom_name(cluster->name);
+        m->reg = NULL;
+        m->cluster = cluster;
+        m->order = count++;
+    }
+    
     codegen_write(ctx, "typedef struct {\n");
     ctx->indent_level++;
     
-    if (reg->fields) {
-        for (size_t i = 0; i < reg->field_count; i++) {
-            ASTField *field = reg->fields[i];
-            
-            /* TODO: Update these field names to match your ASTField structure */
-            /* Currently commented out because field->high_bit, field->low_bit don't exist */
-            
-            codegen_write(ctx, "uint32_t %s; // Field placeholder\n",
-                sanitize_identifier(field->name));
+    int result = codegen_struct_body(ctx, safe_name, safe_name, members, count, 0);
+    
+    ctx->indent_level--;
+    codegen_write(ctx, "} %s_t;\n", safe_name);
+    
+    if (result == 0) {
+        codegen_struct_asserts(ctx, safe_name, safe_name, members, count, 0);
+    }
+    free(members);
+    
+    codegen_write(ctx, "#define %s ((volatile %s_t *)0x%08x)\n\n",
+        safe_name, safe_name, periph->base_address);
+    
+    if (codegen_has_aliases(ctx, periph)) {
+        codegen_write(ctx, "// Atomic alias views: every store XORs, sets or clears the written bits\n");
+        codegen_write(ctx, "#define %s_XOR ((volatile %s_t *)0x%08x)\n",
+            safe_name, safe_name, periph->base_address + RP2040_ALIAS_XOR);
+        codegen_write(ctx, "#define %s_SET ((volatile %s_t *)0x%08x)\n",
+            safe_name, safe_name, periph->base_address + RP2040_ALIAS_SET);
+        codegen_write(ctx, "#define %s_CLR ((volatile %s_t *)0x%08x)\n\n",
+            safe_name, safe_name, periph->base_address + RP2040_ALIAS_CLR);
+    }
+    
+    free(safe_name);
+    return result;
+}
+
+/* Position and mask constants for every field of the register. */
+static void codegen_register_at(CodegenContext *ctx, const CodegenRegSite *site, ASTRegister *reg) {
+    codegen_write(ctx, "// Register: %s (Offset: 0x%x)\n", atom_name(reg->name), reg->offset);
+    codegen_write(ctx, "// Fields: %zu\n", reg->field_count);
+    
+    uint64_t w1c = 0;
+    for (size_t i = 0; i < reg->field_count; i++) {
+        ASTField *field = reg->fields[i];
+        char *prefix = codegen_join(site->prefix, atom_name(field->name), NULL);
+        if (!prefix) return;
+        
+        CodegenFieldBits bits = codegen_field_bits(field);
+        if (bits.pos + bits.width > site->width.size * 8) {
+            codegen_error(ctx, "%s bits [%u:%u] do not fit a %u-bit register", prefix,
+                          bits.pos + bits.width - 1, bits.pos, site->width.size * 8);
+            free(prefix);
+            return;
         }
+        char mask[32];
+        codegen_mask_literal(mask, sizeof(mask), bits.mask, site->width.size == 8);
+        
+        codegen_write(ctx, "#define %s_Pos %uU\n", prefix, bits.pos);
+        codegen_write(ctx, "#define %s_Msk %s\n", prefix, mask);
+        free(prefix);
+        if (field->access == ACCESS_W1C) w1c |= bits.mask;
     }
     
-    ctx->indent_level--;
-    codegen_write(ctx, "} %s_bitfield_t;\n\n", safe_reg_name);
+    // _MASK, not _Msk: a field named W1C already defines <prefix>_W1C_Msk
+    if (site->has_w1c) {
+        char mask[32];
+        codegen_mask_literal(mask, sizeof(mask), w1c, site->width.size == 8);
+        codegen_write(ctx, "#define %s_W1C_MASK %s\n", site->prefix, mask);
+    }
     
-    free(safe_reg_name);
-    return 0;
+    codegen_write(ctx, "\n");
 }
 
-int codegen_field_accessors(CodegenContext *ctx, ASTRegister *reg) {
-    if (!reg || !reg->fields) return -1;
+/*
+ * Per field: GET/SET macros and _read/_write functions that operate on a
+ * register value, plus _get/_set/_clear/_modify that access the register
+ * itself. Masks and shifts are the literal _Pos/_Msk constants, so each
+ * access folds to a single and/or/shift sequence.
+ *
+ * The field's access kind decides which of these exist: ro fields only read,
+ * wo fields get a _set and no readers, and w1c fields get a _clear that
+ * acknowledges just that flag. Both are a single store unless the register
+ * also holds rw fields, which a store would zero; then they read once and
+ * keep them. Every read-modify-write masks w1c bits out of the value written
+ * back, so it never acknowledges a flag that happened to be pending.
+ */
+static void codegen_field_accessors_at(CodegenContext *ctx, const CodegenRegSite *site,
+                                       ASTRegister *reg) {
+    const char *p = site->periph;
+    const char *m = site->member;
+    const char *n = site->index_arg;
+    const char *t = site->width.ctype;
+    const char *v = site->promote;
+    const char *c = site->narrow;
+    const char *e = site->narrow_end;
     
-    char *safe_reg = sanitize_identifier(reg->name);
+    // modify() also drops w1c bits from the value it writes back
+    size_t w1c_length = strlen(site->prefix) + 16;
+    char *w1c = malloc(w1c_length);
+    if (!w1c) return;
+    w1c[0] = '\0';
+    if (site->has_w1c) snprintf(w1c, w1c_length, " & ~%s_W1C_MASK", site->prefix);
     
     for (size_t i = 0; i < reg->field_count; i++) {
         ASTField *field = reg->fields[i];
-        char *safe_field = sanitize_identifier(field->name);
+        char *x = codegen_join(site->prefix, atom_name(field->name), NULL);
+        if (!x) break;
         
-        /* TODO: Update these to use your actual ASTField member names */
-        codegen_write(ctx, "// Field accessor for %s\n", safe_field);
+        AccessKind access = field->access;
+        int readable = access != ACCESS_WO;
+        int writable = access == ACCESS_RW || access == ACCESS_WO;
         
-        free(safe_field);
+        // Bits a read-modify-write of this field must not store back
+        size_t length = 2 * strlen(x) + strlen(site->prefix) + 32;
+        char *keep = malloc(length);
+        if (!keep) {
+            free(x);
+            break;
+        }
+        if (site->has_w1c) {
+            snprintf(keep, length, "(%s_Msk | %s_W1C_MASK)", x, site->prefix);
+        } else {
+            snprintf(keep, length, "%s_Msk", x);
+        }
+        
+        if (readable) {
+            codegen_write(ctx, "#define %s_GET(reg) (((reg) & %s_Msk) >> %s_Pos)\n", x, x, x);
+        }
+        if (writable) {
+            codegen_write(ctx,
+                "#define %s_SET(reg, val) (((reg) & ~%s_Msk) | (((%s)(val) << %s_Pos) & %s_Msk))\n",
+                x, x, site->width.wide, x, x);
+        }
+        codegen_write(ctx, "\n");
+        
+        if (readable) {
+            codegen_write(ctx,
+                "static inline %s %s_read(%s reg) {\n"
+                "    return %s(reg & %s_Msk) >> %s_Pos%s;\n"
+                "}\n\n",
+                t, x, t, c, x, x, e);
+        }
+        if (writable) {
+            codegen_write(ctx,
+                "static inline %s %s_write(%s reg, %s val) {\n"
+                "    return %s(reg & ~%s_Msk) | ((%sval << %s_Pos) & %s_Msk)%s;\n"
+                "}\n\n",
+                t, x, t, t, c, x, v, x, x, e);
+        }
+        
+        if (readable) {
+            codegen_write(ctx,
+                "static inline %s %s_get(%s) {\n"
+                "    return %s(%s->%s & %s_Msk) >> %s_Pos%s;\n"
+                "}\n\n",
+                t, x, site->index_only, c, p, m, x, x, e);
+        }
+        
+        if (access == ACCESS_RW || (access == ACCESS_WO && site->has_rw)) {
+            codegen_write(ctx,
+                "static inline void %s_set(%s%s val) {\n"
+                "    %s->%s = %s(%s->%s & ~%s) | ((%sval << %s_Pos) & %s_Msk)%s;\n"
+                "}\n\n",
+                x, n, t, p, m, c, p, m, keep, v, x, x, e);
+        }
+        if (access == ACCESS_RW) {
+            codegen_write(ctx,
+                "static inline void %s_clear(%s) {\n"
+                "    %s->%s &= %s~%s%s;\n"
+                "}\n\n",
+                x, site->index_only, p, m, c, keep, e);
+            
+            /* modify: clear then set bits, both given relative to the field. */
+            codegen_write(ctx,
+                "static inline void %s_modify(%s%s clear, %s set) {\n"
+                "    %s->%s = %s(%s->%s & ~((%sclear << %s_Pos) & %s_Msk)%s) | ((%sset << %s_Pos) & %s_Msk)%s;\n"
+                "}\n\n",
+                x, n, t, t, p, m, c, p, m, v, x, x, w1c, v, x, x, e);
+        } else if (access == ACCESS_WO && !site->has_rw) {
+            /* Store-only: the other fields of the register are written as zero. */
+            codegen_write(ctx,
+                "static inline void %s_set(%s%s val) {\n"
+                "    %s->%s = %s(%sval << %s_Pos) & %s_Msk%s;\n"
+                "}\n\n",
+                x, n, t, p, m, c, v, x, x, e);
+        } else if (access == ACCESS_W1C && site->has_rw) {
+            codegen_write(ctx,
+                "static inline void %s_clear(%s) {\n"
+                "    %s->%s = %s(%s->%s & ~%s_W1C_MASK) | %s_Msk%s;\n"
+                "}\n\n",
+                x, site->index_only, p, m, c, p, m, site->prefix, x, e);
+        } else if (access == ACCESS_W1C) {
+            /* Acknowledge: a single store of the field's mask, no read. */
+            codegen_write(ctx,
+                "static inline void %s_clear(%s) {\n"
+                "    %s->%s = %s_Msk;\n"
+                "}\n\n",
+                x, site->index_only, p, m, x);
+        }
+        
+        free(keep);
+        free(x);
     }
+    free(w1c);
+}
+
+/*
+ * Whole-register builders. P_R_VALUE(.F = 3, .G = 1) packs the named fields
+ * (others zero) through designated initializers, so constant arguments fold
+ * to one constant. P_R_write_fields(mask, value) replaces any subset of
+ * fields with a single read-modify-write, leaving w1c flags alone.
+ */
+static void codegen_register_builders_at(CodegenContext *ctx, const CodegenRegSite *site,
+                                         ASTRegister *reg) {
+    const char *x = site->prefix;
+    const char *t = site->width.ctype;
+    const char *c = site->narrow;
+    const char *e = site->narrow_end;
+    size_t writable = 0;
     
-    free(safe_reg);
-    return 0;
+    for (size_t i = 0; i < reg->field_count; i++) {
+        AccessKind access = reg->fields[i]->access;
+        if (access == ACCESS_RW || access == ACCESS_WO) writable++;
+    }
+    if (writable == 0) return;
+    
+    codegen_write(ctx, "typedef struct {\n");
+    for (size_t i = 0; i < reg->field_count; i++) {
+        AccessKind access = reg->fields[i]->access;
+        if (access != ACCESS_RW && access != ACCESS_WO) continue;
+        char *safe = sanitize_identifier(atom_name(reg->fields[i]->name));
+        codegen_write(ctx, "    %s %s;\n", site->width.wide, safe);
+        free(safe);
+    }
+    codegen_write(ctx, "} %s_fields_t;\n\n", x);
+    
+    codegen_write(ctx, "static inline %s %s_pack(%s_fields_t f) {\n    return %s", t, x, x, c);
+    size_t emitted = 0;
+    for (size_t i = 0; i < reg->field_count; i++) {
+        AccessKind access = reg->fields[i]->access;
+        if (access != ACCESS_RW && access != ACCESS_WO) continue;
+        char *safe = sanitize_identifier(atom_name(reg->fields[i]->name));
+        char *f = codegen_join(x, safe, NULL);
+        if (f) {
+            codegen_write(ctx, "%s((f.%s << %s_Pos) & %s_Msk)", emitted ? " |\n           " : "",
+                          safe, f, f);
+        }
+        emitted++;
+        free(f);
+        free(safe);
+    }
+    codegen_write(ctx, "%s;\n}\n\n", e);
+    
+    codegen_write(ctx, "#define %s_VALUE(...) %s_pack((%s_fields_t){ __VA_ARGS__ })\n\n", x, x, x);
+    
+    if (site->has_rw && site->has_w1c) {
+        codegen_write(ctx,
+            "static inline void %s_write_fields(%s%s mask, %s value) {\n"
+            "    %s->%s = %s(%s->%s & ~(mask | %s_W1C_MASK)) | (value & mask)%s;\n"
+            "}\n\n",
+            x, site->index_arg, t, t, site->periph, site->member, c,
+            site->periph, site->member, x, e);
+    } else if (site->has_rw) {
+        codegen_write(ctx,
+            "static inline void %s_write_fields(%s%s mask, %s value) {\n"
+            "    %s->%s = %s(%s->%s & ~mask) | (value & mask)%s;\n"
+            "}\n\n",
+            x, site->index_arg, t, t, site->periph, site->member, c,
+            site->periph, site->member, e);
+    }
+}
+
+/* Register-wide atomic: pass any OR of the register's _Msk values. */
+static void codegen_register_aliases_at(CodegenContext *ctx, const CodegenRegSite *site) {
+    const char *x = site->prefix;
+    const char *p = site->periph;
+    const char *m = site->member;
+    const char *n = site->index_arg;
+    
+    const char *t = site->width.ctype;
+    
+    codegen_write(ctx,
+        "static inline void %s_set(%s%s mask) {\n"
+        "    %s_SET->%s = mask;\n"
+        "}\n\n"
+        "static inline void %s_clr(%s%s mask) {\n"
+        "    %s_CLR->%s = mask;\n"
+        "}\n\n"
+        "static inline void %s_xor(%s%s mask) {\n"
+        "    %s_XOR->%s = mask;\n"
+        "}\n\n",
+        x, n, t, p, m,
+        x, n, t, p, m,
+        x, n, t, p, m);
+}
+
+/* Constants, accessors and (where available) atomic aliases for one register. */
+static int codegen_register_all(CodegenContext *ctx, ASTPeripheral *periph,
+                                ASTCluster *cluster, ASTRegister *reg) {
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, cluster, reg);
+    if (result == 0) {
+        codegen_register_at(ctx, &site, reg);
+        codegen_field_accessors_at(ctx, &site, reg);
+        codegen_register_builders_at(ctx, &site, reg);
+        // The alias windows only decode full 32-bit writes.
+        if (codegen_has_aliases(ctx, periph) && site.width.size == 4) {
+            codegen_register_aliases_at(ctx, &site);
+        }
+    }
+    codegen_site_free(&site);
+    return result;
+}
+
+int codegen_register(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg) {
+    if (!periph || !reg || reg->name == ATOM_NONE) return -1;
+    
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, NULL, reg);
+    if (result == 0) codegen_register_at(ctx, &site, reg);
+    codegen_site_free(&site);
+    return result;
+}
+
+int codegen_field_accessors(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg) {
+    if (!periph || !reg || !reg->fields) return -1;
+    
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, NULL, reg);
+    if (result == 0) codegen_field_accessors_at(ctx, &site, reg);
+    codegen_site_free(&site);
+    return result;
+}
+
+int codegen_register_builders(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg) {
+    if (!periph || !reg || !reg->fields) return -1;
+    
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, NULL, reg);
+    if (result == 0) codegen_register_builders_at(ctx, &site, reg);
+    codegen_site_free(&site);
+    return result;
+}
+
+int codegen_register_aliases(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg) {
+    if (!periph || !reg || !codegen_has_aliases(ctx, periph)) return 0;
+    
+    CodegenRegSite site;
+    int result = codegen_site_init(&site, periph, NULL, reg);
+    if (result == 0 && site.width.size == 4) codegen_register_aliases_at(ctx, &site);
+    codegen_site_free(&site);
+    return result;
 }
 
 int codegen_helpers(CodegenContext *ctx) {
@@ -201,13 +1003,18 @@ int codegen_generate(CodegenContext *ctx, ASTProgram *program) {
         for (size_t i = 0; i < program->peripheral_count; i++) {
             ASTPeripheral *periph = program->peripherals[i];
             
-            codegen_peripheral(ctx, periph);
+            if (codegen_peripheral(ctx, periph) != 0) {
+                return -1;
+            }
             
-            if (periph->registers) {
-                for (size_t j = 0; j < periph->register_count; j++) {
-                    ASTRegister *reg = periph->registers[j];
-                    codegen_register(ctx, reg);
-                    codegen_field_accessors(ctx, reg);
+            for (size_t j = 0; j < periph->register_count; j++) {
+                codegen_register_all(ctx, periph, NULL, periph->registers[j]);
+            }
+            
+            for (size_t c = 0; c < periph->cluster_count; c++) {
+                ASTCluster *cluster = periph->clusters[c];
+                for (size_t j = 0; j < cluster->register_count; j++) {
+                    codegen_register_all(ctx, periph, cluster, cluster->registers[j]);
                 }
             }
             
@@ -217,19 +1024,21 @@ int codegen_generate(CodegenContext *ctx, ASTProgram *program) {
     
     codegen_file_footer(ctx);
     
-    return 0;
+    return codegen_flush(ctx);
 }
 
 void codegen_cleanup(CodegenContext *ctx) {
     if (!ctx) return;
     
-    if (ctx->output) {
-        fclose(ctx->output);
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
     }
     
     if (ctx->target_arch) {
         free(ctx->target_arch);
     }
     
+    free(ctx->buffer);
+    free(ctx->scratch);
     free(ctx);
 }
@@ -9,24 +9,47 @@
 #include "../../include/ast.h"
 #include <stdio.h>
 
+// Version of the generated header format. Bump it with any change that makes
+// codegen emit different bytes for the same input, so headers cached by an
+// older build are not served (cache.h keys entries on it).
+#define CODEGEN_FORMAT_VERSION 2
+
+// Output is accumulated in a growable buffer. Contexts opened on a file write
+// it out in large chunks; buffer contexts keep it all for codegen_buffer().
 typedef struct {
-    FILE *output;
+    int fd;                // Output file, or -1 for codegen_init_buffer
+    char *buffer;
+    size_t buffer_length;
+    size_t buffer_capacity;
+    char *scratch;         // Formatting space for codegen_write
+    size_t scratch_capacity;
+    int error;             // Set on allocation/write failure or a bad layout
+    FILE *errors;          // Diagnostics sink (stderr unless redirected)
     int indent_level;
     char *target_arch;
     char *target_abi;
     int use_volatile;
     int inline_asm;
+    int atomic_aliases;    // RP2040: peripherals have XOR/SET/CLR alias windows
 } CodegenContext;
 
 CodegenContext* codegen_init(const char *output_file, const char *target);
+CodegenContext* codegen_init_buffer(const char *target);
+const char* codegen_buffer(CodegenContext *ctx, size_t *length);
 int codegen_generate(CodegenContext *ctx, ASTProgram *program);
 int codegen_peripheral(CodegenContext *ctx, ASTPeripheral *periph);
-int codegen_register(CodegenContext *ctx, ASTRegister *reg);
-int codegen_field_accessors(CodegenContext *ctx, ASTRegister *reg);
+int codegen_register(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg);
+int codegen_field_accessors(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg);
+int codegen_register_builders(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg);
+int codegen_register_aliases(CodegenContext *ctx, ASTPeripheral *periph, ASTRegister *reg);
 int codegen_helpers(CodegenContext *ctx);
+int codegen_flush(CodegenContext *ctx);
 void codegen_cleanup(CodegenContext *ctx);
 void codegen_indent(CodegenContext *ctx);
-void codegen_write(CodegenContext *ctx, const char *fmt, ...);
+void codegen_write(CodegenContext *ctx, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+void codegen_error(CodegenContext *ctx, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
 char* sanitize_identifier(const char *name);
 
 #endif // BITN_CODEGEN_H
@@ -0,0 +1,929 @@
+/**
+ * bit(N) Compiler - Thumb-1 Machine Code Backend
+ *
+ * Each function body is lowered to a linear three-address IR over virtual
+ * registers, the virtual registers are assigned to r0-r7 by linear scan, and
+ * the IR is encoded directly as ARMv6-M instructions. Values narrower than
+ * 32 bits are kept zero- or sign-extended in their registers, so only the
+ * operations that can carry out of the type are followed by an extend.
+ */
+
+#include "thumb.h"
+#include "../../include/type_system.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// IR
+// ============================================================================
+
+typedef enum {
+    TIR_CONST,   // dst = imm
+    TIR_BIN,     // dst = a <sub> b
+    TIR_SHIFTI,  // dst = a <sub> imm, sub is TBIN_SHL/SHR/SAR, imm in 1..31
+    TIR_ADDI,    // dst = a + imm, imm in 0..7
+    TIR_SUBI,    // dst = a - imm, imm in 0..7
+    TIR_NEG,     // dst = -a
+    TIR_NOT,     // dst = ~a
+    TIR_LNOT,    // dst = a == 0
+    TIR_EXT,     // dst = a extended from the width in sub
+    TIR_SET,     // dst = a <cond sub> b ? 1 : 0
+    TIR_CALL,    // dst = symbol(a, b), result taken from r<sub>
+    TIR_RET,     // return a (-1: no value)
+} ThumbIrOp;
+
+typedef enum {
+    TBIN_ADD, TBIN_SUB, TBIN_MUL, TBIN_AND, TBIN_OR, TBIN_XOR,
+    TBIN_SHL, TBIN_SHR, TBIN_SAR, TBIN_ROR,
+} ThumbBin;
+
+typedef enum { TEXT_U8, TEXT_U16, TEXT_I8, TEXT_I16 } ThumbExt;
+
+// Condition codes as encoded in Bcc
+enum {
+    TCOND_EQ = 0x0, TCOND_NE = 0x1, TCOND_HS = 0x2, TCOND_LO = 0x3,
+    TCOND_HI = 0x8, TCOND_LS = 0x9, TCOND_GE = 0xA, TCOND_LT = 0xB,
+    TCOND_GT = 0xC, TCOND_LE = 0xD,
+};
+
+typedef struct {
+    ThumbIrOp op;
+    int sub;               // ThumbBin, ThumbExt, condition or result register
+    int dst, a, b;         // Virtual registers, -1 if unused
+    uint32_t imm;
+    const char *symbol;
+} ThumbIr;
+
+typedef struct {
+    Atom name;
+    int vreg;
+} ThumbLocal;
+
+typedef struct {
+    ThumbContext *ctx;
+    const char *function;
+    ThumbIr *ir;
+    size_t count;
+    size_t capacity;
+    int vregs;
+    ThumbLocal *locals;    // Innermost binding last; locals are immutable
+    size_t local_count;
+    size_t local_capacity;
+    int has_calls;
+    int failed;
+} ThumbLower;
+
+// ============================================================================
+// Diagnostics
+// ============================================================================
+
+void thumb_error(ThumbContext *ctx, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(ctx->errors, "Error: ");
+    vfprintf(ctx->errors, fmt, args);
+    fprintf(ctx->errors, "\n");
+    va_end(args);
+    ctx->error = 1;
+}
+
+static int thumb_lower_fail(ThumbLower *L, const ASTExpr *expr, const char *what) {
+    if (!L->failed) {
+        thumb_error(L->ctx, "fn %s, line %d: %s", L->function, expr ? expr->line : 0, what);
+    }
+    L->failed = 1;
+    return -1;
+}
+
+// ============================================================================
+// Lowering
+// ============================================================================
+
+static int thumb_emit_ir(ThumbLower *L, ThumbIrOp op, int sub, int a, int b, uint32_t imm) {
+    if (L->count == L->capacity) {
+        size_t capacity = L->capacity ? L->capacity * 2 : 64;
+        ThumbIr *ir = (ThumbIr *)realloc(L->ir, capacity * sizeof(ThumbIr));
+        if (!ir) return thumb_lower_fail(L, NULL, "out of memory");
+        L->ir = ir;
+        L->capacity = capacity;
+    }
+
+    int dst = op == TIR_RET ? -1 : L->vregs++;
+    L->ir[L->count++] = (ThumbIr){ op, sub, dst, a, b, imm, NULL };
+    return dst;
+}
+
+static int thumb_is_signed(TypeKind kind) {
+    return kind == TYPE_I8 || kind == TYPE_I16 || kind == TYPE_I32 || kind == TYPE_I64;
+}
+
+// The value of a constant as held in a register of the given type.
+static uint32_t thumb_register_value(uint64_t value, TypeKind kind) {
+    switch (kind) {
+        case TYPE_U8:  return (uint32_t)(value & 0xFF);
+        case TYPE_U16: return (uint32_t)(value & 0xFFFF);
+        case TYPE_I8:  return (uint32_t)(int32_t)(int8_t)(uint8_t)value;
+        case TYPE_I16: return (uint32_t)(int32_t)(int16_t)(uint16_t)value;
+        default:       return (uint32_t)value;
+    }
+}
+
+static int thumb_const(ThumbLower *L, uint32_t value) {
+    return thumb_emit_ir(L, TIR_CONST, 0, -1, -1, value);
+}
+
+// Re-extend a value whose result may have carried past its type's width.
+static int thumb_narrow(ThumbLower *L, int v, TypeKind kind) {
+    switch (kind) {
+        case TYPE_U8:  return thumb_emit_ir(L, TIR_EXT, TEXT_U8, v, -1, 0);
+        case TYPE_U16: return thumb_emit_ir(L, TIR_EXT, TEXT_U16, v, -1, 0);
+        case TYPE_I8:  return thumb_emit_ir(L, TIR_EXT, TEXT_I8, v, -1, 0);
+        case TYPE_I16: return thumb_emit_ir(L, TIR_EXT, TEXT_I16, v, -1, 0);
+        default:       return v;
+    }
+}
+
+static int thumb_bin(ThumbLower *L, ThumbBin op, int a, int b) {
+    return thumb_emit_ir(L, TIR_BIN, op, a, b, 0);
+}
+
+static int thumb_shift(ThumbLower *L, ThumbBin op, int a, unsigned amount) {
+    if (amount == 0) return a;
+    return thumb_emit_ir(L, TIR_SHIFTI, op, a, -1, amount);
+}
+
+static int thumb_call(ThumbLower *L, const char *symbol, int result, int a, int b) {
+    int dst = thumb_emit_ir(L, TIR_CALL, result, a, b, 0);
+    if (dst >= 0) L->ir[L->count - 1].symbol = symbol;
+    L->has_calls = 1;
+    return dst;
+}
+
+static int thumb_constant_operand(const ASTExpr *expr, uint32_t *value) {
+    if (expr->kind != EXPR_NUMBER || !expr->type) return 0;
+    *value = thumb_register_value(expr->data.number_value, expr->type->kind);
+    return 1;
+}
+
+static int thumb_lower_expr(ThumbLower *L, ASTExpr *expr);
+
+// Rotates of narrow values have no instruction; build them from two shifts
+// of the zero-extended bits.
+static int thumb_lower_narrow_rotate(ThumbLower *L, ASTExpr *expr, int a, TypeKind kind,
+                                     unsigned width) {
+    int left = expr->data.binary.op == BOP_LROTATE;
+    int bits = thumb_is_signed(kind) ?
+               thumb_emit_ir(L, TIR_EXT, width == 8 ? TEXT_U8 : TEXT_U16, a, -1, 0) : a;
+    int high, low;
+
+    uint32_t amount;
+    if (thumb_constant_operand(expr->data.binary.right, &amount)) {
+        unsigned k = amount % width;
+        if (k == 0) return a;
+        if (!left) k = width - k;
+        high = thumb_shift(L, TBIN_SHL, bits, k);
+        low = thumb_shift(L, TBIN_SHR, bits, width - k);
+    } else {
+        int b = thumb_lower_expr(L, expr->data.binary.right);
+        if (b < 0) return -1;
+        int n = thumb_bin(L, TBIN_AND, b, thumb_const(L, width - 1));
+        int rest = thumb_bin(L, TBIN_SUB, thumb_const(L, width), n);
+        high = thumb_bin(L, TBIN_SHL, bits, left ? n : rest);
+        low = thumb_bin(L, TBIN_SHR, bits, left ? rest : n);
+    }
+    return thumb_narrow(L, thumb_bin(L, TBIN_OR, high, low), kind);
+}
+
+static int thumb_lower_rotate(ThumbLower *L, ASTExpr *expr, int a, TypeKind kind) {
+    unsigned width = (unsigned)type_get_size(kind) * 8;
+    if (width < 32) return thumb_lower_narrow_rotate(L, expr, a, kind, width);
+
+    // RORS is the only rotate; a left rotate by k is a right rotate by 32 - k.
+    int left = expr->data.binary.op == BOP_LROTATE;
+    uint32_t amount;
+    int b;
+    if (thumb_constant_operand(expr->data.binary.right, &amount)) {
+        unsigned k = amount % 32;
+        if (k == 0) return a;
+        b = thumb_const(L, left ? 32 - k : k);
+    } else {
+        b = thumb_lower_expr(L, expr->data.binary.right);
+        if (b < 0) return -1;
+        if (left) b = thumb_emit_ir(L, TIR_NEG, 0, b, -1, 0);
+    }
+    return thumb_bin(L, TBIN_ROR, a, b);
+}
+
+static int thumb_lower_binary(ThumbLower *L, ASTExpr *expr) {
+    ASTExpr *left = expr->data.binary.left;
+    ASTExpr *right = expr->data.binary.right;
+    TypeKind kind = left->type->kind;
+    int is_signed = thumb_is_signed(kind);
+    BinaryOp op = expr->data.binary.op;
+
+    int a = thumb_lower_expr(L, left);
+    if (a < 0) return -1;
+
+    uint32_t amount;
+    int constant = thumb_constant_operand(right, &amount);
+
+    // Forms with an immediate operand
+    if ((op == BOP_ADD || op == BOP_SUB) && constant && amount < 8) {
+        if (amount == 0) return a;
+        return thumb_narrow(L, thumb_emit_ir(L, op == BOP_ADD ? TIR_ADDI : TIR_SUBI, 0, a, -1, amount),
+                            kind);
+    }
+    if ((op == BOP_LSHIFT || op == BOP_RSHIFT) && constant && amount < 32) {
+        if (amount == 0) return a;
+        if (op == BOP_RSHIFT) return thumb_shift(L, is_signed ? TBIN_SAR : TBIN_SHR, a, amount);
+        return thumb_narrow(L, thumb_shift(L, TBIN_SHL, a, amount), kind);
+    }
+    if (op == BOP_LROTATE || op == BOP_RROTATE) {
+        return thumb_lower_rotate(L, expr, a, kind);
+    }
+
+    int b = thumb_lower_expr(L, right);
+    if (b < 0) return -1;
+
+    switch (op) {
+        case BOP_ADD:    return thumb_narrow(L, thumb_bin(L, TBIN_ADD, a, b), kind);
+        case BOP_SUB:    return thumb_narrow(L, thumb_bin(L, TBIN_SUB, a, b), kind);
+        case BOP_MUL:    return thumb_narrow(L, thumb_bin(L, TBIN_MUL, a, b), kind);
+        case BOP_AND:    return thumb_bin(L, TBIN_AND, a, b);
+        case BOP_OR:     return thumb_bin(L, TBIN_OR, a, b);
+        case BOP_XOR:    return thumb_bin(L, TBIN_XOR, a, b);
+        case BOP_LSHIFT: return thumb_narrow(L, thumb_bin(L, TBIN_SHL, a, b), kind);
+        case BOP_RSHIFT: return thumb_bin(L, is_signed ? TBIN_SAR : TBIN_SHR, a, b);
+
+        // ARMv6-M has no divider; these are the run-time ABI helpers.
+        case BOP_DIV:
+            if (!is_signed) return thumb_call(L, "__aeabi_uidiv", 0, a, b);
+            return thumb_narrow(L, thumb_call(L, "__aeabi_idiv", 0, a, b), kind);   // -128 / -1
+        case BOP_MOD:
+            return thumb_call(L, is_signed ? "__aeabi_idivmod" : "__aeabi_uidivmod", 1, a, b);
+
+        case BOP_EQ: return thumb_emit_ir(L, TIR_SET, TCOND_EQ, a, b, 0);
+        case BOP_NE: return thumb_emit_ir(L, TIR_SET, TCOND_NE, a, b, 0);
+        case BOP_LT: return thumb_emit_ir(L, TIR_SET, is_signed ? TCOND_LT : TCOND_LO, a, b, 0);
+        case BOP_GT: return thumb_emit_ir(L, TIR_SET, is_signed ? TCOND_GT : TCOND_HI, a, b, 0);
+        case BOP_LE: return thumb_emit_ir(L, TIR_SET, is_signed ? TCOND_LE : TCOND_LS, a, b, 0);
+        case BOP_GE: return thumb_emit_ir(L, TIR_SET, is_signed ? TCOND_GE : TCOND_HS, a, b, 0);
+
+        default:
+            return thumb_lower_fail(L, expr, "unsupported binary operator");
+    }
+}
+
+static int thumb_lower_expr(ThumbLower *L, ASTExpr *expr) {
+    if (!expr->type) return thumb_lower_fail(L, expr, "expression was not type-checked");
+    if (type_get_size(expr->type->kind) > 4) {
+        return thumb_lower_fail(L, expr, "64-bit values are not supported on Thumb-1");
+    }
+
+    switch (expr->kind) {
+        case EXPR_NUMBER:
+            return thumb_const(L, thumb_register_value(expr->data.number_value, expr->type->kind));
+
+        case EXPR_BOOLEAN:
+            return thumb_const(L, expr->data.boolean_value ? 1 : 0);
+
+        case EXPR_IDENTIFIER:
+            for (size_t i = L->local_count; i-- > 0;) {
+                if (L->locals[i].name == expr->data.identifier) return L->locals[i].vreg;
+            }
+            return thumb_lower_fail(L, expr, "unknown variable");
+
+        case EXPR_UNARY_OP: {
+            int a = thumb_lower_expr(L, expr->data.unary.operand);
+            if (a < 0) return -1;
+            TypeKind kind = expr->type->kind;
+            switch (expr->data.unary.op) {
+                case UOP_NEG:
+                    return thumb_narrow(L, thumb_emit_ir(L, TIR_NEG, 0, a, -1, 0), kind);
+                case UOP_BIT_NOT: {
+                    // ~ of a sign-extended value is still sign-extended
+                    int v = thumb_emit_ir(L, TIR_NOT, 0, a, -1, 0);
+                    return thumb_is_signed(kind) ? v : thumb_narrow(L, v, kind);
+                }
+                case UOP_NOT:
+                    return thumb_emit_ir(L, TIR_LNOT, 0, a, -1, 0);
+                default:
+                    return thumb_lower_fail(L, expr, "unsupported unary operator");
+            }
+        }
+
+        case EXPR_BINARY_OP:
+            return thumb_lower_binary(L, expr);
+
+        case EXPR_BIT_SLICE: {
+            uint32_t start = expr->data.bit_slice.start;
+            uint32_t end = expr->data.bit_slice.end;
+            if (end > 32 || start >= end) return thumb_lower_fail(L, expr, "bad bit slice");
+            int a = thumb_lower_expr(L, expr->data.bit_slice.expr);
+            if (a < 0) return -1;
+            // Shift the slice to the top, then down to bit 0
+            int top = thumb_shift(L, TBIN_SHL, a, 32 - end);
+            return thumb_shift(L, TBIN_SHR, top, 32 - (end - start));
+        }
+
+        default:
+            return thumb_lower_fail(L, expr, "expression is not supported by the Thumb backend");
+    }
+}
+
+// Returns 1 if the statement returned, so the rest of its block is dead.
+static int thumb_lower_stmt(ThumbLower *L, ASTStmt *stmt) {
+    switch (stmt->kind) {
+        case STMT_VAR_DECL: {
+            ASTExpr *init = stmt->data.var_decl.init;
+            int v = init ? thumb_lower_expr(L, init) : thumb_const(L, 0);
+            if (v < 0) return 0;
+            if (L->local_count == L->local_capacity) {
+                size_t capacity = L->local_capacity ? L->local_capacity * 2 : 16;
+                ThumbLocal *locals = (ThumbLocal *)realloc(L->locals, capacity * sizeof(ThumbLocal));
+                if (!locals) {
+                    thumb_lower_fail(L, NULL, "out of memory");
+                    return 0;
+                }
+                L->locals = locals;
+                L->local_capacity = capacity;
+            }
+            L->locals[L->local_count++] = (ThumbLocal){ stmt->data.var_decl.name, v };
+            return 0;
+        }
+
+        case STMT_EXPR:
+            thumb_lower_expr(L, stmt->data.expr_stmt.expr);
+            return 0;
+
+        case STMT_RETURN: {
+            int v = -1;
+            if (stmt->data.ret.value) {
+                v = thumb_lower_expr(L, stmt->data.ret.value);
+                if (v < 0) return 1;
+            }
+            thumb_emit_ir(L, TIR_RET, 0, v, -1, 0);
+            return 1;
+        }
+
+        case STMT_BLOCK: {
+            size_t scope = L->local_count;
+            int returned = 0;
+            for (size_t i = 0; i < stmt->data.block.count && !returned && !L->failed; i++) {
+                returned = thumb_lower_stmt(L, stmt->data.block.statements[i]);
+            }
+            L->local_count = scope;
+            return returned;
+        }
+
+        default:
+            thumb_lower_fail(L, NULL, "statement is not supported by the Thumb backend");
+            return 0;
+    }
+}
+
+// ============================================================================
+// Register allocation (linear scan)
+//
+// Instruction i reads its operands at position 2i and writes its result at
+// 2i + 1, so a result may take the register of an operand that dies there.
+// Two-address instructions whose second operand must stay distinct from the
+// result (shifts and rotates by register) read it at 2i + 1 instead.
+// ============================================================================
+
+#define THUMB_NO_REG   (-1)
+#define THUMB_SCRATCH0 6
+#define THUMB_SCRATCH1 7
+
+typedef struct {
+    int start;
+    int end;
+    int crosses_call;      // Live across a BL, so it needs a callee-saved register
+    int reg;               // THUMB_NO_REG when spilled
+    int slot;              // Stack slot when spilled
+} ThumbInterval;
+
+typedef struct {
+    ThumbInterval *intervals;
+    int spill_mode;        // r6/r7 reserved as scratch for spilled operands
+    int slots;
+    unsigned saved;        // Callee-saved registers to push (bit mask)
+} ThumbAlloc;
+
+static int thumb_late_use(const ThumbIr *ir) {
+    return ir->op == TIR_BIN &&
+           (ir->sub == TBIN_SHL || ir->sub == TBIN_SHR || ir->sub == TBIN_SAR || ir->sub == TBIN_ROR);
+}
+
+static void thumb_use(ThumbInterval *intervals, int v, int position) {
+    if (v >= 0 && intervals[v].end < position) intervals[v].end = position;
+}
+
+static void thumb_build_intervals(const ThumbLower *L, ThumbInterval *intervals) {
+    for (size_t i = 0; i < L->count; i++) {
+        const ThumbIr *ir = &L->ir[i];
+        int use = (int)(2 * i);
+        thumb_use(intervals, ir->a, use);
+        thumb_use(intervals, ir->b, thumb_late_use(ir) ? use + 1 : use);
+        if (ir->dst >= 0) {
+            intervals[ir->dst] = (ThumbInterval){ use + 1, use + 1, 0, THUMB_NO_REG, -1 };
+        }
+    }
+
+    for (size_t i = 0; i < L->count; i++) {
+        if (L->ir[i].op != TIR_CALL) continue;
+        int call = (int)(2 * i);
+        for (int v = 0; v < L->vregs; v++) {
+            if (intervals[v].start < call && intervals[v].end > call + 1) {
+                intervals[v].crosses_call = 1;
+            }
+        }
+    }
+}
+
+static int thumb_scan(const ThumbLower *L, ThumbAlloc *A, int spill_mode) {
+    ThumbInterval *intervals = A->intervals;
+    int last_reg = spill_mode ? 5 : 7;
+    int active[8];
+    int active_count = 0;
+    int spilled = 0;
+
+    A->spill_mode = spill_mode;
+    A->slots = 0;
+    A->saved = spill_mode ? (1u << THUMB_SCRATCH0) | (1u << THUMB_SCRATCH1) : 0;
+    for (int v = 0; v < L->vregs; v++) {
+        intervals[v].reg = THUMB_NO_REG;
+        intervals[v].slot = -1;
+    }
+
+    // Virtual registers are numbered in definition order, so this is start order.
+    for (int v = 0; v < L->vregs; v++) {
+        ThumbInterval *cur = &intervals[v];
+        int free_regs[8] = {0};
+        for (int r = 0; r <= last_reg; r++) free_regs[r] = 1;
+
+        int kept = 0;
+        for (int k = 0; k < active_count; k++) {
+            if (intervals[active[k]].end >= cur->start) {
+                active[kept++] = active[k];
+                free_regs[intervals[active[k]].reg] = 0;
+            }
+        }
+        active_count = kept;
+
+        int first_reg = cur->crosses_call ? 4 : 0;
+        int reg = THUMB_NO_REG;
+
+        // Reuse the first operand's register when it dies here: no move needed.
+        const ThumbIr *def = &L->ir[cur->start / 2];
+        if (def->a >= 0 && intervals[def->a].reg >= first_reg && free_regs[intervals[def->a].reg]) {
+            reg = intervals[def->a].reg;
+        }
+        for (int r = first_reg; r <= last_reg && reg == THUMB_NO_REG; r++) {
+            if (free_regs[r]) reg = r;
+        }
+
+        if (reg == THUMB_NO_REG) {
+            // Spill whichever eligible interval ends last.
+            int victim = -1;
+            for (int k = 0; k < active_count; k++) {
+                ThumbInterval *candidate = &intervals[active[k]];
+                if (candidate->reg >= first_reg &&
+                    (victim < 0 || candidate->end > intervals[active[victim]].end)) {
+                    victim = k;
+                }
+            }
+            if (victim >= 0 && intervals[active[victim]].end > cur->end) {
+                ThumbInterval *spill = &intervals[active[victim]];
+                reg = spill->reg;
+                spill->reg = THUMB_NO_REG;
+                spill->slot = A->slots++;
+                active[victim] = active[--active_count];
+            } else {
+                cur->slot = A->slots++;
+            }
+            spilled++;
+        }
+
+        cur->reg = reg;
+        if (reg != THUMB_NO_REG) {
+            active[active_count++] = v;
+            if (reg >= 4) A->saved |= 1u << reg;
+        }
+    }
+
+    return spilled;
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+typedef struct {
+    size_t offset;         // LDR (literal) to patch
+    size_t index;          // Pool entry it loads
+} ThumbPoolRef;
+
+typedef struct {
+    ThumbContext *ctx;
+    const ThumbAlloc *alloc;
+    uint8_t *code;
+    size_t size;
+    size_t capacity;
+    uint32_t *pool;
+    size_t pool_count;
+    size_t pool_capacity;
+    ThumbPoolRef *refs;
+    size_t ref_count;
+    size_t ref_capacity;
+    ThumbReloc *relocs;
+    size_t reloc_count;
+    size_t reloc_capacity;
+    unsigned push_mask;    // Registers pushed by the prologue (bit 8 = LR)
+    int frame_slots;
+    int failed;
+} ThumbEmit;
+
+static void *thumb_grow(void *items, size_t count, size_t *capacity, size_t size, ThumbEmit *E) {
+    if (count < *capacity) return items;
+    size_t grown = *capacity ? *capacity * 2 : 16;
+    void *resized = realloc(items, grown * size);
+    if (!resized) {
+        E->failed = 1;
+        return items;
+    }
+    *capacity = grown;
+    return resized;
+}
+
+static void thumb_emit16(ThumbEmit *E, unsigned halfword) {
+    if (E->size + 2 > E->capacity) {
+        size_t capacity = E->capacity ? E->capacity * 2 : 256;
+        uint8_t *code = (uint8_t *)realloc(E->code, capacity);
+        if (!code) {
+            E->failed = 1;
+            return;
+        }
+        E->code = code;
+        E->capacity = capacity;
+    }
+    E->code[E->size++] = (uint8_t)(halfword & 0xFF);
+    E->code[E->size++] = (uint8_t)(halfword >> 8);
+}
+
+// MOVS Rd, Rm (encoded as LSLS Rd, Rm, #0)
+static void thumb_mov(ThumbEmit *E, int rd, int rm) {
+    if (rd != rm) thumb_emit16(E, (unsigned)(rm << 3 | rd));
+}
+
+// Data-processing format: <op>S Rdn, Rm
+static void thumb_dp(ThumbEmit *E, unsigned op, int rdn, int rm) {
+    thumb_emit16(E, 0x4000u | op << 6 | (unsigned)(rm << 3 | rdn));
+}
+
+static void thumb_ldr_sp(ThumbEmit *E, int rt, int slot) {
+    thumb_emit16(E, 0x9800u | (unsigned)(rt << 8 | slot));
+}
+
+static void thumb_str_sp(ThumbEmit *E, int rt, int slot) {
+    thumb_emit16(E, 0x9000u | (unsigned)(rt << 8 | slot));
+}
+
+// Register holding v, loading it into scratch first if it was spilled.
+static int thumb_src(ThumbEmit *E, int v, int scratch) {
+    const ThumbInterval *iv = &E->alloc->intervals[v];
+    if (iv->reg != THUMB_NO_REG) return iv->reg;
+    thumb_ldr_sp(E, scratch, iv->slot);
+    return scratch;
+}
+
+static int thumb_dst(ThumbEmit *E, int v) {
+    const ThumbInterval *iv = &E->alloc->intervals[v];
+    return iv->reg != THUMB_NO_REG ? iv->reg : THUMB_SCRATCH0;
+}
+
+static void thumb_writeback(ThumbEmit *E, int v, int reg) {
+    const ThumbInterval *iv = &E->alloc->intervals[v];
+    if (iv->reg == THUMB_NO_REG) thumb_str_sp(E, reg, iv->slot);
+}
+
+static void thumb_emit_const(ThumbEmit *E, int rd, uint32_t value) {
+    if (value <= 0xFF) {
+        thumb_emit16(E, 0x2000u | (unsigned)rd << 8 | value);
+        return;
+    }
+    if (~value <= 0xFF) {
+        thumb_emit16(E, 0x2000u | (unsigned)rd << 8 | ~value);
+        thumb_dp(E, 0xF, rd, rd);                                  // MVNS
+        return;
+    }
+    unsigned shift = (unsigned)__builtin_ctz(value);
+    if ((value >> shift) <= 0xFF) {
+        thumb_emit16(E, 0x2000u | (unsigned)rd << 8 | (value >> shift));
+        thumb_emit16(E, shift << 6 | (unsigned)(rd << 3 | rd));    // LSLS
+        return;
+    }
+
+    size_t index = 0;
+    while (index < E->pool_count && E->pool[index] != value) index++;
+    if (index == E->pool_count) {
+        E->pool = (uint32_t *)thumb_grow(E->pool, E->pool_count, &E->pool_capacity,
+                                         sizeof(uint32_t), E);
+        if (E->failed) return;
+        E->pool[E->pool_count++] = value;
+    }
+    E->refs = (ThumbPoolRef *)thumb_grow(E->refs, E->ref_count, &E->ref_capacity,
+                                         sizeof(ThumbPoolRef), E);
+    if (E->failed) return;
+    E->refs[E->ref_count++] = (ThumbPoolRef){ E->size, index };
+    thumb_emit16(E, 0x4800u | (unsigned)rd << 8);                  // LDR Rd, [PC, #imm]
+}
+
+static void thumb_emit_epilogue(ThumbEmit *E) {
+    if (E->frame_slots > 0) thumb_emit16(E, 0xB000u | (unsigned)E->frame_slots);  // ADD SP
+    unsigned regs = E->push_mask & 0xFF;
+    if (E->push_mask & 0x100) {
+        thumb_emit16(E, 0xBD00u | regs);                            // POP {..., PC}
+        return;
+    }
+    if (regs) thumb_emit16(E, 0xBC00u | regs);                      // POP {...}
+    thumb_emit16(E, 0x4770);                                        // BX LR
+}
+
+static void thumb_emit_call(ThumbEmit *E, const ThumbIr *ir) {
+    const ThumbInterval *intervals = E->alloc->intervals;
+    int la = ir->a >= 0 ? intervals[ir->a].reg : THUMB_NO_REG;
+    int lb = ir->b >= 0 ? intervals[ir->b].reg : THUMB_NO_REG;
+
+    // Arguments to r0/r1. Anything live across the call is in r4-r7 or a slot.
+    if (ir->b >= 0 && lb == 0 && la == 1) {
+        thumb_dp(E, 0x1, 0, 1);                                     // swap with EORS
+        thumb_dp(E, 0x1, 1, 0);
+        thumb_dp(E, 0x1, 0, 1);
+    } else if (ir->b >= 0 && lb == 0) {
+        thumb_mov(E, 1, 0);
+        if (la == THUMB_NO_REG) thumb_ldr_sp(E, 0, intervals[ir->a].slot);
+        else thumb_mov(E, 0, la);
+    } else {
+        if (ir->a >= 0) {
+            if (la == THUMB_NO_REG) thumb_ldr_sp(E, 0, intervals[ir->a].slot);
+            else thumb_mov(E, 0, la);
+        }
+        if (ir->b >= 0) {
+            if (lb == THUMB_NO_REG) thumb_ldr_sp(E, 1, intervals[ir->b].slot);
+            else thumb_mov(E, 1, lb);
+        }
+    }
+
+    E->relocs = (ThumbReloc *)thumb_grow(E->relocs, E->reloc_count, &E->reloc_capacity,
+                                         sizeof(ThumbReloc), E);
+    if (E->failed) return;
+    E->relocs[E->reloc_count++] = (ThumbReloc){ (uint32_t)E->size, ir->symbol };
+    thumb_emit16(E, 0xF7FF);                                        // BL with addend -4
+    thumb_emit16(E, 0xFFFE);
+
+    int d = thumb_dst(E, ir->dst);
+    thumb_mov(E, d, ir->sub);
+    thumb_writeback(E, ir->dst, d);
+}
+
+static void thumb_emit_bin(ThumbEmit *E, const ThumbIr *ir) {
+    static const unsigned dp_ops[] = {
+        [TBIN_MUL] = 0xD, [TBIN_AND] = 0x0, [TBIN_OR] = 0xC, [TBIN_XOR] = 0x1,
+        [TBIN_SHL] = 0x2, [TBIN_SHR] = 0x3, [TBIN_SAR] = 0x4, [TBIN_ROR] = 0x7,
+    };
+
+    int ra = thumb_src(E, ir->a, THUMB_SCRATCH0);
+    int rb = thumb_src(E, ir->b, THUMB_SCRATCH1);
+    int d = thumb_dst(E, ir->dst);
+
+    if (ir->sub == TBIN_ADD || ir->sub == TBIN_SUB) {
+        unsigned base = ir->sub == TBIN_ADD ? 0x1800u : 0x1A00u;
+        thumb_emit16(E, base | (unsigned)(rb << 6 | ra << 3 | d));
+    } else {
+        int commutative = ir->sub == TBIN_MUL || ir->sub == TBIN_AND ||
+                          ir->sub == TBIN_OR || ir->sub == TBIN_XOR;
+        if (d == rb && d != ra && commutative) {
+            thumb_dp(E, dp_ops[ir->sub], d, ra);
+        } else {
+            thumb_mov(E, d, ra);
+            thumb_dp(E, dp_ops[ir->sub], d, rb);
+        }
+    }
+    thumb_writeback(E, ir->dst, d);
+}
+
+static void thumb_emit_ir_op(ThumbEmit *E, const ThumbIr *ir) {
+    static const unsigned ext_ops[] = {
+        [TEXT_U8] = 0xB2C0, [TEXT_U16] = 0xB280, [TEXT_I8] = 0xB240, [TEXT_I16] = 0xB200,
+    };
+    static const unsigned shift_ops[] = {
+        [TBIN_SHL] = 0x0000, [TBIN_SHR] = 0x0800, [TBIN_SAR] = 0x1000,
+    };
+
+    if (ir->op == TIR_CALL) {
+        thumb_emit_call(E, ir);
+        return;
+    }
+    if (ir->op == TIR_RET) {
+        if (ir->a >= 0) {
+            const ThumbInterval *iv = &E->alloc->intervals[ir->a];
+            if (iv->reg == THUMB_NO_REG) thumb_ldr_sp(E, 0, iv->slot);
+            else thumb_mov(E, 0, iv->reg);
+        }
+        thumb_emit_epilogue(E);
+        return;
+    }
+    if (ir->op == TIR_BIN) {
+        thumb_emit_bin(E, ir);
+        return;
+    }
+
+    int d = thumb_dst(E, ir->dst);
+    int ra = ir->a >= 0 ? thumb_src(E, ir->a, THUMB_SCRATCH0) : THUMB_NO_REG;
+    unsigned rm = (unsigned)ra << 3 | (unsigned)d;
+
+    switch (ir->op) {
+        case TIR_CONST:
+            thumb_emit_const(E, d, ir->imm);
+            break;
+        case TIR_SHIFTI:
+            thumb_emit16(E, shift_ops[ir->sub] | ir->imm << 6 | rm);
+            break;
+        case TIR_ADDI:
+            thumb_emit16(E, 0x1C00u | ir->imm << 6 | rm);
+            break;
+        case TIR_SUBI:
+            thumb_emit16(E, 0x1E00u | ir->imm << 6 | rm);
+            break;
+        case TIR_NEG:
+            thumb_dp(E, 0x9, d, ra);                                // RSBS Rd, Rn, #0
+            break;
+        case TIR_NOT:
+            thumb_dp(E, 0xF, d, ra);                                // MVNS
+            break;
+        case TIR_LNOT:
+            // RSBS sets C only for 0; MOVS keeps C; ADCS picks it up.
+            thumb_dp(E, 0x9, d, ra);
+            thumb_emit16(E, 0x2000u | (unsigned)d << 8);
+            thumb_dp(E, 0x5, d, d);
+            break;
+        case TIR_EXT:
+            thumb_emit16(E, ext_ops[ir->sub] | rm);
+            break;
+        case TIR_SET: {
+            int rb = thumb_src(E, ir->b, THUMB_SCRATCH1);
+            thumb_dp(E, 0xA, ra, rb);                               // CMP Ra, Rb
+            thumb_emit16(E, 0xD001u | (unsigned)ir->sub << 8);      // B<cond> to MOVS #1
+            thumb_emit16(E, 0x2000u | (unsigned)d << 8);            // MOVS Rd, #0
+            thumb_emit16(E, 0xE000);                                // B past MOVS #1
+            thumb_emit16(E, 0x2001u | (unsigned)d << 8);            // MOVS Rd, #1
+            break;
+        }
+        default:
+            break;
+    }
+    thumb_writeback(E, ir->dst, d);
+}
+
+static int thumb_finish_pool(ThumbEmit *E, ThumbFunction *fn) {
+    fn->pool_offset = E->size;
+    if (E->pool_count == 0) return 0;
+
+    if (E->size % 4) thumb_emit16(E, 0xBF00);                       // NOP
+    fn->pool_offset = E->size;
+    for (size_t i = 0; i < E->pool_count; i++) {
+        thumb_emit16(E, E->pool[i] & 0xFFFF);
+        thumb_emit16(E, E->pool[i] >> 16);
+    }
+    if (E->failed) return -1;
+
+    for (size_t i = 0; i < E->ref_count; i++) {
+        size_t pc = (E->refs[i].offset + 4) & ~(size_t)3;
+        size_t words = (fn->pool_offset + 4 * E->refs[i].index - pc) / 4;
+        if (words > 0xFF) {
+            thumb_error(E->ctx, "fn %s is too large for its literal pool", fn->name);
+            return -1;
+        }
+        E->code[E->refs[i].offset] = (uint8_t)words;
+    }
+    return 0;
+}
+
+static int thumb_encode(ThumbEmit *E, const ThumbLower *L, ThumbFunction *fn) {
+    const ThumbAlloc *A = E->alloc;
+
+    E->push_mask = A->saved | (L->has_calls ? 0x100u : 0);
+    int pushed = __builtin_popcount(E->push_mask);
+    E->frame_slots = A->slots + ((pushed + A->slots) & 1);      // Keep SP 8-byte aligned
+    if (E->frame_slots > 127) {
+        thumb_error(E->ctx, "fn %s needs too many stack slots (%d)", fn->name, A->slots);
+        return -1;
+    }
+
+    if (E->push_mask) thumb_emit16(E, 0xB400u | E->push_mask);     // PUSH
+    if (E->frame_slots > 0) thumb_emit16(E, 0xB080u | (unsigned)E->frame_slots);  // SUB SP
+
+    for (size_t i = 0; i < L->count; i++) {
+        thumb_emit_ir_op(E, &L->ir[i]);
+    }
+    if (thumb_finish_pool(E, fn) != 0) return -1;
+    if (E->failed) {
+        thumb_error(E->ctx, "out of memory encoding fn %s", fn->name);
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+ThumbContext* thumb_init(const char *target) {
+    if (!target || (strcmp(target, "arm-cortex-m0") != 0 && strcmp(target, "rp2040") != 0)) {
+        return NULL;
+    }
+    ThumbContext *ctx = (ThumbContext *)calloc(1, sizeof(ThumbContext));
+    if (ctx) ctx->errors = stderr;
+    return ctx;
+}
+
+int thumb_compile_function(ThumbContext *ctx, ASTFunctionDef *func) {
+    if (ctx->function_count == ctx->function_capacity) {
+        size_t capacity = ctx->function_capacity ? ctx->function_capacity * 2 : 8;
+        ThumbFunction *functions = (ThumbFunction *)realloc(ctx->functions,
+                                                            capacity * sizeof(ThumbFunction));
+        if (!functions) {
+            thumb_error(ctx, "out of memory");
+            return -1;
+        }
+        ctx->functions = functions;
+        ctx->function_capacity = capacity;
+    }
+
+    ThumbLower L = { .ctx = ctx, .function = atom_name(func->name) };
+    if (!func->body || !thumb_lower_stmt(&L, func->body)) {
+        if (!L.failed) thumb_emit_ir(&L, TIR_RET, 0, -1, -1, 0);
+    }
+
+    ThumbFunction fn = { .name = strdup(L.function) };
+    ThumbAlloc A = { 0 };
+    ThumbEmit E = { .ctx = ctx, .alloc = &A };
+    int status = L.failed || !fn.name ? -1 : 0;
+
+    if (status == 0) {
+        A.intervals = (ThumbInterval *)calloc((size_t)L.vregs + 1, sizeof(ThumbInterval));
+        if (!A.intervals) {
+            thumb_error(ctx, "out of memory");
+            status = -1;
+        }
+    }
+    if (status == 0) {
+        thumb_build_intervals(&L, A.intervals);
+        // Spilled operands need scratch registers; give up r6/r7 only when needed.
+        fn.spills = thumb_scan(&L, &A, 0);
+        if (fn.spills > 0) fn.spills = thumb_scan(&L, &A, 1);
+        status = thumb_encode(&E, &L, &fn);
+    }
+
+    if (status == 0) {
+        fn.code = E.code;
+        fn.size = E.size;
+        fn.relocs = E.relocs;
+        fn.reloc_count = E.reloc_count;
+        ctx->functions[ctx->function_count++] = fn;
+    } else {
+        ctx->error = 1;
+        free(fn.name);
+        free(E.code);
+        free(E.relocs);
+    }
+
+    free(E.pool);
+    free(E.refs);
+    free(A.intervals);
+    free(L.ir);
+    free(L.locals);
+    return status;
+}
+
+int thumb_compile_program(ThumbContext *ctx, ASTProgram *program) {
+    int status = 0;
+    for (size_t i = 0; i < program->function_count; i++) {
+        if (thumb_compile_function(ctx, program->functions[i]) != 0) status = -1;
+    }
+    return status;
+}
+
+void thumb_cleanup(ThumbContext *ctx) {
+    if (!ctx) return;
+    for (size_t i = 0; i < ctx->function_count; i++) {
+        free(ctx->functions[i].name);
+        free(ctx->functions[i].code);
+        free(ctx->functions[i].relocs);
+    }
+    free(ctx->functions);
+    free(ctx);
+}
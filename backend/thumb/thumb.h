@@ -0,0 +1,56 @@
+/**
+ * bit(N) Compiler - Thumb-1 Machine Code Backend
+ * Lowers type-checked function bodies to ARMv6-M code and packs them into a
+ * relocatable ELF object for the generated linker scripts.
+ */
+
+#ifndef BITN_THUMB_H
+#define BITN_THUMB_H
+
+#include "../../include/ast.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A BL to an external symbol, patched by the linker (R_ARM_THM_CALL).
+typedef struct {
+    uint32_t offset;       // Byte offset of the BL in the function's code
+    const char *symbol;    // Static string or function name
+} ThumbReloc;
+
+// One function's machine code: instructions, then its literal pool.
+typedef struct {
+    char *name;
+    uint8_t *code;
+    size_t size;
+    size_t pool_offset;    // Start of the literal pool; == size if there is none
+    ThumbReloc *relocs;
+    size_t reloc_count;
+    int spills;            // Virtual registers that live in stack slots
+} ThumbFunction;
+
+typedef struct {
+    ThumbFunction *functions;
+    size_t function_count;
+    size_t function_capacity;
+    int error;             // Set by thumb_error; the object must not be written
+    FILE *errors;          // Diagnostics sink (stderr unless redirected)
+} ThumbContext;
+
+// Returns NULL if target is not a Thumb-1 target (arm-cortex-m0, rp2040).
+ThumbContext* thumb_init(const char *target);
+
+// Bodies must have been through check_program_types: lowering reads the
+// type of every expression. Returns 0 on success, -1 on error.
+int thumb_compile_function(ThumbContext *ctx, ASTFunctionDef *func);
+int thumb_compile_program(ThumbContext *ctx, ASTProgram *program);
+
+// Build an ELF32 relocatable object with one .text.<name> section per
+// function. The image is malloc'd. Returns 0 on success, -1 on error.
+int thumb_object(ThumbContext *ctx, uint8_t **image, size_t *length);
+
+void thumb_cleanup(ThumbContext *ctx);
+void thumb_error(ThumbContext *ctx, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif // BITN_THUMB_H
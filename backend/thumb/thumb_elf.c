@@ -0,0 +1,312 @@
+/**
+ * bit(N) Compiler - ELF32 relocatable objects for the Thumb backend
+ *
+ * Layout: ELF header, then per function its .text.<name> section and, if it
+ * calls anything, a .rel.text.<name>; then .symtab, .strtab, .shstrtab and
+ * the section header table. Everything is written little-endian field by
+ * field, so the image does not depend on the host.
+ */
+
+#include "thumb.h"
+
+#include <elf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THUMB_ELF_EHSIZE  52
+#define THUMB_ELF_SHSIZE  40
+#define THUMB_ELF_SYMSIZE 16
+#define THUMB_ELF_RELSIZE 8
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    int failed;
+} ThumbBytes;
+
+static void elf_reserve(ThumbBytes *b, size_t extra) {
+    if (b->failed || b->length + extra <= b->capacity) return;
+    size_t capacity = b->capacity ? b->capacity : 256;
+    while (capacity < b->length + extra) capacity *= 2;
+    uint8_t *data = (uint8_t *)realloc(b->data, capacity);
+    if (!data) {
+        b->failed = 1;
+        return;
+    }
+    b->data = data;
+    b->capacity = capacity;
+}
+
+static void elf_bytes(ThumbBytes *b, const void *data, size_t length) {
+    elf_reserve(b, length);
+    if (b->failed) return;
+    memcpy(b->data + b->length, data, length);
+    b->length += length;
+}
+
+static void elf_u8(ThumbBytes *b, unsigned value) {
+    uint8_t byte = (uint8_t)value;
+    elf_bytes(b, &byte, 1);
+}
+
+static void elf_u16(ThumbBytes *b, unsigned value) {
+    elf_u8(b, value & 0xFF);
+    elf_u8(b, (value >> 8) & 0xFF);
+}
+
+static void elf_u32(ThumbBytes *b, uint32_t value) {
+    elf_u16(b, value & 0xFFFF);
+    elf_u16(b, value >> 16);
+}
+
+static void elf_align(ThumbBytes *b, size_t alignment) {
+    while (!b->failed && b->length % alignment) elf_u8(b, 0);
+}
+
+// Append a NUL-terminated name and return its offset.
+static uint32_t elf_string(ThumbBytes *table, const char *prefix, const char *name) {
+    uint32_t offset = (uint32_t)table->length;
+    elf_bytes(table, prefix, strlen(prefix));
+    elf_bytes(table, name, strlen(name) + 1);
+    return offset;
+}
+
+typedef struct {
+    uint32_t name, type, flags, offset, size, link, info, align, entsize;
+} ThumbSection;
+
+typedef struct {
+    uint32_t name, value, size;
+    unsigned info;
+    unsigned shndx;
+} ThumbSymbol;
+
+typedef struct {
+    ThumbSymbol *items;
+    size_t count;
+    size_t capacity;
+} ThumbSymbols;
+
+static int elf_add_symbol(ThumbSymbols *symbols, ThumbSymbol symbol) {
+    if (symbols->count == symbols->capacity) {
+        size_t capacity = symbols->capacity ? symbols->capacity * 2 : 16;
+        ThumbSymbol *items = (ThumbSymbol *)realloc(symbols->items, capacity * sizeof(ThumbSymbol));
+        if (!items) return -1;
+        symbols->items = items;
+        symbols->capacity = capacity;
+    }
+    symbols->items[symbols->count++] = symbol;
+    return (int)symbols->count - 1;
+}
+
+// Symbol index for a name: defined functions first, then undefined externals.
+static int elf_symbol_index(ThumbContext *ctx, ThumbSymbols *symbols, ThumbBytes *strtab,
+                            const char **externals, size_t *external_count,
+                            size_t first_global, const char *name) {
+    for (size_t f = 0; f < ctx->function_count; f++) {
+        if (strcmp(ctx->functions[f].name, name) == 0) return (int)(first_global + f);
+    }
+    size_t first_external = first_global + ctx->function_count;
+    for (size_t e = 0; e < *external_count; e++) {
+        if (strcmp(externals[e], name) == 0) return (int)(first_external + e);
+    }
+    externals[(*external_count)++] = name;
+    ThumbSymbol undefined = { elf_string(strtab, "", name), 0, 0,
+                              ELF32_ST_INFO(STB_GLOBAL, STT_NOTYPE), SHN_UNDEF };
+    return elf_add_symbol(symbols, undefined);
+}
+
+int thumb_object(ThumbContext *ctx, uint8_t **image, size_t *length) {
+    if (ctx->error) return -1;
+
+    size_t nfunc = ctx->function_count;
+    size_t max_sections = 2 * nfunc + 4;
+    size_t reloc_total = 0;
+    for (size_t f = 0; f < nfunc; f++) reloc_total += ctx->functions[f].reloc_count;
+
+    ThumbSection *sections = (ThumbSection *)calloc(max_sections, sizeof(ThumbSection));
+    size_t *text_index = (size_t *)calloc(nfunc + 1, sizeof(size_t));
+    const char **externals = (const char **)calloc(reloc_total + 1, sizeof(char *));
+    ThumbBytes out = { 0 }, strtab = { 0 }, shstrtab = { 0 };
+    ThumbSymbols symbols = { 0 };
+    size_t external_count = 0;
+    int status = sections && text_index && externals ? 0 : -1;
+
+    if (status == 0) {
+        elf_u8(&strtab, 0);
+        elf_u8(&shstrtab, 0);
+        elf_add_symbol(&symbols, (ThumbSymbol){ 0 });
+
+        // Header placeholder; patched once the section table's offset is known
+        elf_reserve(&out, THUMB_ELF_EHSIZE);
+        if (!out.failed) {
+            memset(out.data, 0, THUMB_ELF_EHSIZE);
+            out.length = THUMB_ELF_EHSIZE;
+        }
+    }
+
+    // Code sections, with $t/$d mapping symbols (all local)
+    size_t section_count = 1;
+    for (size_t f = 0; f < nfunc && status == 0; f++) {
+        ThumbFunction *fn = &ctx->functions[f];
+        elf_align(&out, 4);
+        ThumbSection *text = &sections[section_count];
+        text->name = elf_string(&shstrtab, ".text.", fn->name);
+        text->type = SHT_PROGBITS;
+        text->flags = SHF_ALLOC | SHF_EXECINSTR;
+        text->offset = (uint32_t)out.length;
+        text->size = (uint32_t)fn->size;
+        text->align = 4;
+        text_index[f] = section_count++;
+        elf_bytes(&out, fn->code, fn->size);
+
+        ThumbSymbol code = { elf_string(&strtab, "", "$t"), 0, 0,
+                             ELF32_ST_INFO(STB_LOCAL, STT_NOTYPE), (unsigned)text_index[f] };
+        if (elf_add_symbol(&symbols, code) < 0) status = -1;
+        if (fn->pool_offset < fn->size) {
+            ThumbSymbol data = { elf_string(&strtab, "", "$d"), (uint32_t)fn->pool_offset, 0,
+                                 ELF32_ST_INFO(STB_LOCAL, STT_NOTYPE), (unsigned)text_index[f] };
+            if (elf_add_symbol(&symbols, data) < 0) status = -1;
+        }
+    }
+
+    // Function symbols; bit 0 of the value marks Thumb code
+    size_t first_global = symbols.count;
+    for (size_t f = 0; f < nfunc && status == 0; f++) {
+        ThumbFunction *fn = &ctx->functions[f];
+        ThumbSymbol func = { elf_string(&strtab, "", fn->name), 1, (uint32_t)fn->size,
+                             ELF32_ST_INFO(STB_GLOBAL, STT_FUNC), (unsigned)text_index[f] };
+        if (elf_add_symbol(&symbols, func) < 0) status = -1;
+    }
+
+    size_t symtab_index = section_count;       // After the relocation sections
+    for (size_t f = 0; f < nfunc; f++) {
+        if (ctx->functions[f].reloc_count > 0) symtab_index++;
+    }
+
+    // Relocation sections
+    for (size_t f = 0; f < nfunc && status == 0; f++) {
+        ThumbFunction *fn = &ctx->functions[f];
+        if (fn->reloc_count == 0) continue;
+        elf_align(&out, 4);
+        ThumbSection *rel = &sections[section_count++];
+        rel->name = elf_string(&shstrtab, ".rel.text.", fn->name);
+        rel->type = SHT_REL;
+        rel->flags = SHF_INFO_LINK;
+        rel->offset = (uint32_t)out.length;
+        rel->size = (uint32_t)(fn->reloc_count * THUMB_ELF_RELSIZE);
+        rel->link = (uint32_t)symtab_index;
+        rel->info = (uint32_t)text_index[f];
+        rel->align = 4;
+        rel->entsize = THUMB_ELF_RELSIZE;
+        for (size_t r = 0; r < fn->reloc_count; r++) {
+            int sym = elf_symbol_index(ctx, &symbols, &strtab, externals, &external_count,
+                                       first_global, fn->relocs[r].symbol);
+            if (sym < 0) status = -1;
+            elf_u32(&out, fn->relocs[r].offset);
+            elf_u32(&out, ELF32_R_INFO((uint32_t)sym, R_ARM_THM_PC22));  // R_ARM_THM_CALL
+        }
+    }
+
+    // .symtab, .strtab, .shstrtab
+    if (status == 0) {
+        elf_align(&out, 4);
+        ThumbSection *symtab = &sections[section_count++];
+        symtab->name = elf_string(&shstrtab, "", ".symtab");
+        symtab->type = SHT_SYMTAB;
+        symtab->offset = (uint32_t)out.length;
+        symtab->size = (uint32_t)(symbols.count * THUMB_ELF_SYMSIZE);
+        symtab->link = (uint32_t)section_count;           // .strtab comes next
+        symtab->info = (uint32_t)first_global;            // One past the last local
+        symtab->align = 4;
+        symtab->entsize = THUMB_ELF_SYMSIZE;
+        for (size_t s = 0; s < symbols.count; s++) {
+            ThumbSymbol *sym = &symbols.items[s];
+            elf_u32(&out, sym->name);
+            elf_u32(&out, sym->value);
+            elf_u32(&out, sym->size);
+            elf_u8(&out, sym->info);
+            elf_u8(&out, 0);
+            elf_u16(&out, sym->shndx);
+        }
+
+        ThumbSection *strings = &sections[section_count++];
+        strings->name = elf_string(&shstrtab, "", ".strtab");
+        strings->type = SHT_STRTAB;
+        strings->offset = (uint32_t)out.length;
+        strings->size = (uint32_t)strtab.length;
+        strings->align = 1;
+        elf_bytes(&out, strtab.data, strtab.length);
+
+        ThumbSection *names = &sections[section_count++];
+        names->name = elf_string(&shstrtab, "", ".shstrtab");
+        names->type = SHT_STRTAB;
+        names->offset = (uint32_t)out.length;
+        names->size = (uint32_t)shstrtab.length;
+        names->align = 1;
+        elf_bytes(&out, shstrtab.data, shstrtab.length);
+    }
+
+    if (status == 0) {
+        elf_align(&out, 4);
+        uint32_t shoff = (uint32_t)out.length;
+        for (size_t s = 0; s < section_count; s++) {
+            ThumbSection *sec = &sections[s];
+            elf_u32(&out, sec->name);
+            elf_u32(&out, sec->type);
+            elf_u32(&out, sec->flags);
+            elf_u32(&out, 0);                              // sh_addr
+            elf_u32(&out, sec->offset);
+            elf_u32(&out, sec->size);
+            elf_u32(&out, sec->link);
+            elf_u32(&out, sec->info);
+            elf_u32(&out, sec->align);
+            elf_u32(&out, sec->entsize);
+        }
+
+        ThumbBytes header = { 0 };
+        elf_bytes(&header, ELFMAG, SELFMAG);
+        elf_u8(&header, ELFCLASS32);
+        elf_u8(&header, ELFDATA2LSB);
+        elf_u8(&header, EV_CURRENT);
+        elf_u8(&header, ELFOSABI_NONE);
+        elf_bytes(&header, "\0\0\0\0\0\0\0\0", EI_NIDENT - EI_ABIVERSION);
+        elf_u16(&header, ET_REL);
+        elf_u16(&header, EM_ARM);
+        elf_u32(&header, EV_CURRENT);
+        elf_u32(&header, 0);                               // e_entry
+        elf_u32(&header, 0);                               // e_phoff
+        elf_u32(&header, shoff);
+        elf_u32(&header, EF_ARM_EABI_VER5);
+        elf_u16(&header, THUMB_ELF_EHSIZE);
+        elf_u16(&header, 0);                               // e_phentsize
+        elf_u16(&header, 0);                               // e_phnum
+        elf_u16(&header, THUMB_ELF_SHSIZE);
+        elf_u16(&header, (unsigned)section_count);
+        elf_u16(&header, (unsigned)section_count - 1);     // .shstrtab is last
+        if (header.failed || out.failed || header.length != THUMB_ELF_EHSIZE) {
+            status = -1;
+        } else {
+            memcpy(out.data, header.data, THUMB_ELF_EHSIZE);
+        }
+        free(header.data);
+    }
+
+    if (status != 0 || out.failed || strtab.failed || shstrtab.failed) {
+        thumb_error(ctx, "cannot build the ELF object");
+        free(out.data);
+        status = -1;
+    } else {
+        *image = out.data;
+        *length = out.length;
+    }
+
+    free(sections);
+    free(text_index);
+    free(externals);
+    free(strtab.data);
+    free(shstrtab.data);
+    free(symbols.items);
+    return status;
+}
@@ -0,0 +1,39 @@
+#ifndef BITN_ARENA_H
+#define BITN_ARENA_H
+
+#include <stddef.h>
+
+// ============================================================================
+// Region (bump) allocator
+//
+// Every object allocated from an Arena lives until arena_destroy(), which
+// releases all chunks at once. Used for the AST and everything hanging off it
+// so a whole compilation can be torn down without walking the tree.
+// ============================================================================
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    size_t allocation_count;  // Number of arena_alloc/arena_grow calls served
+    size_t bytes_used;        // Bytes handed out (including alignment padding)
+    size_t bytes_reserved;    // Bytes obtained from malloc for chunks
+    size_t chunk_count;       // Number of chunks obtained from malloc
+} ArenaStats;
+
+typedef struct {
+    ArenaChunk *head;         // Chunk currently being bumped into
+    size_t chunk_size;
+    ArenaStats stats;
+} Arena;
+
+Arena *arena_create(size_t chunk_size);
+void arena_destroy(Arena *arena);
+
+void *arena_alloc(Arena *arena, size_t size);
+void *arena_grow(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+
+const ArenaStats *arena_stats(const Arena *arena);
+
+#endif // BITN_ARENA_H
@@ -4,6 +4,9 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "arena.h"
+#include "intern.h"
+
 // ============================================================================
 // Types
 // ============================================================================
@@ -36,9 +39,10 @@ typedef enum { UOP_NOT, UOP_BIT_NOT, UOP_NEG, } UnaryOp;
 typedef struct ASTExpr {
     ExprKind kind;
     int line;
+    const Type *type;        // Set by infer_expr_type; NULL until checked
     union {
         uint64_t number_value;
-        const char *identifier;
+        Atom identifier;
         const char *string_value;
         int boolean_value;
         struct { BinaryOp op; struct ASTExpr *left; struct ASTExpr *right; } binary;
@@ -46,22 +50,23 @@ typedef struct ASTExpr {
         struct { struct ASTExpr *func; struct ASTExpr **args; size_t arg_count; } call;
         struct { struct ASTExpr *array; struct ASTExpr *index; } array_access;
         struct { struct ASTExpr *expr; uint32_t start; uint32_t end; } bit_slice;
-        struct { struct ASTExpr *object; const char *field; } member;
+        struct { struct ASTExpr *object; Atom field; } member;
     } data;
 } ASTExpr;
 
-ASTExpr *ast_expr_number(uint64_t value, TypeKind type);
-ASTExpr *ast_expr_identifier(const char *name);
-ASTExpr *ast_expr_string(const char *value);
-ASTExpr *ast_expr_true(void);
-ASTExpr *ast_expr_false(void);
-ASTExpr *ast_expr_binary_op(BinaryOp op, ASTExpr *left, ASTExpr *right);
-ASTExpr *ast_expr_unary_op(UnaryOp op, ASTExpr *operand);
-ASTExpr *ast_expr_call(ASTExpr *func, ASTExpr **args, size_t arg_count);
-ASTExpr *ast_expr_array_index(ASTExpr *array, ASTExpr *index);
-ASTExpr *ast_expr_bit_slice(ASTExpr *expr, uint32_t start, uint32_t end);
-ASTExpr *ast_expr_member_access(ASTExpr *object, const char *field);
-void ast_free_expr(ASTExpr *expr);
+// All AST constructors allocate from the given arena; nodes are never freed
+// individually and live until the owning ASTProgram is released.
+ASTExpr *ast_expr_number(Arena *arena, uint64_t value, TypeKind type);
+ASTExpr *ast_expr_identifier(Arena *arena, Atom name);
+ASTExpr *ast_expr_string(Arena *arena, const char *value);
+ASTExpr *ast_expr_true(Arena *arena);
+ASTExpr *ast_expr_false(Arena *arena);
+ASTExpr *ast_expr_binary_op(Arena *arena, BinaryOp op, ASTExpr *left, ASTExpr *right);
+ASTExpr *ast_expr_unary_op(Arena *arena, UnaryOp op, ASTExpr *operand);
+ASTExpr *ast_expr_call(Arena *arena, ASTExpr *func, ASTExpr **args, size_t arg_count);
+ASTExpr *ast_expr_array_index(Arena *arena, ASTExpr *array, ASTExpr *index);
+ASTExpr *ast_expr_bit_slice(Arena *arena, ASTExpr *expr, uint32_t start, uint32_t end);
+ASTExpr *ast_expr_member_access(Arena *arena, ASTExpr *object, Atom field);
 
 // ============================================================================
 // Statements
@@ -72,34 +77,33 @@ typedef enum { STMT_VAR_DECL, STMT_EXPR, STMT_RETURN, STMT_IF, STMT_WHILE, STMT_
 typedef struct ASTStmt {
     StmtKind kind;
     union {
-        struct { const char *name; Type *type; ASTExpr *init; int is_mut; } var_decl;
+        struct { Atom name; const Type *type; ASTExpr *init; int is_mut; } var_decl;
         struct { ASTExpr *expr; } expr_stmt;
         struct { ASTExpr *value; } ret;
         struct { struct ASTStmt **statements; size_t count; } block;
     } data;
 } ASTStmt;
 
-ASTStmt *ast_stmt_var_decl(const char *name, Type *type, ASTExpr *init, int is_mut);
-ASTStmt *ast_stmt_expr(ASTExpr *expr);
-ASTStmt *ast_stmt_return(ASTExpr *value);
-ASTStmt *ast_stmt_block(ASTStmt **statements, size_t count);
-void ast_free_stmt(ASTStmt *stmt);
+ASTStmt *ast_stmt_var_decl(Arena *arena, Atom name, const Type *type, ASTExpr *init, int is_mut);
+ASTStmt *ast_stmt_expr(Arena *arena, ASTExpr *expr);
+ASTStmt *ast_stmt_return(Arena *arena, ASTExpr *value);
+ASTStmt *ast_stmt_block(Arena *arena, ASTStmt **statements, size_t count);
 
 // ============================================================================
 // Functions
 // ============================================================================
 
 typedef struct {
-    const char *name;
-    Type *return_type;
-    char **param_names;
-    Type **param_types;
+    Atom name;
+    const Type *return_type;
+    Atom *param_names;
+    const Type **param_types;
     size_t param_count;
     ASTStmt *body;
 } ASTFunctionDef;
 
-ASTFunctionDef *ast_function_def(const char *name, Type *return_type,
-                                 char **param_names, Type **param_types,
+ASTFunctionDef *ast_function_def(Arena *arena, Atom name, const Type *return_type,
+                                 Atom *param_names, const Type **param_types,
                                  size_t param_count, ASTStmt *body);
 
 // ============================================================================
@@ -114,38 +118,57 @@ typedef enum {
 } AccessKind;
 
 typedef struct {
-    const char *name;
+    Atom name;
     uint32_t start_bit;      // Start bit (inclusive)
     uint32_t end_bit;        // End bit (exclusive, like slice notation)
     AccessKind access;
 } ASTField;
 
 typedef struct {
-    const char *name;
-    Type *type;              // Register type (u32, u16, etc.)
+    Atom name;
+    const Type *type;        // Register type (u32, u16, etc.)
     uint32_t offset;         // Byte offset from peripheral base
     ASTField **fields;
     size_t field_count;
+    size_t field_capacity;
 } ASTRegister;
 
+// A block of registers repeated count times, stride bytes apart (e.g. the 12
+// DMA channels). The template is stored once; register offsets are relative
+// to the start of each element.
 typedef struct {
-    const char *name;
+    Atom name;
+    uint32_t offset;         // Offset of element 0 from peripheral base
+    uint32_t count;
+    uint32_t stride;
+    ASTRegister **registers;
+    size_t register_count;
+    size_t register_capacity;
+} ASTCluster;
+
+typedef struct {
+    Atom name;
     uint32_t base_address;
     ASTRegister **registers;
     size_t register_count;
+    size_t register_capacity;
+    ASTCluster **clusters;
+    size_t cluster_count;
+    size_t cluster_capacity;
 } ASTPeripheral;
 
 // Peripheral construction helpers
-ASTField *ast_field_create(const char *name, uint32_t start, uint32_t end, AccessKind access);
-void ast_field_free(ASTField *field);
+ASTField *ast_field_create(Arena *arena, Atom name, uint32_t start, uint32_t end, AccessKind access);
+
+ASTRegister *ast_register_create(Arena *arena, Atom name, const Type *type, uint32_t offset);
+void ast_register_add_field(Arena *arena, ASTRegister *reg, ASTField *field);
 
-ASTRegister *ast_register_create(const char *name, Type *type, uint32_t offset);
-void ast_register_add_field(ASTRegister *reg, ASTField *field);
-void ast_register_free(ASTRegister *reg);
+ASTCluster *ast_cluster_create(Arena *arena, Atom name, uint32_t offset, uint32_t count, uint32_t stride);
+void ast_cluster_add_register(Arena *arena, ASTCluster *cluster, ASTRegister *reg);
 
-ASTPeripheral *ast_peripheral_create(const char *name, uint32_t base_address);
-void ast_peripheral_add_register(ASTPeripheral *periph, ASTRegister *reg);
-void ast_peripheral_free(ASTPeripheral *periph);
+ASTPeripheral *ast_peripheral_create(Arena *arena, Atom name, uint32_t base_address);
+void ast_peripheral_add_register(Arena *arena, ASTPeripheral *periph, ASTRegister *reg);
+void ast_peripheral_add_cluster(Arena *arena, ASTPeripheral *periph, ASTCluster *cluster);
 
 // ============================================================================
 // Program (Functions + Peripherals)
@@ -154,11 +177,16 @@ void ast_peripheral_free(ASTPeripheral *periph);
 typedef struct {
     ASTFunctionDef **functions;
     size_t function_count;
+    size_t function_capacity;
     
     ASTPeripheral **peripherals;
     size_t peripheral_count;
+    size_t peripheral_capacity;
+
+    Arena *arena;            // Owns every node reachable from this program
 } ASTProgram;
 
+// Creates the program together with its arena; ast_free_program releases both.
 ASTProgram *ast_program_create(void);
 void ast_program_add_function(ASTProgram *prog, ASTFunctionDef *func);
 void ast_program_add_peripheral(ASTProgram *prog, ASTPeripheral *periph);
@@ -0,0 +1,27 @@
+// include/bus/ahb_lite.h
+#ifndef BITN_BUS_AHB_LITE_H
+#define BITN_BUS_AHB_LITE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* AHB-Lite Interconnect
+ *
+ * Carries core accesses that no modelled memory or register block
+ * claims. The peripherals behind it are not modelled yet: reads return
+ * zero and writes are dropped, and both are counted.
+ */
+
+typedef struct {
+    uint64_t reads;
+    uint64_t writes;
+} ahb_interconnect_t;
+
+/* Public API */
+int ahb_interconnect_init(ahb_interconnect_t *bus);
+void ahb_interconnect_destroy(ahb_interconnect_t *bus);
+
+int ahb_read(ahb_interconnect_t *bus, uint32_t addr, uint32_t size, uint32_t *value);
+int ahb_write(ahb_interconnect_t *bus, uint32_t addr, uint32_t size, uint32_t value);
+
+#endif // BITN_BUS_AHB_LITE_H
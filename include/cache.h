@@ -0,0 +1,36 @@
+#ifndef BITN_CACHE_H
+#define BITN_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Incremental compilation cache
+//
+// Generated headers are stored in a directory keyed by a hash of the source
+// text, the compiler version, the codegen output format version and the
+// normalized target, so an unchanged input can be served without lexing,
+// parsing or running codegen.
+// ============================================================================
+
+#define CACHE_DEFAULT_DIR ".bitn-cache"
+
+typedef uint64_t CacheKey;
+
+// format is CODEGEN_FORMAT_VERSION; a header from any other format misses.
+CacheKey cache_key(const char *source, size_t length, const char *target, uint32_t format);
+
+// Load the entry for key into a malloc'd buffer. Returns 0 on a hit, -1 on a
+// miss or read error.
+int cache_load(const char *dir, CacheKey key, char **data, size_t *length);
+
+// Store an entry, creating dir if needed. The entry is written to a temporary
+// file and renamed into place so concurrent builds never see a partial entry.
+int cache_store(const char *dir, CacheKey key, const char *data, size_t length);
+
+// Replace path with data unless it already holds exactly those bytes, so an
+// unchanged output keeps its mtime. Returns 1 if written, 0 if unchanged, -1
+// on error.
+int file_write_if_changed(const char *path, const char *data, size_t length);
+
+#endif // BITN_CACHE_H
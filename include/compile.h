@@ -0,0 +1,53 @@
+#ifndef BITN_COMPILE_H
+#define BITN_COMPILE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Result of compiling one input
+typedef enum {
+    COMPILE_OK = 0,
+    COMPILE_FAILED = 1,          // I/O, allocation or code generation error
+    COMPILE_PARSE_FAILED = 2,    // Source was read but did not parse
+} CompileStatus;
+
+typedef struct {
+    int do_codegen;
+    int verbose;
+    const char *target;          // Normalized target name
+    const char *cache_dir;       // Generated-header cache, or NULL to disable
+    int emit_db;                 // Also write each parsed input as a .bitndb database
+    int emit_obj;                // Also compile functions to a Thumb-1 ELF object (.o)
+} CompileOptions;
+
+// One input in a multi-file compilation. The report holds everything the
+// compilation printed (including diagnostics) so results can be emitted in
+// input order no matter which worker finished first.
+typedef struct {
+    const char *input_file;
+    CompileStatus status;
+    char *report;
+    size_t report_length;
+} CompileJob;
+
+// Lex, parse and (optionally) generate code for one input. input_file may be
+// "-" for stdin; when source is non-NULL it is compiled instead of reading
+// input_file. An input holding a precompiled device database (devdb.h) is
+// loaded instead of parsed. Progress goes to out, diagnostics to err.
+CompileStatus compile_unit(const CompileOptions *opts, const char *input_file,
+                           const char *source, FILE *out, FILE *err);
+
+// Compile every job on a pool of worker threads (threads <= 0 picks one per
+// online CPU, and there are never more workers than jobs). Returns the number
+// of jobs that did not succeed; *workers, if given, gets the workers that ran.
+size_t compile_jobs(const CompileOptions *opts, CompileJob *jobs, size_t count, int threads,
+                    int *workers);
+int compile_default_threads(void);
+
+// Expand a command-line input into .bitn paths: directories yield their
+// *.bitn entries and quoted glob patterns are expanded, both sorted. Plain
+// paths are passed through. Appends malloc'd strings to *paths. Returns the
+// number of paths added, or -1 if the input could not be expanded.
+int compile_expand_input(const char *arg, char ***paths, size_t *count, size_t *capacity);
+
+#endif // BITN_COMPILE_H
@@ -7,6 +7,8 @@
 
 /* ARM Cortex-M Register Definitions */
 
+struct arm_bus;
+
 typedef struct {
     uint32_t r[13];        // R0-R12 general purpose
     uint32_t sp;           // R13 (Stack Pointer)
@@ -29,6 +31,9 @@ typedef struct {
     bool thumb_mode;       // Thumb mode (always true for M0+/M33)
     bool in_exception;     // Currently in exception handler
     uint8_t exception_level; // 0=thread, 1+=handler
+    
+    // Memory the core executes against (isa/arm/decoder.h), set by its system
+    struct arm_bus *bus;
 } arm_core_state_t;
 
 /* RISC-V Core Register Definitions */
@@ -56,7 +61,7 @@ typedef struct {
 } riscv_core_state_t;
 
 /* PSR Flag Bits (ARM) */
-#define PSR_N_BIT    (1 << 31)  // Negative flag
+#define PSR_N_BIT    (1u << 31)  // Negative flag
 #define PSR_Z_BIT    (1 << 30)  // Zero flag
 #define PSR_C_BIT    (1 << 29)  // Carry flag
 #define PSR_V_BIT    (1 << 28)  // Overflow flag
@@ -0,0 +1,119 @@
+#ifndef BITN_DEVDB_H
+#define BITN_DEVDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast.h"
+#include "source.h"
+
+// ============================================================================
+// Precompiled device database
+//
+// The peripherals of a parsed program flattened into fixed-size records that
+// refer to each other by index and to names by offset into a string table.
+// Nothing in the file is a pointer, so it can be mapped and read in place
+// wherever it lands. Peripherals are found by name through an index sorted
+// by name. Values are stored in host byte order; a foreign-endian file fails
+// the version check.
+//
+// Layout: header, then the peripheral, cluster, register and field tables,
+// the index and the string table, each 4-byte aligned. A peripheral's own
+// registers and each cluster's registers are contiguous runs of the register
+// table; each register's fields are a contiguous run of the field table.
+// ============================================================================
+
+#define DEVDB_MAGIC   "BITNDB\r\n"   // 8 bytes, no terminator stored
+#define DEVDB_VERSION 1
+#define DEVDB_SUFFIX  ".bitndb"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;        // sizeof(DevDbHeader)
+    uint32_t file_size;
+    uint32_t peripheral_count;
+    uint32_t cluster_count;
+    uint32_t register_count;
+    uint32_t field_count;
+    uint32_t peripherals;        // Table offsets from the start of the file
+    uint32_t clusters;
+    uint32_t registers;
+    uint32_t fields;
+    uint32_t index;              // peripheral_count uint32_t, sorted by name
+    uint32_t strings;
+    uint32_t strings_size;       // Starts with "" so offset 0 is no name
+} DevDbHeader;
+
+typedef struct {
+    uint32_t name;               // String table offset
+    uint32_t base_address;
+    uint32_t first_register;     // Registers outside any cluster
+    uint32_t register_count;
+    uint32_t first_cluster;
+    uint32_t cluster_count;
+} DevDbPeripheral;
+
+typedef struct {
+    uint32_t name;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t stride;
+    uint32_t first_register;
+    uint32_t register_count;
+} DevDbCluster;
+
+typedef struct {
+    uint32_t name;
+    uint32_t offset;
+    uint32_t type;               // TypeKind
+    uint32_t first_field;
+    uint32_t field_count;
+} DevDbRegister;
+
+typedef struct {
+    uint32_t name;
+    uint32_t start_bit;
+    uint32_t end_bit;
+    uint32_t access;             // AccessKind
+} DevDbField;
+
+// A validated database. The tables point into the mapped file (or the
+// buffer given to devdb_attach) and are only valid while it is.
+typedef struct {
+    SourceFile file;             // Owned when opened with devdb_open
+    const DevDbHeader *header;
+    const DevDbPeripheral *peripherals;
+    const DevDbCluster *clusters;
+    const DevDbRegister *registers;
+    const DevDbField *fields;
+    const uint32_t *index;
+    const char *strings;
+} DevDb;
+
+// Serialize the peripherals of program (functions are not stored). Atoms are
+// resolved on the calling thread. The file is left untouched if it already
+// holds the same bytes. Returns 0 on success, -1 on error.
+int devdb_write(const ASTProgram *program, const char *path);
+
+// True if data starts with the database magic.
+int devdb_is_database(const char *data, size_t length);
+
+// Validate data as a database without copying it; every offset, range and
+// enum is checked, so the tables can be walked without further bounds checks.
+// Returns 0 on success, -1 if the data is not a usable database.
+int devdb_attach(DevDb *db, const char *data, size_t length);
+
+// Map path and attach it. Returns 0 on success, -1 on error.
+int devdb_open(DevDb *db, const char *path);
+void devdb_close(DevDb *db);
+
+const char *devdb_string(const DevDb *db, uint32_t offset);
+
+// Binary search of the name index. Returns NULL if there is no such peripheral.
+const DevDbPeripheral *devdb_find(const DevDb *db, const char *name);
+
+// Rebuild an AST (names interned on the calling thread) for codegen.
+ASTProgram *devdb_to_program(const DevDb *db);
+
+#endif // BITN_DEVDB_H
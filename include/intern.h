@@ -0,0 +1,30 @@
+#ifndef BITN_INTERN_H
+#define BITN_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Identifier interning
+//
+// Every distinct identifier is stored once and named by a stable 32-bit atom,
+// so names compare as integers everywhere after the lexer. Atom 0 is reserved
+// for "no name" and maps to the empty string. The table is per thread: atoms
+// are only meaningful on the thread that interned them.
+// ============================================================================
+
+typedef uint32_t Atom;
+
+#define ATOM_NONE ((Atom)0)
+
+Atom intern(const char *text, size_t length);
+Atom intern_cstr(const char *text);
+
+// NUL-terminated copy of the identifier; valid until intern_reset().
+const char *atom_name(Atom atom);
+size_t atom_length(Atom atom);
+
+size_t intern_count(void);
+void intern_reset(void);
+
+#endif // BITN_INTERN_H
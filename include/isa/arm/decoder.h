@@ -0,0 +1,113 @@
+// include/isa/arm/decoder.h
+#ifndef BITN_ARM_DECODER_H
+#define BITN_ARM_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/registers.h"
+
+/* Thumb-2 Instruction Decoder
+ *
+ * Covers ARMv6-M (Cortex-M0+): the 16-bit Thumb set, plus BL, MRS, MSR
+ * and the barriers among the 32-bit encodings. Exceptions are not
+ * modelled, so SVC and anything that would fault stop execution instead.
+ */
+
+/* Opcode constants */
+#define THUMB_UNCONDITIONAL_MASK 0xF800
+#define THUMB_UNCONDITIONAL      0xE000
+
+/* Instruction types */
+typedef enum {
+    ARM_INSTR_INVALID = 0,
+    ARM_INSTR_ADD,
+    ARM_INSTR_SUB,
+    ARM_INSTR_MOV,
+    ARM_INSTR_LDR,
+    ARM_INSTR_STR,
+    ARM_INSTR_B,
+    ARM_INSTR_BL,
+    ARM_INSTR_AND,
+    ARM_INSTR_ORR,
+    ARM_INSTR_XOR,
+    ARM_INSTR_LDM,
+    ARM_INSTR_STM,
+    ARM_INSTR_CMP,
+    ARM_INSTR_TST,
+    ARM_INSTR_BX,
+    ARM_INSTR_BLX,
+    ARM_INSTR_MRS,
+    ARM_INSTR_MSR,
+    ARM_INSTR_PUSH,
+    ARM_INSTR_POP,
+    ARM_INSTR_NOP,
+    ARM_INSTR_WFI,
+    ARM_INSTR_SVC,
+    ARM_INSTR_ADC,
+    ARM_INSTR_SBC,
+    ARM_INSTR_RSB,
+    ARM_INSTR_MUL,
+    ARM_INSTR_BIC,
+    ARM_INSTR_MVN,
+    ARM_INSTR_CMN,
+    ARM_INSTR_LSL,
+    ARM_INSTR_LSR,
+    ARM_INSTR_ASR,
+    ARM_INSTR_ROR,
+    ARM_INSTR_SXTH,
+    ARM_INSTR_SXTB,
+    ARM_INSTR_UXTH,
+    ARM_INSTR_UXTB,
+    ARM_INSTR_REV,
+    ARM_INSTR_REV16,
+    ARM_INSTR_REVSH,
+    ARM_INSTR_CPS,
+    ARM_INSTR_BKPT,
+} arm_instruction_type_t;
+
+typedef struct {
+    arm_instruction_type_t type;
+    uint32_t raw_instruction;
+    uint8_t condition;
+    
+    /* Operands */
+    uint8_t rd, rs, rm, rn;
+    int32_t immediate;
+    bool setflags;
+    uint32_t shift_amount;
+    uint8_t shift_type;  /* 0=LSL, 1=LSR, 2=ASR, 3=ROR */
+    bool use_imm;        /* Second operand (or offset) is immediate rather than rm */
+    
+    /* Loads and stores */
+    uint8_t size;        /* Bytes per access */
+    bool sign_extend;
+    
+} arm_instruction_t;
+
+/* Memory the executor loads, stores and fetches through. Accesses are
+ * naturally aligned; the callbacks return 0, or -1 for a bus fault. */
+typedef struct arm_bus {
+    void *context;
+    int master;          /* Passed back to the callbacks (e.g. the core number) */
+    int (*read)(void *context, int master, uint32_t addr, uint32_t size, uint32_t *value);
+    int (*write)(void *context, int master, uint32_t addr, uint32_t size, uint32_t value);
+} arm_bus_t;
+
+/* arm_thumb2_execute results */
+#define ARM_EXEC_OK      0
+#define ARM_EXEC_BREAK   1      /* BKPT: PC is left on the instruction */
+#define ARM_EXEC_FAULT   (-1)   /* Undefined instruction, bus or alignment fault */
+
+/* Public API */
+int arm_thumb2_decode(uint32_t instruction, uint8_t instr_len, arm_instruction_t *instr);
+int arm_thumb2_execute(arm_core_state_t *core, uint32_t instruction, uint8_t instr_len);
+
+/* Execute half of arm_thumb2_execute, for instructions decoded ahead of time */
+int arm_thumb2_execute_decoded(arm_core_state_t *core, const arm_instruction_t *instr, uint8_t instr_len);
+
+/* Helper functions */
+uint32_t arm_decode_imm12(uint32_t imm12);
+uint32_t arm_decode_imm8_rotated(uint8_t imm8, uint8_t rotate);
+bool arm_check_condition(arm_core_state_t *core, uint8_t condition);
+
+#endif // BITN_ARM_DECODER_H
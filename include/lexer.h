@@ -22,10 +22,21 @@ typedef struct {
     int at_line_start;                    // Flag: are we at start of new line?
 } Lexer;
 
+// A whole source tokenized in one pass. tokens[count - 1] is always TOK_EOF.
+typedef struct {
+    Token *tokens;
+    size_t count;
+    size_t capacity;
+} TokenStream;
+
 Lexer *lexer_create(const char *input);
 void lexer_free(Lexer *lexer);
 
 Token lexer_next_token(Lexer *lexer);
+TokenType lexer_keyword_type(const char *word, int length);
+
+TokenStream *lexer_tokenize(const char *input);
+void token_stream_free(TokenStream *stream);
 void lexer_skip_whitespace(Lexer *lexer);
 void lexer_skip_comment(Lexer *lexer);
 
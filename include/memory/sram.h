@@ -0,0 +1,81 @@
+// include/memory/sram.h
+#ifndef BITN_MEMORY_SRAM_H
+#define BITN_MEMORY_SRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* On-Chip SRAM
+ *
+ * A flat little-endian array. Offsets are relative to the start of the
+ * SRAM and must be in range; the system decoding addresses checks them.
+ */
+
+#define SRAM_SIZE               0x42800     /* Default size (264KB, RP2040) */
+
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+} sram_t;
+
+/* Public API */
+int sram_init(sram_t *sram, uint32_t size);
+void sram_destroy(sram_t *sram);
+
+/**
+ * Read a byte at offset
+ */
+static inline uint8_t sram_read_byte(const sram_t *sram, uint32_t offset)
+{
+    return sram->data[offset];
+}
+
+/**
+ * Read a little-endian halfword at offset
+ */
+static inline uint16_t sram_read_halfword(const sram_t *sram, uint32_t offset)
+{
+    const uint8_t *p = sram->data + offset;
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * Read a little-endian word at offset
+ */
+static inline uint32_t sram_read_word(const sram_t *sram, uint32_t offset)
+{
+    const uint8_t *p = sram->data + offset;
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Write a byte at offset
+ */
+static inline void sram_write_byte(sram_t *sram, uint32_t offset, uint8_t value)
+{
+    sram->data[offset] = value;
+}
+
+/**
+ * Write a little-endian halfword at offset
+ */
+static inline void sram_write_halfword(sram_t *sram, uint32_t offset, uint16_t value)
+{
+    uint8_t *p = sram->data + offset;
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * Write a little-endian word at offset
+ */
+static inline void sram_write_word(sram_t *sram, uint32_t offset, uint32_t value)
+{
+    uint8_t *p = sram->data + offset;
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+#endif // BITN_MEMORY_SRAM_H
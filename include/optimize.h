@@ -0,0 +1,46 @@
+#ifndef BITN_OPTIMIZE_H
+#define BITN_OPTIMIZE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "ast.h"
+
+// ============================================================================
+// AST optimization passes
+//
+// Rewrites expressions in function bodies after check_program_types has
+// annotated every node with its type. Each pass rewrites bottom-up, and the
+// pipeline repeats until a round changes nothing, so folding can finish what
+// strength reduction and rotate detection expose. Unchecked nodes
+// (type == NULL) are left alone.
+// ============================================================================
+
+typedef enum {
+    OPT_PASS_FOLD,           // Constant folding, wrapping at the type's width
+    OPT_PASS_STRENGTH,       // x * 2^k, x / 2^k, x % 2^k -> shifts and masks
+    OPT_PASS_ROTATE,         // (x << k) | (x >> (W - k)) -> BOP_LROTATE
+    OPT_PASS_COUNT,
+} OptPass;
+
+typedef struct {
+    const char *name;
+    size_t visited;          // Expression nodes examined
+    size_t rewritten;        // Nodes replaced
+} OptPassStats;
+
+typedef struct {
+    Arena *arena;            // Where replacement nodes are allocated
+    int rounds;              // Pipeline iterations run
+    OptPassStats passes[OPT_PASS_COUNT];
+} Optimizer;
+
+void optimizer_init(Optimizer *opt, Arena *arena);
+
+// Run the pipeline over every function. Returns the number of rewrites.
+size_t optimize_program(Optimizer *opt, ASTProgram *program);
+size_t optimize_function(Optimizer *opt, ASTFunctionDef *func);
+
+void optimizer_print_stats(const Optimizer *opt, FILE *out);
+
+#endif // BITN_OPTIMIZE_H
@@ -4,14 +4,21 @@
 #include "lexer.h"
 #include "ast.h"
 
+#include <stdio.h>
+
 typedef struct {
-    Lexer *lexer;
-    Token current;
-    Token peek;
+    const TokenStream *tokens;
+    TokenStream *owned_tokens;  // Set when the parser tokenized the input itself
+    size_t pos;                 // Index of current in tokens
+    const Token *current;
+    const Token *peek;
+    Arena *arena;   // Arena of the program being parsed (owned by the ASTProgram)
     int error;
+    FILE *errors;   // Diagnostics sink (stderr unless redirected)
 } Parser;
 
 Parser *parser_create(const char *input);
+Parser *parser_create_from_tokens(const TokenStream *tokens);
 void parser_free(Parser *parser);
 void parser_error(Parser *parser, const char *message);
 int parser_has_error(Parser *parser);
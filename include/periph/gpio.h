@@ -0,0 +1,28 @@
+// include/periph/gpio.h
+#ifndef BITN_PERIPH_GPIO_H
+#define BITN_PERIPH_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* GPIO Pins
+ *
+ * Pin levels only, as set from the host; pad and function select
+ * registers are not modelled.
+ */
+
+#define GPIO_MAX_PINS           32
+
+typedef struct {
+    uint32_t num_pins;
+    uint32_t levels;            /* One bit per pin */
+} gpio_state_t;
+
+/* Public API */
+int gpio_init(gpio_state_t *gpio, uint32_t num_pins);
+void gpio_destroy(gpio_state_t *gpio);
+
+int gpio_write_pin(gpio_state_t *gpio, int pin, bool value);
+bool gpio_read_pin(const gpio_state_t *gpio, int pin);
+
+#endif // BITN_PERIPH_GPIO_H
@@ -0,0 +1,29 @@
+// include/periph/uart.h
+#ifndef BITN_PERIPH_UART_H
+#define BITN_PERIPH_UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* UART
+ *
+ * A byte FIFO between the host and the device, the depth of the PL011's.
+ * Registers and line settings are not modelled.
+ */
+
+#define UART_FIFO_DEPTH         32
+
+typedef struct {
+    uint8_t fifo[UART_FIFO_DEPTH];
+    uint32_t head;              /* Next byte to read */
+    uint32_t count;
+} uart_state_t;
+
+/* Public API */
+int uart_init(uart_state_t *uart);
+void uart_destroy(uart_state_t *uart);
+
+int uart_write(uart_state_t *uart, const uint8_t *data, uint32_t len);
+int uart_read(uart_state_t *uart, uint8_t *data, uint32_t len);
+
+#endif // BITN_PERIPH_UART_H
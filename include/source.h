@@ -0,0 +1,21 @@
+#ifndef BITN_SOURCE_H
+#define BITN_SOURCE_H
+
+#include <stddef.h>
+
+// Source text loaded for compilation. Regular files are memory-mapped so
+// tokens and AST names point straight into the page cache; pipes, stdin and
+// anything that cannot be mapped are read into a heap buffer instead. Either
+// way data is NUL-terminated, as the lexer expects.
+typedef struct {
+    const char *data;
+    size_t length;
+    void *mapping;           // mmap base, or NULL if data is heap-allocated
+    size_t mapping_length;
+} SourceFile;
+
+// Load path ("-" reads stdin). Returns 0 on success, -1 on error.
+int source_open(SourceFile *src, const char *path);
+void source_close(SourceFile *src);
+
+#endif // BITN_SOURCE_H
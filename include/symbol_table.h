@@ -5,25 +5,42 @@
 
 // A symbol is a named entity (variable, parameter, function)
 typedef struct {
-    const char *name;
-    Type *type;
+    Atom name;
+    const Type *type;
     int is_parameter;   // 1 if parameter, 0 if local variable
     int is_mutable;     // 1 if var, 0 if let (NEW)
     int is_initialized; // 1 if initialized, 0 otherwise
 } Symbol;
 
-// Scope represents a block of code with its own variable space
-typedef struct Scope {
-    Symbol *symbols;
-    size_t symbol_count;
-    size_t capacity;
-    struct Scope *parent; // Enclosing scope for nested blocks
-} Scope;
+// A declared symbol plus the bookkeeping needed to undo it at scope exit.
+// The bindings array is both the symbol storage and the scope undo log:
+// entering a scope records the current binding count, leaving it rewinds to
+// that mark and restores whatever each removed binding was shadowing.
+typedef struct {
+    Symbol symbol;
+    size_t depth;         // Scope depth the symbol was declared at
+    int32_t shadowed;     // Binding this one hides, or -1
+} SymbolBinding;
+
+// Open-addressed hash slot: name -> innermost visible binding
+typedef struct {
+    Atom name;            // ATOM_NONE marks an empty slot
+    int32_t binding;      // Index into bindings, or -1 if currently unbound
+} SymbolSlot;
 
 // Symbol table manages all scopes
 typedef struct {
-    Scope *current_scope;
-    Scope *global_scope;
+    SymbolSlot *slots;
+    size_t slot_count;        // Power of two
+    size_t slots_used;
+
+    SymbolBinding *bindings;
+    size_t binding_count;
+    size_t binding_capacity;
+
+    size_t *scope_marks;      // binding_count at each scope entry
+    size_t depth;             // 0 = global scope
+    size_t mark_capacity;
 } SymbolTable;
 
 // API - Lifecycle
@@ -36,15 +53,15 @@ void symbol_table_pop_scope(SymbolTable *table);
 
 // API - Symbol management (UPDATED signature)
 int symbol_table_add_symbol(SymbolTable *table,
-                            const char *name,
-                            Type *type,
+                            Atom name,
+                            const Type *type,
                             int is_param,
                             int is_mutable,
                             int is_initialized);
 
-Symbol *symbol_table_lookup(SymbolTable *table, const char *name);
-Symbol *symbol_table_lookup_local(SymbolTable *table, const char *name);
-int symbol_table_is_defined(SymbolTable *table, const char *name);
-int symbol_table_is_defined_local(SymbolTable *table, const char *name);
+Symbol *symbol_table_lookup(SymbolTable *table, Atom name);
+Symbol *symbol_table_lookup_local(SymbolTable *table, Atom name);
+int symbol_table_is_defined(SymbolTable *table, Atom name);
+int symbol_table_is_defined_local(SymbolTable *table, Atom name);
 
 #endif // SYMBOL_TABLE_H
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "intern.h"
+
 typedef enum {
     // Literals
     TOK_NUMBER, TOK_IDENTIFIER, TOK_STRING,
@@ -24,7 +26,7 @@ typedef enum {
     TOK_U8, TOK_U16, TOK_U32, TOK_U64, TOK_I8, TOK_I16, TOK_I32, TOK_I64, TOK_VOID,
 
     // Keywords - DSL Peripherals
-    TOK_PERIPHERAL, TOK_REGISTER, TOK_FIELD,
+    TOK_PERIPHERAL, TOK_REGISTER, TOK_FIELD, TOK_CLUSTER, TOK_STRIDE,
     TOK_RO, TOK_WO, TOK_RW, TOK_W1C,
 
     // Operators - Logical/Bitwise
@@ -63,6 +65,7 @@ typedef struct {
     int line;
     int column;
     int length;
+    Atom atom;          // Interned name for TOK_IDENTIFIER, ATOM_NONE otherwise
 } Token;
 
 const char *token_type_name(TokenType type);
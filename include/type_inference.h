@@ -8,8 +8,8 @@
 typedef struct {
     SymbolTable *symbols;
     int error_count;
-    const char *current_function;  // For return type checking
-    Type *expected_return_type;    // Return type of current function
+    Atom current_function;         // For return type checking
+    const Type *expected_return_type;  // Return type of current function
 } TypeContext;
 
 // API - Lifecycle
@@ -17,10 +17,10 @@ TypeContext *type_context_create(void);
 void type_context_free(TypeContext *ctx);
 
 // API - Context setup
-void type_context_set_function(TypeContext *ctx, const char *name, Type *return_type);
+void type_context_set_function(TypeContext *ctx, Atom name, const Type *return_type);
 
-// API - Type inference
-Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr);
+// API - Type inference (also stores the result in expr->type)
+const Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr);
 
 // API - Statement validation
 int check_stmt_types(TypeContext *ctx, ASTStmt *stmt);
@@ -3,25 +3,25 @@
 
 #include "ast.h"
 
-// Type operations using existing Type from ast.h
-Type *type_clone(Type *type);
-void type_free(Type *type);
+// Types are canonical, immutable singletons: type_from_kind hands out const
+// pointers into a read-only table that lives for the whole process and is
+// never freed. Two types are equal exactly when their pointers are.
 
 // Type comparison and conversion
-int type_equal(Type *a, Type *b);
-int type_compatible(Type *target, Type *source);
-int type_is_numeric(Type *type);
-int type_is_integer(Type *type);
-int type_is_void(Type *type);
-int type_is_error(Type *type);
+int type_equal(const Type *a, const Type *b);
+int type_compatible(const Type *target, const Type *source);
+int type_is_numeric(const Type *type);
+int type_is_integer(const Type *type);
+int type_is_void(const Type *type);
+int type_is_error(const Type *type);
 
 // Type information
-const char *type_to_string(Type *type);
+const char *type_to_string(const Type *type);
 const char *type_kind_to_string(TypeKind kind);
 uint64_t type_get_size(TypeKind kind);
 
 // Type conversion
-Type *type_from_kind(TypeKind kind);
+const Type *type_from_kind(TypeKind kind);
 TypeKind type_kind_from_string(const char *name, int length);
 
 #endif // TYPE_SYSTEM_H
@@ -0,0 +1,113 @@
+// include/rp2040/block.h
+#ifndef BITN_RP2040_BLOCK_H
+#define BITN_RP2040_BLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/registers.h"
+
+/* Threaded-Code Block Interpreter
+ *
+ * Straight-line Thumb code up to and including the next branch is
+ * translated once into an array of ops, each carrying the address of its
+ * handler label in rp2040_block_run. Executing a block is a chain of
+ * computed gotos over that array; registers and flags live in locals and
+ * the PC, PSR and cycle_count are written back only when the block exits.
+ *
+ * Anything the translator does not handle (32-bit encodings other than
+ * BL, system instructions, memory outside SRAM) ends the block, and that
+ * one instruction goes through rp2040_step_core. Blocks also end before
+ * breakpoints, so the dispatcher sees every one. Word accesses to the SIO
+ * FIFO and spinlock registers are handled in place.
+ *
+ * Each core has its own block cache; the stores of one core drop blocks
+ * in every cache (see rp2040_code_written).
+ */
+
+#define RP2040_BLOCK_MAX_INSTRS     64
+#define RP2040_BLOCK_BUCKETS        4096    /* Hash buckets, power of two */
+
+/* rp2040_block_run results */
+#define RP2040_BLOCK_DONE           0       /* PC is at the next block */
+#define RP2040_BLOCK_STEP           1       /* Next instruction must be single-stepped */
+#define RP2040_BLOCK_STOP           2       /* Watchpoint hit before the access at PC */
+
+struct rp2040_system;
+
+/* Block ops */
+typedef enum {
+    RP2040_OP_NOP = 0,
+    RP2040_OP_MOV_IMM, RP2040_OP_MOVS_IMM, RP2040_OP_MOV_REG, RP2040_OP_MOVS_REG,
+    RP2040_OP_LSL_IMM, RP2040_OP_LSR_IMM, RP2040_OP_ASR_IMM,
+    RP2040_OP_LSL_REG, RP2040_OP_LSR_REG, RP2040_OP_ASR_REG, RP2040_OP_ROR_REG,
+    RP2040_OP_ADD_IMM, RP2040_OP_ADD_REG, RP2040_OP_ADDS_IMM, RP2040_OP_ADDS_REG,
+    RP2040_OP_SUBS_IMM, RP2040_OP_SUBS_REG,
+    RP2040_OP_ADC, RP2040_OP_SBC, RP2040_OP_RSB, RP2040_OP_MUL,
+    RP2040_OP_AND, RP2040_OP_EOR, RP2040_OP_ORR, RP2040_OP_BIC, RP2040_OP_MVN,
+    RP2040_OP_CMP_IMM, RP2040_OP_CMP_REG, RP2040_OP_CMN_REG, RP2040_OP_TST,
+    RP2040_OP_SXTH, RP2040_OP_SXTB, RP2040_OP_UXTH, RP2040_OP_UXTB,
+    RP2040_OP_REV, RP2040_OP_REV16, RP2040_OP_REVSH,
+    RP2040_OP_LDR_LIT,
+    RP2040_OP_LDR_IMM, RP2040_OP_LDRH_IMM, RP2040_OP_LDRB_IMM,
+    RP2040_OP_STR_IMM, RP2040_OP_STRH_IMM, RP2040_OP_STRB_IMM,
+    RP2040_OP_LDR_REG, RP2040_OP_LDRH_REG, RP2040_OP_LDRB_REG, RP2040_OP_LDRSH_REG, RP2040_OP_LDRSB_REG,
+    RP2040_OP_STR_REG, RP2040_OP_STRH_REG, RP2040_OP_STRB_REG,
+    RP2040_OP_PUSH, RP2040_OP_POP, RP2040_OP_LDM, RP2040_OP_STM,
+    /* Block exits */
+    RP2040_OP_B, RP2040_OP_BCOND, RP2040_OP_BL,
+    RP2040_OP_BX, RP2040_OP_BLX, RP2040_OP_MOV_PC, RP2040_OP_POP_PC,
+    RP2040_OP_EXIT, RP2040_OP_EXIT_STEP,
+    RP2040_OP_COUNT
+} rp2040_block_opcode_t;
+
+typedef struct {
+    const void *handler;        /* Label in rp2040_block_run, bound on first run */
+    uint8_t opcode;
+    uint8_t rd, rn, rm;         /* rm doubles as the condition for conditional branches */
+    uint8_t index;              /* Instructions retired before this one */
+    uint32_t imm;               /* Immediate, register list, address or branch target */
+    uint32_t pc;                /* Address of the instruction */
+} rp2040_block_op_t;
+
+typedef struct rp2040_block {
+    uint32_t start_pc;
+    uint32_t end_pc;            /* First byte past the last translated instruction */
+    uint16_t num_ops;
+    uint16_t num_instrs;
+    bool bound;
+    uint64_t exec_count;
+
+    /* JIT tier */
+    const uint8_t *jit_code;    /* Native entry point, NULL if not translated */
+    uint32_t jit_side_exits;    /* Exits to the core from MMIO accesses */
+    bool jit_disabled;          /* Never translate again */
+    struct rp2040_block *next;  /* Hash chain */
+    rp2040_block_op_t ops[];
+} rp2040_block_t;
+
+typedef struct {
+    rp2040_block_t *buckets[RP2040_BLOCK_BUCKETS];
+    uint16_t *code_pages;       /* Blocks overlapping each SRAM code page */
+    uint32_t num_pages;
+
+    /* Statistics */
+    uint64_t translated;
+    uint64_t executed;
+    uint64_t invalidated;
+    uint64_t stepped;           /* Instructions handed back to rp2040_step_core */
+} rp2040_block_cache_t;
+
+/* Public API */
+int rp2040_block_cache_init(rp2040_block_cache_t *cache);
+void rp2040_block_cache_destroy(rp2040_block_cache_t *cache);
+
+rp2040_block_t *rp2040_block_lookup(rp2040_block_cache_t *cache, uint32_t pc);
+rp2040_block_t *rp2040_block_translate(struct rp2040_system *sys, int core_id, uint32_t pc);
+int rp2040_block_run(struct rp2040_system *sys, int core_id, rp2040_block_t *block);
+bool rp2040_block_access(struct rp2040_system *sys, int core_id, uint32_t pc,
+                         uint32_t *addr, uint32_t *len, bool *write);
+
+void rp2040_block_invalidate(rp2040_block_cache_t *cache, uint32_t addr, uint32_t len);
+void rp2040_block_flush(rp2040_block_cache_t *cache);
+
+#endif // BITN_RP2040_BLOCK_H
@@ -0,0 +1,86 @@
+// include/rp2040/debug.h
+#ifndef BITN_RP2040_DEBUG_H
+#define BITN_RP2040_DEBUG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Breakpoints and Watchpoints
+ *
+ * Breakpoints are one bit per halfword, in bitmaps allocated per 256-byte
+ * page the first time a breakpoint is set on it. With no breakpoints set,
+ * checking PC is a single branch.
+ *
+ * Watchpoints are kept in a list, and each page they overlap is tagged.
+ * Only accesses to tagged pages are checked against the list. The block
+ * interpreter and the JIT emit no checks at all while none are set, and
+ * stepping only works out an instruction's access while some are.
+ * A watchpoint stops the core before the access, with PC on the accessing
+ * instruction; rp2040_step_core then executes it without checking.
+ */
+
+#define RP2040_DEBUG_PAGE_SHIFT     8
+#define RP2040_DEBUG_PAGE_SIZE      (1u << RP2040_DEBUG_PAGE_SHIFT)
+#define RP2040_DEBUG_PAGE_WORDS     (RP2040_DEBUG_PAGE_SIZE / 2 / 64)   /* Bitmap words per page */
+
+typedef enum {
+    RP2040_WATCH_READ = 1,
+    RP2040_WATCH_WRITE = 2,
+    RP2040_WATCH_ACCESS = 3,
+} rp2040_watch_type_t;
+
+typedef struct {
+    uint32_t addr;
+    uint32_t len;
+    rp2040_watch_type_t type;
+} rp2040_watchpoint_t;
+
+typedef struct {
+    uint32_t base;              /* Guest address of the first page */
+    uint32_t size;
+    uint32_t num_pages;
+
+    uint64_t **bp_pages;        /* Breakpoint bitmaps, NULL for pages without any */
+    uint32_t num_breakpoints;
+
+    rp2040_watchpoint_t *watchpoints;
+    uint32_t num_watchpoints;
+    uint32_t watch_capacity;
+    uint16_t *watch_pages;      /* Watchpoints overlapping each page */
+
+    /* First watchpoint hit of a run, recorded by rp2040_watchpoint_hit */
+    uint32_t hit_addr;
+    uint32_t hit_len;
+    bool hit_write;
+    int hit_core;
+} rp2040_debug_t;
+
+/* Public API */
+int rp2040_debug_init(rp2040_debug_t *dbg, uint32_t base, uint32_t size);
+void rp2040_debug_destroy(rp2040_debug_t *dbg);
+
+int rp2040_debug_set_breakpoint(rp2040_debug_t *dbg, uint32_t addr, bool set);
+void rp2040_debug_clear_breakpoints(rp2040_debug_t *dbg);
+
+int rp2040_debug_add_watchpoint(rp2040_debug_t *dbg, uint32_t addr, uint32_t len, rp2040_watch_type_t type);
+int rp2040_debug_remove_watchpoint(rp2040_debug_t *dbg, uint32_t addr);
+void rp2040_debug_clear_watchpoints(rp2040_debug_t *dbg);
+bool rp2040_debug_watch_hit(rp2040_debug_t *dbg, uint32_t addr, uint32_t len, bool write);
+
+/**
+ * Whether a breakpoint is set at pc
+ */
+static inline bool rp2040_debug_breakpoint(const rp2040_debug_t *dbg, uint32_t pc)
+{
+    if (!dbg->num_breakpoints) return false;
+
+    uint32_t offset = pc - dbg->base;       /* Wraps for addresses below base */
+    if (offset >= dbg->size) return false;
+
+    const uint64_t *bits = dbg->bp_pages[offset >> RP2040_DEBUG_PAGE_SHIFT];
+    uint32_t slot = (offset & (RP2040_DEBUG_PAGE_SIZE - 1)) >> 1;
+    return bits && ((bits[slot >> 6] >> (slot & 63)) & 1);
+}
+
+#endif // BITN_RP2040_DEBUG_H
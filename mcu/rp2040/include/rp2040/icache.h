@@ -0,0 +1,79 @@
+// include/rp2040/icache.h
+#ifndef BITN_RP2040_ICACHE_H
+#define BITN_RP2040_ICACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/registers.h"
+#include "isa/arm/decoder.h"
+
+/* Predecoded Instruction Cache
+ *
+ * One slot per halfword of the cached region, filled the first time the
+ * step loop executes that address. Slots are grouped into code pages that
+ * are only allocated once something on them has been decoded, so writes
+ * to pure data pages cost a single NULL check.
+ */
+
+#define RP2040_ICACHE_PAGE_SHIFT    8       /* 256-byte code pages */
+#define RP2040_ICACHE_PAGE_SIZE     (1u << RP2040_ICACHE_PAGE_SHIFT)
+#define RP2040_ICACHE_PAGE_SLOTS    (RP2040_ICACHE_PAGE_SIZE / 2)
+
+typedef struct rp2040_icache_entry rp2040_icache_entry_t;
+
+/* Executes a predecoded instruction (same return convention as arm_thumb2_execute) */
+typedef int (*rp2040_exec_fn)(arm_core_state_t *core, const rp2040_icache_entry_t *entry);
+
+struct rp2040_icache_entry {
+    arm_instruction_t instr;
+    rp2040_exec_fn exec;        /* NULL while the slot is empty */
+    uint8_t length;             /* 2 or 4 bytes */
+};
+
+typedef struct {
+    uint32_t base;              /* Guest address of the first slot */
+    uint32_t size;              /* Bytes covered */
+    rp2040_icache_entry_t **pages;
+    uint32_t num_pages;
+
+    /* Statistics */
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;     /* Filled slots dropped by writes */
+} rp2040_icache_t;
+
+/* Public API */
+int rp2040_icache_init(rp2040_icache_t *cache, uint32_t base, uint32_t size);
+void rp2040_icache_destroy(rp2040_icache_t *cache);
+
+rp2040_icache_entry_t *rp2040_icache_fill(rp2040_icache_t *cache, uint32_t addr,
+                                          uint32_t instruction, uint8_t instr_len);
+void rp2040_icache_invalidate(rp2040_icache_t *cache, uint32_t addr, uint32_t len);
+void rp2040_icache_flush(rp2040_icache_t *cache);
+
+double rp2040_icache_hit_rate(const rp2040_icache_t *cache);
+
+/**
+ * Find the predecoded instruction at addr, or NULL on a miss
+ */
+static inline rp2040_icache_entry_t *rp2040_icache_lookup(rp2040_icache_t *cache, uint32_t addr)
+{
+    uint32_t offset = addr - cache->base;   /* Wraps for addresses below base */
+
+    if (offset < cache->size) {
+        rp2040_icache_entry_t *page = cache->pages[offset >> RP2040_ICACHE_PAGE_SHIFT];
+        if (page) {
+            rp2040_icache_entry_t *entry = &page[(offset & (RP2040_ICACHE_PAGE_SIZE - 1)) >> 1];
+            if (entry->exec) {
+                cache->hits++;
+                return entry;
+            }
+        }
+    }
+
+    cache->misses++;
+    return NULL;
+}
+
+#endif // BITN_RP2040_ICACHE_H
@@ -0,0 +1,74 @@
+// include/rp2040/jit.h
+#ifndef BITN_RP2040_JIT_H
+#define BITN_RP2040_JIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* x86-64 JIT Tier
+ *
+ * Blocks from the threaded interpreter that have run RP2040_JIT_THRESHOLD
+ * times are compiled to native code. Direct branches between compiled
+ * blocks are chained with patched jumps, so a hot loop runs without
+ * returning to C until its instruction budget is spent.
+ *
+ * Compiled code only touches SRAM. Any other access leaves to the
+ * interpreter (or the core) for that one instruction, and blocks that keep
+ * doing it are handed back to the interpreter for good. A write to a page
+ * holding compiled code flushes the code cache and keeps that page
+ * interpreted from then on. Code compiled while watchpoints are set also
+ * leaves before any access to a watched page.
+ *
+ * Each core has its own code cache, so cores on different host threads
+ * never patch each other's code. The cache is never writable and
+ * executable at once: it is made writable to compile a block or patch a
+ * jump, and executable again before any of it runs.
+ *
+ * Only available on x86-64 Unix hosts; rp2040_jit_init fails elsewhere.
+ */
+
+#define RP2040_JIT_THRESHOLD        64              /* Block runs before compiling */
+#define RP2040_JIT_QUANTUM          1024            /* Instructions per dispatch */
+#define RP2040_JIT_CACHE_SIZE       (4u << 20)      /* Executable code cache */
+#define RP2040_JIT_MAX_SIDE_EXITS   16              /* MMIO exits before a block is given up */
+
+struct rp2040_system;
+
+/* Pending chain: a jump in compiled code waiting for its target block */
+typedef struct {
+    uint32_t site;              /* Offset of the rel32 in the code cache */
+    uint32_t target_pc;
+} rp2040_jit_link_t;
+
+typedef struct {
+    uint8_t *code;              /* Code cache, writable or executable (W^X) */
+    size_t size;
+    size_t used;
+
+    rp2040_jit_link_t *links;
+    size_t num_links;
+    size_t links_capacity;
+
+    uint8_t *jit_pages;         /* SRAM pages holding compiled blocks */
+    uint8_t *nojit_pages;       /* SRAM pages written after compilation */
+    uint32_t num_pages;
+
+    /* Statistics */
+    uint64_t compiled;
+    uint64_t rejected;          /* Blocks with ops the JIT does not handle */
+    uint64_t native_runs;
+    uint64_t chained;
+    uint64_t side_exits;
+    uint64_t flushes;
+} rp2040_jit_t;
+
+/* Public API */
+int rp2040_jit_init(rp2040_jit_t *jit);
+void rp2040_jit_destroy(rp2040_jit_t *jit);
+
+int rp2040_jit_step(struct rp2040_system *sys, int core_id, int32_t budget);
+void rp2040_jit_invalidate(struct rp2040_system *sys, int core_id, uint32_t addr, uint32_t len);
+void rp2040_jit_flush(struct rp2040_system *sys, int core_id);
+
+#endif // BITN_RP2040_JIT_H
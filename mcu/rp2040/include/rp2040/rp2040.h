@@ -0,0 +1,172 @@
+// include/rp2040/rp2040.h
+#ifndef BITN_RP2040_H
+#define BITN_RP2040_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "core/registers.h"
+#include "periph/gpio.h"
+#include "periph/uart.h"
+#include "memory/sram.h"
+#include "bus/ahb_lite.h"
+#include "rp2040/icache.h"
+#include "rp2040/block.h"
+#include "rp2040/jit.h"
+#include "rp2040/debug.h"
+#include "rp2040/sio.h"
+
+/* RP2040 System Configuration */
+#define RP2040_SRAM_SIZE        0x42800     /* 264KB */
+#define RP2040_SRAM_BASE        0x20000000
+#define RP2040_GPIO_PINS        30
+#define RP2040_NUM_CORES        2
+#define RP2040_CLOCK_HZ         133000000   /* 133 MHz */
+#define RP2040_SRAM_PAGES       (RP2040_SRAM_SIZE >> RP2040_ICACHE_PAGE_SHIFT)  /* Code pages */
+
+/* RP2040 Memory Map */
+#define RP2040_BOOTROM_BASE     0x00000000  /* 16KB */
+#define RP2040_SRAM_BANK0       0x20000000  /* 64KB */
+#define RP2040_SRAM_BANK1       0x20010000  /* 64KB */
+#define RP2040_SRAM_BANK2       0x20020000  /* 64KB */
+#define RP2040_SRAM_BANK3       0x20030000  /* 64KB */
+#define RP2040_SRAM_BANK4       0x20040000  /* 4KB */
+#define RP2040_SRAM_BANK5       0x20041000  /* 4KB */
+
+#define RP2040_APB0_BASE        0x40000000
+#define RP2040_APB1_BASE        0x50000000
+#define RP2040_AHB_BASE         0x50400000
+#define RP2040_SIO_BASE         0xd0000000
+#define RP2040_XIP_BASE         0x10000000  /* External flash XIP */
+
+/* Execution engines */
+typedef enum {
+    RP2040_EXEC_STEP = 0,       /* One instruction per step, predecoded */
+    RP2040_EXEC_BLOCK,          /* Threaded-code basic blocks */
+    RP2040_EXEC_JIT,            /* Blocks, with hot ones compiled to x86-64 */
+} rp2040_exec_mode_t;
+
+/* Execution engines of one core, only touched by the thread running it */
+typedef struct {
+    arm_bus_t bus;              /* The core's view of memory, for stepped instructions */
+    rp2040_icache_t *icache;    /* Predecoded instructions in SRAM */
+    rp2040_block_cache_t *blocks;
+    rp2040_jit_t *jit;          /* NULL until JIT mode is first selected */
+    uint64_t cycles;            /* Instructions retired by this core */
+} rp2040_engine_t;
+
+struct rp2040_smp;
+
+/* RP2040 Core Structure */
+typedef struct rp2040_system {
+    arm_core_state_t *cores[RP2040_NUM_CORES];
+    rp2040_engine_t engines[RP2040_NUM_CORES];
+    gpio_state_t *gpio;
+    uart_state_t *uart[2];
+    ahb_interconnect_t *ahb_bus;
+    sram_t *sram;
+    rp2040_sio_t *sio;          /* Inter-core FIFOs and spinlocks */
+    uint8_t *code_pages;        /* SRAM pages any core has decoded code from (sticky) */
+    rp2040_exec_mode_t exec_mode;
+    struct rp2040_smp *smp;     /* Set while rp2040_run_threaded is running */
+    int next_core;              /* Round-robin position of rp2040_step */
+    
+    uint64_t cycle_count;       /* Sum of the cores' cycles */
+    uint32_t clock_freq;
+    bool halted;
+    bool breakpoint_triggered;
+    int breakpoint_core;        /* Core that hit the breakpoint */
+    bool watchpoint_triggered;  /* Access details, and the core, in debug->hit_* */
+    
+    /* Debugging support */
+    rp2040_debug_t *debug;      /* Breakpoints and watchpoints in SRAM */
+    uint8_t active_core;  /* Which core to debug */
+} rp2040_system_t;
+
+/* Public API */
+rp2040_system_t *rp2040_create(void);
+void rp2040_destroy(rp2040_system_t *sys);
+
+int rp2040_load_elf(rp2040_system_t *sys, const char *filename);
+int rp2040_load_binary(rp2040_system_t *sys, uint32_t addr, const uint8_t *data, uint32_t len);
+
+int rp2040_step(rp2040_system_t *sys);
+int rp2040_step_core(rp2040_system_t *sys, int core_id);
+int rp2040_step_block(rp2040_system_t *sys, int core_id);
+int rp2040_set_exec_mode(rp2040_system_t *sys, rp2040_exec_mode_t mode);
+int rp2040_run_until_halt(rp2040_system_t *sys);
+int rp2040_run_cycles(rp2040_system_t *sys, uint64_t cycles);
+int rp2040_run_threaded(rp2040_system_t *sys, uint64_t cycles, uint32_t quantum);
+
+/* Debugging */
+uint32_t rp2040_get_register(rp2040_system_t *sys, int core_id, int reg_num);
+void rp2040_set_register(rp2040_system_t *sys, int core_id, int reg_num, uint32_t value);
+
+uint32_t rp2040_read_memory(rp2040_system_t *sys, uint32_t addr);
+void rp2040_write_memory(rp2040_system_t *sys, uint32_t addr, uint32_t value);
+void rp2040_invalidate_code(rp2040_system_t *sys, uint32_t addr, uint32_t len);
+
+int rp2040_add_breakpoint(rp2040_system_t *sys, uint32_t addr);
+void rp2040_remove_breakpoint(rp2040_system_t *sys, uint32_t addr);
+void rp2040_clear_breakpoints(rp2040_system_t *sys);
+
+int rp2040_add_watchpoint(rp2040_system_t *sys, uint32_t addr, uint32_t len, rp2040_watch_type_t type);
+void rp2040_remove_watchpoint(rp2040_system_t *sys, uint32_t addr);
+void rp2040_clear_watchpoints(rp2040_system_t *sys);
+
+/* Engine internals, shared by the interpreters and the threaded runner */
+int rp2040_engine_step(rp2040_system_t *sys, int core_id);
+void rp2040_engine_invalidate(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len);
+void rp2040_code_written(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len);
+void rp2040_breakpoint_hit(rp2040_system_t *sys, int core_id);
+void rp2040_watchpoint_hit(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len, bool write);
+
+/**
+ * Record that [start, end) in SRAM holds code some core is about to
+ * decode. Pages stay marked, and stores to them take the invalidation
+ * path. Call this before reading the code: the fence here pairs with the
+ * one in rp2040_is_code, so either the decoding core reads another core's
+ * store or that core sees the mark and invalidates what was decoded.
+ */
+static inline void rp2040_mark_code(rp2040_system_t *sys, uint32_t start, uint32_t end)
+{
+    uint32_t first = (start - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    uint32_t last = (end - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    
+    for (uint32_t page = first; page <= last && page < RP2040_SRAM_PAGES; page++) {
+        if (!__atomic_load_n(&sys->code_pages[page], __ATOMIC_RELAXED)) {
+            __atomic_store_n(&sys->code_pages[page], 1, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Whether [addr, addr + len) in SRAM overlaps a page marked by
+ * rp2040_mark_code, i.e. whether a store there must invalidate code.
+ * Call this after the store; with cores on their own threads it fences
+ * between the two.
+ */
+static inline bool rp2040_is_code(rp2040_system_t *sys, uint32_t addr, uint32_t len)
+{
+    uint32_t first = (addr - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    uint32_t last = (addr + len - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    
+    if (sys->smp) __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (uint32_t page = first; page <= last; page++) {
+        if (__atomic_load_n(&sys->code_pages[page], __ATOMIC_RELAXED)) return true;
+    }
+    return false;
+}
+
+/* Statistics */
+void rp2040_print_stats(rp2040_system_t *sys, FILE *out);
+
+/* GPIO/Peripheral Control */
+int rp2040_gpio_set(rp2040_system_t *sys, int pin, bool value);
+bool rp2040_gpio_get(rp2040_system_t *sys, int pin);
+
+int rp2040_uart_write(rp2040_system_t *sys, int uart_id, const uint8_t *data, uint32_t len);
+int rp2040_uart_read(rp2040_system_t *sys, int uart_id, uint8_t *data, uint32_t len);
+
+#endif // BITN_RP2040_H
@@ -0,0 +1,55 @@
+// include/rp2040/sio.h
+#ifndef BITN_RP2040_SIO_H
+#define BITN_RP2040_SIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Single-Cycle IO: Inter-Core FIFOs and Spinlocks
+ *
+ * Each core may be running on its own host thread, so the FIFOs are
+ * single-producer single-consumer rings and the spinlocks a bitmask, all
+ * updated with atomics. Pushing to a FIFO or releasing a spinlock is a
+ * release, popping or claiming is an acquire: guest SRAM writes made
+ * before a handoff are visible to the other core after it.
+ */
+
+#define RP2040_SIO_SIZE             0x180   /* Registers handled here */
+#define RP2040_SIO_FIFO_DEPTH       8
+#define RP2040_SIO_NUM_SPINLOCKS    32
+
+/* Register offsets */
+#define RP2040_SIO_CPUID            0x000
+#define RP2040_SIO_FIFO_ST          0x050
+#define RP2040_SIO_FIFO_WR          0x054
+#define RP2040_SIO_FIFO_RD          0x058
+#define RP2040_SIO_SPINLOCK_ST      0x05c
+#define RP2040_SIO_SPINLOCK0        0x100
+
+/* FIFO_ST bits */
+#define RP2040_SIO_FIFO_VLD         (1u << 0)   /* RX FIFO not empty */
+#define RP2040_SIO_FIFO_RDY         (1u << 1)   /* TX FIFO not full */
+#define RP2040_SIO_FIFO_WOF         (1u << 2)   /* TX written while full (sticky) */
+#define RP2040_SIO_FIFO_ROE         (1u << 3)   /* RX read while empty (sticky) */
+
+/* One direction: written by one core, read by the other */
+typedef struct {
+    uint32_t data[RP2040_SIO_FIFO_DEPTH];
+    uint32_t head;              /* Next slot to read, advanced by the reader */
+    uint32_t tail;              /* Next slot to write, advanced by the writer */
+} rp2040_sio_fifo_t;
+
+typedef struct {
+    rp2040_sio_fifo_t fifo[2];  /* fifo[n] is core n's TX */
+    uint32_t errors[2];         /* WOF/ROE seen by each core */
+    uint32_t spinlocks;         /* Claimed locks, one bit each */
+} rp2040_sio_t;
+
+/* Public API */
+void rp2040_sio_init(rp2040_sio_t *sio);
+
+bool rp2040_sio_handles(uint32_t offset);
+uint32_t rp2040_sio_read(rp2040_sio_t *sio, int core_id, uint32_t offset);
+void rp2040_sio_write(rp2040_sio_t *sio, int core_id, uint32_t offset, uint32_t value);
+
+#endif // BITN_RP2040_SIO_H
@@ -0,0 +1,53 @@
+// include/rp2040/smp.h
+#ifndef BITN_RP2040_SMP_H
+#define BITN_RP2040_SMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "rp2040/rp2040.h"
+
+/* Threaded Dual-Core Execution
+ *
+ * rp2040_run_threaded runs core 0 on the calling thread and core 1 on a
+ * second host thread, each with its own engine caches. The cores run
+ * freely for a quantum of instructions each, then meet at a barrier where
+ * cycle_count is updated and the run stopped or the next quantum handed
+ * out. A smaller quantum keeps the cores' clocks closer together; a larger
+ * one syncs less often.
+ *
+ * The cores only meet in SRAM and the SIO, whose FIFOs and spinlocks
+ * order guest memory between them. A store by one core into code another
+ * core has translated is posted to that core, which drops its stale code
+ * once its current block (or JIT quantum) ends. Decoding marks a code
+ * page before reading it and stores check the marks after writing, with a
+ * full fence on both sides, so no store to code goes unnoticed. Breakpoints, watchpoints
+ * and halts stop the run at the next barrier; the other core finishes its
+ * quantum first.
+ *
+ * Nothing else may touch the system while the threads run.
+ */
+
+#define RP2040_SMP_QUANTUM          10000   /* Default instructions per core between barriers */
+
+/* Code written by another core, waiting for the owning thread */
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t lo, hi;            /* Merged range of writes */
+    int pending;
+} rp2040_smp_inval_t;
+
+typedef struct rp2040_smp {
+    rp2040_system_t *sys;
+    pthread_barrier_t barrier;
+    uint64_t target;            /* cycle_count to stop at */
+    uint32_t quantum;
+    uint64_t end[RP2040_NUM_CORES];     /* Each core's cycles at the end of this quantum */
+    bool done;
+    int result;
+    rp2040_smp_inval_t inval[RP2040_NUM_CORES];
+} rp2040_smp_t;
+
+void rp2040_smp_post_invalidate(rp2040_smp_t *smp, int core_id, uint32_t addr, uint32_t len);
+
+#endif // BITN_RP2040_SMP_H
@@ -0,0 +1,1021 @@
+// src/rp2040/block.c
+#include "rp2040/block.h"
+#include "rp2040/rp2040.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define BLOCK_HASH(pc)  (((pc) >> 1) & (RP2040_BLOCK_BUCKETS - 1))
+
+/**
+ * Initialize an empty block cache
+ */
+int rp2040_block_cache_init(rp2040_block_cache_t *cache)
+{
+    if (!cache) return -1;
+
+    memset(cache, 0, sizeof(rp2040_block_cache_t));
+    cache->num_pages = (RP2040_SRAM_SIZE + RP2040_ICACHE_PAGE_SIZE - 1) >> RP2040_ICACHE_PAGE_SHIFT;
+    cache->code_pages = (uint16_t *)calloc(cache->num_pages, sizeof(uint16_t));
+    if (!cache->code_pages) {
+        fprintf(stderr, "Failed to allocate block cache\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Free all blocks
+ */
+void rp2040_block_cache_destroy(rp2040_block_cache_t *cache)
+{
+    if (!cache) return;
+
+    rp2040_block_flush(cache);
+    free(cache->code_pages);
+    cache->code_pages = NULL;
+}
+
+/**
+ * Find the translated block starting at pc
+ */
+rp2040_block_t *rp2040_block_lookup(rp2040_block_cache_t *cache, uint32_t pc)
+{
+    for (rp2040_block_t *block = cache->buckets[BLOCK_HASH(pc)]; block; block = block->next) {
+        if (block->start_pc == pc) return block;
+    }
+    return NULL;
+}
+
+/**
+ * Adjust the per-page block counts for [start, end)
+ */
+static void block_mark_pages(rp2040_block_cache_t *cache, uint32_t start, uint32_t end, int delta)
+{
+    uint32_t first = (start - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    uint32_t last = (end - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+
+    for (uint32_t page = first; page <= last && page < cache->num_pages; page++) {
+        cache->code_pages[page] = (uint16_t)(cache->code_pages[page] + delta);
+    }
+}
+
+/**
+ * Drop blocks overlapping a write to [addr, addr + len)
+ */
+void rp2040_block_invalidate(rp2040_block_cache_t *cache, uint32_t addr, uint32_t len)
+{
+    if (!cache || len == 0) return;
+
+    uint64_t end = (uint64_t)addr + len;
+    if (end <= RP2040_SRAM_BASE || addr >= RP2040_SRAM_BASE + RP2040_SRAM_SIZE) return;
+
+    /* Nothing translated on these pages: done */
+    uint32_t lo = addr < RP2040_SRAM_BASE ? RP2040_SRAM_BASE : addr;
+    uint32_t hi = end > RP2040_SRAM_BASE + RP2040_SRAM_SIZE ? RP2040_SRAM_BASE + RP2040_SRAM_SIZE : (uint32_t)end;
+    bool has_code = false;
+    for (uint32_t page = (lo - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+         page <= (hi - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT; page++) {
+        if (cache->code_pages[page]) {
+            has_code = true;
+            break;
+        }
+    }
+    if (!has_code) return;
+
+    for (uint32_t i = 0; i < RP2040_BLOCK_BUCKETS; i++) {
+        rp2040_block_t **link = &cache->buckets[i];
+        while (*link) {
+            rp2040_block_t *block = *link;
+            if (block->start_pc < end && block->end_pc > addr) {
+                *link = block->next;
+                block_mark_pages(cache, block->start_pc, block->end_pc, -1);
+                free(block);
+                cache->invalidated++;
+            } else {
+                link = &block->next;
+            }
+        }
+    }
+}
+
+/**
+ * Drop every block
+ */
+void rp2040_block_flush(rp2040_block_cache_t *cache)
+{
+    if (!cache) return;
+
+    for (uint32_t i = 0; i < RP2040_BLOCK_BUCKETS; i++) {
+        rp2040_block_t *block = cache->buckets[i];
+        while (block) {
+            rp2040_block_t *next = block->next;
+            free(block);
+            block = next;
+        }
+        cache->buckets[i] = NULL;
+    }
+
+    if (cache->code_pages) {
+        memset(cache->code_pages, 0, cache->num_pages * sizeof(uint16_t));
+    }
+}
+
+/**
+ * Decode one Thumb instruction into a block op.
+ * Returns false if the block interpreter does not handle it.
+ */
+static bool block_decode(uint32_t pc, uint16_t hw, uint16_t hw2, rp2040_block_op_t *op,
+                         uint8_t *len, bool *ends)
+{
+    uint8_t lo0 = hw & 7, lo3 = (hw >> 3) & 7, lo6 = (hw >> 6) & 7;
+    uint8_t hi8 = (hw >> 8) & 7;
+    uint32_t imm5 = (hw >> 6) & 0x1F;
+    uint32_t imm8 = hw & 0xFF;
+
+    memset(op, 0, sizeof(*op));
+    op->pc = pc;
+    *len = 2;
+    *ends = false;
+
+    switch (hw >> 11) {
+    case 0x00:  /* LSLS Rd, Rm, #imm5 (MOVS Rd, Rm when imm5 == 0) */
+        op->opcode = imm5 ? RP2040_OP_LSL_IMM : RP2040_OP_MOVS_REG;
+        op->rd = lo0; op->rm = lo3; op->imm = imm5;
+        return true;
+    case 0x01:  /* LSRS Rd, Rm, #imm5 */
+    case 0x02:  /* ASRS Rd, Rm, #imm5 */
+        op->opcode = (hw >> 11) == 0x01 ? RP2040_OP_LSR_IMM : RP2040_OP_ASR_IMM;
+        op->rd = lo0; op->rm = lo3; op->imm = imm5 ? imm5 : 32;
+        return true;
+    case 0x03:  /* ADDS/SUBS Rd, Rn, Rm / #imm3 */
+        op->rd = lo0; op->rn = lo3;
+        if (hw & (1 << 10)) {
+            op->opcode = (hw & (1 << 9)) ? RP2040_OP_SUBS_IMM : RP2040_OP_ADDS_IMM;
+            op->imm = lo6;
+        } else {
+            op->opcode = (hw & (1 << 9)) ? RP2040_OP_SUBS_REG : RP2040_OP_ADDS_REG;
+            op->rm = lo6;
+        }
+        return true;
+    case 0x04:  /* MOVS Rd, #imm8 */
+        op->opcode = RP2040_OP_MOVS_IMM; op->rd = hi8; op->imm = imm8;
+        return true;
+    case 0x05:  /* CMP Rn, #imm8 */
+        op->opcode = RP2040_OP_CMP_IMM; op->rn = hi8; op->imm = imm8;
+        return true;
+    case 0x06:  /* ADDS Rdn, #imm8 */
+    case 0x07:  /* SUBS Rdn, #imm8 */
+        op->opcode = (hw >> 11) == 0x06 ? RP2040_OP_ADDS_IMM : RP2040_OP_SUBS_IMM;
+        op->rd = op->rn = hi8; op->imm = imm8;
+        return true;
+    case 0x08:
+        if ((hw & 0xFC00) == 0x4000) {
+            /* Data processing: Rdn = Rdn op Rm */
+            static const uint8_t alu[16] = {
+                RP2040_OP_AND, RP2040_OP_EOR, RP2040_OP_LSL_REG, RP2040_OP_LSR_REG,
+                RP2040_OP_ASR_REG, RP2040_OP_ADC, RP2040_OP_SBC, RP2040_OP_ROR_REG,
+                RP2040_OP_TST, RP2040_OP_RSB, RP2040_OP_CMP_REG, RP2040_OP_CMN_REG,
+                RP2040_OP_ORR, RP2040_OP_MUL, RP2040_OP_BIC, RP2040_OP_MVN
+            };
+            op->opcode = alu[(hw >> 6) & 0xF];
+            op->rd = op->rn = lo0; op->rm = lo3;
+            return true;
+        } else {
+            /* High register operations and branch/exchange */
+            uint8_t rm = (hw >> 3) & 0xF;
+            uint8_t rdn = (uint8_t)(((hw >> 4) & 8) | lo0);
+            switch ((hw >> 8) & 3) {
+            case 0:  /* ADD Rdn, Rm */
+                if (rdn == 15 || rm == 15) return false;
+                op->opcode = RP2040_OP_ADD_REG; op->rd = op->rn = rdn; op->rm = rm;
+                return true;
+            case 1:  /* CMP Rn, Rm */
+                if (rdn == 15 || rm == 15) return false;
+                op->opcode = RP2040_OP_CMP_REG; op->rn = rdn; op->rm = rm;
+                return true;
+            case 2:  /* MOV Rd, Rm */
+                if (rm == 15) return false;
+                op->opcode = rdn == 15 ? RP2040_OP_MOV_PC : RP2040_OP_MOV_REG;
+                op->rd = rdn; op->rm = rm;
+                *ends = (rdn == 15);
+                return true;
+            default: /* BX / BLX Rm */
+                if (rm == 15) return false;
+                op->opcode = (hw & 0x80) ? RP2040_OP_BLX : RP2040_OP_BX;
+                op->rm = rm;
+                *ends = true;
+                return true;
+            }
+        }
+    case 0x09:  /* LDR Rt, [PC, #imm8] */
+        op->opcode = RP2040_OP_LDR_LIT; op->rd = hi8;
+        op->imm = ((pc + 4) & ~3u) + imm8 * 4;
+        return true;
+    case 0x0A:
+    case 0x0B: {
+        /* Load/store register offset */
+        static const uint8_t mem[8] = {
+            RP2040_OP_STR_REG, RP2040_OP_STRH_REG, RP2040_OP_STRB_REG, RP2040_OP_LDRSB_REG,
+            RP2040_OP_LDR_REG, RP2040_OP_LDRH_REG, RP2040_OP_LDRB_REG, RP2040_OP_LDRSH_REG
+        };
+        op->opcode = mem[(hw >> 9) & 7];
+        op->rd = lo0; op->rn = lo3; op->rm = lo6;
+        return true;
+    }
+    case 0x0C: op->opcode = RP2040_OP_STR_IMM;  op->imm = imm5 * 4; goto mem_imm;
+    case 0x0D: op->opcode = RP2040_OP_LDR_IMM;  op->imm = imm5 * 4; goto mem_imm;
+    case 0x0E: op->opcode = RP2040_OP_STRB_IMM; op->imm = imm5;     goto mem_imm;
+    case 0x0F: op->opcode = RP2040_OP_LDRB_IMM; op->imm = imm5;     goto mem_imm;
+    case 0x10: op->opcode = RP2040_OP_STRH_IMM; op->imm = imm5 * 2; goto mem_imm;
+    case 0x11: op->opcode = RP2040_OP_LDRH_IMM; op->imm = imm5 * 2; goto mem_imm;
+    mem_imm:
+        op->rd = lo0; op->rn = lo3;
+        return true;
+    case 0x12:  /* STR Rt, [SP, #imm8] */
+    case 0x13:  /* LDR Rt, [SP, #imm8] */
+        op->opcode = (hw >> 11) == 0x12 ? RP2040_OP_STR_IMM : RP2040_OP_LDR_IMM;
+        op->rd = hi8; op->rn = 13; op->imm = imm8 * 4;
+        return true;
+    case 0x14:  /* ADR Rd, label */
+        op->opcode = RP2040_OP_MOV_IMM; op->rd = hi8;
+        op->imm = ((pc + 4) & ~3u) + imm8 * 4;
+        return true;
+    case 0x15:  /* ADD Rd, SP, #imm8 */
+        op->opcode = RP2040_OP_ADD_IMM; op->rd = hi8; op->rn = 13; op->imm = imm8 * 4;
+        return true;
+    case 0x16:
+    case 0x17:
+        /* Miscellaneous */
+        if ((hw & 0xFF00) == 0xB000) {
+            /* ADD/SUB SP, SP, #imm7 */
+            uint32_t imm = (hw & 0x7F) * 4;
+            op->opcode = RP2040_OP_ADD_IMM; op->rd = op->rn = 13;
+            op->imm = (hw & 0x80) ? (uint32_t)-imm : imm;
+            return true;
+        }
+        if ((hw & 0xFF00) == 0xB200) {
+            static const uint8_t ext[4] = { RP2040_OP_SXTH, RP2040_OP_SXTB, RP2040_OP_UXTH, RP2040_OP_UXTB };
+            op->opcode = ext[(hw >> 6) & 3]; op->rd = lo0; op->rm = lo3;
+            return true;
+        }
+        if ((hw & 0xFF00) == 0xBA00 && ((hw >> 6) & 3) != 2) {
+            static const uint8_t rev[4] = { RP2040_OP_REV, RP2040_OP_REV16, RP2040_OP_NOP, RP2040_OP_REVSH };
+            op->opcode = rev[(hw >> 6) & 3]; op->rd = lo0; op->rm = lo3;
+            return true;
+        }
+        if ((hw & 0xFE00) == 0xB400) {
+            /* PUSH {list, LR} */
+            op->opcode = RP2040_OP_PUSH;
+            op->imm = imm8 | ((hw & 0x100) ? (1u << 14) : 0);
+            return op->imm != 0;
+        }
+        if ((hw & 0xFE00) == 0xBC00) {
+            /* POP {list, PC} */
+            op->opcode = (hw & 0x100) ? RP2040_OP_POP_PC : RP2040_OP_POP;
+            op->imm = imm8;
+            *ends = (hw & 0x100) != 0;
+            return *ends || imm8 != 0;
+        }
+        if (hw == 0xBF00) {
+            op->opcode = RP2040_OP_NOP;
+            return true;
+        }
+        return false;  /* Hints, BKPT, CPS: leave to the core */
+    case 0x18:  /* STM Rn!, {list} */
+    case 0x19:  /* LDM Rn!, {list} */
+        op->opcode = (hw >> 11) == 0x18 ? RP2040_OP_STM : RP2040_OP_LDM;
+        op->rn = hi8; op->imm = imm8;
+        return imm8 != 0;
+    case 0x1A:
+    case 0x1B: {
+        /* B<cond> label (cond 14 is UDF, 15 is SVC) */
+        uint8_t cond = (hw >> 8) & 0xF;
+        if (cond >= 14) return false;
+        op->opcode = RP2040_OP_BCOND; op->rm = cond;
+        op->imm = pc + 4 + (uint32_t)((int32_t)(int8_t)imm8 * 2);
+        *ends = true;
+        return true;
+    }
+    case 0x1C: {
+        /* B label */
+        int32_t offset = (int32_t)((uint32_t)(hw & 0x7FF) << 21) >> 20;
+        op->opcode = RP2040_OP_B;
+        op->imm = pc + 4 + (uint32_t)offset;
+        *ends = true;
+        return true;
+    }
+    default:
+        /* 32-bit encodings: only BL is handled here */
+        *len = 4;
+        if ((hw & 0xF800) == 0xF000 && (hw2 & 0xD000) == 0xD000) {
+            uint32_t s = (hw >> 10) & 1;
+            uint32_t i1 = !(((hw2 >> 13) & 1) ^ s);
+            uint32_t i2 = !(((hw2 >> 11) & 1) ^ s);
+            uint32_t imm = (s << 24) | (i1 << 23) | (i2 << 22) |
+                           ((uint32_t)(hw & 0x3FF) << 12) | ((uint32_t)(hw2 & 0x7FF) << 1);
+            int32_t offset = (int32_t)(imm << 7) >> 7;
+            op->opcode = RP2040_OP_BL;
+            op->imm = pc + 4 + (uint32_t)offset;
+            *ends = true;
+            return true;
+        }
+        return false;
+    }
+}
+
+/**
+ * Translate the straight-line code starting at pc.
+ * Returns NULL if pc is outside SRAM or its first instruction is not
+ * handled by the block interpreter.
+ */
+rp2040_block_t *rp2040_block_translate(rp2040_system_t *sys, int core_id, uint32_t pc)
+{
+    rp2040_block_cache_t *cache = sys->engines[core_id].blocks;
+    rp2040_block_op_t ops[RP2040_BLOCK_MAX_INSTRS + 1];
+    uint32_t addr = pc;
+    int count = 0;
+    bool ends = false;
+
+    if (pc & 1) return NULL;
+
+    while (count < RP2040_BLOCK_MAX_INSTRS && !ends) {
+        uint32_t offset = addr - RP2040_SRAM_BASE;
+        if (offset > RP2040_SRAM_SIZE - 2) break;
+        if (count > 0 && rp2040_debug_breakpoint(sys->debug, addr)) break;
+
+        rp2040_mark_code(sys, addr, addr + 2);
+        uint16_t hw1 = sram_read_halfword(sys->sram, offset);
+        uint16_t hw2 = 0;
+        if ((hw1 & 0xE000) == 0xE000 && (hw1 & 0x1800) != 0) {
+            if (offset > RP2040_SRAM_SIZE - 4) break;
+            rp2040_mark_code(sys, addr + 2, addr + 4);
+            hw2 = sram_read_halfword(sys->sram, offset + 2);
+        }
+
+        uint8_t len;
+        if (!block_decode(addr, hw1, hw2, &ops[count], &len, &ends)) {
+            if (count == 0) return NULL;
+            memset(&ops[count], 0, sizeof(ops[count]));
+            ops[count].opcode = RP2040_OP_EXIT_STEP;
+            ops[count].pc = addr;
+            ops[count].index = (uint8_t)count;
+            break;
+        }
+
+        ops[count].index = (uint8_t)count;
+        count++;
+        addr += len;
+    }
+
+    if (count == 0) return NULL;
+
+    int num_ops = count;
+    if (!ends) {
+        if (ops[count].opcode != RP2040_OP_EXIT_STEP || ops[count].pc != addr) {
+            /* Length limit or end of SRAM: continue at the next block */
+            memset(&ops[count], 0, sizeof(ops[count]));
+            ops[count].opcode = RP2040_OP_EXIT;
+            ops[count].pc = addr;
+            ops[count].index = (uint8_t)count;
+        }
+        num_ops++;
+    }
+
+    rp2040_block_t *block = (rp2040_block_t *)malloc(sizeof(rp2040_block_t) +
+                                                     num_ops * sizeof(rp2040_block_op_t));
+    if (!block) return NULL;
+
+    block->start_pc = pc;
+    block->end_pc = addr;
+    block->num_ops = (uint16_t)num_ops;
+    block->num_instrs = (uint16_t)count;
+    block->bound = false;
+    block->exec_count = 0;
+    block->jit_code = NULL;
+    block->jit_side_exits = 0;
+    block->jit_disabled = false;
+    memcpy(block->ops, ops, num_ops * sizeof(rp2040_block_op_t));
+
+    uint32_t bucket = BLOCK_HASH(pc);
+    block->next = cache->buckets[bucket];
+    cache->buckets[bucket] = block;
+    block_mark_pages(cache, block->start_pc, block->end_pc, +1);
+    cache->translated++;
+
+    return block;
+}
+
+/* Execution helpers */
+
+static inline uint32_t add_with_carry(uint32_t a, uint32_t b, uint32_t carry_in,
+                                      uint32_t *carry, uint32_t *overflow)
+{
+    uint64_t sum = (uint64_t)a + b + carry_in;
+    uint32_t result = (uint32_t)sum;
+    *carry = (uint32_t)(sum >> 32);
+    *overflow = ((a ^ result) & (b ^ result)) >> 31;
+    return result;
+}
+
+static inline bool condition_passed(uint8_t cond, uint32_t n, uint32_t z, uint32_t c, uint32_t v)
+{
+    bool result;
+    switch (cond >> 1) {
+    case 0:  result = z; break;                 /* EQ/NE */
+    case 1:  result = c; break;                 /* CS/CC */
+    case 2:  result = n; break;                 /* MI/PL */
+    case 3:  result = v; break;                 /* VS/VC */
+    case 4:  result = c && !z; break;           /* HI/LS */
+    case 5:  result = n == v; break;            /* GE/LT */
+    case 6:  result = !z && n == v; break;      /* GT/LE */
+    default: return true;                       /* AL */
+    }
+    return (cond & 1) ? !result : result;
+}
+
+/* SRAM pointer for an aligned access, or NULL (MMIO, flash, misaligned) */
+static inline uint8_t *block_sram(rp2040_system_t *sys, uint32_t addr, uint32_t size)
+{
+    uint32_t offset = addr - RP2040_SRAM_BASE;
+    if (offset > RP2040_SRAM_SIZE - size || (addr & (size - 1))) return NULL;
+    return sys->sram->data + offset;
+}
+
+/* Whether an op reads or writes memory */
+static inline bool block_op_accesses_memory(uint8_t opcode)
+{
+    return (opcode >= RP2040_OP_LDR_LIT && opcode <= RP2040_OP_STM) || opcode == RP2040_OP_POP_PC;
+}
+
+/* The access a memory op is about to make */
+static void block_op_access(const rp2040_block_op_t *op, const uint32_t *r,
+                            uint32_t *addr, uint32_t *len, bool *write)
+{
+    uint32_t count = (uint32_t)__builtin_popcount(op->imm) * 4;
+
+    *write = false;
+    switch (op->opcode) {
+    case RP2040_OP_LDR_LIT:
+        *addr = op->imm; *len = 4;
+        return;
+    case RP2040_OP_STR_IMM:  *write = true; /* fall through */
+    case RP2040_OP_LDR_IMM:  *addr = r[op->rn] + op->imm; *len = 4; return;
+    case RP2040_OP_STRH_IMM: *write = true; /* fall through */
+    case RP2040_OP_LDRH_IMM: *addr = r[op->rn] + op->imm; *len = 2; return;
+    case RP2040_OP_STRB_IMM: *write = true; /* fall through */
+    case RP2040_OP_LDRB_IMM: *addr = r[op->rn] + op->imm; *len = 1; return;
+    case RP2040_OP_STR_REG:  *write = true; /* fall through */
+    case RP2040_OP_LDR_REG:  *addr = r[op->rn] + r[op->rm]; *len = 4; return;
+    case RP2040_OP_STRH_REG: *write = true; /* fall through */
+    case RP2040_OP_LDRH_REG:
+    case RP2040_OP_LDRSH_REG: *addr = r[op->rn] + r[op->rm]; *len = 2; return;
+    case RP2040_OP_STRB_REG: *write = true; /* fall through */
+    case RP2040_OP_LDRB_REG:
+    case RP2040_OP_LDRSB_REG: *addr = r[op->rn] + r[op->rm]; *len = 1; return;
+    case RP2040_OP_PUSH:
+        *write = true; *addr = r[13] - count; *len = count;
+        return;
+    case RP2040_OP_POP:      *addr = r[13]; *len = count; return;
+    case RP2040_OP_POP_PC:   *addr = r[13]; *len = count + 4; return;
+    case RP2040_OP_STM:      *write = true; /* fall through */
+    default: /* LDM */       *addr = r[op->rn]; *len = count; return;
+    }
+}
+
+/**
+ * The memory access the instruction at pc would make with the core's
+ * current registers, for checking watchpoints outside translated blocks.
+ * Returns false if it makes none.
+ */
+bool rp2040_block_access(rp2040_system_t *sys, int core_id, uint32_t pc,
+                         uint32_t *addr, uint32_t *len, bool *write)
+{
+    arm_core_state_t *core = sys->cores[core_id];
+    uint32_t offset = pc - RP2040_SRAM_BASE;
+
+    if ((pc & 1) || offset > RP2040_SRAM_SIZE - 2) return false;
+
+    uint16_t hw1 = sram_read_halfword(sys->sram, offset);
+    uint16_t hw2 = 0;
+    if ((hw1 & 0xE000) == 0xE000 && (hw1 & 0x1800) != 0) {
+        if (offset > RP2040_SRAM_SIZE - 4) return false;
+        hw2 = sram_read_halfword(sys->sram, offset + 2);
+    }
+
+    rp2040_block_op_t op;
+    uint8_t op_len;
+    bool ends;
+    if (!block_decode(pc, hw1, hw2, &op, &op_len, &ends) || !block_op_accesses_memory(op.opcode)) {
+        return false;
+    }
+
+    uint32_t r[16];
+    memcpy(r, core->r, sizeof(core->r));
+    r[13] = core->sp;
+    r[14] = core->lr;
+    r[15] = 0;
+    block_op_access(&op, r, addr, len, write);
+    return true;
+}
+
+/* Performs a word LDR/STR to an SIO register. Returns false for anything else. */
+static bool block_sio_access(rp2040_system_t *sys, int core_id, const rp2040_block_op_t *op, uint32_t *r)
+{
+    uint32_t addr;
+
+    switch (op->opcode) {
+    case RP2040_OP_LDR_IMM:
+    case RP2040_OP_STR_IMM:
+        addr = r[op->rn] + op->imm;
+        break;
+    case RP2040_OP_LDR_REG:
+    case RP2040_OP_STR_REG:
+        addr = r[op->rn] + r[op->rm];
+        break;
+    default:
+        return false;
+    }
+
+    uint32_t offset = addr - RP2040_SIO_BASE;
+    if (offset >= RP2040_SIO_SIZE || !rp2040_sio_handles(offset)) return false;
+
+    if (op->opcode == RP2040_OP_LDR_IMM || op->opcode == RP2040_OP_LDR_REG) {
+        r[op->rd] = rp2040_sio_read(sys->sio, core_id, offset);
+    } else {
+        rp2040_sio_write(sys->sio, core_id, offset, r[op->rd]);
+    }
+    return true;
+}
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t load16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static inline void store32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static inline void store16(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * Execute a translated block on a core.
+ * Returns RP2040_BLOCK_DONE, RP2040_BLOCK_STEP or RP2040_BLOCK_STOP; the
+ * block may have been freed (by a store into its own code) when this
+ * returns.
+ */
+int rp2040_block_run(rp2040_system_t *sys, int core_id, rp2040_block_t *block)
+{
+    static const void *const dispatch[RP2040_OP_COUNT] = {
+        [RP2040_OP_NOP] = &&op_nop, [RP2040_OP_MOV_IMM] = &&op_mov_imm,
+        [RP2040_OP_MOVS_IMM] = &&op_movs_imm, [RP2040_OP_MOV_REG] = &&op_mov_reg,
+        [RP2040_OP_MOVS_REG] = &&op_movs_reg, [RP2040_OP_LSL_IMM] = &&op_lsl_imm,
+        [RP2040_OP_LSR_IMM] = &&op_lsr_imm, [RP2040_OP_ASR_IMM] = &&op_asr_imm,
+        [RP2040_OP_LSL_REG] = &&op_lsl_reg, [RP2040_OP_LSR_REG] = &&op_lsr_reg,
+        [RP2040_OP_ASR_REG] = &&op_asr_reg, [RP2040_OP_ROR_REG] = &&op_ror_reg,
+        [RP2040_OP_ADD_IMM] = &&op_add_imm, [RP2040_OP_ADD_REG] = &&op_add_reg,
+        [RP2040_OP_ADDS_IMM] = &&op_adds_imm, [RP2040_OP_ADDS_REG] = &&op_adds_reg,
+        [RP2040_OP_SUBS_IMM] = &&op_subs_imm, [RP2040_OP_SUBS_REG] = &&op_subs_reg,
+        [RP2040_OP_ADC] = &&op_adc, [RP2040_OP_SBC] = &&op_sbc, [RP2040_OP_RSB] = &&op_rsb,
+        [RP2040_OP_MUL] = &&op_mul, [RP2040_OP_AND] = &&op_and, [RP2040_OP_EOR] = &&op_eor,
+        [RP2040_OP_ORR] = &&op_orr, [RP2040_OP_BIC] = &&op_bic, [RP2040_OP_MVN] = &&op_mvn,
+        [RP2040_OP_CMP_IMM] = &&op_cmp_imm, [RP2040_OP_CMP_REG] = &&op_cmp_reg,
+        [RP2040_OP_CMN_REG] = &&op_cmn_reg, [RP2040_OP_TST] = &&op_tst,
+        [RP2040_OP_SXTH] = &&op_sxth, [RP2040_OP_SXTB] = &&op_sxtb, [RP2040_OP_UXTH] = &&op_uxth,
+        [RP2040_OP_UXTB] = &&op_uxtb, [RP2040_OP_REV] = &&op_rev, [RP2040_OP_REV16] = &&op_rev16,
+        [RP2040_OP_REVSH] = &&op_revsh, [RP2040_OP_LDR_LIT] = &&op_ldr_lit,
+        [RP2040_OP_LDR_IMM] = &&op_ldr_imm, [RP2040_OP_LDRH_IMM] = &&op_ldrh_imm,
+        [RP2040_OP_LDRB_IMM] = &&op_ldrb_imm, [RP2040_OP_STR_IMM] = &&op_str_imm,
+        [RP2040_OP_STRH_IMM] = &&op_strh_imm, [RP2040_OP_STRB_IMM] = &&op_strb_imm,
+        [RP2040_OP_LDR_REG] = &&op_ldr_reg, [RP2040_OP_LDRH_REG] = &&op_ldrh_reg,
+        [RP2040_OP_LDRB_REG] = &&op_ldrb_reg, [RP2040_OP_LDRSH_REG] = &&op_ldrsh_reg,
+        [RP2040_OP_LDRSB_REG] = &&op_ldrsb_reg, [RP2040_OP_STR_REG] = &&op_str_reg,
+        [RP2040_OP_STRH_REG] = &&op_strh_reg, [RP2040_OP_STRB_REG] = &&op_strb_reg,
+        [RP2040_OP_PUSH] = &&op_push, [RP2040_OP_POP] = &&op_pop, [RP2040_OP_LDM] = &&op_ldm,
+        [RP2040_OP_STM] = &&op_stm, [RP2040_OP_B] = &&op_b, [RP2040_OP_BCOND] = &&op_bcond,
+        [RP2040_OP_BL] = &&op_bl, [RP2040_OP_BX] = &&op_bx, [RP2040_OP_BLX] = &&op_blx,
+        [RP2040_OP_MOV_PC] = &&op_mov_pc, [RP2040_OP_POP_PC] = &&op_pop_pc,
+        [RP2040_OP_EXIT] = &&op_exit, [RP2040_OP_EXIT_STEP] = &&op_exit_step,
+    };
+
+    if (!block->bound) {
+        /* Blocks are dropped when watchpoints come and go, so this holds for the block's lifetime */
+        bool watched = sys->debug->num_watchpoints != 0;
+        for (uint16_t i = 0; i < block->num_ops; i++) {
+            uint8_t opcode = block->ops[i].opcode;
+            block->ops[i].handler = watched && block_op_accesses_memory(opcode) ? &&op_watch : dispatch[opcode];
+        }
+        block->bound = true;
+    }
+    arm_core_state_t *core = sys->cores[core_id];
+    block->exec_count++;
+    sys->engines[core_id].blocks->executed++;
+
+    /* Registers and flags live in locals until the block exits */
+    uint32_t r[16];
+    memcpy(r, core->r, sizeof(core->r));
+    r[13] = core->sp;
+    r[14] = core->lr;
+    r[15] = 0;
+
+    uint32_t n = (core->psr & PSR_N_BIT) != 0;
+    uint32_t z = (core->psr & PSR_Z_BIT) != 0;
+    uint32_t c = (core->psr & PSR_C_BIT) != 0;
+    uint32_t v = (core->psr & PSR_V_BIT) != 0;
+
+    const rp2040_block_op_t *op = block->ops;
+    uint32_t next_pc, retired, addr, value, store_len;
+    uint8_t *p;
+    bool write;
+    int result = RP2040_BLOCK_DONE;
+
+#define R(field)        r[op->field]
+#define NEXT()          goto *(++op)->handler
+#define SET_NZ(x)       do { uint32_t res_ = (x); n = res_ >> 31; z = (res_ == 0); } while (0)
+#define SRAM(a, size)   do { if (!(p = block_sram(sys, (a), (size)))) goto side_exit; } while (0)
+/* A store into code ends the block right after it, since the block may be stale */
+#define STORED(a, size) do { if (rp2040_is_code(sys, (a), (size))) { store_len = (size); goto store_exit; } } while (0)
+
+    goto *op->handler;
+
+op_nop:
+    NEXT();
+op_mov_imm:
+    R(rd) = op->imm;
+    NEXT();
+op_movs_imm:
+    R(rd) = op->imm; SET_NZ(op->imm);
+    NEXT();
+op_mov_reg:
+    R(rd) = R(rm);
+    NEXT();
+op_movs_reg:
+    R(rd) = R(rm); SET_NZ(R(rd));
+    NEXT();
+
+    /* Shifts; immediate amounts are 1..32 */
+op_lsl_imm:
+    c = (R(rm) >> (32 - op->imm)) & 1;
+    R(rd) = R(rm) << op->imm; SET_NZ(R(rd));
+    NEXT();
+op_lsr_imm:
+    c = (uint32_t)(((uint64_t)R(rm) >> (op->imm - 1)) & 1);
+    R(rd) = (uint32_t)((uint64_t)R(rm) >> op->imm); SET_NZ(R(rd));
+    NEXT();
+op_asr_imm:
+    c = ((int32_t)R(rm) >> (op->imm - 1)) & 1;
+    R(rd) = (uint32_t)((int32_t)R(rm) >> (op->imm == 32 ? 31 : op->imm)); SET_NZ(R(rd));
+    NEXT();
+op_lsl_reg:
+    value = R(rm) & 0xFF;
+    if (value) {
+        c = value <= 32 ? (uint32_t)(((uint64_t)R(rd) << value) >> 32) & 1 : 0;
+        R(rd) = value < 32 ? R(rd) << value : 0;
+    }
+    SET_NZ(R(rd));
+    NEXT();
+op_lsr_reg:
+    value = R(rm) & 0xFF;
+    if (value) {
+        c = value <= 32 ? (uint32_t)((uint64_t)R(rd) >> (value - 1)) & 1 : 0;
+        R(rd) = value < 32 ? R(rd) >> value : 0;
+    }
+    SET_NZ(R(rd));
+    NEXT();
+op_asr_reg:
+    value = R(rm) & 0xFF;
+    if (value) {
+        if (value >= 32) value = 32;
+        c = ((int32_t)R(rd) >> (value - 1)) & 1;
+        R(rd) = (uint32_t)((int32_t)R(rd) >> (value == 32 ? 31 : value));
+    }
+    SET_NZ(R(rd));
+    NEXT();
+op_ror_reg:
+    value = R(rm) & 0xFF;
+    if (value) {
+        value &= 31;
+        if (value) R(rd) = (R(rd) >> value) | (R(rd) << (32 - value));
+        c = R(rd) >> 31;
+    }
+    SET_NZ(R(rd));
+    NEXT();
+
+    /* Arithmetic */
+op_add_imm:
+    R(rd) = R(rn) + op->imm;
+    NEXT();
+op_add_reg:
+    R(rd) = R(rn) + R(rm);
+    NEXT();
+op_adds_imm:
+    R(rd) = add_with_carry(R(rn), op->imm, 0, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_adds_reg:
+    R(rd) = add_with_carry(R(rn), R(rm), 0, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_subs_imm:
+    R(rd) = add_with_carry(R(rn), ~op->imm, 1, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_subs_reg:
+    R(rd) = add_with_carry(R(rn), ~R(rm), 1, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_adc:
+    R(rd) = add_with_carry(R(rn), R(rm), c, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_sbc:
+    R(rd) = add_with_carry(R(rn), ~R(rm), c, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_rsb:
+    R(rd) = add_with_carry(0, ~R(rm), 1, &c, &v); SET_NZ(R(rd));
+    NEXT();
+op_mul:
+    R(rd) = R(rn) * R(rm); SET_NZ(R(rd));
+    NEXT();
+
+    /* Logical */
+op_and:
+    R(rd) = R(rn) & R(rm); SET_NZ(R(rd));
+    NEXT();
+op_eor:
+    R(rd) = R(rn) ^ R(rm); SET_NZ(R(rd));
+    NEXT();
+op_orr:
+    R(rd) = R(rn) | R(rm); SET_NZ(R(rd));
+    NEXT();
+op_bic:
+    R(rd) = R(rn) & ~R(rm); SET_NZ(R(rd));
+    NEXT();
+op_mvn:
+    R(rd) = ~R(rm); SET_NZ(R(rd));
+    NEXT();
+
+    /* Comparisons */
+op_cmp_imm:
+    SET_NZ(add_with_carry(R(rn), ~op->imm, 1, &c, &v));
+    NEXT();
+op_cmp_reg:
+    SET_NZ(add_with_carry(R(rn), ~R(rm), 1, &c, &v));
+    NEXT();
+op_cmn_reg:
+    SET_NZ(add_with_carry(R(rn), R(rm), 0, &c, &v));
+    NEXT();
+op_tst:
+    SET_NZ(R(rn) & R(rm));
+    NEXT();
+
+    /* Extension and byte reversal */
+op_sxth:
+    R(rd) = (uint32_t)(int32_t)(int16_t)R(rm);
+    NEXT();
+op_sxtb:
+    R(rd) = (uint32_t)(int32_t)(int8_t)R(rm);
+    NEXT();
+op_uxth:
+    R(rd) = R(rm) & 0xFFFF;
+    NEXT();
+op_uxtb:
+    R(rd) = R(rm) & 0xFF;
+    NEXT();
+op_rev:
+    R(rd) = __builtin_bswap32(R(rm));
+    NEXT();
+op_rev16:
+    value = R(rm);
+    R(rd) = ((value & 0x00FF00FF) << 8) | ((value >> 8) & 0x00FF00FF);
+    NEXT();
+op_revsh:
+    R(rd) = (uint32_t)(int32_t)(int16_t)(((R(rm) & 0xFF) << 8) | ((R(rm) >> 8) & 0xFF));
+    NEXT();
+
+    /* Loads */
+op_ldr_lit:
+    SRAM(op->imm, 4);
+    R(rd) = load32(p);
+    NEXT();
+op_ldr_imm:
+    SRAM(R(rn) + op->imm, 4);
+    R(rd) = load32(p);
+    NEXT();
+op_ldrh_imm:
+    SRAM(R(rn) + op->imm, 2);
+    R(rd) = load16(p);
+    NEXT();
+op_ldrb_imm:
+    SRAM(R(rn) + op->imm, 1);
+    R(rd) = p[0];
+    NEXT();
+op_ldr_reg:
+    SRAM(R(rn) + R(rm), 4);
+    R(rd) = load32(p);
+    NEXT();
+op_ldrh_reg:
+    SRAM(R(rn) + R(rm), 2);
+    R(rd) = load16(p);
+    NEXT();
+op_ldrb_reg:
+    SRAM(R(rn) + R(rm), 1);
+    R(rd) = p[0];
+    NEXT();
+op_ldrsh_reg:
+    SRAM(R(rn) + R(rm), 2);
+    R(rd) = (uint32_t)(int32_t)(int16_t)load16(p);
+    NEXT();
+op_ldrsb_reg:
+    SRAM(R(rn) + R(rm), 1);
+    R(rd) = (uint32_t)(int32_t)(int8_t)p[0];
+    NEXT();
+
+    /* Stores */
+op_str_imm:
+    addr = R(rn) + op->imm; SRAM(addr, 4);
+    store32(p, R(rd)); STORED(addr, 4);
+    NEXT();
+op_strh_imm:
+    addr = R(rn) + op->imm; SRAM(addr, 2);
+    store16(p, R(rd)); STORED(addr, 2);
+    NEXT();
+op_strb_imm:
+    addr = R(rn) + op->imm; SRAM(addr, 1);
+    p[0] = (uint8_t)R(rd); STORED(addr, 1);
+    NEXT();
+op_str_reg:
+    addr = R(rn) + R(rm); SRAM(addr, 4);
+    store32(p, R(rd)); STORED(addr, 4);
+    NEXT();
+op_strh_reg:
+    addr = R(rn) + R(rm); SRAM(addr, 2);
+    store16(p, R(rd)); STORED(addr, 2);
+    NEXT();
+op_strb_reg:
+    addr = R(rn) + R(rm); SRAM(addr, 1);
+    p[0] = (uint8_t)R(rd); STORED(addr, 1);
+    NEXT();
+
+    /* Multiple transfers: check the whole range before touching anything */
+op_push:
+    value = (uint32_t)__builtin_popcount(op->imm) * 4;
+    addr = r[13] - value;
+    SRAM(addr, 4);
+    if (!block_sram(sys, addr + value - 4, 4)) goto side_exit;
+    for (int i = 0; i < 15; i++) {
+        if (op->imm & (1u << i)) {
+            store32(p, r[i]);
+            p += 4;
+        }
+    }
+    r[13] = addr;
+    STORED(addr, value);
+    NEXT();
+op_pop:
+    value = (uint32_t)__builtin_popcount(op->imm) * 4;
+    SRAM(r[13], 4);
+    if (!block_sram(sys, r[13] + value - 4, 4)) goto side_exit;
+    for (int i = 0; i < 8; i++) {
+        if (op->imm & (1u << i)) {
+            r[i] = load32(p);
+            p += 4;
+        }
+    }
+    r[13] += value;
+    NEXT();
+op_stm:
+    value = (uint32_t)__builtin_popcount(op->imm) * 4;
+    addr = R(rn);
+    SRAM(addr, 4);
+    if (!block_sram(sys, addr + value - 4, 4)) goto side_exit;
+    for (int i = 0; i < 8; i++) {
+        if (op->imm & (1u << i)) {
+            store32(p, r[i]);
+            p += 4;
+        }
+    }
+    R(rn) = addr + value;
+    STORED(addr, value);
+    NEXT();
+op_ldm:
+    value = (uint32_t)__builtin_popcount(op->imm) * 4;
+    addr = R(rn);
+    SRAM(addr, 4);
+    if (!block_sram(sys, addr + value - 4, 4)) goto side_exit;
+    if (!(op->imm & (1u << op->rn))) R(rn) = addr + value;
+    for (int i = 0; i < 8; i++) {
+        if (op->imm & (1u << i)) {
+            r[i] = load32(p);
+            p += 4;
+        }
+    }
+    NEXT();
+
+    /* Block exits */
+op_b:
+    next_pc = op->imm;
+    goto taken;
+op_bcond:
+    next_pc = condition_passed(op->rm, n, z, c, v) ? op->imm : op->pc + 2;
+    goto taken;
+op_bl:
+    r[14] = (op->pc + 4) | 1;
+    next_pc = op->imm;
+    goto taken;
+op_bx:
+    /* Exception returns and interworking faults belong to the core */
+    value = R(rm);
+    if (!(value & 1) || (value & 0xF0000000) == 0xF0000000) goto side_exit;
+    next_pc = value & ~1u;
+    goto taken;
+op_blx:
+    value = R(rm);
+    if (!(value & 1) || (value & 0xF0000000) == 0xF0000000) goto side_exit;
+    r[14] = (op->pc + 2) | 1;
+    next_pc = value & ~1u;
+    goto taken;
+op_mov_pc:
+    next_pc = R(rm) & ~1u;
+    goto taken;
+op_pop_pc:
+    value = (uint32_t)__builtin_popcount(op->imm) * 4;
+    SRAM(r[13], 4);
+    if (!block_sram(sys, r[13] + value, 4)) goto side_exit;
+    next_pc = load32(p + value);
+    if (!(next_pc & 1) || (next_pc & 0xF0000000) == 0xF0000000) goto side_exit;
+    for (int i = 0; i < 8; i++) {
+        if (op->imm & (1u << i)) {
+            r[i] = load32(p);
+            p += 4;
+        }
+    }
+    r[13] += value + 4;
+    next_pc &= ~1u;
+    goto taken;
+op_exit:
+    next_pc = op->pc;
+    retired = op->index;
+    goto done;
+op_exit_step:
+    next_pc = op->pc;
+    retired = op->index;
+    result = RP2040_BLOCK_STEP;
+    goto done;
+
+taken:
+    retired = op->index + 1u;
+    goto done;
+
+op_watch:
+    /* Memory ops while watchpoints are set: check, then run the real handler */
+    block_op_access(op, r, &addr, &value, &write);
+    if (!rp2040_debug_watch_hit(sys->debug, addr, value, write)) goto *dispatch[op->opcode];
+    rp2040_watchpoint_hit(sys, core_id, addr, value, write);
+    next_pc = op->pc;
+    retired = op->index;
+    result = RP2040_BLOCK_STOP;
+    goto done;
+
+side_exit:
+    if (block_sio_access(sys, core_id, op, r)) NEXT();
+    /* Hand this instruction, unexecuted, to rp2040_step_core */
+    next_pc = op->pc;
+    retired = op->index;
+    result = RP2040_BLOCK_STEP;
+    goto done;
+
+store_exit:
+    next_pc = op->pc + 2;
+    retired = op->index + 1u;
+    /* May free this block: op must not be used past this point */
+    rp2040_code_written(sys, core_id, addr, store_len);
+
+done:
+    memcpy(core->r, r, sizeof(core->r));
+    core->sp = r[13];
+    core->lr = r[14];
+    core->pc = next_pc;
+    core->psr = (core->psr & ~(PSR_N_BIT | PSR_Z_BIT | PSR_C_BIT | PSR_V_BIT)) |
+                (n ? PSR_N_BIT : 0) | (z ? PSR_Z_BIT : 0) |
+                (c ? PSR_C_BIT : 0) | (v ? PSR_V_BIT : 0);
+    sys->engines[core_id].cycles += retired;
+
+    return result;
+
+#undef R
+#undef NEXT
+#undef SET_NZ
+#undef SRAM
+#undef STORED
+}
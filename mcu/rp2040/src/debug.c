@@ -0,0 +1,199 @@
+// src/rp2040/debug.c
+#include "rp2040/debug.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * Initialize with no breakpoints or watchpoints over [base, base + size)
+ */
+int rp2040_debug_init(rp2040_debug_t *dbg, uint32_t base, uint32_t size)
+{
+    if (!dbg) return -1;
+
+    memset(dbg, 0, sizeof(rp2040_debug_t));
+    dbg->base = base;
+    dbg->size = size;
+    dbg->num_pages = (size + RP2040_DEBUG_PAGE_SIZE - 1) >> RP2040_DEBUG_PAGE_SHIFT;
+
+    dbg->bp_pages = (uint64_t **)calloc(dbg->num_pages, sizeof(uint64_t *));
+    dbg->watch_pages = (uint16_t *)calloc(dbg->num_pages, sizeof(uint16_t));
+    if (!dbg->bp_pages || !dbg->watch_pages) {
+        fprintf(stderr, "Failed to allocate debug state\n");
+        rp2040_debug_destroy(dbg);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Free breakpoint bitmaps and watchpoints
+ */
+void rp2040_debug_destroy(rp2040_debug_t *dbg)
+{
+    if (!dbg) return;
+
+    if (dbg->bp_pages) {
+        rp2040_debug_clear_breakpoints(dbg);
+        free(dbg->bp_pages);
+        dbg->bp_pages = NULL;
+    }
+    free(dbg->watchpoints);
+    free(dbg->watch_pages);
+    dbg->watchpoints = NULL;
+    dbg->watch_pages = NULL;
+    dbg->num_watchpoints = 0;
+}
+
+/**
+ * Set or clear the breakpoint at addr.
+ * Returns 1 if it changed, 0 if it already was in that state, -1 if addr
+ * is outside the covered range.
+ */
+int rp2040_debug_set_breakpoint(rp2040_debug_t *dbg, uint32_t addr, bool set)
+{
+    if (!dbg) return -1;
+
+    uint32_t offset = addr - dbg->base;
+    if (offset >= dbg->size || (offset & 1)) return -1;
+
+    uint32_t page = offset >> RP2040_DEBUG_PAGE_SHIFT;
+    uint32_t slot = (offset & (RP2040_DEBUG_PAGE_SIZE - 1)) >> 1;
+    uint64_t mask = 1ull << (slot & 63);
+
+    if (!dbg->bp_pages[page]) {
+        if (!set) return 0;
+        dbg->bp_pages[page] = (uint64_t *)calloc(RP2040_DEBUG_PAGE_WORDS, sizeof(uint64_t));
+        if (!dbg->bp_pages[page]) return -1;
+    }
+
+    uint64_t *word = &dbg->bp_pages[page][slot >> 6];
+    if (((*word & mask) != 0) == set) return 0;
+
+    if (set) {
+        *word |= mask;
+        dbg->num_breakpoints++;
+    } else {
+        *word &= ~mask;
+        dbg->num_breakpoints--;
+    }
+    return 1;
+}
+
+/**
+ * Remove all breakpoints
+ */
+void rp2040_debug_clear_breakpoints(rp2040_debug_t *dbg)
+{
+    if (!dbg || !dbg->bp_pages) return;
+
+    for (uint32_t i = 0; i < dbg->num_pages; i++) {
+        free(dbg->bp_pages[i]);
+        dbg->bp_pages[i] = NULL;
+    }
+    dbg->num_breakpoints = 0;
+}
+
+/**
+ * Add delta to the tag of every page overlapping [addr, addr + len)
+ */
+static void debug_tag_pages(rp2040_debug_t *dbg, uint32_t addr, uint32_t len, int delta)
+{
+    uint32_t first = (addr - dbg->base) >> RP2040_DEBUG_PAGE_SHIFT;
+    uint32_t last = (addr + len - 1 - dbg->base) >> RP2040_DEBUG_PAGE_SHIFT;
+
+    for (uint32_t page = first; page <= last; page++) {
+        dbg->watch_pages[page] = (uint16_t)(dbg->watch_pages[page] + delta);
+    }
+}
+
+/**
+ * Watch [addr, addr + len) for reads, writes or both.
+ * Returns -1 if the range is not inside the covered range.
+ */
+int rp2040_debug_add_watchpoint(rp2040_debug_t *dbg, uint32_t addr, uint32_t len, rp2040_watch_type_t type)
+{
+    if (!dbg || len == 0 || !(type & RP2040_WATCH_ACCESS)) return -1;
+
+    uint32_t offset = addr - dbg->base;
+    if (offset >= dbg->size || len > dbg->size - offset) return -1;
+
+    if (dbg->num_watchpoints == dbg->watch_capacity) {
+        uint32_t capacity = dbg->watch_capacity ? dbg->watch_capacity * 2 : 8;
+        rp2040_watchpoint_t *watchpoints = (rp2040_watchpoint_t *)realloc(dbg->watchpoints,
+                                                                          capacity * sizeof(rp2040_watchpoint_t));
+        if (!watchpoints) return -1;
+        dbg->watchpoints = watchpoints;
+        dbg->watch_capacity = capacity;
+    }
+
+    rp2040_watchpoint_t *wp = &dbg->watchpoints[dbg->num_watchpoints++];
+    wp->addr = addr;
+    wp->len = len;
+    wp->type = type;
+    debug_tag_pages(dbg, addr, len, +1);
+
+    return 0;
+}
+
+/**
+ * Remove every watchpoint starting at addr.
+ * Returns the number removed.
+ */
+int rp2040_debug_remove_watchpoint(rp2040_debug_t *dbg, uint32_t addr)
+{
+    if (!dbg) return 0;
+
+    int removed = 0;
+    for (uint32_t i = 0; i < dbg->num_watchpoints; ) {
+        rp2040_watchpoint_t *wp = &dbg->watchpoints[i];
+        if (wp->addr == addr) {
+            debug_tag_pages(dbg, wp->addr, wp->len, -1);
+            *wp = dbg->watchpoints[--dbg->num_watchpoints];
+            removed++;
+        } else {
+            i++;
+        }
+    }
+
+    return removed;
+}
+
+/**
+ * Remove all watchpoints
+ */
+void rp2040_debug_clear_watchpoints(rp2040_debug_t *dbg)
+{
+    if (!dbg || !dbg->watch_pages) return;
+
+    dbg->num_watchpoints = 0;
+    memset(dbg->watch_pages, 0, dbg->num_pages * sizeof(uint16_t));
+}
+
+/**
+ * Check an access against the watchpoints. Accesses outside the covered
+ * range or to untagged pages never match.
+ */
+bool rp2040_debug_watch_hit(rp2040_debug_t *dbg, uint32_t addr, uint32_t len, bool write)
+{
+    if (!dbg->num_watchpoints) return false;
+
+    uint32_t offset = addr - dbg->base;
+    if (offset >= dbg->size || len > dbg->size - offset) return false;
+
+    if (!dbg->watch_pages[offset >> RP2040_DEBUG_PAGE_SHIFT] &&
+        !dbg->watch_pages[(offset + len - 1) >> RP2040_DEBUG_PAGE_SHIFT]) {
+        return false;
+    }
+
+    rp2040_watch_type_t type = write ? RP2040_WATCH_WRITE : RP2040_WATCH_READ;
+    for (uint32_t i = 0; i < dbg->num_watchpoints; i++) {
+        const rp2040_watchpoint_t *wp = &dbg->watchpoints[i];
+        if ((wp->type & type) && addr < wp->addr + wp->len && wp->addr < addr + len) {
+            return true;
+        }
+    }
+
+    return false;
+}
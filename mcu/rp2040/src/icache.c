@@ -0,0 +1,136 @@
+// src/rp2040/icache.c
+#include "rp2040/icache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * Default handler: run the decoded form without decoding again
+ */
+static int icache_exec_decoded(arm_core_state_t *core, const rp2040_icache_entry_t *entry)
+{
+    return arm_thumb2_execute_decoded(core, &entry->instr, entry->length);
+}
+
+/**
+ * Initialize a cache covering [base, base + size)
+ */
+int rp2040_icache_init(rp2040_icache_t *cache, uint32_t base, uint32_t size)
+{
+    if (!cache) return -1;
+
+    memset(cache, 0, sizeof(rp2040_icache_t));
+    cache->base = base;
+    cache->size = size;
+    cache->num_pages = (size + RP2040_ICACHE_PAGE_SIZE - 1) >> RP2040_ICACHE_PAGE_SHIFT;
+
+    cache->pages = (rp2040_icache_entry_t **)calloc(cache->num_pages, sizeof(rp2040_icache_entry_t *));
+    if (!cache->pages) {
+        fprintf(stderr, "Failed to allocate instruction cache\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Free all code pages
+ */
+void rp2040_icache_destroy(rp2040_icache_t *cache)
+{
+    if (!cache || !cache->pages) return;
+
+    for (uint32_t i = 0; i < cache->num_pages; i++) {
+        free(cache->pages[i]);
+    }
+    free(cache->pages);
+    cache->pages = NULL;
+}
+
+/**
+ * Decode an instruction fetched from addr and store it in its slot.
+ * Returns NULL if addr is outside the cache or the instruction does not
+ * decode; the caller then falls back to arm_thumb2_execute.
+ */
+rp2040_icache_entry_t *rp2040_icache_fill(rp2040_icache_t *cache, uint32_t addr,
+                                          uint32_t instruction, uint8_t instr_len)
+{
+    uint32_t offset = addr - cache->base;
+    if (offset >= cache->size || (offset & 1)) return NULL;
+
+    uint32_t page_index = offset >> RP2040_ICACHE_PAGE_SHIFT;
+    rp2040_icache_entry_t *page = cache->pages[page_index];
+    if (!page) {
+        page = (rp2040_icache_entry_t *)calloc(RP2040_ICACHE_PAGE_SLOTS, sizeof(rp2040_icache_entry_t));
+        if (!page) return NULL;
+        cache->pages[page_index] = page;
+    }
+
+    rp2040_icache_entry_t *entry = &page[(offset & (RP2040_ICACHE_PAGE_SIZE - 1)) >> 1];
+    if (arm_thumb2_decode(instruction, instr_len, &entry->instr) < 0 ||
+        entry->instr.type == ARM_INSTR_INVALID) {
+        entry->exec = NULL;
+        return NULL;
+    }
+
+    entry->length = instr_len;
+    entry->exec = icache_exec_decoded;
+    return entry;
+}
+
+/**
+ * Drop slots overlapping a write to [addr, addr + len)
+ */
+void rp2040_icache_invalidate(rp2040_icache_t *cache, uint32_t addr, uint32_t len)
+{
+    if (!cache || len == 0) return;
+
+    /* A 32-bit instruction starting one halfword earlier also covers addr */
+    uint64_t start = addr & ~1u;
+    if (start >= 2) start -= 2;
+    uint64_t end = (uint64_t)addr + len;
+
+    if (start < cache->base) start = cache->base;
+    if (end > (uint64_t)cache->base + cache->size) end = (uint64_t)cache->base + cache->size;
+
+    for (uint64_t a = start; a < end; a += 2) {
+        uint32_t offset = (uint32_t)(a - cache->base);
+        rp2040_icache_entry_t *page = cache->pages[offset >> RP2040_ICACHE_PAGE_SHIFT];
+
+        if (!page) {
+            /* Data-only page: skip to the next one */
+            a = cache->base + ((offset | (RP2040_ICACHE_PAGE_SIZE - 1)) + 1) - 2;
+            continue;
+        }
+
+        rp2040_icache_entry_t *entry = &page[(offset & (RP2040_ICACHE_PAGE_SIZE - 1)) >> 1];
+        if (entry->exec) {
+            entry->exec = NULL;
+            cache->invalidations++;
+        }
+    }
+}
+
+/**
+ * Drop every slot (e.g. after a bulk load or a reset)
+ */
+void rp2040_icache_flush(rp2040_icache_t *cache)
+{
+    if (!cache || !cache->pages) return;
+
+    for (uint32_t i = 0; i < cache->num_pages; i++) {
+        free(cache->pages[i]);
+        cache->pages[i] = NULL;
+    }
+}
+
+/**
+ * Fraction of lookups served from the cache
+ */
+double rp2040_icache_hit_rate(const rp2040_icache_t *cache)
+{
+    if (!cache) return 0.0;
+
+    uint64_t total = cache->hits + cache->misses;
+    return total ? (double)cache->hits / (double)total : 0.0;
+}
@@ -0,0 +1,1188 @@
+// src/rp2040/jit.c
+#include "rp2040/jit.h"
+#include "rp2040/rp2040.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define RP2040_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#endif
+
+/* Exit status left in the frame by compiled code */
+#define JIT_DONE            0       /* next_pc starts the next block */
+#define JIT_STEP            1       /* Instruction at next_pc belongs to the core */
+#define JIT_SIDE            2       /* Same, because of a non-SRAM access */
+#define JIT_STORE           3       /* A store hit code; invalidate, then continue */
+#define JIT_WATCH_READ      4       /* Access to a watched page at store_addr */
+#define JIT_WATCH_WRITE     5
+
+/* Layout of the code cache */
+#define JIT_EPILOGUE        0       /* pop rbx; ret */
+#define JIT_ENTER           2       /* push rbx; mov rbx, rdi; jmp rsi */
+#define JIT_RUNTIME_SIZE    16
+#define JIT_BLOCK_MAX       32768   /* Worst case for one block, checked while emitting */
+
+/* Flag bits for liveness */
+#define FLAG_N              1
+#define FLAG_Z              2
+#define FLAG_C              4
+#define FLAG_V              8
+#define FLAGS_ALL           15
+
+/* Guest state shared with compiled code, which keeps its address in rbx */
+typedef struct {
+    uint32_t r[16];
+    uint8_t n, z, c, v;
+    uint32_t next_pc;
+    int32_t budget;
+    uint32_t exit_block;        /* Start of the block that took a side exit */
+    uint32_t store_addr;        /* Also the address of a watched access */
+    uint8_t status;
+    uint8_t store_len;
+    uint64_t retired;
+    uint8_t *sram;
+    uint8_t *code_pages;
+    uint16_t *watch_pages;
+} jit_frame_t;
+
+/* Every field must be reachable with an 8-bit displacement */
+_Static_assert(offsetof(jit_frame_t, watch_pages) < 128, "JIT frame too large");
+
+#define F_N             ((uint8_t)offsetof(jit_frame_t, n))
+#define F_Z             ((uint8_t)offsetof(jit_frame_t, z))
+#define F_C             ((uint8_t)offsetof(jit_frame_t, c))
+#define F_V             ((uint8_t)offsetof(jit_frame_t, v))
+#define F_NEXT_PC       ((uint8_t)offsetof(jit_frame_t, next_pc))
+#define F_BUDGET        ((uint8_t)offsetof(jit_frame_t, budget))
+#define F_STATUS        ((uint8_t)offsetof(jit_frame_t, status))
+#define F_EXIT_BLOCK    ((uint8_t)offsetof(jit_frame_t, exit_block))
+#define F_STORE_ADDR    ((uint8_t)offsetof(jit_frame_t, store_addr))
+#define F_STORE_LEN     ((uint8_t)offsetof(jit_frame_t, store_len))
+#define F_RETIRED       ((uint8_t)offsetof(jit_frame_t, retired))
+#define F_SRAM          ((uint8_t)offsetof(jit_frame_t, sram))
+#define F_CODE_PAGES    ((uint8_t)offsetof(jit_frame_t, code_pages))
+#define F_WATCH_PAGES   ((uint8_t)offsetof(jit_frame_t, watch_pages))
+#define GR(x)           ((uint8_t)((x) * 4))
+
+typedef void (*jit_enter_t)(jit_frame_t *frame, const uint8_t *code);
+
+#ifdef RP2040_JIT_SUPPORTED
+
+/* x86 registers and condition codes */
+enum { EAX = 0, ECX = 1, EDX = 2 };
+enum {
+    CC_O = 0x0, CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5,
+    CC_A = 0x7, CC_S = 0x8
+};
+
+typedef struct {
+    uint8_t *code;              /* Code cache base */
+    size_t pos;                 /* Absolute offset of the next byte */
+    size_t limit;
+} jit_emit_t;
+
+/* Out-of-line exits, emitted after the block body */
+enum { STUB_SIDE, STUB_STEP, STUB_STORE, STUB_WATCH_READ, STUB_WATCH_WRITE };
+
+typedef struct {
+    size_t site;
+    uint8_t kind;
+    const rp2040_block_op_t *op;
+    uint32_t len;
+} jit_stub_t;
+
+typedef struct {
+    jit_emit_t e;
+    rp2040_block_t *block;
+    bool watch;                 /* Check accesses against watched pages */
+    bool smp;                   /* Other cores run on their own threads */
+    jit_stub_t stubs[RP2040_BLOCK_MAX_INSTRS * 8];
+    int num_stubs;
+    rp2040_jit_link_t chains[RP2040_BLOCK_MAX_INSTRS * 2];
+    int num_chains;
+} jit_compiler_t;
+
+static void emit_bytes(jit_emit_t *e, const uint8_t *bytes, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (e->pos < e->limit) e->code[e->pos] = bytes[i];
+        e->pos++;
+    }
+}
+
+#define EMIT(e, ...) \
+    emit_bytes((e), (const uint8_t[]){ __VA_ARGS__ }, sizeof((const uint8_t[]){ __VA_ARGS__ }))
+
+static void emit32(jit_emit_t *e, uint32_t v)
+{
+    EMIT(e, (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24));
+}
+
+static void patch32(jit_emit_t *e, size_t site, size_t target)
+{
+    uint32_t rel = (uint32_t)(target - (site + 4));
+    if (site + 4 > e->limit) return;
+    memcpy(e->code + site, &rel, 4);
+}
+
+static size_t jcc32(jit_emit_t *e, uint8_t cc)
+{
+    EMIT(e, 0x0F, (uint8_t)(0x80 | cc));
+    size_t site = e->pos;
+    emit32(e, 0);
+    return site;
+}
+
+static size_t jmp32(jit_emit_t *e)
+{
+    EMIT(e, 0xE9);
+    size_t site = e->pos;
+    emit32(e, 0);
+    return site;
+}
+
+static size_t jcc8(jit_emit_t *e, uint8_t cc)
+{
+    EMIT(e, (uint8_t)(0x70 | cc), 0);
+    return e->pos - 1;
+}
+
+static size_t jmp8(jit_emit_t *e)
+{
+    EMIT(e, 0xEB, 0);
+    return e->pos - 1;
+}
+
+static void patch8(jit_emit_t *e, size_t site)
+{
+    if (site < e->limit) e->code[site] = (uint8_t)(e->pos - (site + 1));
+}
+
+/* mov x, [guest reg] / mov [guest reg], x */
+static void ld(jit_emit_t *e, int x, int g) { EMIT(e, 0x8B, (uint8_t)(0x43 | (x << 3)), GR(g)); }
+static void st(jit_emit_t *e, int x, int g) { EMIT(e, 0x89, (uint8_t)(0x43 | (x << 3)), GR(g)); }
+
+/* <op> eax, [rbx + disp8] */
+static void alu_m(jit_emit_t *e, uint8_t opcode, uint8_t disp) { EMIT(e, opcode, 0x43, disp); }
+
+static void mov_m_imm(jit_emit_t *e, uint8_t disp, uint32_t imm)
+{
+    EMIT(e, 0xC7, 0x43, disp);
+    emit32(e, imm);
+}
+
+static void movb_m_imm(jit_emit_t *e, uint8_t disp, uint8_t imm) { EMIT(e, 0xC6, 0x43, disp, imm); }
+static void setcc_m(jit_emit_t *e, uint8_t cc, uint8_t disp) { EMIT(e, 0x0F, (uint8_t)(0x90 | cc), 0x43, disp); }
+static void test_eax(jit_emit_t *e) { EMIT(e, 0x85, 0xC0); }
+
+static void emit_nz(jit_emit_t *e, unsigned live)
+{
+    if (live & FLAG_N) setcc_m(e, CC_S, F_N);
+    if (live & FLAG_Z) setcc_m(e, CC_E, F_Z);
+}
+
+/* ARM C is the x86 carry for additions and its inverse for subtractions */
+static void emit_nzcv(jit_emit_t *e, unsigned live, bool sub)
+{
+    emit_nz(e, live);
+    if (live & FLAG_C) setcc_m(e, sub ? CC_AE : CC_B, F_C);
+    if (live & FLAG_V) setcc_m(e, CC_O, F_V);
+}
+
+static void add_stub(jit_compiler_t *jc, size_t site, uint8_t kind, const rp2040_block_op_t *op, uint32_t len)
+{
+    jit_stub_t *stub = &jc->stubs[jc->num_stubs++];
+    stub->site = site;
+    stub->kind = kind;
+    stub->op = op;
+    stub->len = len;
+}
+
+/* Account for retired instructions and leave through the epilogue */
+static void emit_exit(jit_compiler_t *jc, bool direct, uint32_t target, uint32_t retired, bool chain)
+{
+    jit_emit_t *e = &jc->e;
+
+    if (direct) mov_m_imm(e, F_NEXT_PC, target);
+    if (retired) {
+        EMIT(e, 0x48, 0x83, 0x43, F_RETIRED, (uint8_t)retired);   /* add qword [retired], n */
+        EMIT(e, 0x83, 0x6B, F_BUDGET, (uint8_t)retired);          /* sub dword [budget], n */
+    }
+
+    size_t site = jmp32(e);
+    patch32(e, site, JIT_EPILOGUE);
+    if (chain) {
+        jc->chains[jc->num_chains].site = (uint32_t)site;
+        jc->chains[jc->num_chains].target_pc = target;
+        jc->num_chains++;
+    }
+}
+
+/* edx = SRAM offset; exits before the access if its page is watched */
+static void emit_watch_check(jit_compiler_t *jc, const rp2040_block_op_t *op, uint32_t size, bool write)
+{
+    jit_emit_t *e = &jc->e;
+
+    EMIT(e, 0xC1, 0xEA, RP2040_DEBUG_PAGE_SHIFT);      /* shr edx, page shift */
+    EMIT(e, 0x01, 0xD2);                                /* add edx, edx */
+    EMIT(e, 0x48, 0x03, 0x53, F_WATCH_PAGES);           /* add rdx, [watch_pages] */
+    EMIT(e, 0x66, 0x83, 0x3A, 0x00);                    /* cmp word [rdx], 0 */
+    add_stub(jc, jcc32(e, CC_NE), write ? STUB_WATCH_WRITE : STUB_WATCH_READ, op, size);
+}
+
+/* eax = guest address. Leaves the SRAM offset in ecx and the SRAM base in rdx. */
+static void emit_sram_check(jit_compiler_t *jc, const rp2040_block_op_t *op, uint32_t size, uint32_t align,
+                            bool write)
+{
+    jit_emit_t *e = &jc->e;
+
+    EMIT(e, 0x89, 0xC1);                                /* mov ecx, eax */
+    EMIT(e, 0x81, 0xE9); emit32(e, RP2040_SRAM_BASE);   /* sub ecx, base */
+    EMIT(e, 0x81, 0xF9); emit32(e, RP2040_SRAM_SIZE - size);
+    add_stub(jc, jcc32(e, CC_A), STUB_SIDE, op, 0);
+    if (align > 1) {
+        EMIT(e, 0xA8, (uint8_t)(align - 1));            /* test al, align - 1 */
+        add_stub(jc, jcc32(e, CC_NE), STUB_SIDE, op, 0);
+    }
+    if (jc->watch) {
+        EMIT(e, 0x89, 0xCA);                            /* mov edx, ecx */
+        emit_watch_check(jc, op, size, write);
+        if (size > 4) {
+            EMIT(e, 0x8D, 0x51, (uint8_t)(size - 1));   /* lea edx, [rcx + size - 1] */
+            emit_watch_check(jc, op, size, write);
+        }
+    }
+    EMIT(e, 0x48, 0x8B, 0x53, F_SRAM);                  /* mov rdx, [sram] */
+}
+
+/* Orders a store before its code check, as rp2040_is_code does, while cores run threaded */
+static void emit_store_fence(jit_compiler_t *jc)
+{
+    if (jc->smp) EMIT(&jc->e, 0x0F, 0xAE, 0xF0);       /* mfence */
+}
+
+/* x holds an SRAM page index; exits if any core has decoded code from that page */
+static void emit_code_check(jit_compiler_t *jc, const rp2040_block_op_t *op, int x, uint32_t len)
+{
+    jit_emit_t *e = &jc->e;
+
+    EMIT(e, 0x48, 0x8B, 0x53, F_CODE_PAGES);
+    EMIT(e, 0x80, 0x3C, (uint8_t)(0x02 | (x << 3)), 0x00);         /* cmp byte [rdx + x], 0 */
+    add_stub(jc, jcc32(e, CC_NE), STUB_STORE, op, len);
+}
+
+/* eax = address of a single load or store */
+static void emit_address(jit_emit_t *e, const rp2040_block_op_t *op, bool reg_offset)
+{
+    ld(e, EAX, op->rn);
+    if (reg_offset) {
+        alu_m(e, 0x03, GR(op->rm));                     /* add eax, [rm] */
+    } else if (op->imm) {
+        EMIT(e, 0x05); emit32(e, op->imm);              /* add eax, imm */
+    }
+}
+
+static void emit_load(jit_compiler_t *jc, const rp2040_block_op_t *op, bool reg_offset,
+                      uint32_t size, uint8_t opcode2)
+{
+    jit_emit_t *e = &jc->e;
+
+    emit_address(e, op, reg_offset);
+    emit_sram_check(jc, op, size, size, false);
+    if (opcode2) {
+        EMIT(e, 0x0F, opcode2, 0x04, 0x0A);             /* movzx/movsx eax, [rdx + rcx] */
+    } else {
+        EMIT(e, 0x8B, 0x04, 0x0A);                      /* mov eax, [rdx + rcx] */
+    }
+    st(e, EAX, op->rd);
+}
+
+static void emit_store(jit_compiler_t *jc, const rp2040_block_op_t *op, bool reg_offset, uint32_t size)
+{
+    jit_emit_t *e = &jc->e;
+
+    emit_address(e, op, reg_offset);
+    EMIT(e, 0x89, 0x43, F_STORE_ADDR);
+    emit_sram_check(jc, op, size, size, true);
+    ld(e, EAX, op->rd);
+    if (size == 4) EMIT(e, 0x89, 0x04, 0x0A);
+    else if (size == 2) EMIT(e, 0x66, 0x89, 0x04, 0x0A);
+    else EMIT(e, 0x88, 0x04, 0x0A);
+    EMIT(e, 0xC1, 0xE9, RP2040_ICACHE_PAGE_SHIFT);      /* shr ecx, page shift */
+    emit_store_fence(jc);
+    emit_code_check(jc, op, ECX, size);
+}
+
+/* Stores registers of a list to [rdx + rcx] upwards */
+static void emit_store_list(jit_emit_t *e, uint32_t list)
+{
+    uint8_t disp = 0;
+
+    for (int i = 0; i < 15; i++) {
+        if (list & (1u << i)) {
+            ld(e, EAX, i);
+            EMIT(e, 0x89, 0x44, 0x0A, disp);            /* mov [rdx + rcx + disp], eax */
+            disp += 4;
+        }
+    }
+}
+
+/* Checks the first and last page of a multiple store at SRAM offset rcx */
+static void emit_list_code_check(jit_compiler_t *jc, const rp2040_block_op_t *op, uint32_t bytes)
+{
+    jit_emit_t *e = &jc->e;
+
+    EMIT(e, 0x8D, 0x41, (uint8_t)(bytes - 1));          /* lea eax, [rcx + bytes - 1] */
+    EMIT(e, 0xC1, 0xE8, RP2040_ICACHE_PAGE_SHIFT);
+    EMIT(e, 0xC1, 0xE9, RP2040_ICACHE_PAGE_SHIFT);
+    emit_store_fence(jc);
+    emit_code_check(jc, op, EAX, bytes);
+    emit_code_check(jc, op, ECX, bytes);
+}
+
+static void emit_load_list(jit_emit_t *e, uint32_t list)
+{
+    uint8_t disp = 0;
+
+    for (int i = 0; i < 8; i++) {
+        if (list & (1u << i)) {
+            EMIT(e, 0x8B, 0x44, 0x0A, disp);            /* mov eax, [rdx + rcx + disp] */
+            st(e, EAX, i);
+            disp += 4;
+        }
+    }
+}
+
+/* al = condition passed */
+static void emit_condition(jit_emit_t *e, uint8_t cond)
+{
+    switch (cond >> 1) {
+    case 0: EMIT(e, 0x8A, 0x43, F_Z); break;
+    case 1: EMIT(e, 0x8A, 0x43, F_C); break;
+    case 2: EMIT(e, 0x8A, 0x43, F_N); break;
+    case 3: EMIT(e, 0x8A, 0x43, F_V); break;
+    case 4:  /* C && !Z */
+        EMIT(e, 0x8A, 0x43, F_Z, 0x34, 0x01, 0x22, 0x43, F_C);
+        break;
+    case 5:  /* N == V */
+        EMIT(e, 0x8A, 0x43, F_N, 0x32, 0x43, F_V, 0x34, 0x01);
+        break;
+    default: /* !Z && N == V */
+        EMIT(e, 0x8A, 0x43, F_N, 0x32, 0x43, F_V, 0x0A, 0x43, F_Z, 0x34, 0x01);
+        break;
+    }
+    if (cond & 1) EMIT(e, 0x34, 0x01);                  /* xor al, 1 */
+}
+
+/* ecx = shift amount (low byte of Rm), eax = Rd; shifts eax and sets C as ARM does */
+static void emit_register_shift(jit_emit_t *e, const rp2040_block_op_t *op)
+{
+    ld(e, ECX, op->rm);
+    EMIT(e, 0x0F, 0xB6, 0xC9);                          /* movzx ecx, cl */
+    ld(e, EAX, op->rd);
+    EMIT(e, 0x85, 0xC9);                                /* test ecx, ecx */
+    size_t zero = jcc8(e, CC_E);                        /* Shift by 0: C unchanged */
+    size_t done1 = 0, done2 = 0;
+
+    switch (op->opcode) {
+    case RP2040_OP_LSL_REG:
+    case RP2040_OP_LSR_REG: {
+        bool left = op->opcode == RP2040_OP_LSL_REG;
+        EMIT(e, 0x83, 0xF9, 0x20);                      /* cmp ecx, 32 */
+        size_t small = jcc8(e, CC_B);
+        size_t exact = jcc8(e, CC_E);
+        EMIT(e, 0xC6, 0x43, F_C, 0x00, 0x31, 0xC0);     /* > 32: C = 0, result 0 */
+        done1 = jmp8(e);
+        patch8(e, exact);
+        if (left) EMIT(e, 0x83, 0xE0, 0x01);            /* == 32: C = bit 0 */
+        else EMIT(e, 0xC1, 0xE8, 0x1F);                 /*        or bit 31 */
+        EMIT(e, 0x88, 0x43, F_C, 0x31, 0xC0);
+        done2 = jmp8(e);
+        patch8(e, small);
+        EMIT(e, 0xD3, left ? 0xE0 : 0xE8);              /* shl/shr eax, cl */
+        setcc_m(e, CC_B, F_C);
+        break;
+    }
+    case RP2040_OP_ASR_REG: {
+        EMIT(e, 0x83, 0xF9, 0x20);
+        size_t small = jcc8(e, CC_B);
+        EMIT(e, 0xC1, 0xF8, 0x1F);                      /* >= 32: sign fill, C = sign */
+        EMIT(e, 0x89, 0xC2, 0x83, 0xE2, 0x01, 0x88, 0x53, F_C);
+        done1 = jmp8(e);
+        patch8(e, small);
+        EMIT(e, 0xD3, 0xF8);
+        setcc_m(e, CC_B, F_C);
+        break;
+    }
+    default: /* ROR: C = bit 31 of the result */
+        EMIT(e, 0x83, 0xE1, 0x1F, 0xD3, 0xC8);
+        EMIT(e, 0x89, 0xC2, 0xC1, 0xEA, 0x1F, 0x88, 0x53, F_C);
+        break;
+    }
+
+    patch8(e, zero);
+    if (done1) patch8(e, done1);
+    if (done2) patch8(e, done2);
+}
+
+/**
+ * Emit one op. Returns false if the JIT does not handle it.
+ */
+static bool emit_op(jit_compiler_t *jc, const rp2040_block_op_t *op, unsigned live)
+{
+    jit_emit_t *e = &jc->e;
+    uint32_t count, bytes;
+
+    switch (op->opcode) {
+    case RP2040_OP_NOP:
+        return true;
+    case RP2040_OP_MOV_IMM:
+    case RP2040_OP_MOVS_IMM:
+        mov_m_imm(e, GR(op->rd), op->imm);
+        if (op->opcode == RP2040_OP_MOVS_IMM) {
+            if (live & FLAG_N) EMIT(e, 0xC6, 0x43, F_N, (uint8_t)(op->imm >> 31));
+            if (live & FLAG_Z) EMIT(e, 0xC6, 0x43, F_Z, (uint8_t)(op->imm == 0));
+        }
+        return true;
+    case RP2040_OP_MOV_REG:
+    case RP2040_OP_MOVS_REG:
+        ld(e, EAX, op->rm);
+        st(e, EAX, op->rd);
+        if (op->opcode == RP2040_OP_MOVS_REG && (live & (FLAG_N | FLAG_Z))) {
+            test_eax(e);
+            emit_nz(e, live);
+        }
+        return true;
+
+    case RP2040_OP_LSL_IMM:
+    case RP2040_OP_LSR_IMM:
+    case RP2040_OP_ASR_IMM:
+        ld(e, EAX, op->rm);
+        if (op->imm < 32) {
+            static const uint8_t modrm[] = { 0xE0, 0xE8, 0xF8 };
+            EMIT(e, 0xC1, modrm[op->opcode - RP2040_OP_LSL_IMM], (uint8_t)op->imm);
+            emit_nzcv(e, live & ~FLAG_V, false);
+        } else {
+            /* LSR/ASR #32: C = bit 31 */
+            EMIT(e, 0x0F, 0xBA, 0xE0, 0x1F);            /* bt eax, 31 */
+            if (live & FLAG_C) setcc_m(e, CC_B, F_C);
+            if (op->opcode == RP2040_OP_LSR_IMM) EMIT(e, 0x31, 0xC0);
+            else EMIT(e, 0xC1, 0xF8, 0x1F);
+            test_eax(e);
+            emit_nz(e, live);
+        }
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_LSL_REG:
+    case RP2040_OP_LSR_REG:
+    case RP2040_OP_ASR_REG:
+    case RP2040_OP_ROR_REG:
+        emit_register_shift(e, op);
+        st(e, EAX, op->rd);
+        if (live & (FLAG_N | FLAG_Z)) {
+            test_eax(e);
+            emit_nz(e, live);
+        }
+        return true;
+
+    case RP2040_OP_ADD_IMM:
+    case RP2040_OP_ADDS_IMM:
+    case RP2040_OP_SUBS_IMM:
+        ld(e, EAX, op->rn);
+        EMIT(e, op->opcode == RP2040_OP_SUBS_IMM ? 0x2D : 0x05);
+        emit32(e, op->imm);
+        if (op->opcode != RP2040_OP_ADD_IMM) emit_nzcv(e, live, op->opcode == RP2040_OP_SUBS_IMM);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_ADD_REG:
+    case RP2040_OP_ADDS_REG:
+    case RP2040_OP_SUBS_REG:
+        ld(e, EAX, op->rn);
+        alu_m(e, op->opcode == RP2040_OP_SUBS_REG ? 0x2B : 0x03, GR(op->rm));
+        if (op->opcode != RP2040_OP_ADD_REG) emit_nzcv(e, live, op->opcode == RP2040_OP_SUBS_REG);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_ADC:
+    case RP2040_OP_SBC:
+        ld(e, EAX, op->rn);
+        EMIT(e, 0x0F, 0xBA, 0x63, F_C, 0x00);           /* bt dword [c], 0 */
+        if (op->opcode == RP2040_OP_SBC) EMIT(e, 0xF5); /* cmc: x86 borrows on !C */
+        alu_m(e, op->opcode == RP2040_OP_SBC ? 0x1B : 0x13, GR(op->rm));
+        emit_nzcv(e, live, op->opcode == RP2040_OP_SBC);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_RSB:
+        EMIT(e, 0x31, 0xC0);
+        alu_m(e, 0x2B, GR(op->rm));
+        emit_nzcv(e, live, true);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_MUL:
+        ld(e, EAX, op->rn);
+        EMIT(e, 0x0F, 0xAF, 0x43, GR(op->rm));
+        test_eax(e);
+        emit_nz(e, live);
+        st(e, EAX, op->rd);
+        return true;
+
+    case RP2040_OP_AND:
+    case RP2040_OP_EOR:
+    case RP2040_OP_ORR:
+        ld(e, EAX, op->rn);
+        alu_m(e, op->opcode == RP2040_OP_AND ? 0x23 : op->opcode == RP2040_OP_EOR ? 0x33 : 0x0B, GR(op->rm));
+        emit_nz(e, live);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_BIC:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0xF7, 0xD0);                            /* not eax */
+        alu_m(e, 0x23, GR(op->rn));
+        emit_nz(e, live);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_MVN:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0xF7, 0xD0);
+        test_eax(e);
+        emit_nz(e, live);
+        st(e, EAX, op->rd);
+        return true;
+
+    case RP2040_OP_CMP_IMM:
+        ld(e, EAX, op->rn);
+        EMIT(e, 0x3D);
+        emit32(e, op->imm);
+        emit_nzcv(e, live, true);
+        return true;
+    case RP2040_OP_CMP_REG:
+    case RP2040_OP_CMN_REG:
+        ld(e, EAX, op->rn);
+        alu_m(e, op->opcode == RP2040_OP_CMP_REG ? 0x3B : 0x03, GR(op->rm));
+        emit_nzcv(e, live, op->opcode == RP2040_OP_CMP_REG);
+        return true;
+    case RP2040_OP_TST:
+        ld(e, EAX, op->rn);
+        EMIT(e, 0x85, 0x43, GR(op->rm));                /* test [rm], eax */
+        emit_nz(e, live);
+        return true;
+
+    case RP2040_OP_SXTH: EMIT(e, 0x0F, 0xBF, 0x43, GR(op->rm)); st(e, EAX, op->rd); return true;
+    case RP2040_OP_SXTB: EMIT(e, 0x0F, 0xBE, 0x43, GR(op->rm)); st(e, EAX, op->rd); return true;
+    case RP2040_OP_UXTH: EMIT(e, 0x0F, 0xB7, 0x43, GR(op->rm)); st(e, EAX, op->rd); return true;
+    case RP2040_OP_UXTB: EMIT(e, 0x0F, 0xB6, 0x43, GR(op->rm)); st(e, EAX, op->rd); return true;
+    case RP2040_OP_REV:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0x0F, 0xC8);                            /* bswap eax */
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_REV16:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0x89, 0xC1, 0xC1, 0xE0, 0x08, 0xC1, 0xE9, 0x08);
+        EMIT(e, 0x25); emit32(e, 0xFF00FF00);
+        EMIT(e, 0x81, 0xE1); emit32(e, 0x00FF00FF);
+        EMIT(e, 0x09, 0xC8);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_REVSH:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0x66, 0xC1, 0xC0, 0x08, 0x0F, 0xBF, 0xC0);  /* rol ax, 8; movsx eax, ax */
+        st(e, EAX, op->rd);
+        return true;
+
+    case RP2040_OP_LDR_LIT:
+        /* Pool address is known; only its contents are read at run time */
+        if (op->imm - RP2040_SRAM_BASE > RP2040_SRAM_SIZE - 4 || (op->imm & 3)) return false;
+        if (jc->watch) {
+            EMIT(e, 0xB9); emit32(e, op->imm - RP2040_SRAM_BASE);  /* mov ecx, offset */
+            EMIT(e, 0x89, 0xCA);
+            emit_watch_check(jc, op, 4, false);
+        }
+        EMIT(e, 0x48, 0x8B, 0x53, F_SRAM);
+        EMIT(e, 0x8B, 0x82); emit32(e, op->imm - RP2040_SRAM_BASE);
+        st(e, EAX, op->rd);
+        return true;
+    case RP2040_OP_LDR_IMM:    emit_load(jc, op, false, 4, 0);    return true;
+    case RP2040_OP_LDRH_IMM:   emit_load(jc, op, false, 2, 0xB7); return true;
+    case RP2040_OP_LDRB_IMM:   emit_load(jc, op, false, 1, 0xB6); return true;
+    case RP2040_OP_LDR_REG:    emit_load(jc, op, true, 4, 0);     return true;
+    case RP2040_OP_LDRH_REG:   emit_load(jc, op, true, 2, 0xB7);  return true;
+    case RP2040_OP_LDRB_REG:   emit_load(jc, op, true, 1, 0xB6);  return true;
+    case RP2040_OP_LDRSH_REG:  emit_load(jc, op, true, 2, 0xBF);  return true;
+    case RP2040_OP_LDRSB_REG:  emit_load(jc, op, true, 1, 0xBE);  return true;
+    case RP2040_OP_STR_IMM:    emit_store(jc, op, false, 4);      return true;
+    case RP2040_OP_STRH_IMM:   emit_store(jc, op, false, 2);      return true;
+    case RP2040_OP_STRB_IMM:   emit_store(jc, op, false, 1);      return true;
+    case RP2040_OP_STR_REG:    emit_store(jc, op, true, 4);       return true;
+    case RP2040_OP_STRH_REG:   emit_store(jc, op, true, 2);       return true;
+    case RP2040_OP_STRB_REG:   emit_store(jc, op, true, 1);       return true;
+
+    case RP2040_OP_PUSH:
+        bytes = (uint32_t)__builtin_popcount(op->imm) * 4;
+        ld(e, EAX, 13);
+        EMIT(e, 0x2D); emit32(e, bytes);
+        EMIT(e, 0x89, 0x43, F_STORE_ADDR);
+        emit_sram_check(jc, op, bytes, 4, true);
+        st(e, EAX, 13);
+        emit_store_list(e, op->imm);
+        emit_list_code_check(jc, op, bytes);
+        return true;
+    case RP2040_OP_STM:
+        bytes = (uint32_t)__builtin_popcount(op->imm) * 4;
+        ld(e, EAX, op->rn);
+        EMIT(e, 0x89, 0x43, F_STORE_ADDR);
+        emit_sram_check(jc, op, bytes, 4, true);
+        emit_store_list(e, op->imm);
+        EMIT(e, 0x83, 0x43, GR(op->rn), (uint8_t)bytes);  /* add [rn], bytes */
+        emit_list_code_check(jc, op, bytes);
+        return true;
+    case RP2040_OP_POP:
+    case RP2040_OP_LDM: {
+        uint8_t base = op->opcode == RP2040_OP_POP ? 13 : op->rn;
+        bytes = (uint32_t)__builtin_popcount(op->imm) * 4;
+        ld(e, EAX, base);
+        emit_sram_check(jc, op, bytes, 4, false);
+        if (op->opcode == RP2040_OP_POP || !(op->imm & (1u << base))) {
+            EMIT(e, 0x83, 0x43, GR(base), (uint8_t)bytes);
+        }
+        emit_load_list(e, op->imm);
+        return true;
+    }
+
+    /* Exits */
+    case RP2040_OP_B:
+        emit_exit(jc, true, op->imm, op->index + 1u, true);
+        return true;
+    case RP2040_OP_BL:
+        mov_m_imm(e, GR(14), (op->pc + 4) | 1);
+        emit_exit(jc, true, op->imm, op->index + 1u, true);
+        return true;
+    case RP2040_OP_BCOND: {
+        emit_condition(e, op->rm);
+        EMIT(e, 0x84, 0xC0);                            /* test al, al */
+        size_t not_taken = jcc8(e, CC_E);
+        emit_exit(jc, true, op->imm, op->index + 1u, true);
+        patch8(e, not_taken);
+        emit_exit(jc, true, op->pc + 2, op->index + 1u, true);
+        return true;
+    }
+    case RP2040_OP_BX:
+    case RP2040_OP_BLX:
+        /* Exception returns and interworking faults belong to the core */
+        ld(e, EAX, op->rm);
+        EMIT(e, 0xA8, 0x01);
+        add_stub(jc, jcc32(e, CC_E), STUB_STEP, op, 0);
+        EMIT(e, 0x3D); emit32(e, 0xF0000000);
+        add_stub(jc, jcc32(e, CC_AE), STUB_STEP, op, 0);
+        if (op->opcode == RP2040_OP_BLX) mov_m_imm(e, GR(14), (op->pc + 2) | 1);
+        EMIT(e, 0x83, 0xE0, 0xFE, 0x89, 0x43, F_NEXT_PC);
+        emit_exit(jc, false, 0, op->index + 1u, false);
+        return true;
+    case RP2040_OP_MOV_PC:
+        ld(e, EAX, op->rm);
+        EMIT(e, 0x83, 0xE0, 0xFE, 0x89, 0x43, F_NEXT_PC);
+        emit_exit(jc, false, 0, op->index + 1u, false);
+        return true;
+    case RP2040_OP_POP_PC:
+        count = (uint32_t)__builtin_popcount(op->imm);
+        bytes = count * 4 + 4;
+        ld(e, EAX, 13);
+        emit_sram_check(jc, op, bytes, 4, false);
+        EMIT(e, 0x8B, 0x44, 0x0A, (uint8_t)(count * 4));    /* New PC first: nothing changes if it faults */
+        EMIT(e, 0xA8, 0x01);
+        add_stub(jc, jcc32(e, CC_E), STUB_STEP, op, 0);
+        EMIT(e, 0x3D); emit32(e, 0xF0000000);
+        add_stub(jc, jcc32(e, CC_AE), STUB_STEP, op, 0);
+        EMIT(e, 0x83, 0xE0, 0xFE, 0x89, 0x43, F_NEXT_PC);
+        emit_load_list(e, op->imm);
+        EMIT(e, 0x83, 0x43, GR(13), (uint8_t)bytes);
+        emit_exit(jc, false, 0, op->index + 1u, false);
+        return true;
+    case RP2040_OP_EXIT:
+        emit_exit(jc, true, op->pc, op->index, true);
+        return true;
+    case RP2040_OP_EXIT_STEP:
+        movb_m_imm(e, F_STATUS, JIT_STEP);
+        emit_exit(jc, true, op->pc, op->index, false);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Flags an op writes, reads, and whether it can leave the block */
+static unsigned op_flag_defs(const rp2040_block_op_t *op)
+{
+    switch (op->opcode) {
+    case RP2040_OP_MOVS_IMM: case RP2040_OP_MOVS_REG: case RP2040_OP_MUL:
+    case RP2040_OP_AND: case RP2040_OP_EOR: case RP2040_OP_ORR: case RP2040_OP_BIC:
+    case RP2040_OP_MVN: case RP2040_OP_TST:
+    case RP2040_OP_LSL_REG: case RP2040_OP_LSR_REG: case RP2040_OP_ASR_REG: case RP2040_OP_ROR_REG:
+        return FLAG_N | FLAG_Z;
+    case RP2040_OP_LSL_IMM: case RP2040_OP_LSR_IMM: case RP2040_OP_ASR_IMM:
+        return FLAG_N | FLAG_Z | FLAG_C;
+    case RP2040_OP_ADDS_IMM: case RP2040_OP_ADDS_REG: case RP2040_OP_SUBS_IMM: case RP2040_OP_SUBS_REG:
+    case RP2040_OP_ADC: case RP2040_OP_SBC: case RP2040_OP_RSB:
+    case RP2040_OP_CMP_IMM: case RP2040_OP_CMP_REG: case RP2040_OP_CMN_REG:
+        return FLAGS_ALL;
+    default:
+        return 0;
+    }
+}
+
+static unsigned op_flag_uses(const rp2040_block_op_t *op)
+{
+    static const unsigned cond_uses[8] = {
+        FLAG_Z, FLAG_C, FLAG_N, FLAG_V, FLAG_C | FLAG_Z, FLAG_N | FLAG_V,
+        FLAG_Z | FLAG_N | FLAG_V, 0
+    };
+
+    switch (op->opcode) {
+    case RP2040_OP_ADC: case RP2040_OP_SBC:
+    case RP2040_OP_LSL_REG: case RP2040_OP_LSR_REG: case RP2040_OP_ASR_REG: case RP2040_OP_ROR_REG:
+        return FLAG_C;      /* Register shifts by 0 keep C */
+    case RP2040_OP_BCOND:
+        return cond_uses[op->rm >> 1];
+    default:
+        return 0;
+    }
+}
+
+static bool op_may_exit(const rp2040_block_op_t *op)
+{
+    switch (op->opcode) {
+    case RP2040_OP_LDR_LIT: case RP2040_OP_LDR_IMM: case RP2040_OP_LDRH_IMM: case RP2040_OP_LDRB_IMM:
+    case RP2040_OP_STR_IMM: case RP2040_OP_STRH_IMM: case RP2040_OP_STRB_IMM:
+    case RP2040_OP_LDR_REG: case RP2040_OP_LDRH_REG: case RP2040_OP_LDRB_REG:
+    case RP2040_OP_LDRSH_REG: case RP2040_OP_LDRSB_REG:
+    case RP2040_OP_STR_REG: case RP2040_OP_STRH_REG: case RP2040_OP_STRB_REG:
+    case RP2040_OP_PUSH: case RP2040_OP_POP: case RP2040_OP_LDM: case RP2040_OP_STM:
+        return true;
+    default:
+        return op->opcode >= RP2040_OP_B;
+    }
+}
+
+static bool jit_pages_clear(rp2040_jit_t *jit, const rp2040_block_t *block, uint8_t *pages)
+{
+    uint32_t first = (block->start_pc - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    uint32_t last = (block->end_pc - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+
+    for (uint32_t page = first; page <= last && page < jit->num_pages; page++) {
+        if (pages[page]) return false;
+    }
+    return true;
+}
+
+static int jit_add_link(rp2040_jit_t *jit, uint32_t site, uint32_t target_pc)
+{
+    if (jit->num_links == jit->links_capacity) {
+        size_t capacity = jit->links_capacity ? jit->links_capacity * 2 : 256;
+        rp2040_jit_link_t *links = (rp2040_jit_link_t *)realloc(jit->links, capacity * sizeof(rp2040_jit_link_t));
+        if (!links) return -1;
+        jit->links = links;
+        jit->links_capacity = capacity;
+    }
+    jit->links[jit->num_links].site = site;
+    jit->links[jit->num_links].target_pc = target_pc;
+    jit->num_links++;
+    return 0;
+}
+
+/**
+ * Make the code cache writable (and not executable) or executable (and
+ * not writable). Returns -1 if the protection cannot be changed.
+ */
+static int jit_protect(rp2040_jit_t *jit, bool writable)
+{
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC;
+
+    if (mprotect(jit->code, jit->size, prot) < 0) {
+        fprintf(stderr, "Failed to make the JIT code cache %s\n", writable ? "writable" : "executable");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Emit a block into the writable code cache and chain it to its
+ * neighbours. Returns 0 on success, -1 if the block stays interpreted.
+ */
+static int jit_emit_block(rp2040_system_t *sys, int core_id, rp2040_block_t *block)
+{
+    rp2040_jit_t *jit = sys->engines[core_id].jit;
+    static _Thread_local jit_compiler_t jc;     /* One per core thread */
+    unsigned live_after[RP2040_BLOCK_MAX_INSTRS + 1];
+
+    if (!jit_pages_clear(jit, block, jit->nojit_pages)) {
+        block->jit_disabled = true;
+        return -1;
+    }
+
+    if (jit->size - jit->used < JIT_BLOCK_MAX) {
+        rp2040_jit_flush(sys, core_id);
+    }
+
+    /* Flag liveness: drop flag updates overwritten before anything can observe them */
+    unsigned live = FLAGS_ALL;
+    for (int i = block->num_ops - 1; i >= 0; i--) {
+        const rp2040_block_op_t *op = &block->ops[i];
+        live_after[i] = live;
+        live = (live & ~op_flag_defs(op)) | op_flag_uses(op);
+        if (op_may_exit(op)) live = FLAGS_ALL;
+    }
+
+    jc.e.code = jit->code;
+    jc.e.pos = jit->used;
+    jc.e.limit = jit->used + JIT_BLOCK_MAX;
+    jc.block = block;
+    jc.watch = sys->debug->num_watchpoints != 0;
+    jc.smp = sys->smp != NULL;
+    jc.num_stubs = 0;
+    jc.num_chains = 0;
+
+    /* Entry: leave to the dispatcher once the budget is spent */
+    size_t entry = jc.e.pos;
+    EMIT(&jc.e, 0x83, 0x7B, F_BUDGET, 0x00, 0x7F, 12);  /* cmp [budget], 0; jg body */
+    mov_m_imm(&jc.e, F_NEXT_PC, block->start_pc);
+    patch32(&jc.e, jmp32(&jc.e), JIT_EPILOGUE);
+
+    for (uint16_t i = 0; i < block->num_ops; i++) {
+        if (!emit_op(&jc, &block->ops[i], live_after[i])) {
+            block->jit_disabled = true;
+            jit->rejected++;
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < jc.num_stubs; i++) {
+        jit_stub_t *stub = &jc.stubs[i];
+        patch32(&jc.e, stub->site, jc.e.pos);
+        if (stub->kind == STUB_STORE) {
+            /* The store completed: resume after it */
+            movb_m_imm(&jc.e, F_STATUS, JIT_STORE);
+            movb_m_imm(&jc.e, F_STORE_LEN, (uint8_t)stub->len);
+            emit_exit(&jc, true, stub->op->pc + 2, stub->op->index + 1u, false);
+        } else if (stub->kind == STUB_WATCH_READ || stub->kind == STUB_WATCH_WRITE) {
+            /* Before the access, with the SRAM offset still in ecx */
+            EMIT(&jc.e, 0x8D, 0x81); emit32(&jc.e, RP2040_SRAM_BASE);   /* lea eax, [rcx + base] */
+            EMIT(&jc.e, 0x89, 0x43, F_STORE_ADDR);
+            movb_m_imm(&jc.e, F_STORE_LEN, (uint8_t)stub->len);
+            movb_m_imm(&jc.e, F_STATUS, stub->kind == STUB_WATCH_WRITE ? JIT_WATCH_WRITE : JIT_WATCH_READ);
+            emit_exit(&jc, true, stub->op->pc, stub->op->index, false);
+        } else {
+            movb_m_imm(&jc.e, F_STATUS, stub->kind == STUB_SIDE ? JIT_SIDE : JIT_STEP);
+            mov_m_imm(&jc.e, F_EXIT_BLOCK, block->start_pc);
+            emit_exit(&jc, true, stub->op->pc, stub->op->index, false);
+        }
+    }
+
+    if (jc.e.pos > jc.e.limit) {
+        block->jit_disabled = true;
+        jit->rejected++;
+        return -1;
+    }
+
+    jit->used = (jc.e.pos + 15) & ~(size_t)15;
+    block->jit_code = jit->code + entry;
+    jit->compiled++;
+
+    uint32_t first = (block->start_pc - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    uint32_t last = (block->end_pc - 1 - RP2040_SRAM_BASE) >> RP2040_ICACHE_PAGE_SHIFT;
+    for (uint32_t page = first; page <= last && page < jit->num_pages; page++) {
+        jit->jit_pages[page] = 1;
+    }
+
+    /* Chain this block's exits, and earlier exits waiting for this block */
+    for (int i = 0; i < jc.num_chains; i++) {
+        rp2040_block_t *target = rp2040_block_lookup(sys->engines[core_id].blocks, jc.chains[i].target_pc);
+        if (target && target->jit_code) {
+            patch32(&jc.e, jc.chains[i].site, (size_t)(target->jit_code - jit->code));
+            jit->chained++;
+        } else {
+            jit_add_link(jit, jc.chains[i].site, jc.chains[i].target_pc);
+        }
+    }
+
+    for (size_t i = 0; i < jit->num_links; ) {
+        if (jit->links[i].target_pc == block->start_pc) {
+            patch32(&jc.e, jit->links[i].site, entry);
+            jit->links[i] = jit->links[--jit->num_links];
+            jit->chained++;
+        } else {
+            i++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Compile a block with the code cache writable for just as long as it
+ * takes. Returns 0 on success, -1 if the block stays interpreted.
+ */
+static int jit_compile(rp2040_system_t *sys, int core_id, rp2040_block_t *block)
+{
+    rp2040_jit_t *jit = sys->engines[core_id].jit;
+
+    if (jit_protect(jit, true) < 0) {
+        block->jit_disabled = true;
+        return -1;
+    }
+
+    int result = jit_emit_block(sys, core_id, block);
+
+    if (jit_protect(jit, false) < 0) {
+        /* Nothing in the cache can run any more */
+        rp2040_jit_flush(sys, core_id);
+        return -1;
+    }
+    return result;
+}
+
+/**
+ * Send a compiled block back to the interpreter. Chained jumps into it
+ * keep working: its entry now always exits to the dispatcher.
+ */
+static void jit_disable(rp2040_block_t *block)
+{
+    uint8_t *entry = (uint8_t *)block->jit_code;
+
+    entry[4] = 0x66;    /* jg body -> 2-byte nop */
+    entry[5] = 0x90;
+    block->jit_code = NULL;
+    block->jit_disabled = true;
+}
+
+/**
+ * Run compiled code starting at a block until the budget is spent or
+ * control leaves compiled code. Returns an RP2040_BLOCK_* result.
+ */
+static int jit_run(rp2040_system_t *sys, int core_id, rp2040_block_t *block, int32_t budget)
+{
+    rp2040_engine_t *engine = &sys->engines[core_id];
+    rp2040_jit_t *jit = engine->jit;
+    arm_core_state_t *core = sys->cores[core_id];
+    jit_frame_t frame;
+
+    memcpy(frame.r, core->r, sizeof(core->r));
+    frame.r[13] = core->sp;
+    frame.r[14] = core->lr;
+    frame.r[15] = 0;
+    frame.n = (core->psr & PSR_N_BIT) != 0;
+    frame.z = (core->psr & PSR_Z_BIT) != 0;
+    frame.c = (core->psr & PSR_C_BIT) != 0;
+    frame.v = (core->psr & PSR_V_BIT) != 0;
+    frame.next_pc = core->pc;
+    frame.budget = budget;
+    frame.status = JIT_DONE;
+    frame.exit_block = 0;
+    frame.retired = 0;
+    frame.sram = sys->sram->data;
+    frame.code_pages = sys->code_pages;
+    frame.watch_pages = sys->debug->watch_pages;
+
+    jit_enter_t enter = (jit_enter_t)(void *)(jit->code + JIT_ENTER);
+    enter(&frame, block->jit_code);
+    jit->native_runs++;
+
+    memcpy(core->r, frame.r, sizeof(core->r));
+    core->sp = frame.r[13];
+    core->lr = frame.r[14];
+    core->pc = frame.next_pc;
+    core->psr = (core->psr & ~(PSR_N_BIT | PSR_Z_BIT | PSR_C_BIT | PSR_V_BIT)) |
+                (frame.n ? PSR_N_BIT : 0) | (frame.z ? PSR_Z_BIT : 0) |
+                (frame.c ? PSR_C_BIT : 0) | (frame.v ? PSR_V_BIT : 0);
+    engine->cycles += frame.retired;
+
+    switch (frame.status) {
+    case JIT_STORE:
+        rp2040_code_written(sys, core_id, frame.store_addr, frame.store_len);
+        return RP2040_BLOCK_DONE;
+    case JIT_WATCH_READ:
+    case JIT_WATCH_WRITE:
+        if (rp2040_debug_watch_hit(sys->debug, frame.store_addr, frame.store_len,
+                                   frame.status == JIT_WATCH_WRITE)) {
+            rp2040_watchpoint_hit(sys, core_id, frame.store_addr, frame.store_len,
+                                  frame.status == JIT_WATCH_WRITE);
+            return RP2040_BLOCK_STOP;
+        }
+        /* Unwatched address on a watched page */
+        return RP2040_BLOCK_STEP;
+    case JIT_SIDE: {
+        /* MMIO (or a misaligned access): give up on blocks that keep doing it */
+        rp2040_block_t *exited = rp2040_block_lookup(engine->blocks, frame.exit_block);
+        jit->side_exits++;
+        if (exited && exited->jit_code && ++exited->jit_side_exits >= RP2040_JIT_MAX_SIDE_EXITS &&
+            jit_protect(jit, true) == 0) {
+            jit_disable(exited);
+            if (jit_protect(jit, false) < 0) rp2040_jit_flush(sys, core_id);
+        }
+        return RP2040_BLOCK_STEP;
+    }
+    case JIT_STEP:
+        return RP2040_BLOCK_STEP;
+    default:
+        return RP2040_BLOCK_DONE;
+    }
+}
+
+/**
+ * Initialize the JIT and its code cache
+ */
+int rp2040_jit_init(rp2040_jit_t *jit)
+{
+    if (!jit) return -1;
+
+    memset(jit, 0, sizeof(rp2040_jit_t));
+
+    void *code = mmap(NULL, RP2040_JIT_CACHE_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        fprintf(stderr, "Failed to map JIT code cache\n");
+        return -1;
+    }
+
+    jit->code = (uint8_t *)code;
+    jit->size = RP2040_JIT_CACHE_SIZE;
+    jit->num_pages = (RP2040_SRAM_SIZE + RP2040_ICACHE_PAGE_SIZE - 1) >> RP2040_ICACHE_PAGE_SHIFT;
+    jit->jit_pages = (uint8_t *)calloc(jit->num_pages, 1);
+    jit->nojit_pages = (uint8_t *)calloc(jit->num_pages, 1);
+    if (!jit->jit_pages || !jit->nojit_pages) {
+        fprintf(stderr, "Failed to allocate JIT page maps\n");
+        rp2040_jit_destroy(jit);
+        return -1;
+    }
+
+    /* Shared entry and exit */
+    static const uint8_t runtime[] = {
+        0x5B, 0xC3,                         /* JIT_EPILOGUE: pop rbx; ret */
+        0x53, 0x48, 0x89, 0xFB, 0xFF, 0xE6  /* JIT_ENTER: push rbx; mov rbx, rdi; jmp rsi */
+    };
+    memcpy(jit->code, runtime, sizeof(runtime));
+    jit->used = JIT_RUNTIME_SIZE;
+
+    if (jit_protect(jit, false) < 0) {
+        rp2040_jit_destroy(jit);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Unmap the code cache
+ */
+void rp2040_jit_destroy(rp2040_jit_t *jit)
+{
+    if (!jit) return;
+
+    if (jit->code) munmap(jit->code, jit->size);
+    free(jit->links);
+    free(jit->jit_pages);
+    free(jit->nojit_pages);
+    memset(jit, 0, sizeof(rp2040_jit_t));
+}
+
+#else /* !RP2040_JIT_SUPPORTED */
+
+int rp2040_jit_init(rp2040_jit_t *jit)
+{
+    fprintf(stderr, "JIT is only available on x86-64 hosts\n");
+    return -1;
+}
+
+void rp2040_jit_destroy(rp2040_jit_t *jit)
+{
+}
+
+#endif /* RP2040_JIT_SUPPORTED */
+
+/**
+ * Run up to budget instructions on a core: compiled code for hot blocks,
+ * the threaded interpreter for the rest. When compiled code leaves at an
+ * instruction it does not handle, the interpreter gets a go at it (it
+ * knows the SIO registers). Returns an RP2040_BLOCK_* result; on
+ * RP2040_BLOCK_STEP the caller single-steps the instruction at PC.
+ */
+int rp2040_jit_step(rp2040_system_t *sys, int core_id, int32_t budget)
+{
+    if (!sys || core_id < 0 || core_id >= RP2040_NUM_CORES || !sys->engines[core_id].jit) {
+        return -1;
+    }
+
+    rp2040_block_cache_t *blocks = sys->engines[core_id].blocks;
+    arm_core_state_t *core = sys->cores[core_id];
+    rp2040_block_t *block = rp2040_block_lookup(blocks, core->pc);
+    if (!block) {
+        block = rp2040_block_translate(sys, core_id, core->pc);
+    }
+
+    if (!block) return RP2040_BLOCK_STEP;
+
+#ifdef RP2040_JIT_SUPPORTED
+    if (!block->jit_code && !block->jit_disabled && block->exec_count >= RP2040_JIT_THRESHOLD) {
+        jit_compile(sys, core_id, block);
+    }
+
+    if (block->jit_code) {
+        int result = jit_run(sys, core_id, block, budget);
+        if (result != RP2040_BLOCK_STEP) return result;
+
+        block = rp2040_block_lookup(blocks, core->pc);
+        if (!block) {
+            block = rp2040_block_translate(sys, core_id, core->pc);
+        }
+        if (!block) return RP2040_BLOCK_STEP;
+    }
+#endif
+
+    return rp2040_block_run(sys, core_id, block);
+}
+
+/**
+ * A write hit SRAM: if a core's compiled code lives there, flush its code
+ * cache and keep those pages interpreted
+ */
+void rp2040_jit_invalidate(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len)
+{
+    if (!sys || !sys->engines[core_id].jit || !sys->engines[core_id].jit->jit_pages || len == 0) return;
+
+    rp2040_jit_t *jit = sys->engines[core_id].jit;
+    uint64_t end = (uint64_t)addr + len;
+    if (end <= RP2040_SRAM_BASE || addr >= RP2040_SRAM_BASE + RP2040_SRAM_SIZE) return;
+
+    uint32_t lo = addr < RP2040_SRAM_BASE ? 0 : addr - RP2040_SRAM_BASE;
+    uint32_t hi = end > RP2040_SRAM_BASE + RP2040_SRAM_SIZE ? RP2040_SRAM_SIZE : (uint32_t)(end - RP2040_SRAM_BASE);
+    bool hit = false;
+
+    for (uint32_t page = lo >> RP2040_ICACHE_PAGE_SHIFT; page <= (hi - 1) >> RP2040_ICACHE_PAGE_SHIFT; page++) {
+        if (jit->jit_pages[page]) {
+            jit->nojit_pages[page] = 1;
+            hit = true;
+        }
+    }
+
+    if (hit) rp2040_jit_flush(sys, core_id);
+}
+
+/**
+ * Drop all of a core's compiled code
+ */
+void rp2040_jit_flush(rp2040_system_t *sys, int core_id)
+{
+    if (!sys || !sys->engines[core_id].jit || !sys->engines[core_id].jit->code) return;
+
+    rp2040_jit_t *jit = sys->engines[core_id].jit;
+    jit->used = JIT_RUNTIME_SIZE;
+    jit->num_links = 0;
+    memset(jit->jit_pages, 0, jit->num_pages);
+    jit->flushes++;
+
+    for (uint32_t i = 0; i < RP2040_BLOCK_BUCKETS; i++) {
+        for (rp2040_block_t *block = sys->engines[core_id].blocks->buckets[i]; block; block = block->next) {
+            block->jit_code = NULL;
+        }
+    }
+}
@@ -1,10 +1,69 @@
 // src/rp2040/rp2040.c
 #include "rp2040/rp2040.h"
+#include "rp2040/smp.h"
 #include "isa/arm/decoder.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/**
+ * Core loads and fetches: SRAM, then the SIO registers, then whatever
+ * sits on the AHB-Lite bus
+ */
+static int rp2040_bus_read(void *context, int core_id, uint32_t addr, uint32_t size, uint32_t *value)
+{
+    rp2040_system_t *sys = (rp2040_system_t *)context;
+    uint32_t offset = addr - RP2040_SRAM_BASE;
+    
+    if (offset <= RP2040_SRAM_SIZE - size) {
+        *value = size == 4 ? sram_read_word(sys->sram, offset) :
+                 size == 2 ? sram_read_halfword(sys->sram, offset) : sram_read_byte(sys->sram, offset);
+        return 0;
+    }
+    
+    offset = addr - RP2040_SIO_BASE;
+    if (offset < RP2040_SIO_SIZE && rp2040_sio_handles(offset)) {
+        if (size != 4) return -1;   /* SIO registers only take word accesses */
+        *value = rp2040_sio_read(sys->sio, core_id, offset);
+        return 0;
+    }
+    
+    return ahb_read(sys->ahb_bus, addr, size, value);
+}
+
+/**
+ * Core stores. A store into code goes down the same invalidation path as
+ * the block interpreter's and the JIT's.
+ */
+static int rp2040_bus_write(void *context, int core_id, uint32_t addr, uint32_t size, uint32_t value)
+{
+    rp2040_system_t *sys = (rp2040_system_t *)context;
+    uint32_t offset = addr - RP2040_SRAM_BASE;
+    
+    if (offset <= RP2040_SRAM_SIZE - size) {
+        if (size == 4) {
+            sram_write_word(sys->sram, offset, value);
+        } else if (size == 2) {
+            sram_write_halfword(sys->sram, offset, (uint16_t)value);
+        } else {
+            sram_write_byte(sys->sram, offset, (uint8_t)value);
+        }
+        if (rp2040_is_code(sys, addr, size)) {
+            rp2040_code_written(sys, core_id, addr, size);
+        }
+        return 0;
+    }
+    
+    offset = addr - RP2040_SIO_BASE;
+    if (offset < RP2040_SIO_SIZE && rp2040_sio_handles(offset)) {
+        if (size != 4) return -1;
+        rp2040_sio_write(sys->sio, core_id, offset, value);
+        return 0;
+    }
+    
+    return ahb_write(sys->ahb_bus, addr, size, value);
+}
+
 /**
  * Create and initialize an RP2040 system
  */
@@ -31,12 +90,69 @@ rp2040_system_t *rp2040_create(void)
     
     /* Allocate SRAM */
     sys->sram = (sram_t *)malloc(sizeof(sram_t));
-    if (!sys->sram) {
+    if (!sys->sram || sram_init(sys->sram, RP2040_SRAM_SIZE) < 0) {
         fprintf(stderr, "Failed to allocate SRAM\n");
+        free(sys->sram);
+        sys->sram = NULL;
+        rp2040_destroy(sys);
+        return NULL;
+    }
+    
+    /* Connect each core to memory, and allocate its predecode and block caches for code running from SRAM */
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        rp2040_engine_t *engine = &sys->engines[i];
+        
+        engine->bus.context = sys;
+        engine->bus.master = i;
+        engine->bus.read = rp2040_bus_read;
+        engine->bus.write = rp2040_bus_write;
+        sys->cores[i]->bus = &engine->bus;
+        
+        engine->icache = (rp2040_icache_t *)malloc(sizeof(rp2040_icache_t));
+        if (!engine->icache || rp2040_icache_init(engine->icache, RP2040_SRAM_BASE, RP2040_SRAM_SIZE) < 0) {
+            fprintf(stderr, "Failed to allocate instruction cache for core %d\n", i);
+            free(engine->icache);
+            engine->icache = NULL;
+            rp2040_destroy(sys);
+            return NULL;
+        }
+        
+        engine->blocks = (rp2040_block_cache_t *)malloc(sizeof(rp2040_block_cache_t));
+        if (!engine->blocks || rp2040_block_cache_init(engine->blocks) < 0) {
+            fprintf(stderr, "Failed to allocate block cache for core %d\n", i);
+            free(engine->blocks);
+            engine->blocks = NULL;
+            rp2040_destroy(sys);
+            return NULL;
+        }
+    }
+    
+    /* Allocate the shared map of pages holding code */
+    sys->code_pages = (uint8_t *)calloc(RP2040_SRAM_PAGES, 1);
+    if (!sys->code_pages) {
+        fprintf(stderr, "Failed to allocate code page map\n");
+        rp2040_destroy(sys);
+        return NULL;
+    }
+    
+    /* Allocate SIO */
+    sys->sio = (rp2040_sio_t *)malloc(sizeof(rp2040_sio_t));
+    if (!sys->sio) {
+        fprintf(stderr, "Failed to allocate SIO\n");
+        rp2040_destroy(sys);
+        return NULL;
+    }
+    rp2040_sio_init(sys->sio);
+    
+    /* Allocate breakpoint and watchpoint state */
+    sys->debug = (rp2040_debug_t *)malloc(sizeof(rp2040_debug_t));
+    if (!sys->debug || rp2040_debug_init(sys->debug, RP2040_SRAM_BASE, RP2040_SRAM_SIZE) < 0) {
+        fprintf(stderr, "Failed to allocate debug state\n");
+        free(sys->debug);
+        sys->debug = NULL;
         rp2040_destroy(sys);
         return NULL;
     }
-    sram_init(sys->sram, RP2040_SRAM_SIZE);
     
     /* Allocate GPIO */
     sys->gpio = (gpio_state_t *)malloc(sizeof(gpio_state_t));
@@ -72,8 +188,10 @@ rp2040_system_t *rp2040_create(void)
     sys->clock_freq = RP2040_CLOCK_HZ;
     sys->halted = false;
     sys->breakpoint_triggered = false;
-    sys->num_breakpoints = 0;
+    sys->watchpoint_triggered = false;
     sys->active_core = 0;
+    sys->next_core = 0;
+    sys->exec_mode = RP2040_EXEC_BLOCK;
     
     return sys;
 }
@@ -94,6 +212,33 @@ void rp2040_destroy(rp2040_system_t *sys)
         free(sys->sram);
     }
     
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        rp2040_engine_t *engine = &sys->engines[i];
+        
+        if (engine->icache) {
+            rp2040_icache_destroy(engine->icache);
+            free(engine->icache);
+        }
+        
+        if (engine->jit) {
+            rp2040_jit_destroy(engine->jit);
+            free(engine->jit);
+        }
+        
+        if (engine->blocks) {
+            rp2040_block_cache_destroy(engine->blocks);
+            free(engine->blocks);
+        }
+    }
+    
+    free(sys->code_pages);
+    free(sys->sio);
+    
+    if (sys->debug) {
+        rp2040_debug_destroy(sys->debug);
+        free(sys->debug);
+    }
+    
     if (sys->gpio) {
         gpio_destroy(sys->gpio);
         free(sys->gpio);
@@ -166,60 +311,210 @@ int rp2040_load_binary(rp2040_system_t *sys, uint32_t addr, const uint8_t *data,
     
     uint32_t offset = addr - RP2040_SRAM_BASE;
     memcpy(sys->sram->data + offset, data, len);
+    rp2040_invalidate_code(sys, addr, len);
     
     return 0;
 }
 
 /**
- * Step a single core through one instruction
+ * Account for an executed instruction: count it in the core's cycles, or
+ * halt the system on BKPT (which does not retire)
  */
-int rp2040_step_core(rp2040_system_t *sys, int core_id)
+static int core_retire(rp2040_system_t *sys, int core_id, int result, uint32_t instr)
 {
-    if (!sys || core_id < 0 || core_id >= RP2040_NUM_CORES) {
+    if (result == ARM_EXEC_BREAK) {
+        __atomic_store_n(&sys->halted, true, __ATOMIC_RELAXED);
+        return 0;
+    }
+    if (result < 0) {
+        fprintf(stderr, "Execution error at 0x%08x: 0x%08x\n", sys->cores[core_id]->pc, instr);
         return -1;
     }
     
+    sys->engines[core_id].cycles++;
+    return 0;
+}
+
+/**
+ * Execute one instruction on a core, counting it in the core's cycles.
+ * With watch set, an access hitting a watchpoint stops the core before
+ * the instruction executes.
+ */
+static int core_step(rp2040_system_t *sys, int core_id, bool watch)
+{
     arm_core_state_t *core = sys->cores[core_id];
+    rp2040_engine_t *engine = &sys->engines[core_id];
     
     /* Check breakpoint */
-    for (int i = 0; i < sys->num_breakpoints; i++) {
-        if (sys->breakpoints[i] == core->pc) {
-            sys->breakpoint_triggered = true;
-            return 1;  /* Breakpoint hit */
-        }
+    if (rp2040_debug_breakpoint(sys->debug, core->pc)) {
+        rp2040_breakpoint_hit(sys, core_id);
+        return 1;  /* Breakpoint hit */
+    }
+    
+    /* Check watchpoints */
+    uint32_t addr, len;
+    bool write;
+    if (watch && sys->debug->num_watchpoints &&
+        rp2040_block_access(sys, core_id, core->pc, &addr, &len, &write) &&
+        rp2040_debug_watch_hit(sys->debug, addr, len, write)) {
+        rp2040_watchpoint_hit(sys, core_id, addr, len, write);
+        return 1;  /* Watchpoint hit */
     }
     
-    /* Fetch instruction from memory */
     uint32_t pc = core->pc;
-    uint16_t hw1, hw2;
+    int result;
+    
+    /* Predecoded hit: no fetch, no decode */
+    rp2040_icache_entry_t *entry = rp2040_icache_lookup(engine->icache, pc);
+    
+    if (!entry) {
+        /* Fetch instruction from memory */
+        uint32_t hw1, hw2;
+        
+        rp2040_mark_code(sys, pc, pc + 2);
+        if (core->bus->read(sys, core_id, pc, 2, &hw1) < 0) {
+            fprintf(stderr, "Fetch error at 0x%08x\n", pc);
+            return -1;
+        }
+        
+        /* Determine if 16-bit or 32-bit instruction */
+        uint32_t instr;
+        uint8_t instr_len = 2;  /* bytes */
+        
+        if ((hw1 & 0xE000) == 0xE000 && (hw1 & 0x1800) != 0) {
+            /* 32-bit Thumb-2 instruction */
+            rp2040_mark_code(sys, pc + 2, pc + 4);
+            if (core->bus->read(sys, core_id, pc + 2, 2, &hw2) < 0) {
+                fprintf(stderr, "Fetch error at 0x%08x\n", pc + 2);
+                return -1;
+            }
+            instr = (hw2 << 16) | hw1;
+            instr_len = 4;
+        } else {
+            /* 16-bit Thumb instruction */
+            instr = hw1;
+            instr_len = 2;
+        }
+        
+        entry = rp2040_icache_fill(engine->icache, pc, instr, instr_len);
+        if (!entry) {
+            /* Not cacheable: decode and execute the slow way */
+            result = arm_thumb2_execute(core, instr, instr_len);
+            return core_retire(sys, core_id, result, instr);
+        }
+    }
+    
+    /* Execute */
+    result = entry->exec(core, entry);
+    return core_retire(sys, core_id, result, entry->instr.raw_instruction);
+}
+
+/**
+ * Bring cycle_count up to date with the cores' own counts
+ */
+static void sync_cycles(rp2040_system_t *sys)
+{
+    uint64_t total = 0;
     
-    hw1 = sram_read_halfword(sys->sram, pc - RP2040_SRAM_BASE);
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        total += sys->engines[i].cycles;
+    }
+    sys->cycle_count = total;
+}
+
+/**
+ * Step a single core through one instruction
+ */
+int rp2040_step_core(rp2040_system_t *sys, int core_id)
+{
+    if (!sys || core_id < 0 || core_id >= RP2040_NUM_CORES) {
+        return -1;
+    }
+    
+    int result = core_step(sys, core_id, false);
+    sync_cycles(sys);
+    
+    return result;
+}
+
+/**
+ * Run one translated block on a core, or one instruction if the code at
+ * PC cannot be translated, without touching cycle_count. Only uses the
+ * core's own engines, so each core may call this from its own thread.
+ * Returns 1 on a breakpoint or watchpoint hit.
+ */
+int rp2040_engine_step(rp2040_system_t *sys, int core_id)
+{
+    if (sys->exec_mode == RP2040_EXEC_STEP) {
+        return core_step(sys, core_id, true);
+    }
     
-    /* Determine if 16-bit or 32-bit instruction */
-    uint32_t instr;
-    uint8_t instr_len = 2;  /* bytes */
+    arm_core_state_t *core = sys->cores[core_id];
+    rp2040_engine_t *engine = &sys->engines[core_id];
+    if (rp2040_debug_breakpoint(sys->debug, core->pc)) {
+        rp2040_breakpoint_hit(sys, core_id);
+        return 1;
+    }
     
-    if ((hw1 & 0xE000) == 0xE000 && (hw1 & 0x1800) != 0) {
-        /* 32-bit Thumb-2 instruction */
-        hw2 = sram_read_halfword(sys->sram, pc + 2 - RP2040_SRAM_BASE);
-        instr = (hw2 << 16) | hw1;
-        instr_len = 4;
+    int result;
+    if (sys->exec_mode == RP2040_EXEC_JIT) {
+        result = rp2040_jit_step(sys, core_id, RP2040_JIT_QUANTUM);
     } else {
-        /* 16-bit Thumb instruction */
-        instr = hw1;
-        instr_len = 2;
+        rp2040_block_t *block = rp2040_block_lookup(engine->blocks, core->pc);
+        if (!block) {
+            block = rp2040_block_translate(sys, core_id, core->pc);
+        }
+        result = block ? rp2040_block_run(sys, core_id, block) : RP2040_BLOCK_STEP;
     }
     
-    /* Decode and execute */
-    int result = arm_thumb2_execute(core, instr, instr_len);
-    if (result < 0) {
-        fprintf(stderr, "Execution error at 0x%08x: 0x%08x\n", pc, instr);
+    if (result < 0) return -1;
+    if (result == RP2040_BLOCK_DONE) return 0;
+    if (result == RP2040_BLOCK_STOP) return 1;
+    
+    /* Untranslatable instruction: let the core execute it */
+    engine->blocks->stepped++;
+    return core_step(sys, core_id, true);
+}
+
+/**
+ * Run one translated block on a core, or one instruction if the code at
+ * PC cannot be translated. In JIT mode, compiled code may chain through
+ * up to RP2040_JIT_QUANTUM instructions. Blocks end before breakpoints
+ * and setting one flushes compiled code, so every breakpoint is reached
+ * through this check. Returns 1 on a breakpoint or watchpoint hit.
+ */
+int rp2040_step_block(rp2040_system_t *sys, int core_id)
+{
+    if (!sys || core_id < 0 || core_id >= RP2040_NUM_CORES) {
         return -1;
     }
     
-    /* Increment cycle count */
-    sys->cycle_count++;
+    int result = rp2040_engine_step(sys, core_id);
+    sync_cycles(sys);
+    
+    return result;
+}
+
+/**
+ * Select the execution engine. Returns -1 (and keeps the current mode)
+ * if the JIT is not available on this host.
+ */
+int rp2040_set_exec_mode(rp2040_system_t *sys, rp2040_exec_mode_t mode)
+{
+    if (!sys) return -1;
+    
+    for (int i = 0; mode == RP2040_EXEC_JIT && i < RP2040_NUM_CORES; i++) {
+        if (sys->engines[i].jit) continue;
+        
+        rp2040_jit_t *jit = (rp2040_jit_t *)malloc(sizeof(rp2040_jit_t));
+        if (!jit || rp2040_jit_init(jit) < 0) {
+            free(jit);
+            return -1;
+        }
+        sys->engines[i].jit = jit;
+    }
     
+    sys->exec_mode = mode;
     return 0;
 }
 
@@ -230,43 +525,53 @@ int rp2040_step(rp2040_system_t *sys)
 {
     if (!sys) return -1;
     
-    static int last_core = 0;
-    int result = rp2040_step_core(sys, last_core);
+    int result = rp2040_step_core(sys, sys->next_core);
     
-    last_core = (last_core + 1) % RP2040_NUM_CORES;
+    sys->next_core = (sys->next_core + 1) % RP2040_NUM_CORES;
     
     return result;
 }
 
 /**
- * Run until halted or breakpoint
+ * Run until halted, or a breakpoint or watchpoint is hit
  */
 int rp2040_run_until_halt(rp2040_system_t *sys)
 {
     if (!sys) return -1;
     
-    while (!sys->halted && !sys->breakpoint_triggered) {
-        if (rp2040_step(sys) < 0) {
-            return -1;
+    int core_id = 0;
+    int result = 0;
+    
+    while (!sys->halted && !sys->breakpoint_triggered &&
+           !sys->watchpoint_triggered) {
+        if (rp2040_engine_step(sys, core_id) < 0) {
+            result = -1;
+            break;
         }
+        core_id = (core_id + 1) % RP2040_NUM_CORES;
     }
     
-    return 0;
+    sync_cycles(sys);
+    return result;
 }
 
 /**
- * Run for specific number of cycles
+ * Run for specific number of cycles (block mode may overshoot by up to
+ * one block per core, JIT mode by up to one quantum per core)
  */
 int rp2040_run_cycles(rp2040_system_t *sys, uint64_t cycles)
 {
     if (!sys) return -1;
     
     uint64_t target = sys->cycle_count + cycles;
+    int core_id = 0;
     
-    while (sys->cycle_count < target && !sys->halted && !sys->breakpoint_triggered) {
-        if (rp2040_step(sys) < 0) {
+    while (sys->cycle_count < target && !sys->halted && !sys->breakpoint_triggered &&
+           !sys->watchpoint_triggered) {
+        if (rp2040_step_block(sys, core_id) < 0) {
             return -1;
         }
+        core_id = (core_id + 1) % RP2040_NUM_CORES;
     }
     
     return 0;
@@ -321,32 +626,114 @@ void rp2040_write_memory(rp2040_system_t *sys, uint32_t addr, uint32_t value)
     if (addr >= RP2040_SRAM_BASE && addr < RP2040_SRAM_BASE + RP2040_SRAM_SIZE) {
         uint32_t offset = addr - RP2040_SRAM_BASE;
         sram_write_word(sys->sram, offset, value);
+        rp2040_invalidate_code(sys, addr, 4);
     }
 }
 
 /**
- * Add a breakpoint
+ * Drop a core's predecoded instructions, translated blocks and compiled
+ * code overlapping a write. Only the thread running that core may call
+ * this while rp2040_run_threaded is running.
  */
-void rp2040_add_breakpoint(rp2040_system_t *sys, uint32_t addr)
+void rp2040_engine_invalidate(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len)
 {
-    if (!sys || sys->num_breakpoints >= 32) return;
+    rp2040_engine_t *engine = &sys->engines[core_id];
     
-    sys->breakpoints[sys->num_breakpoints++] = addr;
+    rp2040_jit_invalidate(sys, core_id, addr, len);
+    rp2040_icache_invalidate(engine->icache, addr, len);
+    rp2040_block_invalidate(engine->blocks, addr, len);
 }
 
 /**
- * Remove a breakpoint
+ * A core stored into code: drop its own stale code now, and have the
+ * other cores drop theirs (when threaded, after their current block)
  */
-void rp2040_remove_breakpoint(rp2040_system_t *sys, uint32_t addr)
+void rp2040_code_written(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len)
+{
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        if (i == core_id || !sys->smp) {
+            rp2040_engine_invalidate(sys, i, addr, len);
+        } else {
+            rp2040_smp_post_invalidate(sys->smp, i, addr, len);
+        }
+    }
+}
+
+/**
+ * Drop predecoded instructions, translated blocks and compiled code
+ * overlapping a write
+ */
+void rp2040_invalidate_code(rp2040_system_t *sys, uint32_t addr, uint32_t len)
 {
     if (!sys) return;
     
-    for (int i = 0; i < sys->num_breakpoints; i++) {
-        if (sys->breakpoints[i] == addr) {
-            sys->breakpoints[i] = sys->breakpoints[--sys->num_breakpoints];
-            break;
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        rp2040_engine_invalidate(sys, i, addr, len);
+    }
+}
+
+/**
+ * Stop the run on a breakpoint at a core's PC. If both cores hit one in
+ * the same threaded quantum, the first to get here is reported; the core
+ * is valid once the run has stopped.
+ */
+void rp2040_breakpoint_hit(rp2040_system_t *sys, int core_id)
+{
+    bool expected = false;
+    
+    if (__atomic_compare_exchange_n(&sys->breakpoint_triggered, &expected, true, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&sys->breakpoint_core, core_id, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Stop the run on a watched access, before it happens. As with
+ * breakpoints, the first core to hit one is the one reported.
+ */
+void rp2040_watchpoint_hit(rp2040_system_t *sys, int core_id, uint32_t addr, uint32_t len, bool write)
+{
+    rp2040_debug_t *debug = sys->debug;
+    bool expected = false;
+    
+    if (__atomic_compare_exchange_n(&sys->watchpoint_triggered, &expected, true, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&debug->hit_addr, addr, __ATOMIC_RELAXED);
+        __atomic_store_n(&debug->hit_len, len, __ATOMIC_RELAXED);
+        __atomic_store_n(&debug->hit_write, write, __ATOMIC_RELAXED);
+        __atomic_store_n(&debug->hit_core, core_id, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Add a breakpoint in SRAM. Returns -1 if addr is outside SRAM.
+ */
+int rp2040_add_breakpoint(rp2040_system_t *sys, uint32_t addr)
+{
+    if (!sys) return -1;
+    
+    int changed = rp2040_debug_set_breakpoint(sys->debug, addr, true);
+    if (changed < 0) return -1;
+    
+    if (changed) {
+        /* Retranslate so blocks end before it and no compiled code runs through it */
+        for (int i = 0; i < RP2040_NUM_CORES; i++) {
+            rp2040_jit_flush(sys, i);
+            rp2040_block_invalidate(sys->engines[i].blocks, addr, 2);
         }
     }
+    
+    return 0;
+}
+
+/**
+ * Remove a breakpoint
+ */
+void rp2040_remove_breakpoint(rp2040_system_t *sys, uint32_t addr)
+{
+    if (!sys) return;
+    
+    rp2040_debug_set_breakpoint(sys->debug, addr, false);
 }
 
 /**
@@ -356,7 +743,103 @@ void rp2040_clear_breakpoints(rp2040_system_t *sys)
 {
     if (!sys) return;
     
-    sys->num_breakpoints = 0;
+    rp2040_debug_clear_breakpoints(sys->debug);
+}
+
+/**
+ * Memory ops are bound with watchpoint checks only while watchpoints
+ * exist: drop translations when that changes
+ */
+static void rp2040_watch_state_changed(rp2040_system_t *sys)
+{
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        rp2040_jit_flush(sys, i);
+        rp2040_block_flush(sys->engines[i].blocks);
+    }
+}
+
+/**
+ * Add a watchpoint on [addr, addr + len) in SRAM.
+ * Returns -1 if the range is outside SRAM.
+ */
+int rp2040_add_watchpoint(rp2040_system_t *sys, uint32_t addr, uint32_t len, rp2040_watch_type_t type)
+{
+    if (!sys) return -1;
+    
+    if (rp2040_debug_add_watchpoint(sys->debug, addr, len, type) < 0) {
+        return -1;
+    }
+    
+    if (sys->debug->num_watchpoints == 1) {
+        rp2040_watch_state_changed(sys);
+    }
+    
+    return 0;
+}
+
+/**
+ * Remove watchpoints starting at addr
+ */
+void rp2040_remove_watchpoint(rp2040_system_t *sys, uint32_t addr)
+{
+    if (!sys) return;
+    
+    if (rp2040_debug_remove_watchpoint(sys->debug, addr) > 0 && sys->debug->num_watchpoints == 0) {
+        rp2040_watch_state_changed(sys);
+    }
+}
+
+/**
+ * Clear all watchpoints
+ */
+void rp2040_clear_watchpoints(rp2040_system_t *sys)
+{
+    if (!sys || sys->debug->num_watchpoints == 0) return;
+    
+    rp2040_debug_clear_watchpoints(sys->debug);
+    rp2040_watch_state_changed(sys);
+}
+
+/**
+ * Print execution statistics
+ */
+void rp2040_print_stats(rp2040_system_t *sys, FILE *out)
+{
+    if (!sys || !out) return;
+    
+    fprintf(out, "Cycles: %llu\n", (unsigned long long)sys->cycle_count);
+    
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        const rp2040_engine_t *engine = &sys->engines[i];
+        
+        fprintf(out, "Core %d: %llu cycles\n", i, (unsigned long long)engine->cycles);
+        
+        if (engine->icache) {
+            fprintf(out, "  Predecode cache: %llu hits, %llu misses (%.1f%% hit rate), %llu invalidated\n",
+                    (unsigned long long)engine->icache->hits,
+                    (unsigned long long)engine->icache->misses,
+                    rp2040_icache_hit_rate(engine->icache) * 100.0,
+                    (unsigned long long)engine->icache->invalidations);
+        }
+        
+        if (engine->blocks) {
+            fprintf(out, "  Blocks: %llu translated, %llu executed, %llu invalidated, %llu instructions stepped\n",
+                    (unsigned long long)engine->blocks->translated,
+                    (unsigned long long)engine->blocks->executed,
+                    (unsigned long long)engine->blocks->invalidated,
+                    (unsigned long long)engine->blocks->stepped);
+        }
+        
+        if (engine->jit) {
+            fprintf(out, "  JIT: %llu compiled, %llu rejected, %llu native runs, %llu chained, %llu side exits, %llu flushes\n",
+                    (unsigned long long)engine->jit->compiled,
+                    (unsigned long long)engine->jit->rejected,
+                    (unsigned long long)engine->jit->native_runs,
+                    (unsigned long long)engine->jit->chained,
+                    (unsigned long long)engine->jit->side_exits,
+                    (unsigned long long)engine->jit->flushes);
+        }
+    }
 }
 
 /**
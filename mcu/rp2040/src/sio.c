@@ -0,0 +1,110 @@
+// src/rp2040/sio.c
+#include "rp2040/sio.h"
+#include <string.h>
+
+/**
+ * Reset: FIFOs empty, all spinlocks free
+ */
+void rp2040_sio_init(rp2040_sio_t *sio)
+{
+    if (!sio) return;
+
+    memset(sio, 0, sizeof(rp2040_sio_t));
+}
+
+/**
+ * Whether offset is a register modelled here; others go to the core's bus
+ */
+bool rp2040_sio_handles(uint32_t offset)
+{
+    switch (offset) {
+    case RP2040_SIO_CPUID:
+    case RP2040_SIO_FIFO_ST:
+    case RP2040_SIO_FIFO_WR:
+    case RP2040_SIO_FIFO_RD:
+    case RP2040_SIO_SPINLOCK_ST:
+        return true;
+    default:
+        return offset >= RP2040_SIO_SPINLOCK0 && offset < RP2040_SIO_SIZE && !(offset & 3);
+    }
+}
+
+/* Entries waiting in a FIFO, as seen by either end */
+static inline uint32_t fifo_count(rp2040_sio_fifo_t *fifo)
+{
+    return __atomic_load_n(&fifo->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&fifo->head, __ATOMIC_ACQUIRE);
+}
+
+static uint32_t sio_fifo_status(rp2040_sio_t *sio, int core_id)
+{
+    uint32_t status = __atomic_load_n(&sio->errors[core_id], __ATOMIC_RELAXED);
+
+    if (fifo_count(&sio->fifo[core_id ^ 1]) != 0) status |= RP2040_SIO_FIFO_VLD;
+    if (fifo_count(&sio->fifo[core_id]) < RP2040_SIO_FIFO_DEPTH) status |= RP2040_SIO_FIFO_RDY;
+    return status;
+}
+
+/**
+ * Read a register on behalf of a core
+ */
+uint32_t rp2040_sio_read(rp2040_sio_t *sio, int core_id, uint32_t offset)
+{
+    switch (offset) {
+    case RP2040_SIO_CPUID:
+        return (uint32_t)core_id;
+    case RP2040_SIO_FIFO_ST:
+        return sio_fifo_status(sio, core_id);
+    case RP2040_SIO_FIFO_RD: {
+        rp2040_sio_fifo_t *rx = &sio->fifo[core_id ^ 1];
+        uint32_t head = __atomic_load_n(&rx->head, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&rx->tail, __ATOMIC_ACQUIRE) == head) {
+            __atomic_fetch_or(&sio->errors[core_id], RP2040_SIO_FIFO_ROE, __ATOMIC_RELAXED);
+            return 0;
+        }
+        uint32_t value = rx->data[head % RP2040_SIO_FIFO_DEPTH];
+        __atomic_store_n(&rx->head, head + 1, __ATOMIC_RELEASE);
+        return value;
+    }
+    case RP2040_SIO_SPINLOCK_ST:
+        return __atomic_load_n(&sio->spinlocks, __ATOMIC_ACQUIRE);
+    default:
+        if (offset >= RP2040_SIO_SPINLOCK0 && offset < RP2040_SIO_SIZE) {
+            /* Reading claims: nonzero if this read got the lock */
+            uint32_t bit = 1u << ((offset - RP2040_SIO_SPINLOCK0) >> 2);
+            uint32_t old = __atomic_fetch_or(&sio->spinlocks, bit, __ATOMIC_ACQ_REL);
+            return (old & bit) ? 0 : bit;
+        }
+        return 0;
+    }
+}
+
+/**
+ * Write a register on behalf of a core
+ */
+void rp2040_sio_write(rp2040_sio_t *sio, int core_id, uint32_t offset, uint32_t value)
+{
+    switch (offset) {
+    case RP2040_SIO_FIFO_ST:
+        __atomic_fetch_and(&sio->errors[core_id], ~(value & (RP2040_SIO_FIFO_WOF | RP2040_SIO_FIFO_ROE)),
+                           __ATOMIC_RELAXED);
+        return;
+    case RP2040_SIO_FIFO_WR: {
+        rp2040_sio_fifo_t *tx = &sio->fifo[core_id];
+        uint32_t tail = __atomic_load_n(&tx->tail, __ATOMIC_RELAXED);
+        if (tail - __atomic_load_n(&tx->head, __ATOMIC_ACQUIRE) >= RP2040_SIO_FIFO_DEPTH) {
+            __atomic_fetch_or(&sio->errors[core_id], RP2040_SIO_FIFO_WOF, __ATOMIC_RELAXED);
+            return;
+        }
+        tx->data[tail % RP2040_SIO_FIFO_DEPTH] = value;
+        __atomic_store_n(&tx->tail, tail + 1, __ATOMIC_RELEASE);
+        return;
+    }
+    default:
+        if (offset >= RP2040_SIO_SPINLOCK0 && offset < RP2040_SIO_SIZE) {
+            /* Any write releases */
+            uint32_t bit = 1u << ((offset - RP2040_SIO_SPINLOCK0) >> 2);
+            __atomic_fetch_and(&sio->spinlocks, ~bit, __ATOMIC_RELEASE);
+        }
+        return;
+    }
+}
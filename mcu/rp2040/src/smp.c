@@ -0,0 +1,168 @@
+// src/rp2040/smp.c
+#include "rp2040/smp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+_Static_assert(RP2040_NUM_CORES == 2, "One extra thread per run assumes two cores");
+
+typedef struct {
+    rp2040_smp_t *smp;
+    int core_id;
+} smp_worker_t;
+
+/**
+ * Queue [addr, addr + len) for another core to drop from its caches
+ */
+void rp2040_smp_post_invalidate(rp2040_smp_t *smp, int core_id, uint32_t addr, uint32_t len)
+{
+    rp2040_smp_inval_t *inval = &smp->inval[core_id];
+
+    pthread_mutex_lock(&inval->lock);
+    if (inval->pending) {
+        if (addr < inval->lo) inval->lo = addr;
+        if (addr + len > inval->hi) inval->hi = addr + len;
+    } else {
+        inval->lo = addr;
+        inval->hi = addr + len;
+    }
+    __atomic_store_n(&inval->pending, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&inval->lock);
+}
+
+/**
+ * Drop code other cores have written since this core last looked
+ */
+static void smp_apply_invalidations(rp2040_smp_t *smp, int core_id)
+{
+    rp2040_smp_inval_t *inval = &smp->inval[core_id];
+    if (!__atomic_load_n(&inval->pending, __ATOMIC_ACQUIRE)) return;
+
+    pthread_mutex_lock(&inval->lock);
+    uint32_t lo = inval->lo;
+    uint32_t hi = inval->hi;
+    __atomic_store_n(&inval->pending, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&inval->lock);
+
+    rp2040_engine_invalidate(smp->sys, core_id, lo, hi - lo);
+}
+
+/**
+ * Between quanta, on one thread while the others wait: update cycle_count
+ * and either stop or hand out the next quantum. What is left of the run is
+ * split evenly, so it overshoots by at most one block per core.
+ */
+static void smp_plan(rp2040_smp_t *smp)
+{
+    rp2040_system_t *sys = smp->sys;
+    uint64_t total = 0;
+
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        total += sys->engines[i].cycles;
+    }
+    sys->cycle_count = total;
+
+    if (smp->result < 0 || total >= smp->target || sys->halted ||
+        sys->breakpoint_triggered || sys->watchpoint_triggered) {
+        smp->done = true;
+        return;
+    }
+
+    uint64_t share = (smp->target - total + RP2040_NUM_CORES - 1) / RP2040_NUM_CORES;
+    if (share > smp->quantum) share = smp->quantum;
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        smp->end[i] = sys->engines[i].cycles + share;
+    }
+}
+
+/**
+ * Run one core quantum by quantum until the run is done
+ */
+static void *smp_worker(void *arg)
+{
+    smp_worker_t *worker = (smp_worker_t *)arg;
+    rp2040_smp_t *smp = worker->smp;
+    rp2040_system_t *sys = smp->sys;
+    int core_id = worker->core_id;
+    const rp2040_engine_t *engine = &sys->engines[core_id];
+
+    while (!smp->done) {
+        int result = 0;
+        while (result == 0 && engine->cycles < smp->end[core_id] &&
+               !__atomic_load_n(&sys->halted, __ATOMIC_RELAXED)) {
+            result = rp2040_engine_step(sys, core_id);
+            smp_apply_invalidations(smp, core_id);
+        }
+        if (result < 0) {
+            __atomic_store_n(&smp->result, -1, __ATOMIC_RELAXED);
+        }
+
+        if (pthread_barrier_wait(&smp->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            smp_plan(smp);
+        }
+        pthread_barrier_wait(&smp->barrier);
+    }
+
+    /* Writes from the other core's last quantum */
+    smp_apply_invalidations(smp, core_id);
+    return NULL;
+}
+
+/**
+ * Run for a number of cycles (summed over both cores) with each core on
+ * its own host thread, syncing every quantum instructions per core
+ * (0 for RP2040_SMP_QUANTUM). Stops early when halted, or on a breakpoint
+ * or watchpoint hit. Returns -1 on an execution error or if the second
+ * thread cannot be started.
+ */
+int rp2040_run_threaded(rp2040_system_t *sys, uint64_t cycles, uint32_t quantum)
+{
+    if (!sys || sys->smp) return -1;
+
+    rp2040_smp_t smp;
+    memset(&smp, 0, sizeof(smp));
+    smp.sys = sys;
+    smp.target = sys->cycle_count + cycles;
+    smp.quantum = quantum ? quantum : RP2040_SMP_QUANTUM;
+
+    smp_plan(&smp);
+    if (smp.done) return 0;
+
+    pthread_barrier_init(&smp.barrier, NULL, RP2040_NUM_CORES);
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        pthread_mutex_init(&smp.inval[i].lock, NULL);
+    }
+
+    smp_worker_t workers[RP2040_NUM_CORES];
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        workers[i].smp = &smp;
+        workers[i].core_id = i;
+    }
+
+    sys->smp = &smp;
+
+    /* Compiled code without fences on its stores cannot run threaded */
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        rp2040_jit_flush(sys, i);
+    }
+
+    pthread_t thread;
+    int result = 0;
+    if (pthread_create(&thread, NULL, smp_worker, &workers[1]) != 0) {
+        fprintf(stderr, "Failed to start thread for core 1\n");
+        result = -1;
+    } else {
+        smp_worker(&workers[0]);
+        pthread_join(thread, NULL);
+        result = smp.result;
+    }
+
+    sys->smp = NULL;
+
+    pthread_barrier_destroy(&smp.barrier);
+    for (int i = 0; i < RP2040_NUM_CORES; i++) {
+        pthread_mutex_destroy(&smp.inval[i].lock);
+    }
+
+    return result;
+}
@@ -0,0 +1,117 @@
+#include "../include/arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t size;              // Usable bytes in data[]
+    size_t used;              // Bytes bumped so far
+    size_t last_offset;       // Offset of the most recent allocation (for arena_grow)
+    _Alignas(max_align_t) unsigned char data[];
+};
+
+static size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaChunk *arena_chunk_create(Arena *arena, size_t size) {
+    ArenaChunk *chunk = (ArenaChunk *)malloc(sizeof(ArenaChunk) + size);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->last_offset = SIZE_MAX;
+
+    arena->stats.chunk_count++;
+    arena->stats.bytes_reserved += size;
+    return chunk;
+}
+
+Arena *arena_create(size_t chunk_size) {
+    Arena *arena = (Arena *)malloc(sizeof(Arena));
+    if (!arena) return NULL;
+    memset(&arena->stats, 0, sizeof(arena->stats));
+    arena->chunk_size = chunk_size ? arena_align(chunk_size) : ARENA_DEFAULT_CHUNK_SIZE;
+    arena->head = NULL;
+    return arena;
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) return;
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    if (!arena) return NULL;
+    size = arena_align(size ? size : 1);
+
+    ArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < size) {
+        // Oversized requests get a dedicated chunk linked behind the current
+        // one so the remaining space in the head chunk is not abandoned.
+        if (chunk && size > arena->chunk_size / 4) {
+            ArenaChunk *big = arena_chunk_create(arena, size);
+            if (!big) return NULL;
+            big->next = chunk->next;
+            chunk->next = big;
+            big->used = size;
+            big->last_offset = 0;
+            arena->stats.allocation_count++;
+            arena->stats.bytes_used += size;
+            return big->data;
+        }
+
+        size_t chunk_size = size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = arena_chunk_create(arena, chunk_size);
+        if (!chunk) return NULL;
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+
+    void *ptr = chunk->data + chunk->used;
+    chunk->last_offset = chunk->used;
+    chunk->used += size;
+
+    arena->stats.allocation_count++;
+    arena->stats.bytes_used += size;
+    return ptr;
+}
+
+// Resize an allocation. The most recent allocation in the head chunk is
+// extended in place; anything else is copied to a fresh block (the old block
+// is simply abandoned until the arena is destroyed).
+void *arena_grow(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    if (!ptr) return arena_alloc(arena, new_size);
+    if (new_size <= old_size) return ptr;
+
+    ArenaChunk *chunk = arena->head;
+    if (chunk && chunk->last_offset != SIZE_MAX &&
+        (unsigned char *)ptr == chunk->data + chunk->last_offset) {
+        size_t old_aligned = chunk->used - chunk->last_offset;
+        size_t new_aligned = arena_align(new_size);
+        if (chunk->last_offset + new_aligned <= chunk->size) {
+            chunk->used = chunk->last_offset + new_aligned;
+            arena->stats.allocation_count++;
+            arena->stats.bytes_used += new_aligned - old_aligned;
+            return ptr;
+        }
+    }
+
+    void *fresh = arena_alloc(arena, new_size);
+    if (fresh) memcpy(fresh, ptr, old_size);
+    return fresh;
+}
+
+const ArenaStats *arena_stats(const Arena *arena) {
+    return arena ? &arena->stats : NULL;
+}
@@ -0,0 +1,102 @@
+#include "../include/cache.h"
+#include "../include/source.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef BITN_VERSION
+#define BITN_VERSION "unknown"
+#endif
+
+#define CACHE_PATH_MAX 4096
+
+static CacheKey cache_hash(CacheKey hash, const void *data, size_t length) {
+    // FNV-1a, 64-bit
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+CacheKey cache_key(const char *source, size_t length, const char *target, uint32_t format) {
+    // The NUL separators keep ("ab", "c") and ("a", "bc") apart.
+    CacheKey hash = 14695981039346656037ull;
+    hash = cache_hash(hash, BITN_VERSION, sizeof(BITN_VERSION));
+    hash = cache_hash(hash, &format, sizeof(format));
+    hash = cache_hash(hash, target, strlen(target) + 1);
+    return cache_hash(hash, source, length);
+}
+
+static int cache_path(char *buffer, size_t size, const char *dir, CacheKey key) {
+    int n = snprintf(buffer, size, "%s/%016llx.h", dir, (unsigned long long)key);
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+int cache_load(const char *dir, CacheKey key, char **data, size_t *length) {
+    char path[CACHE_PATH_MAX];
+    if (cache_path(path, sizeof(path), dir, key) != 0) return -1;
+
+    SourceFile entry;
+    if (source_open(&entry, path) != 0) return -1;
+
+    *data = (char *)malloc(entry.length + 1);
+    if (!*data) {
+        source_close(&entry);
+        return -1;
+    }
+    memcpy(*data, entry.data, entry.length + 1);
+    *length = entry.length;
+    source_close(&entry);
+    return 0;
+}
+
+int cache_store(const char *dir, CacheKey key, const char *data, size_t length) {
+    char path[CACHE_PATH_MAX];
+    char temp[CACHE_PATH_MAX];
+    if (cache_path(path, sizeof(path), dir, key) != 0) return -1;
+
+    int n = snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    if (n < 0 || (size_t)n >= sizeof(temp)) return -1;
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return -1;
+
+    int fd = mkstemp(temp);
+    if (fd < 0) return -1;
+
+    size_t written = 0;
+    while (written < length) {
+        ssize_t w = write(fd, data + written, length - written);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        written += (size_t)w;
+    }
+
+    if (close(fd) != 0 || written != length || rename(temp, path) != 0) {
+        unlink(temp);
+        return -1;
+    }
+    return 0;
+}
+
+int file_write_if_changed(const char *path, const char *data, size_t length) {
+    SourceFile existing;
+    if (source_open(&existing, path) == 0) {
+        int same = existing.length == length && memcmp(existing.data, data, length) == 0;
+        source_close(&existing);
+        if (same) return 0;
+    }
+
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    size_t written = fwrite(data, 1, length, out);
+    if (fclose(out) != 0 || written != length) return -1;
+    return 1;
+}
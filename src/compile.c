@@ -0,0 +1,554 @@
+/**
+ * bit(N) Compiler - Compilation driver
+ * Runs the lex/parse/codegen pipeline for one input, and fans multi-file
+ * builds out over a worker pool.
+ */
+
+#include "../include/compile.h"
+#include "../include/cache.h"
+#include "../include/devdb.h"
+#include "../include/optimize.h"
+#include "../include/parser.h"
+#include "../include/source.h"
+#include "../include/type_inference.h"
+#include "../backend/codegen/codegen.h"
+#include "../backend/thumb/thumb.h"
+
+#include <dirent.h>
+#include <glob.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char *access_kind_name(AccessKind access) {
+    switch (access) {
+        case ACCESS_RO:  return "ro";
+        case ACCESS_WO:  return "wo";
+        case ACCESS_RW:  return "rw";
+        case ACCESS_W1C: return "w1c";
+        default:         return "?";
+    }
+}
+
+static const char *type_kind_name(TypeKind kind) {
+    switch (kind) {
+        case TYPE_VOID: return "void";
+        case TYPE_U8:   return "u8";
+        case TYPE_U16:  return "u16";
+        case TYPE_U32:  return "u32";
+        case TYPE_U64:  return "u64";
+        case TYPE_I8:   return "i8";
+        case TYPE_I16:  return "i16";
+        case TYPE_I32:  return "i32";
+        case TYPE_I64:  return "i64";
+        default:        return "?";
+    }
+}
+
+static void compile_print_register(FILE *out, ASTRegister *reg, const char *indent) {
+    fprintf(out, "%s* register %s: %s @ offset 0x%02X\n",
+            indent,
+            atom_name(reg->name),
+            type_kind_name(reg->type->kind),
+            reg->offset);
+    for (size_t fk = 0; fk < reg->field_count; fk++) {
+        ASTField *field = reg->fields[fk];
+        fprintf(out, "%s  - field %s: [%u:%u] %s\n",
+                indent,
+                atom_name(field->name),
+                field->start_bit,
+                field->end_bit,
+                access_kind_name(field->access));
+    }
+}
+
+static void compile_print_program(FILE *out, ASTProgram *program) {
+    fprintf(out, " Functions: %lu\n", program->function_count);
+    for (size_t fi = 0; fi < program->function_count; fi++) {
+        fprintf(out, " - fn %s\n", atom_name(program->functions[fi]->name));
+    }
+
+    fprintf(out, " Peripherals: %lu\n", program->peripheral_count);
+    for (size_t pi = 0; pi < program->peripheral_count; pi++) {
+        ASTPeripheral *periph = program->peripherals[pi];
+        fprintf(out, " - peripheral %s @ 0x%08X\n",
+                atom_name(periph->name), periph->base_address);
+        for (size_t rj = 0; rj < periph->register_count; rj++) {
+            compile_print_register(out, periph->registers[rj], "   ");
+        }
+        for (size_t cj = 0; cj < periph->cluster_count; cj++) {
+            ASTCluster *cluster = periph->clusters[cj];
+            fprintf(out, "   * cluster %s[%u] @ offset 0x%02X stride 0x%02X\n",
+                    atom_name(cluster->name), cluster->count,
+                    cluster->offset, cluster->stride);
+            for (size_t rk = 0; rk < cluster->register_count; rk++) {
+                compile_print_register(out, cluster->registers[rk], "     ");
+            }
+        }
+    }
+}
+
+// Output path for an input: its extension replaced by suffix (".h").
+static void compile_output_path(const char *input_file, const char *suffix,
+                                char *buffer, size_t size) {
+    if (!input_file || strcmp(input_file, "-") == 0) {
+        snprintf(buffer, size, "generated%s", suffix);
+        return;
+    }
+
+    strncpy(buffer, input_file, size - 1);
+    buffer[size - 1] = '\0';
+
+    char *dot = strrchr(buffer, '.');
+    char *slash = strrchr(buffer, '/');
+    if (dot && (!slash || dot > slash)) {
+        *dot = '\0';
+    }
+    if (strlen(buffer) + strlen(suffix) + 1 <= size) {
+        strcat(buffer, suffix);
+    }
+}
+
+static CompileStatus compile_emit(const char *output_file, const char *data, size_t length,
+                                  FILE *out, FILE *err) {
+    int written = file_write_if_changed(output_file, data, length);
+    if (written < 0) {
+        fprintf(err, "Error: Cannot write %s\n", output_file);
+        return COMPILE_FAILED;
+    }
+    if (written == 0) {
+        fprintf(out, "%s is up to date\n", output_file);
+    }
+    return COMPILE_OK;
+}
+
+static CompileStatus compile_codegen(const CompileOptions *opts, const char *input_file,
+                                     ASTProgram *program, CacheKey key, FILE *out, FILE *err) {
+    if (program->peripheral_count == 0) {
+        fprintf(out, "\n⚠️ --compile flag specified but no peripherals found.\n");
+        fprintf(out, " Device files must contain 'peripheral' definitions.\n");
+        fprintf(out, "\n Example:\n");
+        fprintf(out, " peripheral UART {\n");
+        fprintf(out, "   base_address: 0x40000000\n");
+        fprintf(out, "   register CTRL { ... }\n");
+        fprintf(out, " }\n");
+        return COMPILE_OK;
+    }
+
+    fprintf(out, "\n--- Code Generation ---\n");
+
+    char output_file[256];
+    compile_output_path(input_file, ".h", output_file, sizeof(output_file));
+    fprintf(out, "Generating C code to: %s\n", output_file);
+
+    /* Generate into memory so the cache and the output file get the same bytes. */
+    CodegenContext *ctx = codegen_init_buffer(opts->target);
+    if (!ctx) {
+        fprintf(err, "Error: Failed to initialize code generator\n");
+        return COMPILE_FAILED;
+    }
+    ctx->errors = err;
+
+    size_t length = 0;
+    const char *header = NULL;
+    if (codegen_generate(ctx, program) != 0 || !(header = codegen_buffer(ctx, &length))) {
+        fprintf(err, "❌ Code generation failed\n");
+        codegen_cleanup(ctx);
+        return COMPILE_FAILED;
+    }
+
+    CompileStatus status = compile_emit(output_file, header, length, out, err);
+    if (status == COMPILE_OK) {
+        fprintf(out, "✅ Successfully generated C code\n");
+        if (opts->cache_dir && cache_store(opts->cache_dir, key, header, length) != 0) {
+            fprintf(err, "Warning: Cannot update cache in %s\n", opts->cache_dir);
+        }
+    }
+
+    codegen_cleanup(ctx);
+    return status;
+}
+
+// Serve a --compile run from the cache. Returns 1 on a hit.
+static int compile_from_cache(const CompileOptions *opts, const char *input_file,
+                              CacheKey key, CompileStatus *status, FILE *out, FILE *err) {
+    char *header = NULL;
+    size_t length = 0;
+    if (cache_load(opts->cache_dir, key, &header, &length) != 0) return 0;
+
+    char output_file[256];
+    compile_output_path(input_file, ".h", output_file, sizeof(output_file));
+
+    fprintf(out, "✅ Unchanged since last build (cache %016llx)\n", (unsigned long long)key);
+    *status = compile_emit(output_file, header, length, out, err);
+    if (*status == COMPILE_OK) {
+        fprintf(out, "\n=== Compilation Successful ===\n");
+    }
+
+    free(header);
+    return 1;
+}
+
+// Type-check the functions and run the AST passes over them. A program that
+// does not check is reported and left as parsed; peripherals are unaffected.
+// Returns 0 if the functions checked, -1 if not.
+static int compile_optimize(const CompileOptions *opts, ASTProgram *program,
+                            FILE *out, FILE *err) {
+    TypeContext *types = type_context_create();
+    if (!types) {
+        fprintf(err, "Error: Memory allocation failed\n");
+        return -1;
+    }
+
+    int checked = check_program_types(types, program);
+    if (checked) {
+        Optimizer opt;
+        optimizer_init(&opt, program->arena);
+        size_t rewrites = optimize_program(&opt, program);
+        if (opts->verbose) {
+            fprintf(out, "\n");
+            optimizer_print_stats(&opt, out);
+        } else if (rewrites > 0) {
+            fprintf(out, " Optimized: %zu expressions rewritten\n", rewrites);
+        }
+    } else {
+        fprintf(err, "Warning: %d type errors, functions left unoptimized\n", types->error_count);
+    }
+
+    type_context_free(types);
+    return checked ? 0 : -1;
+}
+
+static CompileStatus compile_emit_object(const CompileOptions *opts, const char *input_file,
+                                         ASTProgram *program, FILE *out, FILE *err) {
+    ThumbContext *ctx = thumb_init(opts->target);
+    if (!ctx) {
+        fprintf(err, "Error: --emit-obj needs a Thumb-1 target (arm-cortex-m0, rp2040), not %s\n",
+                opts->target);
+        return COMPILE_FAILED;
+    }
+    ctx->errors = err;
+
+    fprintf(out, "\n--- Machine Code (Thumb-1) ---\n");
+
+    CompileStatus status = COMPILE_FAILED;
+    uint8_t *image = NULL;
+    size_t length = 0;
+    if (thumb_compile_program(ctx, program) == 0 && thumb_object(ctx, &image, &length) == 0) {
+        char obj_file[256];
+        compile_output_path(input_file, ".o", obj_file, sizeof(obj_file));
+        status = compile_emit(obj_file, (const char *)image, length, out, err);
+        if (status == COMPILE_OK) {
+            fprintf(out, "Object: %s\n", obj_file);
+        }
+        if (opts->verbose) {
+            for (size_t f = 0; f < ctx->function_count; f++) {
+                fprintf(out, " - fn %s: %zu bytes, %d spilled\n", ctx->functions[f].name,
+                        ctx->functions[f].size, ctx->functions[f].spills);
+            }
+        }
+    } else {
+        fprintf(err, "❌ Machine code generation failed\n");
+    }
+
+    free(image);
+    thumb_cleanup(ctx);
+    return status;
+}
+
+static CompileStatus compile_emit_database(const char *input_file, ASTProgram *program,
+                                           FILE *out, FILE *err) {
+    char db_file[256];
+    compile_output_path(input_file, DEVDB_SUFFIX, db_file, sizeof(db_file));
+    if (devdb_write(program, db_file) != 0) {
+        fprintf(err, "Error: Cannot write device database %s\n", db_file);
+        return COMPILE_FAILED;
+    }
+    fprintf(out, "Device database: %s\n", db_file);
+    return COMPILE_OK;
+}
+
+// A precompiled database stands in for lexing and parsing.
+static CompileStatus compile_database(const CompileOptions *opts, const char *input_file,
+                                      const SourceFile *file, CacheKey key, FILE *out, FILE *err) {
+    DevDb db;
+    if (devdb_attach(&db, file->data, file->length) != 0) {
+        fprintf(err, "Error: %s is not a usable device database (version %d expected)\n",
+                input_file, DEVDB_VERSION);
+        return COMPILE_FAILED;
+    }
+
+    ASTProgram *program = devdb_to_program(&db);
+    if (!program) {
+        fprintf(err, "Error: Memory allocation failed\n");
+        return COMPILE_FAILED;
+    }
+
+    fprintf(out, "✅ Loaded device database (%u peripherals, %u registers, %u fields)\n",
+            db.header->peripheral_count, db.header->register_count, db.header->field_count);
+    if (opts->verbose) {
+        compile_print_program(out, program);
+    }
+
+    CompileStatus status = COMPILE_OK;
+    if (opts->do_codegen) {
+        status = compile_codegen(opts, input_file, program, key, out, err);
+    }
+    if (status == COMPILE_OK) {
+        fprintf(out, "\n=== Compilation Successful ===\n");
+    }
+
+    ast_free_program(program);
+    return status;
+}
+
+CompileStatus compile_unit(const CompileOptions *opts, const char *input_file,
+                           const char *source, FILE *out, FILE *err) {
+    /* ----------------- file loading ----------------- */
+    /* Regular files are mapped, not copied: tokens and AST names point into the mapping. */
+    SourceFile file = {0};
+    if (!source) {
+        if (source_open(&file, input_file) != 0) {
+            fprintf(err, "Error: Cannot open file %s\n", input_file);
+            return COMPILE_FAILED;
+        }
+        source = file.data;
+    }
+
+    fprintf(out, "Input: %s\n\n", input_file ? input_file : "default");
+    if (opts->verbose) {
+        fprintf(out, "Target: %s\n\n", opts->target);
+    }
+
+    /* ----------------- cache lookup ----------------- */
+    CompileStatus status = COMPILE_OK;
+    CacheKey key = 0;
+    if (opts->do_codegen && opts->cache_dir) {
+        key = cache_key(source, file.data ? file.length : strlen(source), opts->target,
+                        CODEGEN_FORMAT_VERSION);
+        /* --emit-db and --emit-obj need the parse, so they only refresh the cache. */
+        if (!opts->emit_db && !opts->emit_obj && compile_from_cache(opts, input_file, key, &status, out, err)) {
+            source_close(&file);
+            return status;
+        }
+    }
+
+    /* ----------------- precompiled database ----------------- */
+    if (file.data && devdb_is_database(file.data, file.length)) {
+        status = compile_database(opts, input_file, &file, key, out, err);
+        source_close(&file);
+        intern_reset();
+        return status;
+    }
+
+    /* ----------------- lexical analysis ----------------- */
+    /* Tokenize once; the dump, the token count and the parser all share it. */
+    TokenStream *tokens = lexer_tokenize(source);
+    if (!tokens) {
+        fprintf(err, "Error: Memory allocation failed\n");
+        source_close(&file);
+        return COMPILE_FAILED;
+    }
+
+    if (opts->verbose) {
+        fprintf(out, "--- Lexical Analysis ---\n");
+        for (size_t ti = 0; ti < tokens->count; ti++) {
+            Token *tok = &tokens->tokens[ti];
+            fprintf(out, "Token(%s, line=%d, col=%d, len=%d)\n",
+                    token_type_name(tok->type), tok->line, tok->column, tok->length);
+        }
+        fprintf(out, "Total tokens: %zu\n\n", tokens->count - 1);
+    }
+
+    /* ----------------- parsing ----------------- */
+    Parser *parser = parser_create_from_tokens(tokens);
+    parser->errors = err;
+    if (opts->verbose) {
+        fprintf(out, "--- Parsing ---\n");
+    }
+
+    ASTProgram *program = parser_parse_program(parser);
+    if (program && opts->verbose) {
+        const ArenaStats *stats = arena_stats(program->arena);
+        fprintf(out, "AST arena: %zu allocations, %zu bytes used, %zu bytes reserved in %zu chunks\n\n",
+                stats->allocation_count, stats->bytes_used,
+                stats->bytes_reserved, stats->chunk_count);
+    }
+
+    if (program && !parser_has_error(parser)) {
+        fprintf(out, "✅ Successfully parsed\n");
+        compile_print_program(out, program);
+
+        int checked = program->function_count > 0 ? compile_optimize(opts, program, out, err) : 0;
+
+        if (opts->emit_obj) {
+            if (checked != 0) {
+                fprintf(err, "Error: Machine code needs functions that type-check\n");
+                status = COMPILE_FAILED;
+            } else if (program->function_count == 0) {
+                fprintf(out, "\n⚠️ --emit-obj flag specified but no functions found.\n");
+            } else {
+                status = compile_emit_object(opts, input_file, program, out, err);
+            }
+        }
+
+        if (opts->emit_db && status == COMPILE_OK) {
+            status = compile_emit_database(input_file, program, out, err);
+        }
+
+        /* ----------------- code generation ----------------- */
+        if (opts->do_codegen && status == COMPILE_OK) {
+            status = compile_codegen(opts, input_file, program, key, out, err);
+        }
+
+        if (status == COMPILE_OK) {
+            fprintf(out, "\n=== Compilation Successful ===\n");
+        }
+    } else {
+        fprintf(out, "❌ Parsing failed\n");
+        status = COMPILE_PARSE_FAILED;
+    }
+
+    /* ----------------- cleanup ----------------- */
+    parser_free(parser);
+    token_stream_free(tokens);
+    ast_free_program(program);
+    source_close(&file);
+    intern_reset();
+
+    return status;
+}
+
+// ============================================================================
+// Worker pool
+// ============================================================================
+
+typedef struct {
+    const CompileOptions *opts;
+    CompileJob *jobs;
+    size_t count;
+    atomic_size_t next;        // Next unclaimed job
+    atomic_size_t failures;
+} CompileQueue;
+
+static void *compile_worker(void *arg) {
+    CompileQueue *queue = (CompileQueue *)arg;
+
+    for (;;) {
+        size_t index = atomic_fetch_add(&queue->next, 1);
+        if (index >= queue->count) break;
+
+        CompileJob *job = &queue->jobs[index];
+        FILE *report = open_memstream(&job->report, &job->report_length);
+        if (!report) {
+            job->status = COMPILE_FAILED;
+        } else {
+            job->status = compile_unit(queue->opts, job->input_file, NULL, report, report);
+            fclose(report);
+        }
+
+        if (job->status != COMPILE_OK) {
+            atomic_fetch_add(&queue->failures, 1);
+        }
+    }
+
+    return NULL;
+}
+
+int compile_default_threads(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+size_t compile_jobs(const CompileOptions *opts, CompileJob *jobs, size_t count, int threads,
+                    int *workers) {
+    CompileQueue queue;
+    queue.opts = opts;
+    queue.jobs = jobs;
+    queue.count = count;
+    atomic_init(&queue.next, 0);
+    atomic_init(&queue.failures, 0);
+
+    if (threads <= 0) threads = compile_default_threads();
+    if ((size_t)threads > count) threads = (int)count;
+
+    // The calling thread is one of the workers.
+    int extra = threads > 1 ? threads - 1 : 0;
+    pthread_t *pool = extra ? (pthread_t *)malloc((size_t)extra * sizeof(pthread_t)) : NULL;
+    int started = 0;
+    if (pool) {
+        for (; started < extra; started++) {
+            if (pthread_create(&pool[started], NULL, compile_worker, &queue) != 0) break;
+        }
+    }
+
+    compile_worker(&queue);
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(pool[t], NULL);
+    }
+    free(pool);
+
+    if (workers) *workers = started + 1;
+    return atomic_load(&queue.failures);
+}
+
+// ============================================================================
+// Input expansion
+// ============================================================================
+
+static int compile_path_cmp(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int compile_has_suffix(const char *name, const char *suffix) {
+    size_t name_len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    return name_len > suffix_len && strcmp(name + name_len - suffix_len, suffix) == 0;
+}
+
+static void compile_push_path(char ***paths, size_t *count, size_t *capacity, char *path) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        *paths = (char **)realloc(*paths, *capacity * sizeof(char *));
+    }
+    (*paths)[(*count)++] = path;
+}
+
+int compile_expand_input(const char *arg, char ***paths, size_t *count, size_t *capacity) {
+    size_t first = *count;
+    struct stat st;
+
+    if (strcmp(arg, "-") != 0 && stat(arg, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(arg);
+        if (!dir) return -1;
+
+        size_t arg_len = strlen(arg);
+        int needs_slash = arg_len > 0 && arg[arg_len - 1] != '/';
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (!compile_has_suffix(entry->d_name, ".bitn")) continue;
+            size_t len = arg_len + (size_t)needs_slash + strlen(entry->d_name) + 1;
+            char *path = (char *)malloc(len);
+            snprintf(path, len, "%s%s%s", arg, needs_slash ? "/" : "", entry->d_name);
+            compile_push_path(paths, count, capacity, path);
+        }
+        closedir(dir);
+    } else if (strpbrk(arg, "*?[") != NULL) {
+        glob_t matches;
+        if (glob(arg, 0, NULL, &matches) != 0) return -1;
+        for (size_t m = 0; m < matches.gl_pathc; m++) {
+            compile_push_path(paths, count, capacity, strdup(matches.gl_pathv[m]));
+        }
+        globfree(&matches);
+    } else {
+        compile_push_path(paths, count, capacity, strdup(arg));
+        return 1;
+    }
+
+    qsort(*paths + first, *count - first, sizeof(char *), compile_path_cmp);
+    return (int)(*count - first);
+}
@@ -1,5 +1,339 @@
-#include <stdint.h>
+// src/core/execution.c
+#include "isa/arm/decoder.h"
 
-void execution_step(void) {
-    // TODO: implement RP2040 execution stepping
+#define APSR_FLAGS  (PSR_N_BIT | PSR_Z_BIT | PSR_C_BIT | PSR_V_BIT)
+
+/* Special registers for MRS/MSR (SYSm); 0-7 are views of xPSR */
+#define SYSM_APSR       0
+#define SYSM_MSP        8
+#define SYSM_PSP        9
+#define SYSM_PRIMASK    16
+#define SYSM_CONTROL    20
+
+/* Register read as an operand: PC reads as the instruction address plus 4 */
+static inline uint32_t reg_read(const arm_core_state_t *core, uint8_t n)
+{
+    switch (n) {
+    case 13: return core->sp;
+    case 14: return core->lr;
+    case 15: return core->pc + 4;
+    default: return core->r[n];
+    }
+}
+
+/* Register write other than PC */
+static inline void reg_write(arm_core_state_t *core, uint8_t n, uint32_t value)
+{
+    switch (n) {
+    case 13: core->sp = value; break;
+    case 14: core->lr = value; break;
+    default: core->r[n] = value; break;
+    }
+}
+
+static inline void set_nz(arm_core_state_t *core, uint32_t result)
+{
+    core->psr &= ~(PSR_N_BIT | PSR_Z_BIT);
+    if (result & 0x80000000u) core->psr |= PSR_N_BIT;
+    if (result == 0) core->psr |= PSR_Z_BIT;
+}
+
+static inline void set_c(arm_core_state_t *core, uint32_t carry)
+{
+    core->psr = carry ? (core->psr | PSR_C_BIT) : (core->psr & ~PSR_C_BIT);
+}
+
+/* AddWithCarry, setting all four flags when asked */
+static uint32_t add_with_carry(arm_core_state_t *core, uint32_t a, uint32_t b, uint32_t carry_in, bool setflags)
+{
+    uint64_t sum = (uint64_t)a + b + carry_in;
+    uint32_t result = (uint32_t)sum;
+
+    if (setflags) {
+        set_nz(core, result);
+        set_c(core, (uint32_t)(sum >> 32));
+        core->psr = (((a ^ result) & (b ^ result)) >> 31) ? (core->psr | PSR_V_BIT) : (core->psr & ~PSR_V_BIT);
+    }
+    return result;
+}
+
+/* Shift value by amount (0..255), updating C unless the amount is 0 */
+static uint32_t shift(arm_core_state_t *core, arm_instruction_type_t type, uint32_t value, uint32_t amount)
+{
+    if (amount == 0) return value;
+
+    switch (type) {
+    case ARM_INSTR_LSL:
+        set_c(core, amount <= 32 ? (uint32_t)(((uint64_t)value << amount) >> 32) & 1 : 0);
+        return amount < 32 ? value << amount : 0;
+    case ARM_INSTR_LSR:
+        set_c(core, amount <= 32 ? (uint32_t)((uint64_t)value >> (amount - 1)) & 1 : 0);
+        return amount < 32 ? value >> amount : 0;
+    case ARM_INSTR_ASR:
+        if (amount > 32) amount = 32;
+        set_c(core, ((int32_t)value >> (amount - 1)) & 1);
+        return (uint32_t)((int32_t)value >> (amount == 32 ? 31 : amount));
+    default: /* ROR */
+        amount &= 31;
+        if (amount) value = (value >> amount) | (value << (32 - amount));
+        set_c(core, value >> 31);
+        return value;
+    }
+}
+
+static inline int bus_read(arm_core_state_t *core, uint32_t addr, uint32_t size, uint32_t *value)
+{
+    if (addr & (size - 1)) return ARM_EXEC_FAULT;
+    return core->bus->read(core->bus->context, core->bus->master, addr, size, value);
+}
+
+static inline int bus_write(arm_core_state_t *core, uint32_t addr, uint32_t size, uint32_t value)
+{
+    if (addr & (size - 1)) return ARM_EXEC_FAULT;
+    return core->bus->write(core->bus->context, core->bus->master, addr, size, value);
+}
+
+/* Interworking branch (BX, BLX, POP {PC}): ARMv6-M only has Thumb state */
+static inline int branch_exchange(uint32_t target, uint32_t *next_pc)
+{
+    if (!(target & 1) || (target & 0xF0000000) == 0xF0000000) {
+        return ARM_EXEC_FAULT;      /* ARM state or an exception return */
+    }
+    *next_pc = target & ~1u;
+    return ARM_EXEC_OK;
+}
+
+/**
+ * Execute a decoded instruction at core->pc, then advance PC past it (or
+ * to the branch target). On a fault PC and the registers written so far
+ * stay as they are; BKPT leaves PC on itself.
+ */
+int arm_thumb2_execute_decoded(arm_core_state_t *core, const arm_instruction_t *instr, uint8_t instr_len)
+{
+    if (!core || !instr || !core->bus) return ARM_EXEC_FAULT;
+
+    uint32_t pc = core->pc;
+    uint32_t next_pc = pc + instr_len;
+    uint32_t op2 = instr->use_imm ? (uint32_t)instr->immediate : reg_read(core, instr->rm);
+    uint32_t carry = (core->psr & PSR_C_BIT) != 0;
+    uint32_t result, addr, value;
+    int status;
+
+    switch (instr->type) {
+    case ARM_INSTR_MOV:
+        result = op2;
+        if (instr->setflags) set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_ADD: {
+        /* ADR and PC-relative bases are word-aligned */
+        uint32_t base = reg_read(core, instr->rn);
+        if (instr->rn == 15 && instr->use_imm) base &= ~3u;
+        result = add_with_carry(core, base, op2, 0, instr->setflags);
+        goto write_rd;
+    }
+    case ARM_INSTR_SUB:
+        result = add_with_carry(core, reg_read(core, instr->rn), ~op2, 1, instr->setflags);
+        goto write_rd;
+    case ARM_INSTR_ADC:
+        result = add_with_carry(core, reg_read(core, instr->rn), op2, carry, true);
+        goto write_rd;
+    case ARM_INSTR_SBC:
+        result = add_with_carry(core, reg_read(core, instr->rn), ~op2, carry, true);
+        goto write_rd;
+    case ARM_INSTR_RSB:
+        result = add_with_carry(core, ~reg_read(core, instr->rn), op2, 1, true);
+        goto write_rd;
+    case ARM_INSTR_CMP:
+        add_with_carry(core, reg_read(core, instr->rn), ~op2, 1, true);
+        break;
+    case ARM_INSTR_CMN:
+        add_with_carry(core, reg_read(core, instr->rn), op2, 0, true);
+        break;
+    case ARM_INSTR_MUL:
+        result = reg_read(core, instr->rn) * op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_AND:
+        result = reg_read(core, instr->rn) & op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_XOR:
+        result = reg_read(core, instr->rn) ^ op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_ORR:
+        result = reg_read(core, instr->rn) | op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_BIC:
+        result = reg_read(core, instr->rn) & ~op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_MVN:
+        result = ~op2;
+        set_nz(core, result);
+        goto write_rd;
+    case ARM_INSTR_TST:
+        set_nz(core, reg_read(core, instr->rn) & op2);
+        break;
+    case ARM_INSTR_LSL:
+    case ARM_INSTR_LSR:
+    case ARM_INSTR_ASR:
+    case ARM_INSTR_ROR:
+        value = instr->use_imm ? instr->shift_amount : reg_read(core, instr->rs) & 0xFF;
+        result = shift(core, instr->type, reg_read(core, instr->rm), value);
+        set_nz(core, result);
+        goto write_rd;
+
+    /* Extension and byte reversal */
+    case ARM_INSTR_SXTH:  result = (uint32_t)(int32_t)(int16_t)op2; goto write_rd;
+    case ARM_INSTR_SXTB:  result = (uint32_t)(int32_t)(int8_t)op2; goto write_rd;
+    case ARM_INSTR_UXTH:  result = op2 & 0xFFFF; goto write_rd;
+    case ARM_INSTR_UXTB:  result = op2 & 0xFF; goto write_rd;
+    case ARM_INSTR_REV:   result = __builtin_bswap32(op2); goto write_rd;
+    case ARM_INSTR_REV16:
+        result = ((op2 & 0x00FF00FF) << 8) | ((op2 >> 8) & 0x00FF00FF);
+        goto write_rd;
+    case ARM_INSTR_REVSH:
+        result = (uint32_t)(int32_t)(int16_t)(((op2 & 0xFF) << 8) | ((op2 >> 8) & 0xFF));
+        goto write_rd;
+
+    /* Loads and stores */
+    case ARM_INSTR_LDR: {
+        uint32_t base = reg_read(core, instr->rn);
+        if (instr->rn == 15) base &= ~3u;
+        status = bus_read(core, base + op2, instr->size, &value);
+        if (status < 0) return ARM_EXEC_FAULT;
+        if (instr->sign_extend) {
+            value = instr->size == 1 ? (uint32_t)(int32_t)(int8_t)value : (uint32_t)(int32_t)(int16_t)value;
+        }
+        reg_write(core, instr->rd, value);
+        break;
+    }
+    case ARM_INSTR_STR:
+        status = bus_write(core, reg_read(core, instr->rn) + op2, instr->size, reg_read(core, instr->rd));
+        if (status < 0) return ARM_EXEC_FAULT;
+        break;
+    case ARM_INSTR_STM:
+    case ARM_INSTR_PUSH: {
+        uint32_t list = (uint32_t)instr->immediate;
+        uint32_t bytes = (uint32_t)__builtin_popcount(list) * 4;
+        addr = instr->type == ARM_INSTR_PUSH ? core->sp - bytes : reg_read(core, instr->rn);
+        for (uint8_t i = 0, at = 0; i < 15; i++) {
+            if (!(list & (1u << i))) continue;
+            if (bus_write(core, addr + at, 4, reg_read(core, i)) < 0) return ARM_EXEC_FAULT;
+            at += 4;
+        }
+        if (instr->type == ARM_INSTR_PUSH) {
+            core->sp = addr;
+        } else {
+            reg_write(core, instr->rn, addr + bytes);
+        }
+        break;
+    }
+    case ARM_INSTR_LDM:
+    case ARM_INSTR_POP: {
+        uint32_t list = (uint32_t)instr->immediate;
+        uint32_t loaded[16];
+        addr = instr->type == ARM_INSTR_POP ? core->sp : reg_read(core, instr->rn);
+        /* Load everything first, so a fault leaves the registers alone */
+        for (uint8_t i = 0, at = 0; i < 16; i++) {
+            if (!(list & (1u << i))) continue;
+            if (bus_read(core, addr + at, 4, &loaded[i]) < 0) return ARM_EXEC_FAULT;
+            at += 4;
+        }
+        if ((list & (1u << 15)) && branch_exchange(loaded[15], &next_pc) < 0) return ARM_EXEC_FAULT;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (list & (1u << i)) core->r[i] = loaded[i];
+        }
+        uint32_t end = addr + (uint32_t)__builtin_popcount(list) * 4;
+        if (instr->type == ARM_INSTR_POP) {
+            core->sp = end;
+        } else if (!(list & (1u << instr->rn))) {
+            core->r[instr->rn] = end;
+        }
+        break;
+    }
+
+    /* Branches */
+    case ARM_INSTR_B:
+        if (arm_check_condition(core, instr->condition)) next_pc = pc + 4 + (uint32_t)instr->immediate;
+        break;
+    case ARM_INSTR_BL:
+        core->lr = (pc + 4) | 1;
+        next_pc = pc + 4 + (uint32_t)instr->immediate;
+        break;
+    case ARM_INSTR_BX:
+        if (branch_exchange(op2, &next_pc) < 0) return ARM_EXEC_FAULT;
+        break;
+    case ARM_INSTR_BLX:
+        if (branch_exchange(op2, &next_pc) < 0) return ARM_EXEC_FAULT;
+        core->lr = (pc + 2) | 1;
+        break;
+
+    /* System */
+    case ARM_INSTR_MRS:
+        switch (instr->immediate) {
+        case 0 ... 7:
+            /* Bit 0 selects IPSR, bit 2 drops APSR; EPSR reads as zero */
+            result = ((instr->immediate & 4) ? 0 : core->psr & APSR_FLAGS) |
+                     ((instr->immediate & 1) ? core->psr & PSR_IPSR_MASK : 0);
+            break;
+        case SYSM_MSP:
+        case SYSM_PSP:      result = core->sp; break;
+        case SYSM_PRIMASK:  result = core->primask & 1; break;
+        case SYSM_CONTROL:  result = core->control & 3; break;
+        default:            result = 0; break;
+        }
+        reg_write(core, instr->rd, result);
+        break;
+    case ARM_INSTR_MSR:
+        value = reg_read(core, instr->rn);
+        switch (instr->immediate) {
+        case SYSM_APSR:     core->psr = (core->psr & ~APSR_FLAGS) | (value & APSR_FLAGS); break;
+        case SYSM_MSP:
+        case SYSM_PSP:      core->sp = value & ~3u; break;
+        case SYSM_PRIMASK:  core->primask = value & 1; break;
+        case SYSM_CONTROL:  core->control = value & 3; break;
+        default:            break;
+        }
+        break;
+    case ARM_INSTR_CPS:
+        core->primask = (uint32_t)instr->immediate;
+        break;
+    case ARM_INSTR_NOP:
+    case ARM_INSTR_WFI:
+        break;
+    case ARM_INSTR_BKPT:
+        return ARM_EXEC_BREAK;
+    default:
+        /* SVC and anything else needing the exception model */
+        return ARM_EXEC_FAULT;
+    }
+
+    core->pc = next_pc;
+    return ARM_EXEC_OK;
+
+write_rd:
+    if (instr->rd == 15) {
+        /* ADD PC / MOV PC: a branch, without interworking */
+        next_pc = result & ~1u;
+    } else {
+        reg_write(core, instr->rd, result);
+    }
+    core->pc = next_pc;
+    return ARM_EXEC_OK;
+}
+
+/**
+ * Decode and execute one instruction at core->pc
+ */
+int arm_thumb2_execute(arm_core_state_t *core, uint32_t instruction, uint8_t instr_len)
+{
+    arm_instruction_t instr;
+
+    if (arm_thumb2_decode(instruction, instr_len, &instr) < 0) {
+        return ARM_EXEC_FAULT;
+    }
+    return arm_thumb2_execute_decoded(core, &instr, instr_len);
 }
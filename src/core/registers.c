@@ -1,5 +1,6 @@
 // src/core/registers.c
 #include "core/registers.h"
+#include "memory/sram.h"
 #include <string.h>
 
 /**
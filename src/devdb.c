@@ -0,0 +1,353 @@
+#include "../include/devdb.h"
+#include "../include/cache.h"
+#include "../include/intern.h"
+#include "../include/type_system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DEVDB_ALIGN(n) (((n) + 3u) & ~(size_t)3u)
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+typedef struct {
+    char *data;
+    size_t size;
+    size_t strings;              // Start of the string table
+    size_t strings_used;
+    uint32_t *atom_offsets;      // Atom -> string offset, 0 = not stored yet
+    size_t atom_count;
+} DevDbWriter;
+
+// Intern-table atoms are dense, so each distinct name is stored once.
+static uint32_t devdb_put_name(DevDbWriter *w, Atom atom) {
+    if (atom == ATOM_NONE || atom >= w->atom_count) return 0;
+    if (w->atom_offsets[atom] == 0) {
+        size_t length = atom_length(atom) + 1;
+        memcpy(w->data + w->strings + w->strings_used, atom_name(atom), length);
+        w->atom_offsets[atom] = (uint32_t)w->strings_used;
+        w->strings_used += length;
+    }
+    return w->atom_offsets[atom];
+}
+
+static void devdb_put_register(DevDbWriter *w, DevDbRegister *out, DevDbField *fields,
+                               uint32_t *field_next, const ASTRegister *reg) {
+    out->name = devdb_put_name(w, reg->name);
+    out->offset = reg->offset;
+    out->type = reg->type ? (uint32_t)reg->type->kind : (uint32_t)TYPE_U32;
+    out->first_field = *field_next;
+    out->field_count = (uint32_t)reg->field_count;
+
+    for (size_t f = 0; f < reg->field_count; f++) {
+        const ASTField *field = reg->fields[f];
+        DevDbField *record = &fields[(*field_next)++];
+        record->name = devdb_put_name(w, field->name);
+        record->start_bit = field->start_bit;
+        record->end_bit = field->end_bit;
+        record->access = (uint32_t)field->access;
+    }
+}
+
+typedef struct {
+    const char *name;
+    uint32_t peripheral;
+} DevDbIndexEntry;
+
+static int devdb_index_cmp(const void *a, const void *b) {
+    const DevDbIndexEntry *x = (const DevDbIndexEntry *)a;
+    const DevDbIndexEntry *y = (const DevDbIndexEntry *)b;
+    int order = strcmp(x->name, y->name);
+    if (order != 0) return order;
+    return x->peripheral < y->peripheral ? -1 : (x->peripheral > y->peripheral);
+}
+
+int devdb_write(const ASTProgram *program, const char *path) {
+    size_t clusters = 0, registers = 0, fields = 0, names = 1;
+
+    for (size_t p = 0; p < program->peripheral_count; p++) {
+        const ASTPeripheral *periph = program->peripherals[p];
+        names += atom_length(periph->name) + 1;
+        for (size_t r = 0; r < periph->register_count; r++) {
+            const ASTRegister *reg = periph->registers[r];
+            names += atom_length(reg->name) + 1;
+            for (size_t f = 0; f < reg->field_count; f++) {
+                names += atom_length(reg->fields[f]->name) + 1;
+            }
+            fields += reg->field_count;
+        }
+        registers += periph->register_count;
+        for (size_t c = 0; c < periph->cluster_count; c++) {
+            const ASTCluster *cluster = periph->clusters[c];
+            names += atom_length(cluster->name) + 1;
+            for (size_t r = 0; r < cluster->register_count; r++) {
+                const ASTRegister *reg = cluster->registers[r];
+                names += atom_length(reg->name) + 1;
+                for (size_t f = 0; f < reg->field_count; f++) {
+                    names += atom_length(reg->fields[f]->name) + 1;
+                }
+                fields += reg->field_count;
+            }
+            registers += cluster->register_count;
+        }
+        clusters += periph->cluster_count;
+    }
+
+    // Every table is made of uint32_t, so 4-byte alignment is all they need.
+    size_t peripherals_at = DEVDB_ALIGN(sizeof(DevDbHeader));
+    size_t clusters_at = peripherals_at + program->peripheral_count * sizeof(DevDbPeripheral);
+    size_t registers_at = clusters_at + clusters * sizeof(DevDbCluster);
+    size_t fields_at = registers_at + registers * sizeof(DevDbRegister);
+    size_t index_at = fields_at + fields * sizeof(DevDbField);
+    size_t strings_at = index_at + program->peripheral_count * sizeof(uint32_t);
+    size_t size = DEVDB_ALIGN(strings_at + names);   // Upper bound; names are deduplicated
+    if (size > UINT32_MAX) return -1;
+
+    DevDbWriter w;
+    w.data = (char *)calloc(1, size);
+    w.strings = strings_at;
+    w.strings_used = 1;
+    w.atom_count = intern_count() + 1;
+    w.atom_offsets = (uint32_t *)calloc(w.atom_count, sizeof(uint32_t));
+    DevDbIndexEntry *entries = (DevDbIndexEntry *)malloc(
+        (program->peripheral_count + 1) * sizeof(DevDbIndexEntry));
+    if (!w.data || !w.atom_offsets || !entries) {
+        free(w.data);
+        free(w.atom_offsets);
+        free(entries);
+        return -1;
+    }
+
+    DevDbPeripheral *periph_out = (DevDbPeripheral *)(w.data + peripherals_at);
+    DevDbCluster *cluster_out = (DevDbCluster *)(w.data + clusters_at);
+    DevDbRegister *reg_out = (DevDbRegister *)(w.data + registers_at);
+    DevDbField *field_out = (DevDbField *)(w.data + fields_at);
+    uint32_t cluster_next = 0, reg_next = 0, field_next = 0;
+
+    for (size_t p = 0; p < program->peripheral_count; p++) {
+        const ASTPeripheral *periph = program->peripherals[p];
+        DevDbPeripheral *record = &periph_out[p];
+        record->name = devdb_put_name(&w, periph->name);
+        record->base_address = periph->base_address;
+
+        record->first_register = reg_next;
+        record->register_count = (uint32_t)periph->register_count;
+        for (size_t r = 0; r < periph->register_count; r++) {
+            devdb_put_register(&w, &reg_out[reg_next++], field_out, &field_next,
+                               periph->registers[r]);
+        }
+
+        record->first_cluster = cluster_next;
+        record->cluster_count = (uint32_t)periph->cluster_count;
+        for (size_t c = 0; c < periph->cluster_count; c++) {
+            const ASTCluster *cluster = periph->clusters[c];
+            DevDbCluster *group = &cluster_out[cluster_next++];
+            group->name = devdb_put_name(&w, cluster->name);
+            group->offset = cluster->offset;
+            group->count = cluster->count;
+            group->stride = cluster->stride;
+            group->first_register = reg_next;
+            group->register_count = (uint32_t)cluster->register_count;
+            for (size_t r = 0; r < cluster->register_count; r++) {
+                devdb_put_register(&w, &reg_out[reg_next++], field_out, &field_next,
+                                   cluster->registers[r]);
+            }
+        }
+
+        entries[p].name = atom_name(periph->name);
+        entries[p].peripheral = (uint32_t)p;
+    }
+
+    qsort(entries, program->peripheral_count, sizeof(DevDbIndexEntry), devdb_index_cmp);
+    uint32_t *index = (uint32_t *)(w.data + index_at);
+    for (size_t p = 0; p < program->peripheral_count; p++) {
+        index[p] = entries[p].peripheral;
+    }
+
+    size = DEVDB_ALIGN(strings_at + w.strings_used);
+
+    DevDbHeader *header = (DevDbHeader *)w.data;
+    memcpy(header->magic, DEVDB_MAGIC, sizeof(header->magic));
+    header->version = DEVDB_VERSION;
+    header->header_size = sizeof(DevDbHeader);
+    header->file_size = (uint32_t)size;
+    header->peripheral_count = (uint32_t)program->peripheral_count;
+    header->cluster_count = (uint32_t)clusters;
+    header->register_count = (uint32_t)registers;
+    header->field_count = (uint32_t)fields;
+    header->peripherals = (uint32_t)peripherals_at;
+    header->clusters = (uint32_t)clusters_at;
+    header->registers = (uint32_t)registers_at;
+    header->fields = (uint32_t)fields_at;
+    header->index = (uint32_t)index_at;
+    header->strings = (uint32_t)strings_at;
+    header->strings_size = (uint32_t)w.strings_used;
+
+    int result = file_write_if_changed(path, w.data, size) < 0 ? -1 : 0;
+
+    free(entries);
+    free(w.atom_offsets);
+    free(w.data);
+    return result;
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+int devdb_is_database(const char *data, size_t length) {
+    return length >= sizeof(DevDbHeader) && memcmp(data, DEVDB_MAGIC, 8) == 0;
+}
+
+// A table of count records of size bytes at offset lies inside the file.
+static int devdb_table_ok(size_t length, uint32_t offset, uint32_t count, size_t size) {
+    return offset % 4 == 0 && offset <= length &&
+           (uint64_t)count * size <= (uint64_t)(length - offset);
+}
+
+static int devdb_range_ok(uint32_t first, uint32_t count, uint32_t total) {
+    return first <= total && count <= total - first;
+}
+
+int devdb_attach(DevDb *db, const char *data, size_t length) {
+    memset(db, 0, sizeof(*db));
+    if (!devdb_is_database(data, length) || (uintptr_t)data % 4 != 0) return -1;
+
+    const DevDbHeader *h = (const DevDbHeader *)data;
+    if (h->version != DEVDB_VERSION || h->header_size != sizeof(DevDbHeader) ||
+        h->file_size != length ||
+        !devdb_table_ok(length, h->peripherals, h->peripheral_count, sizeof(DevDbPeripheral)) ||
+        !devdb_table_ok(length, h->clusters, h->cluster_count, sizeof(DevDbCluster)) ||
+        !devdb_table_ok(length, h->registers, h->register_count, sizeof(DevDbRegister)) ||
+        !devdb_table_ok(length, h->fields, h->field_count, sizeof(DevDbField)) ||
+        !devdb_table_ok(length, h->index, h->peripheral_count, sizeof(uint32_t)) ||
+        !devdb_table_ok(length, h->strings, h->strings_size, 1) ||
+        h->strings_size == 0 || data[h->strings] != '\0' ||
+        data[h->strings + h->strings_size - 1] != '\0') {
+        return -1;
+    }
+
+    db->header = h;
+    db->peripherals = (const DevDbPeripheral *)(data + h->peripherals);
+    db->clusters = (const DevDbCluster *)(data + h->clusters);
+    db->registers = (const DevDbRegister *)(data + h->registers);
+    db->fields = (const DevDbField *)(data + h->fields);
+    db->index = (const uint32_t *)(data + h->index);
+    db->strings = data + h->strings;
+
+    // Check every record once so readers can follow indices blindly.
+    uint32_t names = h->strings_size;
+    for (uint32_t i = 0; i < h->peripheral_count; i++) {
+        const DevDbPeripheral *p = &db->peripherals[i];
+        if (p->name >= names || db->index[i] >= h->peripheral_count ||
+            !devdb_range_ok(p->first_register, p->register_count, h->register_count) ||
+            !devdb_range_ok(p->first_cluster, p->cluster_count, h->cluster_count)) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < h->cluster_count; i++) {
+        const DevDbCluster *c = &db->clusters[i];
+        if (c->name >= names ||
+            !devdb_range_ok(c->first_register, c->register_count, h->register_count)) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < h->register_count; i++) {
+        const DevDbRegister *r = &db->registers[i];
+        if (r->name >= names || r->type > TYPE_I64 ||
+            !devdb_range_ok(r->first_field, r->field_count, h->field_count)) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < h->field_count; i++) {
+        const DevDbField *f = &db->fields[i];
+        if (f->name >= names || f->access > ACCESS_W1C) return -1;
+    }
+    for (uint32_t i = 1; i < h->peripheral_count; i++) {
+        if (strcmp(devdb_string(db, db->peripherals[db->index[i - 1]].name),
+                   devdb_string(db, db->peripherals[db->index[i]].name)) > 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int devdb_open(DevDb *db, const char *path) {
+    SourceFile file;
+    if (source_open(&file, path) != 0) return -1;
+    if (devdb_attach(db, file.data, file.length) != 0) {
+        source_close(&file);
+        return -1;
+    }
+    db->file = file;
+    return 0;
+}
+
+void devdb_close(DevDb *db) {
+    if (db->file.data) source_close(&db->file);
+    memset(db, 0, sizeof(*db));
+}
+
+const char *devdb_string(const DevDb *db, uint32_t offset) {
+    return db->strings + offset;
+}
+
+const DevDbPeripheral *devdb_find(const DevDb *db, const char *name) {
+    size_t lo = 0, hi = db->header->peripheral_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const DevDbPeripheral *p = &db->peripherals[db->index[mid]];
+        int order = strcmp(devdb_string(db, p->name), name);
+        if (order == 0) return p;
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+static ASTRegister *devdb_build_register(const DevDb *db, Arena *arena, const DevDbRegister *r) {
+    ASTRegister *reg = ast_register_create(arena, intern_cstr(devdb_string(db, r->name)),
+                                           type_from_kind((TypeKind)r->type), r->offset);
+    for (uint32_t f = 0; f < r->field_count; f++) {
+        const DevDbField *field = &db->fields[r->first_field + f];
+        ast_register_add_field(arena, reg,
+            ast_field_create(arena, intern_cstr(devdb_string(db, field->name)),
+                             field->start_bit, field->end_bit, (AccessKind)field->access));
+    }
+    return reg;
+}
+
+ASTProgram *devdb_to_program(const DevDb *db) {
+    ASTProgram *program = ast_program_create();
+    if (!program) return NULL;
+    Arena *arena = program->arena;
+
+    for (uint32_t p = 0; p < db->header->peripheral_count; p++) {
+        const DevDbPeripheral *record = &db->peripherals[p];
+        ASTPeripheral *periph = ast_peripheral_create(
+            arena, intern_cstr(devdb_string(db, record->name)), record->base_address);
+
+        for (uint32_t r = 0; r < record->register_count; r++) {
+            ast_peripheral_add_register(arena, periph,
+                devdb_build_register(db, arena, &db->registers[record->first_register + r]));
+        }
+        for (uint32_t c = 0; c < record->cluster_count; c++) {
+            const DevDbCluster *group = &db->clusters[record->first_cluster + c];
+            ASTCluster *cluster = ast_cluster_create(
+                arena, intern_cstr(devdb_string(db, group->name)),
+                group->offset, group->count, group->stride);
+            for (uint32_t r = 0; r < group->register_count; r++) {
+                ast_cluster_add_register(arena, cluster,
+                    devdb_build_register(db, arena, &db->registers[group->first_register + r]));
+            }
+            ast_peripheral_add_cluster(arena, periph, cluster);
+        }
+        ast_program_add_peripheral(program, periph);
+    }
+    return program;
+}
@@ -0,0 +1,145 @@
+#include "../include/intern.h"
+#include "../include/arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_INITIAL_SLOTS 1024
+
+typedef struct {
+    const char *name;
+    uint32_t length;
+    uint32_t hash;
+} InternEntry;
+
+typedef struct {
+    Atom *slots;              // Open-addressed, power-of-two sized; 0 = empty
+    size_t slot_count;
+    InternEntry *entries;     // Indexed by atom
+    size_t entry_count;
+    size_t entry_capacity;
+    Arena *strings;           // Backing storage for the names
+} InternTable;
+
+// One table per thread so independent compilations can run side by side.
+static _Thread_local InternTable table;
+
+static uint32_t intern_hash(const char *text, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int intern_init(void) {
+    table.slots = (Atom *)calloc(INTERN_INITIAL_SLOTS, sizeof(Atom));
+    table.entries = (InternEntry *)malloc(INTERN_INITIAL_SLOTS * sizeof(InternEntry));
+    table.strings = arena_create(ARENA_DEFAULT_CHUNK_SIZE);
+    if (!table.slots || !table.entries || !table.strings) {
+        free(table.slots);
+        free(table.entries);
+        arena_destroy(table.strings);
+        memset(&table, 0, sizeof(table));
+        return -1;
+    }
+    table.slot_count = INTERN_INITIAL_SLOTS;
+    table.entry_capacity = INTERN_INITIAL_SLOTS;
+
+    // Atom 0 is the empty name.
+    table.entries[0].name = "";
+    table.entries[0].length = 0;
+    table.entries[0].hash = 0;
+    table.entry_count = 1;
+    return 0;
+}
+
+static int intern_grow_slots(void) {
+    size_t new_count = table.slot_count * 2;
+    Atom *slots = (Atom *)calloc(new_count, sizeof(Atom));
+    if (!slots) return -1;
+
+    for (size_t atom = 1; atom < table.entry_count; atom++) {
+        size_t i = table.entries[atom].hash & (new_count - 1);
+        while (slots[i]) i = (i + 1) & (new_count - 1);
+        slots[i] = (Atom)atom;
+    }
+
+    free(table.slots);
+    table.slots = slots;
+    table.slot_count = new_count;
+    return 0;
+}
+
+Atom intern(const char *text, size_t length) {
+    if (!text || length == 0) return ATOM_NONE;
+    if (!table.slots && intern_init() != 0) return ATOM_NONE;
+
+    uint32_t hash = intern_hash(text, length);
+    size_t mask = table.slot_count - 1;
+    size_t i = hash & mask;
+
+    while (table.slots[i]) {
+        InternEntry *entry = &table.entries[table.slots[i]];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->name, text, length) == 0) {
+            return table.slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Keep the load factor at or below 1/2.
+    if ((table.entry_count + 1) * 2 > table.slot_count) {
+        if (intern_grow_slots() != 0) return ATOM_NONE;
+        mask = table.slot_count - 1;
+        i = hash & mask;
+        while (table.slots[i]) i = (i + 1) & mask;
+    }
+
+    if (table.entry_count == table.entry_capacity) {
+        size_t new_capacity = table.entry_capacity * 2;
+        InternEntry *entries = (InternEntry *)realloc(table.entries, new_capacity * sizeof(InternEntry));
+        if (!entries) return ATOM_NONE;
+        table.entries = entries;
+        table.entry_capacity = new_capacity;
+    }
+
+    char *copy = (char *)arena_alloc(table.strings, length + 1);
+    if (!copy) return ATOM_NONE;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    Atom atom = (Atom)table.entry_count++;
+    table.entries[atom].name = copy;
+    table.entries[atom].length = (uint32_t)length;
+    table.entries[atom].hash = hash;
+    table.slots[i] = atom;
+    return atom;
+}
+
+Atom intern_cstr(const char *text) {
+    return text ? intern(text, strlen(text)) : ATOM_NONE;
+}
+
+const char *atom_name(Atom atom) {
+    if (atom >= table.entry_count) return "";
+    return table.entries[atom].name;
+}
+
+size_t atom_length(Atom atom) {
+    if (atom >= table.entry_count) return 0;
+    return table.entries[atom].length;
+}
+
+size_t intern_count(void) {
+    return table.entry_count ? table.entry_count - 1 : 0;
+}
+
+void intern_reset(void) {
+    free(table.slots);
+    free(table.entries);
+    arena_destroy(table.strings);
+    memset(&table, 0, sizeof(table));
+}
@@ -0,0 +1,359 @@
+// src/isa/arm/decoder.c
+#include "isa/arm/decoder.h"
+#include <string.h>
+
+/* Data processing (0x4000-0x43FF), indexed by bits 9:6 */
+static const arm_instruction_type_t thumb_alu[16] = {
+    ARM_INSTR_AND, ARM_INSTR_XOR, ARM_INSTR_LSL, ARM_INSTR_LSR,
+    ARM_INSTR_ASR, ARM_INSTR_ADC, ARM_INSTR_SBC, ARM_INSTR_ROR,
+    ARM_INSTR_TST, ARM_INSTR_RSB, ARM_INSTR_CMP, ARM_INSTR_CMN,
+    ARM_INSTR_ORR, ARM_INSTR_MUL, ARM_INSTR_BIC, ARM_INSTR_MVN
+};
+
+/**
+ * Decode a 16-bit Thumb instruction. Returns -1 if it is undefined.
+ */
+static int thumb16_decode(uint16_t hw, arm_instruction_t *instr)
+{
+    uint8_t lo0 = hw & 7, lo3 = (hw >> 3) & 7, lo6 = (hw >> 6) & 7;
+    uint8_t hi8 = (hw >> 8) & 7;
+    uint32_t imm5 = (hw >> 6) & 0x1F;
+    uint32_t imm8 = hw & 0xFF;
+
+    switch (hw >> 11) {
+    case 0x00:  /* LSLS Rd, Rm, #imm5 (MOVS Rd, Rm when imm5 == 0) */
+    case 0x01:  /* LSRS Rd, Rm, #imm5 */
+    case 0x02:  /* ASRS Rd, Rm, #imm5 */
+        instr->rd = lo0; instr->rm = lo3;
+        instr->setflags = true;
+        if ((hw >> 11) == 0x00 && imm5 == 0) {
+            instr->type = ARM_INSTR_MOV;
+            return 0;
+        }
+        instr->type = (hw >> 11) == 0x00 ? ARM_INSTR_LSL : (hw >> 11) == 0x01 ? ARM_INSTR_LSR : ARM_INSTR_ASR;
+        instr->shift_type = (uint8_t)(hw >> 11);
+        instr->shift_amount = imm5 ? imm5 : 32;
+        instr->use_imm = true;
+        return 0;
+    case 0x03:  /* ADDS/SUBS Rd, Rn, Rm / #imm3 */
+        instr->type = (hw & (1 << 9)) ? ARM_INSTR_SUB : ARM_INSTR_ADD;
+        instr->rd = lo0; instr->rn = lo3;
+        instr->setflags = true;
+        if (hw & (1 << 10)) {
+            instr->use_imm = true;
+            instr->immediate = lo6;
+        } else {
+            instr->rm = lo6;
+        }
+        return 0;
+    case 0x04:  /* MOVS Rd, #imm8 */
+    case 0x05:  /* CMP Rn, #imm8 */
+    case 0x06:  /* ADDS Rdn, #imm8 */
+    case 0x07: { /* SUBS Rdn, #imm8 */
+        static const arm_instruction_type_t imm_ops[4] = {
+            ARM_INSTR_MOV, ARM_INSTR_CMP, ARM_INSTR_ADD, ARM_INSTR_SUB
+        };
+        instr->type = imm_ops[(hw >> 11) & 3];
+        instr->rd = instr->rn = hi8;
+        instr->immediate = (int32_t)imm8;
+        instr->use_imm = true;
+        instr->setflags = true;
+        return 0;
+    }
+    case 0x08:
+        if ((hw & 0xFC00) == 0x4000) {
+            /* Data processing: Rdn = Rdn op Rm */
+            instr->type = thumb_alu[(hw >> 6) & 0xF];
+            instr->rd = instr->rn = lo0;
+            instr->rm = lo3;
+            instr->setflags = true;
+            switch (instr->type) {
+            case ARM_INSTR_LSL: case ARM_INSTR_LSR: case ARM_INSTR_ASR: case ARM_INSTR_ROR:
+                /* Shift Rdn by the bottom byte of Rm */
+                instr->rm = lo0;
+                instr->rs = lo3;
+                instr->shift_type = instr->type == ARM_INSTR_LSL ? 0 : instr->type == ARM_INSTR_LSR ? 1 :
+                                    instr->type == ARM_INSTR_ASR ? 2 : 3;
+                break;
+            case ARM_INSTR_RSB:  /* RSBS Rd, Rn, #0 */
+                instr->rn = lo3;
+                instr->use_imm = true;
+                instr->immediate = 0;
+                break;
+            case ARM_INSTR_MUL:  /* MULS Rdm, Rn, Rdm */
+                instr->rn = lo3;
+                instr->rm = lo0;
+                break;
+            default:
+                break;
+            }
+            return 0;
+        } else {
+            /* High register operations and branch/exchange */
+            uint8_t rm = (hw >> 3) & 0xF;
+            uint8_t rdn = (uint8_t)(((hw >> 4) & 8) | lo0);
+            switch ((hw >> 8) & 3) {
+            case 0:  /* ADD Rdn, Rm */
+                instr->type = ARM_INSTR_ADD;
+                instr->rd = instr->rn = rdn; instr->rm = rm;
+                return 0;
+            case 1:  /* CMP Rn, Rm */
+                instr->type = ARM_INSTR_CMP;
+                instr->rn = rdn; instr->rm = rm;
+                instr->setflags = true;
+                return (rdn == 15 || rm == 15) ? -1 : 0;
+            case 2:  /* MOV Rd, Rm */
+                instr->type = ARM_INSTR_MOV;
+                instr->rd = rdn; instr->rm = rm;
+                return 0;
+            default: /* BX / BLX Rm */
+                instr->type = (hw & 0x80) ? ARM_INSTR_BLX : ARM_INSTR_BX;
+                instr->rm = rm;
+                return (lo0 != 0 || (instr->type == ARM_INSTR_BLX && rm == 15)) ? -1 : 0;
+            }
+        }
+    case 0x09:  /* LDR Rt, [PC, #imm8] */
+        instr->type = ARM_INSTR_LDR;
+        instr->rd = hi8; instr->rn = 15;
+        instr->immediate = (int32_t)(imm8 * 4);
+        instr->use_imm = true;
+        instr->size = 4;
+        return 0;
+    case 0x0A:
+    case 0x0B: {
+        /* Load/store register offset: STR STRH STRB LDRSB LDR LDRH LDRB LDRSH */
+        static const uint8_t sizes[8] = { 4, 2, 1, 1, 4, 2, 1, 2 };
+        uint8_t op = (hw >> 9) & 7;
+        instr->type = (op >= 3) ? ARM_INSTR_LDR : ARM_INSTR_STR;
+        instr->rd = lo0; instr->rn = lo3; instr->rm = lo6;
+        instr->size = sizes[op];
+        instr->sign_extend = (op == 3 || op == 7);
+        return 0;
+    }
+    case 0x0C: instr->type = ARM_INSTR_STR; instr->size = 4; goto mem_imm;
+    case 0x0D: instr->type = ARM_INSTR_LDR; instr->size = 4; goto mem_imm;
+    case 0x0E: instr->type = ARM_INSTR_STR; instr->size = 1; goto mem_imm;
+    case 0x0F: instr->type = ARM_INSTR_LDR; instr->size = 1; goto mem_imm;
+    case 0x10: instr->type = ARM_INSTR_STR; instr->size = 2; goto mem_imm;
+    case 0x11: instr->type = ARM_INSTR_LDR; instr->size = 2; goto mem_imm;
+    mem_imm:
+        instr->rd = lo0; instr->rn = lo3;
+        instr->immediate = (int32_t)(imm5 * instr->size);
+        instr->use_imm = true;
+        return 0;
+    case 0x12:  /* STR Rt, [SP, #imm8] */
+    case 0x13:  /* LDR Rt, [SP, #imm8] */
+        instr->type = (hw >> 11) == 0x12 ? ARM_INSTR_STR : ARM_INSTR_LDR;
+        instr->rd = hi8; instr->rn = 13;
+        instr->immediate = (int32_t)(imm8 * 4);
+        instr->use_imm = true;
+        instr->size = 4;
+        return 0;
+    case 0x14:  /* ADR Rd, label */
+    case 0x15:  /* ADD Rd, SP, #imm8 */
+        instr->type = ARM_INSTR_ADD;
+        instr->rd = hi8; instr->rn = (hw >> 11) == 0x14 ? 15 : 13;
+        instr->immediate = (int32_t)(imm8 * 4);
+        instr->use_imm = true;
+        return 0;
+    case 0x16:
+    case 0x17:
+        /* Miscellaneous */
+        if ((hw & 0xFF00) == 0xB000) {
+            /* ADD/SUB SP, SP, #imm7 */
+            int32_t imm = (int32_t)((hw & 0x7F) * 4);
+            instr->type = ARM_INSTR_ADD;
+            instr->rd = instr->rn = 13;
+            instr->immediate = (hw & 0x80) ? -imm : imm;
+            instr->use_imm = true;
+            return 0;
+        }
+        if ((hw & 0xFF00) == 0xB200) {
+            static const arm_instruction_type_t ext[4] = {
+                ARM_INSTR_SXTH, ARM_INSTR_SXTB, ARM_INSTR_UXTH, ARM_INSTR_UXTB
+            };
+            instr->type = ext[(hw >> 6) & 3];
+            instr->rd = lo0; instr->rm = lo3;
+            return 0;
+        }
+        if ((hw & 0xFF00) == 0xBA00 && ((hw >> 6) & 3) != 2) {
+            static const arm_instruction_type_t rev[4] = {
+                ARM_INSTR_REV, ARM_INSTR_REV16, ARM_INSTR_INVALID, ARM_INSTR_REVSH
+            };
+            instr->type = rev[(hw >> 6) & 3];
+            instr->rd = lo0; instr->rm = lo3;
+            return 0;
+        }
+        if ((hw & 0xFE00) == 0xB400) {
+            /* PUSH {list, LR} */
+            instr->type = ARM_INSTR_PUSH;
+            instr->immediate = (int32_t)(imm8 | ((hw & 0x100) ? (1u << 14) : 0));
+            return instr->immediate ? 0 : -1;
+        }
+        if ((hw & 0xFE00) == 0xBC00) {
+            /* POP {list, PC} */
+            instr->type = ARM_INSTR_POP;
+            instr->immediate = (int32_t)(imm8 | ((hw & 0x100) ? (1u << 15) : 0));
+            return instr->immediate ? 0 : -1;
+        }
+        if ((hw & 0xFF00) == 0xBE00) {
+            instr->type = ARM_INSTR_BKPT;
+            instr->immediate = (int32_t)imm8;
+            return 0;
+        }
+        if ((hw & 0xFFEF) == 0xB662) {
+            /* CPSIE/CPSID i */
+            instr->type = ARM_INSTR_CPS;
+            instr->immediate = (hw >> 4) & 1;
+            return 0;
+        }
+        if ((hw & 0xFF0F) == 0xBF00 && ((hw >> 4) & 0xF) <= 4) {
+            /* NOP, YIELD, WFE, WFI, SEV: nothing to wait for or signal */
+            instr->type = ((hw >> 4) & 0xF) == 3 ? ARM_INSTR_WFI : ARM_INSTR_NOP;
+            return 0;
+        }
+        return -1;
+    case 0x18:  /* STM Rn!, {list} */
+    case 0x19:  /* LDM Rn!, {list} */
+        instr->type = (hw >> 11) == 0x18 ? ARM_INSTR_STM : ARM_INSTR_LDM;
+        instr->rn = hi8;
+        instr->immediate = (int32_t)imm8;
+        return imm8 ? 0 : -1;
+    case 0x1A:
+    case 0x1B: {
+        /* B<cond> label (cond 14 is UDF, 15 is SVC) */
+        uint8_t cond = (hw >> 8) & 0xF;
+        if (cond == 14) return -1;
+        if (cond == 15) {
+            instr->type = ARM_INSTR_SVC;
+            instr->immediate = (int32_t)imm8;
+            return 0;
+        }
+        instr->type = ARM_INSTR_B;
+        instr->condition = cond;
+        instr->immediate = (int32_t)(int8_t)imm8 * 2;
+        return 0;
+    }
+    case 0x1C:  /* B label */
+        instr->type = ARM_INSTR_B;
+        instr->condition = 0xE;
+        instr->immediate = (int32_t)((uint32_t)(hw & 0x7FF) << 21) >> 20;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Decode a 32-bit Thumb instruction (first halfword in the low 16 bits).
+ * Returns -1 for anything ARMv6-M does not define.
+ */
+static int thumb32_decode(uint16_t hw1, uint16_t hw2, arm_instruction_t *instr)
+{
+    if ((hw1 & 0xF800) == 0xF000 && (hw2 & 0xD000) == 0xD000) {
+        /* BL label */
+        uint32_t s = (hw1 >> 10) & 1;
+        uint32_t i1 = !(((hw2 >> 13) & 1) ^ s);
+        uint32_t i2 = !(((hw2 >> 11) & 1) ^ s);
+        uint32_t imm = (s << 24) | (i1 << 23) | (i2 << 22) |
+                       ((uint32_t)(hw1 & 0x3FF) << 12) | ((uint32_t)(hw2 & 0x7FF) << 1);
+        instr->type = ARM_INSTR_BL;
+        instr->immediate = (int32_t)(imm << 7) >> 7;
+        return 0;
+    }
+    if (hw1 == 0xF3EF && (hw2 & 0xF000) == 0x8000) {
+        /* MRS Rd, spec_reg */
+        instr->type = ARM_INSTR_MRS;
+        instr->rd = (hw2 >> 8) & 0xF;
+        instr->immediate = hw2 & 0xFF;
+        return instr->rd >= 13 ? -1 : 0;
+    }
+    if ((hw1 & 0xFFF0) == 0xF380 && (hw2 & 0xFF00) == 0x8800) {
+        /* MSR spec_reg, Rn */
+        instr->type = ARM_INSTR_MSR;
+        instr->rn = hw1 & 0xF;
+        instr->immediate = hw2 & 0xFF;
+        return instr->rn >= 13 ? -1 : 0;
+    }
+    if (hw1 == 0xF3BF && (hw2 & 0xFF00) == 0x8F00 && ((hw2 >> 4) & 0xF) >= 4 && ((hw2 >> 4) & 0xF) <= 6) {
+        /* DSB, DMB, ISB: accesses already complete in order */
+        instr->type = ARM_INSTR_NOP;
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * Decode a Thumb instruction of instr_len bytes. For 32-bit encodings the
+ * first halfword is in the low 16 bits. Returns -1 (with type
+ * ARM_INSTR_INVALID) for undefined or unsupported encodings.
+ */
+int arm_thumb2_decode(uint32_t instruction, uint8_t instr_len, arm_instruction_t *instr)
+{
+    if (!instr) return -1;
+
+    memset(instr, 0, sizeof(arm_instruction_t));
+    instr->raw_instruction = instruction;
+    instr->condition = 0xE;
+
+    int result = instr_len == 4 ? thumb32_decode((uint16_t)instruction, (uint16_t)(instruction >> 16), instr)
+                                : thumb16_decode((uint16_t)instruction, instr);
+    if (result < 0 || instr->type == ARM_INSTR_INVALID) {
+        instr->type = ARM_INSTR_INVALID;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * ThumbExpandImm: the 32-bit constant encoded by a Thumb-2 imm12
+ */
+uint32_t arm_decode_imm12(uint32_t imm12)
+{
+    uint32_t imm8 = imm12 & 0xFF;
+
+    switch ((imm12 >> 8) & 0xF) {
+    case 0: return imm8;
+    case 1: return (imm8 << 16) | imm8;
+    case 2: return (imm8 << 24) | (imm8 << 8);
+    case 3: return (imm8 << 24) | (imm8 << 16) | (imm8 << 8) | imm8;
+    default: {
+        uint32_t value = 0x80 | (imm12 & 0x7F);
+        uint32_t rotate = (imm12 >> 7) & 0x1F;
+        return (value >> rotate) | (value << (32 - rotate));
+    }
+    }
+}
+
+/**
+ * ARM modified immediate: imm8 rotated right by twice rotate
+ */
+uint32_t arm_decode_imm8_rotated(uint8_t imm8, uint8_t rotate)
+{
+    uint32_t amount = (rotate & 0xF) * 2u;
+    return amount ? ((uint32_t)imm8 >> amount) | ((uint32_t)imm8 << (32 - amount)) : imm8;
+}
+
+/**
+ * Whether a condition passes on the core's current flags
+ */
+bool arm_check_condition(arm_core_state_t *core, uint8_t condition)
+{
+    bool n = (core->psr & PSR_N_BIT) != 0;
+    bool z = (core->psr & PSR_Z_BIT) != 0;
+    bool c = (core->psr & PSR_C_BIT) != 0;
+    bool v = (core->psr & PSR_V_BIT) != 0;
+    bool result;
+
+    switch (condition >> 1) {
+    case 0:  result = z; break;                 /* EQ/NE */
+    case 1:  result = c; break;                 /* CS/CC */
+    case 2:  result = n; break;                 /* MI/PL */
+    case 3:  result = v; break;                 /* VS/VC */
+    case 4:  result = c && !z; break;           /* HI/LS */
+    case 5:  result = n == v; break;            /* GE/LT */
+    case 6:  result = !z && n == v; break;      /* GT/LE */
+    default: return true;                       /* AL */
+    }
+    return (condition & 1) ? !result : result;
+}
@@ -26,8 +26,7 @@ static char lexer_peek(Lexer *lexer) {
     return lexer->input[lexer->pos + 1];
 }
 
-Lexer *lexer_create(const char *input) {
-    Lexer *lexer = (Lexer *)malloc(sizeof(Lexer));
+static void lexer_init(Lexer *lexer, const char *input) {
     lexer->input = input;
     lexer->pos = 0;
     lexer->line = 1;
@@ -41,7 +40,11 @@ Lexer *lexer_create(const char *input) {
     lexer->last_line_indent = 0;
     lexer->at_line_start = 1;
     for (int i = 0; i < MAX_INDENT_DEPTH; i++) lexer->indent_stack[i] = 0;
+}
 
+Lexer *lexer_create(const char *input) {
+    Lexer *lexer = (Lexer *)malloc(sizeof(Lexer));
+    lexer_init(lexer, input);
     return lexer;
 }
 
@@ -87,57 +90,98 @@ static Token lexer_make_token(TokenType type, const char *value, int length, int
     tok.length = length;
     tok.line = line;
     tok.column = column;
+    tok.atom = ATOM_NONE;
     return tok;
 }
 
-static TokenType lexer_keyword_type(const char *word, int length) {
-    // Deprecated/compat
-    if (length == 2 && strncmp(word, "fn", 2) == 0) return TOK_FN;
-    if (length == 3 && strncmp(word, "mut", 3) == 0) return TOK_MUT;
-
-    // Nim-style
-    if (length == 4 && strncmp(word, "proc", 4) == 0) return TOK_PROC;
-    if (length == 4 && strncmp(word, "func", 4) == 0) return TOK_FUNC;
-    if (length == 3 && strncmp(word, "var", 3) == 0) return TOK_VAR;
-
-    // Control flow
-    if (length == 3 && strncmp(word, "let", 3) == 0) return TOK_LET;
-    if (length == 6 && strncmp(word, "return", 6) == 0) return TOK_RETURN;
-    if (length == 2 && strncmp(word, "if", 2) == 0) return TOK_IF;
-    if (length == 4 && strncmp(word, "else", 4) == 0) return TOK_ELSE;
-    if (length == 5 && strncmp(word, "while", 5) == 0) return TOK_WHILE;
-    if (length == 3 && strncmp(word, "for", 3) == 0) return TOK_FOR;
-    if (length == 2 && strncmp(word, "in", 2) == 0) return TOK_IN;
-
-    // Boolean
-    if (length == 4 && strncmp(word, "true", 4) == 0) return TOK_TRUE;
-    if (length == 5 && strncmp(word, "false", 5) == 0) return TOK_FALSE;
-
-    // Types
-    if (length == 2 && strncmp(word, "u8", 2) == 0) return TOK_U8;
-    if (length == 3 && strncmp(word, "u16", 3) == 0) return TOK_U16;
-    if (length == 3 && strncmp(word, "u32", 3) == 0) return TOK_U32;
-    if (length == 3 && strncmp(word, "u64", 3) == 0) return TOK_U64;
-    if (length == 2 && strncmp(word, "i8", 2) == 0) return TOK_I8;
-    if (length == 3 && strncmp(word, "i16", 3) == 0) return TOK_I16;
-    if (length == 3 && strncmp(word, "i32", 3) == 0) return TOK_I32;
-    if (length == 3 && strncmp(word, "i64", 3) == 0) return TOK_I64;
-    if (length == 4 && strncmp(word, "void", 4) == 0) return TOK_VOID;
-
-    // DSL keywords
-    if (length == 10 && strncmp(word, "peripheral", 10) == 0) return TOK_PERIPHERAL;
-    if (length == 8 && strncmp(word, "register", 8) == 0) return TOK_REGISTER;
-    if (length == 5 && strncmp(word, "field", 5) == 0) return TOK_FIELD;
-
-    // DSL access specifiers
-    if (length == 2 && strncmp(word, "ro", 2) == 0) return TOK_RO;
-    if (length == 2 && strncmp(word, "wo", 2) == 0) return TOK_WO;
-    if (length == 2 && strncmp(word, "rw", 2) == 0) return TOK_RW;
-    if (length == 3 && strncmp(word, "w1c", 3) == 0) return TOK_W1C;
+// Keyword recognition dispatches on the token length and first byte, so an
+// ordinary identifier costs at most one short memcmp instead of a walk over
+// every keyword. Keep token.h, this table and tests/bench/lexer_bench.c in sync.
+#define KEYWORD(text, tok) \
+    do { if (memcmp(word, text, sizeof(text) - 1) == 0) return tok; } while (0)
+
+TokenType lexer_keyword_type(const char *word, int length) {
+    switch (length) {
+        case 2:
+            switch (word[0]) {
+                case 'f': if (word[1] == 'n') return TOK_FN; break;
+                case 'i':
+                    if (word[1] == 'f') return TOK_IF;
+                    if (word[1] == 'n') return TOK_IN;
+                    if (word[1] == '8') return TOK_I8;
+                    break;
+                case 'u': if (word[1] == '8') return TOK_U8; break;
+                case 'r':
+                    if (word[1] == 'o') return TOK_RO;
+                    if (word[1] == 'w') return TOK_RW;
+                    break;
+                case 'w': if (word[1] == 'o') return TOK_WO; break;
+            }
+            break;
+
+        case 3:
+            switch (word[0]) {
+                case 'm': KEYWORD("mut", TOK_MUT); break;
+                case 'v': KEYWORD("var", TOK_VAR); break;
+                case 'l': KEYWORD("let", TOK_LET); break;
+                case 'f': KEYWORD("for", TOK_FOR); break;
+                case 'w': KEYWORD("w1c", TOK_W1C); break;
+                case 'u':
+                    KEYWORD("u16", TOK_U16);
+                    KEYWORD("u32", TOK_U32);
+                    KEYWORD("u64", TOK_U64);
+                    break;
+                case 'i':
+                    KEYWORD("i16", TOK_I16);
+                    KEYWORD("i32", TOK_I32);
+                    KEYWORD("i64", TOK_I64);
+                    break;
+            }
+            break;
+
+        case 4:
+            switch (word[0]) {
+                case 'p': KEYWORD("proc", TOK_PROC); break;
+                case 'f': KEYWORD("func", TOK_FUNC); break;
+                case 'e': KEYWORD("else", TOK_ELSE); break;
+                case 't': KEYWORD("true", TOK_TRUE); break;
+                case 'v': KEYWORD("void", TOK_VOID); break;
+            }
+            break;
+
+        case 5:
+            switch (word[0]) {
+                case 'w': KEYWORD("while", TOK_WHILE); break;
+                case 'f':
+                    KEYWORD("false", TOK_FALSE);
+                    KEYWORD("field", TOK_FIELD);
+                    break;
+            }
+            break;
+
+        case 6:
+            if (word[0] == 'r') KEYWORD("return", TOK_RETURN);
+            if (word[0] == 's') KEYWORD("stride", TOK_STRIDE);
+            break;
+
+        case 7:
+            if (word[0] == 'c') KEYWORD("cluster", TOK_CLUSTER);
+            break;
+
+        case 8:
+            if (word[0] == 'r') KEYWORD("register", TOK_REGISTER);
+            break;
+
+        case 10:
+            if (word[0] == 'p') KEYWORD("peripheral", TOK_PERIPHERAL);
+            break;
+    }
 
     return TOK_IDENTIFIER;
 }
 
+#undef KEYWORD
+
 static Token lexer_read_string(Lexer *lexer) {
     int line = lexer->line;
     int column = lexer->column;
@@ -201,7 +245,11 @@ static Token lexer_read_identifier_or_keyword(Lexer *lexer) {
     int length = (int)(lexer->pos - start_pos);
     const char *start = &lexer->input[start_pos];
     TokenType type = lexer_keyword_type(start, length);
-    return lexer_make_token(type, start, length, line, column);
+    Token tok = lexer_make_token(type, start, length, line, column);
+    if (type == TOK_IDENTIFIER) {
+        tok.atom = intern(start, (size_t)length);
+    }
+    return tok;
 }
 
 Token lexer_next_token(Lexer *lexer) {
@@ -324,3 +372,45 @@ Token lexer_next_token(Lexer *lexer) {
             return lexer_make_token(TOK_ERROR, "", 0, line, column);
     }
 }
+
+TokenStream *lexer_tokenize(const char *input) {
+    TokenStream *stream = (TokenStream *)malloc(sizeof(TokenStream));
+    if (!stream) return NULL;
+
+    // Device files average well over four bytes per token; start from that
+    // estimate so typical inputs never need to grow the array.
+    stream->capacity = strlen(input) / 4 + 16;
+    stream->count = 0;
+    stream->tokens = (Token *)malloc(stream->capacity * sizeof(Token));
+    if (!stream->tokens) {
+        free(stream);
+        return NULL;
+    }
+
+    Lexer lexer;
+    lexer_init(&lexer, input);
+
+    Token tok;
+    do {
+        tok = lexer_next_token(&lexer);
+        if (stream->count == stream->capacity) {
+            size_t new_capacity = stream->capacity * 2;
+            Token *grown = (Token *)realloc(stream->tokens, new_capacity * sizeof(Token));
+            if (!grown) {
+                token_stream_free(stream);
+                return NULL;
+            }
+            stream->tokens = grown;
+            stream->capacity = new_capacity;
+        }
+        stream->tokens[stream->count++] = tok;
+    } while (tok.type != TOK_EOF);
+
+    return stream;
+}
+
+void token_stream_free(TokenStream *stream) {
+    if (!stream) return;
+    free(stream->tokens);
+    free(stream);
+}
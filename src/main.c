@@ -7,35 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "parser.h"
-#include "ast.h"
-#include "lexer.h"
-#include "../backend/codegen/codegen.h"
-
-static const char *access_kind_name(AccessKind access) {
-    switch (access) {
-        case ACCESS_RO:  return "ro";
-        case ACCESS_WO:  return "wo";
-        case ACCESS_RW:  return "rw";
-        case ACCESS_W1C: return "w1c";
-        default:         return "?";
-    }
-}
-
-static const char *type_kind_name(TypeKind kind) {
-    switch (kind) {
-        case TYPE_VOID: return "void";
-        case TYPE_U8:   return "u8";
-        case TYPE_U16:  return "u16";
-        case TYPE_U32:  return "u32";
-        case TYPE_U64:  return "u64";
-        case TYPE_I8:   return "i8";
-        case TYPE_I16:  return "i16";
-        case TYPE_I32:  return "i32";
-        case TYPE_I64:  return "i64";
-        default:        return "?";
-    }
-}
+#include "cache.h"
+#include "compile.h"
 
 static const char *normalize_target(const char *user) {
     if (!user) return "arm-cortex-m0";
@@ -47,16 +20,57 @@ static const char *normalize_target(const char *user) {
     return user;
 }
 
+/* Compile several inputs on a worker pool; reports come out in input order. */
+static int run_jobs(const CompileOptions *opts, char **paths, size_t count, int threads) {
+    CompileJob *jobs = (CompileJob *)calloc(count, sizeof(CompileJob));
+    if (!jobs) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    for (size_t j = 0; j < count; j++) {
+        jobs[j].input_file = paths[j];
+    }
+
+    int workers = 0;
+    size_t failures = compile_jobs(opts, jobs, count, threads, &workers);
+
+    for (size_t j = 0; j < count; j++) {
+        if (j > 0) printf("\n");
+        if (jobs[j].report) {
+            fwrite(jobs[j].report, 1, jobs[j].report_length, stdout);
+        }
+        free(jobs[j].report);
+    }
+
+    printf("\n=== %zu of %zu inputs compiled (%d jobs) ===\n",
+           count - failures, count, workers);
+    for (size_t j = 0; j < count; j++) {
+        if (jobs[j].status != COMPILE_OK) {
+            fprintf(stderr, "❌ %s: %s\n", jobs[j].input_file,
+                    jobs[j].status == COMPILE_PARSE_FAILED ? "parsing failed" : "compilation failed");
+        }
+    }
+
+    free(jobs);
+    return failures ? 1 : 0;
+}
+
 int main(int argc, char *argv[]) {
     printf("=== bit(N) Compiler with DSL Support ===\n\n");
 
     const char *source         = "fn main() -> u32 { return 42; }";
-    const char *default_source = source;
-    int         should_free    = 0;
     int         do_codegen     = 0;
+    int         emit_db        = 0;
+    int         emit_obj       = 0;
     int         verbose        = 0;
-    const char *input_file     = NULL;
+    int         threads        = 0;   /* 0 = one per CPU */
+    int         expanded       = 0;   /* an input named a directory or glob */
+    const char *cache_dir      = CACHE_DEFAULT_DIR;
     const char *target         = "arm-cortex-m0";  /* default generic target */
+    char      **inputs         = NULL;
+    size_t      input_count    = 0;
+    size_t      input_capacity = 0;
+    int         status         = 0;
 
     /* ----------------- argument parsing ----------------- */
     int i = 1;
@@ -64,6 +78,12 @@ int main(int argc, char *argv[]) {
         if (strcmp(argv[i], "--compile") == 0) {
             do_codegen = 1;
             i++;
+        } else if (strcmp(argv[i], "--emit-db") == 0) {
+            emit_db = 1;
+            i++;
+        } else if (strcmp(argv[i], "--emit-obj") == 0) {
+            emit_obj = 1;
+            i++;
         } else if (strcmp(argv[i], "--verbose") == 0) {
             verbose = 1;
             i++;
@@ -75,183 +95,76 @@ int main(int argc, char *argv[]) {
                 fprintf(stderr, "Error: --target requires an argument\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            cache_dir = NULL;
+            i++;
+        } else if (strcmp(argv[i], "--cache-dir") == 0) {
+            if (i + 1 < argc) {
+                cache_dir = argv[++i];
+                i++;
+            } else {
+                fprintf(stderr, "Error: --cache-dir requires an argument\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                threads = atoi(argv[++i]);
+                i++;
+            } else {
+                fprintf(stderr, "Error: %s requires a positive job count\n", argv[i]);
+                return 1;
+            }
         } else if (strcmp(argv[i], "-c") == 0) {
             if (i + 1 < argc) {
-                source         = argv[++i];
-                default_source = source;
-                should_free    = 0;
+                source = argv[++i];
                 i++;
             } else {
                 fprintf(stderr, "Error: -c requires code argument\n");
                 return 1;
             }
-        } else if (argv[i][0] != '-') {
-            input_file = argv[i];
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            int added = compile_expand_input(argv[i], &inputs, &input_count, &input_capacity);
+            if (added < 0) {
+                fprintf(stderr, "Error: No inputs match %s\n", argv[i]);
+                status = 1;
+                goto cleanup;
+            }
+            if (added != 1 || strcmp(inputs[input_count - 1], argv[i]) != 0) {
+                expanded = 1;
+            }
             i++;
         } else {
             i++;
         }
     }
 
-    /* ----------------- file loading ----------------- */
-    if (input_file && source == default_source) {
-        FILE *f = fopen(input_file, "r");
-        if (!f) {
-            fprintf(stderr, "Error: Cannot open file %s\n", input_file);
-            return 1;
-        }
-
-        fseek(f, 0, SEEK_END);
-        long size = ftell(f);
-        fseek(f, 0, SEEK_SET);
-
-        char *file_source = malloc(size + 1);
-        if (!file_source) {
-            fprintf(stderr, "Error: Memory allocation failed\n");
-            fclose(f);
-            return 1;
-        }
-
-        size_t bytes_read = fread(file_source, 1, (size_t)size, f);
-        file_source[bytes_read] = '\0';
-        fclose(f);
-
-        source      = file_source;
-        should_free = 1;
-    }
-
-    printf("Input: %s\n\n", input_file ? input_file : "default");
-    if (verbose) {
-        printf("Target: %s\n\n", normalize_target(target));
-    }
-
-    /* ----------------- lexical analysis ----------------- */
-    Lexer *lexer = lexer_create(source);
-    if (verbose) {
-        printf("--- Lexical Analysis ---\n");
-    }
-
-    Token tok;
-    int   token_count = 0;
-    do {
-        tok = lexer_next_token(lexer);
-        if (verbose) {
-            token_print(&tok);
-        }
-        token_count++;
-    } while (tok.type != TOK_EOF);
-
-    lexer_free(lexer);
-
-    if (verbose) {
-        printf("Total tokens: %d\n\n", token_count - 1);
-    }
-
-    /* ----------------- parsing ----------------- */
-    Parser *parser = parser_create(source);
-    if (verbose) {
-        printf("--- Parsing ---\n");
-    }
-
-    ASTProgram *program = parser_parse_program(parser);
-    if (!parser_has_error(parser)) {
-        printf("✅ Successfully parsed\n");
-        printf(" Functions: %lu\n", program->function_count);
-        for (size_t fi = 0; fi < program->function_count; fi++) {
-            printf(" - fn %s\n", program->functions[fi]->name);
-        }
-
-        printf(" Peripherals: %lu\n", program->peripheral_count);
-        for (size_t pi = 0; pi < program->peripheral_count; pi++) {
-            ASTPeripheral *periph = program->peripherals[pi];
-            printf(" - peripheral %s @ 0x%08X\n",
-                   periph->name, periph->base_address);
-            for (size_t rj = 0; rj < periph->register_count; rj++) {
-                ASTRegister *reg = periph->registers[rj];
-                printf("   * register %s: %s @ offset 0x%02X\n",
-                       reg->name,
-                       type_kind_name(reg->type->kind),
-                       reg->offset);
-                for (size_t fk = 0; fk < reg->field_count; fk++) {
-                    ASTField *field = reg->fields[fk];
-                    printf("     - field %s: [%u:%u] %s\n",
-                           field->name,
-                           field->start_bit,
-                           field->end_bit,
-                           access_kind_name(field->access));
-                }
-            }
-        }
-
-        /* ----------------- code generation ----------------- */
-        if (do_codegen) {
-            if (program->peripheral_count > 0) {
-                printf("\n--- Code Generation ---\n");
-
-                const char *output_file = "generated.h";
-                char        output_buf[256];
-
-                if (input_file) {
-                    strncpy(output_buf, input_file, sizeof(output_buf) - 1);
-                    output_buf[sizeof(output_buf) - 1] = '\0';
-
-                    char *dot = strrchr(output_buf, '.');
-                    if (dot) {
-                        strcpy(dot, ".h");
-                    } else {
-                        strcat(output_buf, ".h");
-                    }
-                    output_file = output_buf;
-                }
-
-                printf("Generating C code to: %s\n", output_file);
-
-                const char *norm_target = normalize_target(target);
-                CodegenContext *ctx =
-                    codegen_init(output_file, norm_target);
-                if (!ctx) {
-                    fprintf(stderr,
-                            "Error: Failed to initialize code generator\n");
-                    parser_free(parser);
-                    ast_free_program(program);
-                    if (should_free) free((void *)source);
-                    return 1;
-                }
-
-                if (codegen_generate(ctx, program) == 0) {
-                    printf("✅ Successfully generated C code\n");
-                } else {
-                    fprintf(stderr, "❌ Code generation failed\n");
-                    codegen_cleanup(ctx);
-                    parser_free(parser);
-                    ast_free_program(program);
-                    if (should_free) free((void *)source);
-                    return 1;
-                }
-
-                codegen_cleanup(ctx);
-            } else {
-                printf("\n⚠️ --compile flag specified but no peripherals found.\n");
-                printf(" Device files must contain 'peripheral' definitions.\n");
-                printf("\n Example:\n");
-                printf(" peripheral UART {\n");
-                printf("   base_address: 0x40000000\n");
-                printf("   register CTRL { ... }\n");
-                printf(" }\n");
-            }
+    CompileOptions opts;
+    opts.do_codegen = do_codegen;
+    opts.verbose = verbose;
+    opts.target = normalize_target(target);
+    opts.cache_dir = cache_dir;
+    opts.emit_db = emit_db;
+    opts.emit_obj = emit_obj;
+
+    if (input_count > 1 || expanded) {
+        if (input_count == 0) {
+            fprintf(stderr, "Error: No .bitn inputs found\n");
+            status = 1;
+        } else {
+            status = run_jobs(&opts, inputs, input_count, threads);
         }
-
-        printf("\n=== Compilation Successful ===\n");
     } else {
-        printf("❌ Parsing failed\n");
+        /* A lone input keeps the historical behaviour: a parse failure is not an error exit. */
+        const char *input_file = input_count ? inputs[0] : NULL;
+        CompileStatus result = compile_unit(&opts, input_file, input_file ? NULL : source,
+                                            stdout, stderr);
+        status = result == COMPILE_FAILED ? 1 : 0;
     }
 
-    /* ----------------- cleanup ----------------- */
-    parser_free(parser);
-    ast_free_program(program);
-    if (should_free) {
-        free((void *)source);
+cleanup:
+    for (size_t k = 0; k < input_count; k++) {
+        free(inputs[k]);
     }
-
-    return 0;
+    free(inputs);
+    return status;
 }
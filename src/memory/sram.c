@@ -0,0 +1,34 @@
+// src/memory/sram.c
+#include "memory/sram.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/**
+ * Allocate size bytes of zeroed SRAM
+ */
+int sram_init(sram_t *sram, uint32_t size)
+{
+    if (!sram) return -1;
+
+    sram->data = (uint8_t *)calloc(size, 1);
+    if (!sram->data) {
+        sram->size = 0;
+        fprintf(stderr, "Failed to allocate %u bytes of SRAM\n", size);
+        return -1;
+    }
+
+    sram->size = size;
+    return 0;
+}
+
+/**
+ * Free the SRAM contents
+ */
+void sram_destroy(sram_t *sram)
+{
+    if (!sram) return;
+
+    free(sram->data);
+    sram->data = NULL;
+    sram->size = 0;
+}
@@ -0,0 +1,413 @@
+/**
+ * bit(N) Compiler - AST optimization passes
+ * Constant folding, strength reduction and rotate recognition over typed
+ * function bodies.
+ */
+
+#include "../include/optimize.h"
+#include "../include/type_system.h"
+
+#include <string.h>
+
+#define OPT_MAX_ROUNDS 8
+
+typedef ASTExpr *(*OptRewrite)(Optimizer *opt, ASTExpr *expr);
+
+// ============================================================================
+// Fixed-width arithmetic
+// ============================================================================
+
+static unsigned opt_width(const Type *type) {
+    return (unsigned)type_get_size(type->kind) * 8;
+}
+
+static int opt_is_signed(const Type *type) {
+    switch (type->kind) {
+        case TYPE_I8:
+        case TYPE_I16:
+        case TYPE_I32:
+        case TYPE_I64:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static uint64_t opt_wrap(uint64_t value, unsigned width) {
+    return width >= 64 ? value : value & ((1ull << width) - 1);
+}
+
+// Value of a wrapped bit pattern read as a signed integer of the given width
+static int64_t opt_sign_extend(uint64_t value, unsigned width) {
+    if (width >= 64) return (int64_t)value;
+    uint64_t sign = 1ull << (width - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+static int opt_is_constant(const ASTExpr *expr) {
+    return expr->kind == EXPR_NUMBER && expr->type && type_is_integer(expr->type);
+}
+
+static int opt_is_power_of_two(const ASTExpr *expr, unsigned *log2) {
+    if (!opt_is_constant(expr)) return 0;
+    uint64_t value = opt_wrap(expr->data.number_value, opt_width(expr->type));
+    if (value == 0 || (value & (value - 1)) != 0) return 0;
+    *log2 = (unsigned)__builtin_ctzll(value);
+    return 1;
+}
+
+static ASTExpr *opt_number(Optimizer *opt, const ASTExpr *like, uint64_t value, const Type *type) {
+    ASTExpr *expr = ast_expr_number(opt->arena, opt_wrap(value, opt_width(type)), type->kind);
+    expr->line = like->line;
+    expr->type = type;
+    return expr;
+}
+
+static ASTExpr *opt_binary(Optimizer *opt, const ASTExpr *like, BinaryOp op,
+                           ASTExpr *left, ASTExpr *right) {
+    ASTExpr *expr = ast_expr_binary_op(opt->arena, op, left, right);
+    expr->line = like->line;
+    expr->type = like->type;
+    return expr;
+}
+
+// Structural equality of side-effect-free expressions; calls never match.
+static int opt_same_value(const ASTExpr *a, const ASTExpr *b) {
+    if (a->kind != b->kind) return 0;
+    switch (a->kind) {
+        case EXPR_NUMBER:
+            return a->data.number_value == b->data.number_value;
+        case EXPR_IDENTIFIER:
+            return a->data.identifier == b->data.identifier;
+        case EXPR_BOOLEAN:
+            return a->data.boolean_value == b->data.boolean_value;
+        case EXPR_UNARY_OP:
+            return a->data.unary.op == b->data.unary.op &&
+                   opt_same_value(a->data.unary.operand, b->data.unary.operand);
+        case EXPR_BINARY_OP:
+            return a->data.binary.op == b->data.binary.op &&
+                   opt_same_value(a->data.binary.left, b->data.binary.left) &&
+                   opt_same_value(a->data.binary.right, b->data.binary.right);
+        case EXPR_BIT_SLICE:
+            return a->data.bit_slice.start == b->data.bit_slice.start &&
+                   a->data.bit_slice.end == b->data.bit_slice.end &&
+                   opt_same_value(a->data.bit_slice.expr, b->data.bit_slice.expr);
+        case EXPR_MEMBER_ACCESS:
+            return a->data.member.field == b->data.member.field &&
+                   opt_same_value(a->data.member.object, b->data.member.object);
+        default:
+            return 0;
+    }
+}
+
+// ============================================================================
+// Constant folding
+// ============================================================================
+
+// Fold a op b at the operands' width. Returns 0 when the result is not
+// defined (division by zero, shift by the width or more).
+static int opt_fold_binary(BinaryOp op, const Type *type, uint64_t a, uint64_t b,
+                           uint64_t *result) {
+    unsigned width = opt_width(type);
+    int is_signed = opt_is_signed(type);
+    int64_t sa = opt_sign_extend(a, width);
+    int64_t sb = opt_sign_extend(b, width);
+
+    switch (op) {
+        case BOP_ADD: *result = a + b; return 1;
+        case BOP_SUB: *result = a - b; return 1;
+        case BOP_MUL: *result = a * b; return 1;
+        case BOP_AND: *result = a & b; return 1;
+        case BOP_OR:  *result = a | b; return 1;
+        case BOP_XOR: *result = a ^ b; return 1;
+
+        case BOP_DIV:
+        case BOP_MOD:
+            if (b == 0) return 0;
+            if (is_signed) {
+                // INT_MIN / -1 overflows in C; at a fixed width it wraps to INT_MIN, remainder 0
+                if (sb == -1) {
+                    *result = op == BOP_DIV ? (uint64_t)0 - a : 0;
+                } else {
+                    *result = (uint64_t)(op == BOP_DIV ? sa / sb : sa % sb);
+                }
+            } else {
+                *result = op == BOP_DIV ? a / b : a % b;
+            }
+            return 1;
+
+        case BOP_LSHIFT:
+        case BOP_RSHIFT:
+            if (b >= width) return 0;
+            if (op == BOP_LSHIFT) {
+                *result = a << b;
+            } else if (is_signed) {
+                *result = (uint64_t)(sa < 0 ? ~(~sa >> b) : sa >> b);
+            } else {
+                *result = a >> b;
+            }
+            return 1;
+
+        case BOP_LROTATE:
+        case BOP_RROTATE: {
+            unsigned k = (unsigned)(b % width);
+            if (op == BOP_RROTATE) k = (width - k) % width;
+            *result = k == 0 ? a : (a << k) | (a >> (width - k));
+            return 1;
+        }
+
+        case BOP_EQ: *result = a == b; return 1;
+        case BOP_NE: *result = a != b; return 1;
+        case BOP_LT: *result = is_signed ? sa < sb : a < b; return 1;
+        case BOP_GT: *result = is_signed ? sa > sb : a > b; return 1;
+        case BOP_LE: *result = is_signed ? sa <= sb : a <= b; return 1;
+        case BOP_GE: *result = is_signed ? sa >= sb : a >= b; return 1;
+
+        default:
+            return 0;
+    }
+}
+
+static ASTExpr *opt_fold(Optimizer *opt, ASTExpr *expr) {
+    if (!expr->type || !type_is_integer(expr->type)) return expr;
+
+    if (expr->kind == EXPR_UNARY_OP && opt_is_constant(expr->data.unary.operand)) {
+        // Wrap to the operand's width first: a u8 0x100 is 0, so !0x100 is 1
+        const ASTExpr *operand = expr->data.unary.operand;
+        uint64_t value = opt_wrap(operand->data.number_value, opt_width(operand->type));
+        switch (expr->data.unary.op) {
+            case UOP_NOT:     return opt_number(opt, expr, value == 0, expr->type);
+            case UOP_BIT_NOT: return opt_number(opt, expr, ~value, expr->type);
+            case UOP_NEG:     return opt_number(opt, expr, (uint64_t)0 - value, expr->type);
+            default:          return expr;
+        }
+    }
+
+    if (expr->kind == EXPR_BINARY_OP &&
+        opt_is_constant(expr->data.binary.left) && opt_is_constant(expr->data.binary.right)) {
+        const Type *operands = expr->data.binary.left->type;
+        unsigned width = opt_width(operands);
+        uint64_t result;
+        if (opt_fold_binary(expr->data.binary.op, operands,
+                            opt_wrap(expr->data.binary.left->data.number_value, width),
+                            opt_wrap(expr->data.binary.right->data.number_value, width),
+                            &result)) {
+            return opt_number(opt, expr, result, expr->type);
+        }
+    }
+
+    return expr;
+}
+
+// ============================================================================
+// Strength reduction
+// ============================================================================
+
+static ASTExpr *opt_strength(Optimizer *opt, ASTExpr *expr) {
+    if (expr->kind != EXPR_BINARY_OP || !expr->type || !type_is_integer(expr->type)) return expr;
+
+    ASTExpr *left = expr->data.binary.left;
+    ASTExpr *right = expr->data.binary.right;
+    unsigned k;
+
+    switch (expr->data.binary.op) {
+        case BOP_MUL:
+            // Wrapping multiply by 2^k is a left shift for either signedness.
+            if (opt_is_power_of_two(left, &k) && !opt_is_constant(right)) {
+                ASTExpr *swap = left;
+                left = right;
+                right = swap;
+            } else if (!opt_is_power_of_two(right, &k)) {
+                return expr;
+            }
+            if (k == 0) return left;
+            return opt_binary(opt, expr, BOP_LSHIFT, left, opt_number(opt, right, k, right->type));
+
+        case BOP_DIV:
+            // Signed division rounds toward zero; a shift rounds down.
+            if (opt_is_signed(expr->type) || !opt_is_power_of_two(right, &k)) return expr;
+            if (k == 0) return left;
+            return opt_binary(opt, expr, BOP_RSHIFT, left, opt_number(opt, right, k, right->type));
+
+        case BOP_MOD:
+            if (opt_is_signed(expr->type) || !opt_is_power_of_two(right, &k)) return expr;
+            return opt_binary(opt, expr, BOP_AND, left,
+                              opt_number(opt, right, (1ull << k) - 1, right->type));
+
+        default:
+            return expr;
+    }
+}
+
+// ============================================================================
+// Rotate recognition
+// ============================================================================
+
+// Is amount + other == width? Both constant, or other is (width - amount).
+static int opt_amounts_complement(const ASTExpr *amount, const ASTExpr *other, unsigned width) {
+    if (opt_is_constant(amount) && opt_is_constant(other)) {
+        uint64_t a = amount->data.number_value;
+        uint64_t b = other->data.number_value;
+        return a > 0 && a < width && a + b == width;
+    }
+    return other->kind == EXPR_BINARY_OP && other->data.binary.op == BOP_SUB &&
+           opt_is_constant(other->data.binary.left) &&
+           other->data.binary.left->data.number_value == width &&
+           opt_same_value(other->data.binary.right, amount);
+}
+
+// (x << k) | (x >> (W - k)), in either order and with ^ or + in place of |
+// since the two halves never overlap. Unsigned only: a signed >> smears the
+// sign bit into the low half.
+static ASTExpr *opt_rotate(Optimizer *opt, ASTExpr *expr) {
+    if (expr->kind != EXPR_BINARY_OP || !expr->type || !type_is_integer(expr->type) ||
+        opt_is_signed(expr->type)) {
+        return expr;
+    }
+    BinaryOp op = expr->data.binary.op;
+    if (op != BOP_OR && op != BOP_XOR && op != BOP_ADD) return expr;
+
+    ASTExpr *shl = expr->data.binary.left;
+    ASTExpr *shr = expr->data.binary.right;
+    if (shl->kind != EXPR_BINARY_OP || shr->kind != EXPR_BINARY_OP) return expr;
+    if (shl->data.binary.op == BOP_RSHIFT && shr->data.binary.op == BOP_LSHIFT) {
+        ASTExpr *swap = shl;
+        shl = shr;
+        shr = swap;
+    }
+    if (shl->data.binary.op != BOP_LSHIFT || shr->data.binary.op != BOP_RSHIFT) return expr;
+
+    ASTExpr *value = shl->data.binary.left;
+    if (!opt_same_value(value, shr->data.binary.left)) return expr;
+
+    unsigned width = opt_width(expr->type);
+    ASTExpr *left_amount = shl->data.binary.right;
+    ASTExpr *right_amount = shr->data.binary.right;
+
+    if (opt_amounts_complement(left_amount, right_amount, width)) {
+        return opt_binary(opt, expr, BOP_LROTATE, value, left_amount);
+    }
+    if (opt_amounts_complement(right_amount, left_amount, width)) {
+        return opt_binary(opt, expr, BOP_RROTATE, value, right_amount);
+    }
+    return expr;
+}
+
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+static const OptRewrite opt_rewrites[OPT_PASS_COUNT] = {
+    [OPT_PASS_FOLD]     = opt_fold,
+    [OPT_PASS_STRENGTH] = opt_strength,
+    [OPT_PASS_ROTATE]   = opt_rotate,
+};
+
+static const char *const opt_pass_names[OPT_PASS_COUNT] = {
+    [OPT_PASS_FOLD]     = "constant-fold",
+    [OPT_PASS_STRENGTH] = "strength-reduce",
+    [OPT_PASS_ROTATE]   = "rotate",
+};
+
+void optimizer_init(Optimizer *opt, Arena *arena) {
+    memset(opt, 0, sizeof(*opt));
+    opt->arena = arena;
+    for (int p = 0; p < OPT_PASS_COUNT; p++) {
+        opt->passes[p].name = opt_pass_names[p];
+    }
+}
+
+static ASTExpr *opt_expr(Optimizer *opt, OptPass pass, ASTExpr *expr) {
+    if (!expr) return NULL;
+
+    switch (expr->kind) {
+        case EXPR_UNARY_OP:
+            expr->data.unary.operand = opt_expr(opt, pass, expr->data.unary.operand);
+            break;
+        case EXPR_BINARY_OP:
+            expr->data.binary.left = opt_expr(opt, pass, expr->data.binary.left);
+            expr->data.binary.right = opt_expr(opt, pass, expr->data.binary.right);
+            break;
+        case EXPR_CALL:
+            for (size_t i = 0; i < expr->data.call.arg_count; i++) {
+                expr->data.call.args[i] = opt_expr(opt, pass, expr->data.call.args[i]);
+            }
+            break;
+        case EXPR_ARRAY_INDEX:
+            expr->data.array_access.index = opt_expr(opt, pass, expr->data.array_access.index);
+            break;
+        case EXPR_BIT_SLICE:
+            expr->data.bit_slice.expr = opt_expr(opt, pass, expr->data.bit_slice.expr);
+            break;
+        default:
+            break;
+    }
+
+    OptPassStats *stats = &opt->passes[pass];
+    stats->visited++;
+    ASTExpr *rewritten = opt_rewrites[pass](opt, expr);
+    if (rewritten != expr) stats->rewritten++;
+    return rewritten;
+}
+
+static void opt_stmt(Optimizer *opt, OptPass pass, ASTStmt *stmt) {
+    if (!stmt) return;
+
+    switch (stmt->kind) {
+        case STMT_VAR_DECL:
+            stmt->data.var_decl.init = opt_expr(opt, pass, stmt->data.var_decl.init);
+            break;
+        case STMT_EXPR:
+            stmt->data.expr_stmt.expr = opt_expr(opt, pass, stmt->data.expr_stmt.expr);
+            break;
+        case STMT_RETURN:
+            stmt->data.ret.value = opt_expr(opt, pass, stmt->data.ret.value);
+            break;
+        case STMT_BLOCK:
+            for (size_t i = 0; i < stmt->data.block.count; i++) {
+                opt_stmt(opt, pass, stmt->data.block.statements[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static size_t opt_total_rewrites(const Optimizer *opt) {
+    size_t total = 0;
+    for (int p = 0; p < OPT_PASS_COUNT; p++) {
+        total += opt->passes[p].rewritten;
+    }
+    return total;
+}
+
+size_t optimize_function(Optimizer *opt, ASTFunctionDef *func) {
+    size_t before = opt_total_rewrites(opt);
+
+    for (int round = 0; round < OPT_MAX_ROUNDS; round++) {
+        size_t start = opt_total_rewrites(opt);
+        for (int p = 0; p < OPT_PASS_COUNT; p++) {
+            opt_stmt(opt, (OptPass)p, func->body);
+        }
+        opt->rounds++;
+        if (opt_total_rewrites(opt) == start) break;
+    }
+
+    return opt_total_rewrites(opt) - before;
+}
+
+size_t optimize_program(Optimizer *opt, ASTProgram *program) {
+    size_t rewrites = 0;
+    for (size_t i = 0; i < program->function_count; i++) {
+        rewrites += optimize_function(opt, program->functions[i]);
+    }
+    return rewrites;
+}
+
+void optimizer_print_stats(const Optimizer *opt, FILE *out) {
+    fprintf(out, "--- Optimization (%d rounds) ---\n", opt->rounds);
+    for (int p = 0; p < OPT_PASS_COUNT; p++) {
+        fprintf(out, " %-16s %6zu visited %6zu rewritten\n",
+                opt->passes[p].name, opt->passes[p].visited, opt->passes[p].rewritten);
+    }
+}
@@ -1,6 +1,7 @@
 #include "../include/parser.h"
 #include "../include/lexer.h"
 #include "../include/ast.h"
+#include "../include/type_system.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -10,26 +11,43 @@
 // PARSER CORE
 // ============================================================================
 
-Parser *parser_create(const char *input) {
+static void parser_seek(Parser *parser, size_t pos) {
+    size_t last = parser->tokens->count - 1;   // Trailing TOK_EOF
+    parser->pos = pos < last ? pos : last;
+    parser->current = &parser->tokens->tokens[parser->pos];
+    parser->peek = &parser->tokens->tokens[parser->pos < last ? parser->pos + 1 : last];
+}
+
+Parser *parser_create_from_tokens(const TokenStream *tokens) {
     Parser *parser = (Parser *)malloc(sizeof(Parser));
-    parser->lexer = lexer_create(input);
-    parser->current = lexer_next_token(parser->lexer);
-    parser->peek = lexer_next_token(parser->lexer);
+    parser->tokens = tokens;
+    parser->owned_tokens = NULL;
+    parser->arena = NULL;
     parser->error = 0;
+    parser->errors = stderr;
+    parser_seek(parser, 0);
+    return parser;
+}
+
+Parser *parser_create(const char *input) {
+    TokenStream *tokens = lexer_tokenize(input);
+    if (!tokens) return NULL;
+    Parser *parser = parser_create_from_tokens(tokens);
+    parser->owned_tokens = tokens;
     return parser;
 }
 
 void parser_free(Parser *parser) {
     if (parser) {
-        lexer_free(parser->lexer);
+        token_stream_free(parser->owned_tokens);
         free(parser);
     }
 }
 
 void parser_error(Parser *parser, const char *message) {
-    fprintf(stderr, "Parser error at %d:%d %s\n",
-            parser->current.line,
-            parser->current.column,
+    fprintf(parser->errors, "Parser error at %d:%d %s\n",
+            parser->current->line,
+            parser->current->column,
             message);
     parser->error = 1;
 }
@@ -39,12 +57,11 @@ int parser_has_error(Parser *parser) {
 }
 
 static void parser_advance(Parser *parser) {
-    parser->current = parser->peek;
-    parser->peek = lexer_next_token(parser->lexer);
+    parser_seek(parser, parser->pos + 1);
 }
 
 static int parser_match(Parser *parser, TokenType type) {
-    if (parser->current.type == type) {
+    if (parser->current->type == type) {
         parser_advance(parser);
         return 1;
     }
@@ -52,7 +69,7 @@ static int parser_match(Parser *parser, TokenType type) {
 }
 
 static int parser_check(Parser *parser, TokenType type) {
-    return parser->current.type == type;
+    return parser->current->type == type;
 }
 
 static void parser_expect(Parser *parser, TokenType type, const char *message) {
@@ -65,7 +82,7 @@ static void parser_expect(Parser *parser, TokenType type, const char *message) {
 // TYPE PARSING
 // ============================================================================
 
-Type *parser_parse_type(Parser *parser) {
+const Type *parser_parse_type(Parser *parser) {
     TypeKind kind = TYPE_VOID;
     
     if (parser_match(parser, TOK_U8)) {
@@ -91,9 +108,7 @@ Type *parser_parse_type(Parser *parser) {
         return NULL;
     }
     
-    Type *type = (Type *)malloc(sizeof(Type));
-    type->kind = kind;
-    return type;
+    return type_from_kind(kind);
 }
 
 // ============================================================================
@@ -116,14 +131,14 @@ static ASTExpr *parser_parse_bitwise_or(Parser *parser);
 static ASTExpr *parser_parse_primary(Parser *parser) {
     // Numbers
     if (parser_check(parser, TOK_NUMBER)) {
-        uint64_t value = strtoull(parser->current.value, NULL, 0);
+        uint64_t value = strtoull(parser->current->value, NULL, 0);
         parser_advance(parser);
-        return ast_expr_number(value, TYPE_U32);
+        return ast_expr_number(parser->arena, value, TYPE_U32);
     }
     
     // Identifiers and function calls
     if (parser_check(parser, TOK_IDENTIFIER)) {
-        const char *name = parser->current.value;
+        Atom name = parser->current->atom;
         parser_advance(parser);
         
         // Check for function call
@@ -134,13 +149,15 @@ static ASTExpr *parser_parse_primary(Parser *parser) {
             ASTExpr **args = NULL;
             size_t arg_count = 0;
             size_t arg_capacity = 10;
-            args = (ASTExpr **)malloc(arg_capacity * sizeof(ASTExpr *));
+            args = (ASTExpr **)arena_alloc(parser->arena, arg_capacity * sizeof(ASTExpr *));
             
             if (!parser_check(parser, TOK_RPAREN)) {
                 while (1) {
                     if (arg_count >= arg_capacity) {
+                        args = (ASTExpr **)arena_grow(parser->arena, args,
+                                                      arg_capacity * sizeof(ASTExpr *),
+                                                      arg_capacity * 2 * sizeof(ASTExpr *));
                         arg_capacity *= 2;
-                        args = (ASTExpr **)realloc(args, arg_capacity * sizeof(ASTExpr *));
                     }
                     args[arg_count] = parser_parse_expression(parser);
                     arg_count++;
@@ -151,21 +168,21 @@ static ASTExpr *parser_parse_primary(Parser *parser) {
             parser_expect(parser, TOK_RPAREN, "Expected ')' after arguments");
             
             // Regular function call
-            ASTExpr *func = ast_expr_identifier(name);
-            return ast_expr_call(func, args, arg_count);
+            ASTExpr *func = ast_expr_identifier(parser->arena, name);
+            return ast_expr_call(parser->arena, func, args, arg_count);
         }
         
         // Simple identifier (variable reference)
-        return ast_expr_identifier(name);
+        return ast_expr_identifier(parser->arena, name);
     }
     
     // Boolean literals
     if (parser_match(parser, TOK_TRUE)) {
-        return ast_expr_true();
+        return ast_expr_true(parser->arena);
     }
     
     if (parser_match(parser, TOK_FALSE)) {
-        return ast_expr_false();
+        return ast_expr_false(parser->arena);
     }
     
     // Parenthesized expression
@@ -184,17 +201,17 @@ static ASTExpr *parser_parse_unary(Parser *parser) {
     // Unary operators: -, !, ~ (~ is TOK_XOR in your token set)
     if (parser_match(parser, TOK_MINUS)) {
         ASTExpr *operand = parser_parse_unary(parser);
-        return ast_expr_unary_op(UOP_NEG, operand);
+        return ast_expr_unary_op(parser->arena, UOP_NEG, operand);
     }
     
     if (parser_match(parser, TOK_NOT)) {
         ASTExpr *operand = parser_parse_unary(parser);
-        return ast_expr_unary_op(UOP_NOT, operand);
+        return ast_expr_unary_op(parser->arena, UOP_NOT, operand);
     }
     
     if (parser_match(parser, TOK_XOR)) {
         ASTExpr *operand = parser_parse_unary(parser);
-        return ast_expr_unary_op(UOP_BIT_NOT, operand);
+        return ast_expr_unary_op(parser->arena, UOP_BIT_NOT, operand);
     }
     
     return parser_parse_primary(parser);
@@ -215,7 +232,7 @@ static ASTExpr *parser_parse_multiplicative(Parser *parser) {
         }
         
         ASTExpr *right = parser_parse_unary(parser);
-        left = ast_expr_binary_op(op, left, right);
+        left = ast_expr_binary_op(parser->arena, op, left, right);
     }
     return left;
 }
@@ -228,7 +245,7 @@ static ASTExpr *parser_parse_additive(Parser *parser) {
         if (op != BOP_ADD) parser_match(parser, TOK_MINUS);
         
         ASTExpr *right = parser_parse_multiplicative(parser);
-        left = ast_expr_binary_op(op, left, right);
+        left = ast_expr_binary_op(parser->arena, op, left, right);
     }
     return left;
 }
@@ -241,7 +258,7 @@ static ASTExpr *parser_parse_shift(Parser *parser) {
         if (op != BOP_LSHIFT) parser_match(parser, TOK_RSHIFT);
         
         ASTExpr *right = parser_parse_additive(parser);
-        left = ast_expr_binary_op(op, left, right);
+        left = ast_expr_binary_op(parser->arena, op, left, right);
     }
     return left;
 }
@@ -264,7 +281,7 @@ static ASTExpr *parser_parse_comparison(Parser *parser) {
         }
         
         ASTExpr *right = parser_parse_shift(parser);
-        left = ast_expr_binary_op(op, left, right);
+        left = ast_expr_binary_op(parser->arena, op, left, right);
     }
     return left;
 }
@@ -277,7 +294,7 @@ static ASTExpr *parser_parse_equality(Parser *parser) {
         if (op != BOP_EQ) parser_match(parser, TOK_NE);
         
         ASTExpr *right = parser_parse_comparison(parser);
-        left = ast_expr_binary_op(op, left, right);
+        left = ast_expr_binary_op(parser->arena, op, left, right);
     }
     return left;
 }
@@ -287,7 +304,7 @@ static ASTExpr *parser_parse_bitwise_and(Parser *parser) {
     
     while (parser_match(parser, TOK_AND)) {
         ASTExpr *right = parser_parse_equality(parser);
-        left = ast_expr_binary_op(BOP_AND, left, right);
+        left = ast_expr_binary_op(parser->arena, BOP_AND, left, right);
     }
     return left;
 }
@@ -297,7 +314,7 @@ static ASTExpr *parser_parse_bitwise_xor(Parser *parser) {
     
     while (parser_match(parser, TOK_XOR)) {
         ASTExpr *right = parser_parse_bitwise_and(parser);
-        left = ast_expr_binary_op(BOP_XOR, left, right);
+        left = ast_expr_binary_op(parser->arena, BOP_XOR, left, right);
     }
     return left;
 }
@@ -307,7 +324,7 @@ static ASTExpr *parser_parse_bitwise_or(Parser *parser) {
     
     while (parser_match(parser, TOK_OR)) {
         ASTExpr *right = parser_parse_bitwise_xor(parser);
-        left = ast_expr_binary_op(BOP_OR, left, right);
+        left = ast_expr_binary_op(parser->arena, BOP_OR, left, right);
     }
     return left;
 }
@@ -330,15 +347,22 @@ static ASTStmt *parser_parse_block(Parser *parser) {
     
     ASTStmt **statements = NULL;
     size_t stmt_count = 0;
+    size_t stmt_capacity = 0;
     
     while (!parser_check(parser, TOK_RBRACE) && !parser_check(parser, TOK_EOF)) {
-        statements = (ASTStmt **)realloc(statements, (stmt_count + 1) * sizeof(ASTStmt *));
+        if (stmt_count >= stmt_capacity) {
+            size_t new_capacity = stmt_capacity ? stmt_capacity * 2 : 8;
+            statements = (ASTStmt **)arena_grow(parser->arena, statements,
+                                                stmt_capacity * sizeof(ASTStmt *),
+                                                new_capacity * sizeof(ASTStmt *));
+            stmt_capacity = new_capacity;
+        }
         statements[stmt_count] = parser_parse_statement(parser);
         stmt_count++;
     }
     
     parser_expect(parser, TOK_RBRACE, "Expected '}'");
-    return ast_stmt_block(statements, stmt_count);
+    return ast_stmt_block(parser->arena, statements, stmt_count);
 }
 
 static ASTStmt *parser_parse_statement(Parser *parser) {
@@ -347,12 +371,12 @@ static ASTStmt *parser_parse_statement(Parser *parser) {
         int is_mut = parser_check(parser, TOK_VAR) ? 1 : 0;
         parser_advance(parser); // consume let/var
         
-        const char *name = parser->current.value;
+        Atom name = parser->current->atom;
         parser_expect(parser, TOK_IDENTIFIER, "Expected variable name");
         
         parser_expect(parser, TOK_COLON, "Expected ':' after variable name");
         
-        Type *decl_type = parser_parse_type(parser);
+        const Type *decl_type = parser_parse_type(parser);
         if (!decl_type) {
             return NULL;
         }
@@ -369,7 +393,7 @@ static ASTStmt *parser_parse_statement(Parser *parser) {
         // Optional semicolon
         parser_match(parser, TOK_SEMICOLON);
         
-        return ast_stmt_var_decl(name, decl_type, init, is_mut);
+        return ast_stmt_var_decl(parser->arena, name, decl_type, init, is_mut);
     }
     
     // Return statement
@@ -381,7 +405,7 @@ static ASTStmt *parser_parse_statement(Parser *parser) {
             value = parser_parse_expression(parser);
         }
         parser_match(parser, TOK_SEMICOLON);
-        return ast_stmt_return(value);
+        return ast_stmt_return(parser->arena, value);
     }
     
     // Block
@@ -392,7 +416,7 @@ static ASTStmt *parser_parse_statement(Parser *parser) {
     // Expression statement
     ASTExpr *expr = parser_parse_expression(parser);
     parser_match(parser, TOK_SEMICOLON);
-    return ast_stmt_expr(expr);
+    return ast_stmt_expr(parser->arena, expr);
 }
 
 // ============================================================================
@@ -414,31 +438,28 @@ ASTFunctionDef *parser_parse_function(Parser *parser) {
         return NULL;
     }
     
-    const char *name = parser->current.value;
+    Atom name = parser->current->atom;
     parser_expect(parser, TOK_IDENTIFIER, "Expected function name");
     
     parser_expect(parser, TOK_LPAREN, "Expected '('");
     parser_expect(parser, TOK_RPAREN, "Expected ')'");
     
-    Type *return_type = (Type *)malloc(sizeof(Type));
-    return_type->kind = TYPE_U32;
+    const Type *return_type = type_from_kind(TYPE_U32);
     
     // Nim-style: expects ":" then type
     // fn-style: expects "->" then type
     if (is_nim_style) {
         parser_expect(parser, TOK_COLON, "Expected ':' after ()");
-        Type *parsed_type = parser_parse_type(parser);
+        const Type *parsed_type = parser_parse_type(parser);
         if (parsed_type) {
-            return_type->kind = parsed_type->kind;
-            free(parsed_type);
+            return_type = parsed_type;
         }
     } else {
         // fn-style: always expect "->" return type
         parser_expect(parser, TOK_ARROW, "Expected '->' after ()");
-        Type *parsed_type = parser_parse_type(parser);
+        const Type *parsed_type = parser_parse_type(parser);
         if (parsed_type) {
-            return_type->kind = parsed_type->kind;
-            free(parsed_type);
+            return_type = parsed_type;
         }
     }
     
@@ -446,19 +467,19 @@ ASTFunctionDef *parser_parse_function(Parser *parser) {
     ASTStmt *body = NULL;
     if (parser_match(parser, TOK_ASSIGN)) {
         // Single statement after =
-        ASTStmt **statements = (ASTStmt **)malloc(sizeof(ASTStmt *));
+        ASTStmt **statements = (ASTStmt **)arena_alloc(parser->arena, sizeof(ASTStmt *));
         statements[0] = parser_parse_statement(parser);
-        body = ast_stmt_block(statements, 1);
+        body = ast_stmt_block(parser->arena, statements, 1);
     } else if (parser_check(parser, TOK_LBRACE)) {
         // Block with braces
         body = parser_parse_block(parser);
     } else {
         parser_error(parser, "Expected '=' or '{' for function body");
-        body = ast_stmt_block(NULL, 0);
+        body = ast_stmt_block(parser->arena, NULL, 0);
     }
 
     
-    return ast_function_def(name, return_type, NULL, NULL, 0, body);
+    return ast_function_def(parser->arena, name, return_type, NULL, NULL, 0, body);
 }
 
 // ============================================================================
@@ -468,18 +489,18 @@ ASTFunctionDef *parser_parse_function(Parser *parser) {
 static ASTField *parser_parse_field(Parser *parser) {
     parser_expect(parser, TOK_FIELD, "Expected 'field'");
     
-    const char *name = parser->current.value;
+    Atom name = parser->current->atom;
     parser_expect(parser, TOK_IDENTIFIER, "Expected field name");
     
     parser_expect(parser, TOK_COLON, "Expected ':' after field name");
     parser_expect(parser, TOK_LBRACKET, "Expected '[' for bit range");
     
-    uint32_t start = strtoull(parser->current.value, NULL, 0);
+    uint32_t start = strtoull(parser->current->value, NULL, 0);
     parser_expect(parser, TOK_NUMBER, "Expected start bit");
     
     parser_expect(parser, TOK_COLON, "Expected ':' in bit range");
     
-    uint32_t end = strtoull(parser->current.value, NULL, 0);
+    uint32_t end = strtoull(parser->current->value, NULL, 0);
     parser_expect(parser, TOK_NUMBER, "Expected end bit");
     
     parser_expect(parser, TOK_RBRACKET, "Expected ']' after bit range");
@@ -499,13 +520,13 @@ static ASTField *parser_parse_field(Parser *parser) {
     
     parser_match(parser, TOK_SEMICOLON);
     
-    return ast_field_create(name, start, end, access);
+    return ast_field_create(parser->arena, name, start, end, access);
 }
 
 static ASTRegister *parser_parse_register(Parser *parser) {
     parser_expect(parser, TOK_REGISTER, "Expected 'register'");
     
-    const char *name = parser->current.value;
+    Atom name = parser->current->atom;
     parser_expect(parser, TOK_IDENTIFIER, "Expected register name");
     
     parser_expect(parser, TOK_COLON, "Expected ':' after register name");
@@ -521,23 +542,22 @@ static ASTRegister *parser_parse_register(Parser *parser) {
     } else if (parser_match(parser, TOK_U64)) {
         kind = TYPE_U64;
     }
-    Type *type = (Type *)malloc(sizeof(Type));
-    type->kind = kind;
+    const Type *type = type_from_kind(kind);
     
     parser_expect(parser, TOK_AT, "Expected '@' before offset");
     
-    uint32_t offset = strtoull(parser->current.value, NULL, 0);
+    uint32_t offset = strtoull(parser->current->value, NULL, 0);
     parser_expect(parser, TOK_NUMBER, "Expected offset value");
     
     parser_expect(parser, TOK_LBRACE, "Expected '{' after register");
     
-    ASTRegister *reg = ast_register_create(name, type, offset);
+    ASTRegister *reg = ast_register_create(parser->arena, name, type, offset);
     
     // Parse fields
     while (!parser_check(parser, TOK_RBRACE) && !parser_check(parser, TOK_EOF)) {
         ASTField *field = parser_parse_field(parser);
         if (field) {
-            ast_register_add_field(reg, field);
+            ast_register_add_field(parser->arena, reg, field);
         }
     }
     
@@ -546,26 +566,74 @@ static ASTRegister *parser_parse_register(Parser *parser) {
     return reg;
 }
 
+// cluster NAME[count] @ offset stride bytes { register ... }
+static ASTCluster *parser_parse_cluster(Parser *parser) {
+    parser_expect(parser, TOK_CLUSTER, "Expected 'cluster'");
+    
+    Atom name = parser->current->atom;
+    parser_expect(parser, TOK_IDENTIFIER, "Expected cluster name");
+    
+    parser_expect(parser, TOK_LBRACKET, "Expected '[' before cluster count");
+    uint32_t count = strtoull(parser->current->value, NULL, 0);
+    parser_expect(parser, TOK_NUMBER, "Expected cluster count");
+    parser_expect(parser, TOK_RBRACKET, "Expected ']' after cluster count");
+    
+    parser_expect(parser, TOK_AT, "Expected '@' before offset");
+    uint32_t offset = strtoull(parser->current->value, NULL, 0);
+    parser_expect(parser, TOK_NUMBER, "Expected offset value");
+    
+    parser_expect(parser, TOK_STRIDE, "Expected 'stride' after cluster offset");
+    uint32_t stride = strtoull(parser->current->value, NULL, 0);
+    parser_expect(parser, TOK_NUMBER, "Expected stride value");
+    
+    if (count == 0 || stride == 0) {
+        parser_error(parser, "Cluster count and stride must be non-zero");
+    }
+    
+    parser_expect(parser, TOK_LBRACE, "Expected '{' after cluster");
+    
+    ASTCluster *cluster = ast_cluster_create(parser->arena, name, offset, count, stride);
+    
+    while (!parser_check(parser, TOK_RBRACE) && !parser_check(parser, TOK_EOF)) {
+        ASTRegister *reg = parser_parse_register(parser);
+        if (reg) {
+            ast_cluster_add_register(parser->arena, cluster, reg);
+        }
+    }
+    
+    parser_expect(parser, TOK_RBRACE, "Expected '}' after cluster");
+    
+    return cluster;
+}
+
 static ASTPeripheral *parser_parse_peripheral(Parser *parser) {
     parser_expect(parser, TOK_PERIPHERAL, "Expected 'peripheral'");
     
-    const char *name = parser->current.value;
+    Atom name = parser->current->atom;
     parser_expect(parser, TOK_IDENTIFIER, "Expected peripheral name");
     
     parser_expect(parser, TOK_AT, "Expected '@' before base address");
     
-    uint32_t base = strtoull(parser->current.value, NULL, 0);
+    uint32_t base = strtoull(parser->current->value, NULL, 0);
     parser_expect(parser, TOK_NUMBER, "Expected base address");
     
     parser_expect(parser, TOK_LBRACE, "Expected '{' after peripheral");
     
-    ASTPeripheral *periph = ast_peripheral_create(name, base);
+    ASTPeripheral *periph = ast_peripheral_create(parser->arena, name, base);
     
-    // Parse registers
+    // Parse registers and clusters
     while (!parser_check(parser, TOK_RBRACE) && !parser_check(parser, TOK_EOF)) {
+        if (parser_check(parser, TOK_CLUSTER)) {
+            ASTCluster *cluster = parser_parse_cluster(parser);
+            if (cluster) {
+                ast_peripheral_add_cluster(parser->arena, periph, cluster);
+            }
+            continue;
+        }
+        
         ASTRegister *reg = parser_parse_register(parser);
         if (reg) {
-            ast_peripheral_add_register(periph, reg);
+            ast_peripheral_add_register(parser->arena, periph, reg);
         }
     }
     
@@ -580,6 +648,11 @@ static ASTPeripheral *parser_parse_peripheral(Parser *parser) {
 
 ASTProgram *parser_parse_program(Parser *parser) {
     ASTProgram *program = ast_program_create();
+    if (!program) {
+        parser_error(parser, "Out of memory");
+        return NULL;
+    }
+    parser->arena = program->arena;
     
     while (!parser_check(parser, TOK_EOF)) {
         // Check for function definitions (proc, func, or fn)
@@ -0,0 +1,48 @@
+// src/periph/gpio.c
+#include "periph/gpio.h"
+#include <string.h>
+
+/**
+ * Reset: all pins low
+ */
+int gpio_init(gpio_state_t *gpio, uint32_t num_pins)
+{
+    if (!gpio || num_pins > GPIO_MAX_PINS) return -1;
+
+    memset(gpio, 0, sizeof(gpio_state_t));
+    gpio->num_pins = num_pins;
+    return 0;
+}
+
+/**
+ * Nothing to free; kept for symmetry with the other peripherals
+ */
+void gpio_destroy(gpio_state_t *gpio)
+{
+    (void)gpio;
+}
+
+/**
+ * Drive a pin. Returns -1 if the pin does not exist.
+ */
+int gpio_write_pin(gpio_state_t *gpio, int pin, bool value)
+{
+    if (!gpio || pin < 0 || (uint32_t)pin >= gpio->num_pins) return -1;
+
+    if (value) {
+        gpio->levels |= 1u << pin;
+    } else {
+        gpio->levels &= ~(1u << pin);
+    }
+    return 0;
+}
+
+/**
+ * Level of a pin (low for pins that do not exist)
+ */
+bool gpio_read_pin(const gpio_state_t *gpio, int pin)
+{
+    if (!gpio || pin < 0 || (uint32_t)pin >= gpio->num_pins) return false;
+
+    return (gpio->levels >> pin) & 1;
+}
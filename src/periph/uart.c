@@ -0,0 +1,54 @@
+// src/periph/uart.c
+#include "periph/uart.h"
+#include <string.h>
+
+/**
+ * Reset: FIFO empty
+ */
+int uart_init(uart_state_t *uart)
+{
+    if (!uart) return -1;
+
+    memset(uart, 0, sizeof(uart_state_t));
+    return 0;
+}
+
+/**
+ * Nothing to free; kept for symmetry with the other peripherals
+ */
+void uart_destroy(uart_state_t *uart)
+{
+    (void)uart;
+}
+
+/**
+ * Queue bytes. Returns how many fit, or -1 on bad arguments.
+ */
+int uart_write(uart_state_t *uart, const uint8_t *data, uint32_t len)
+{
+    if (!uart || !data) return -1;
+
+    uint32_t written = 0;
+    while (written < len && uart->count < UART_FIFO_DEPTH) {
+        uart->fifo[(uart->head + uart->count) % UART_FIFO_DEPTH] = data[written++];
+        uart->count++;
+    }
+    return (int)written;
+}
+
+/**
+ * Take up to len queued bytes. Returns how many were read, or -1 on bad
+ * arguments.
+ */
+int uart_read(uart_state_t *uart, uint8_t *data, uint32_t len)
+{
+    if (!uart || !data) return -1;
+
+    uint32_t read = 0;
+    while (read < len && uart->count > 0) {
+        data[read++] = uart->fifo[uart->head];
+        uart->head = (uart->head + 1) % UART_FIFO_DEPTH;
+        uart->count--;
+    }
+    return (int)read;
+}
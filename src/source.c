@@ -0,0 +1,103 @@
+#include "../include/source.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read everything from fd into a NUL-terminated heap buffer.
+static int source_read_fd(SourceFile *src, int fd, size_t size_hint) {
+    size_t capacity = size_hint ? size_hint + 1 : 64 * 1024;
+    size_t length = 0;
+    char *buffer = (char *)malloc(capacity);
+    if (!buffer) return -1;
+
+    for (;;) {
+        if (length + 1 >= capacity) {
+            capacity *= 2;
+            char *grown = (char *)realloc(buffer, capacity);
+            if (!grown) {
+                free(buffer);
+                return -1;
+            }
+            buffer = grown;
+        }
+
+        ssize_t n = read(fd, buffer + length, capacity - length - 1);
+        if (n == 0) break;
+        if (n < 0) {
+            free(buffer);
+            return -1;
+        }
+        length += (size_t)n;
+    }
+
+    buffer[length] = '\0';
+    src->data = buffer;
+    src->length = length;
+    src->mapping = NULL;
+    src->mapping_length = 0;
+    return 0;
+}
+
+// Map a regular file read-only. One extra page of address space is reserved
+// behind the file so the terminating NUL exists even when the file size is an
+// exact multiple of the page size (bytes past EOF in the last file page are
+// zero-filled by the kernel).
+static int source_map_fd(SourceFile *src, int fd, size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapping_length = (size + 1 + page - 1) & ~(page - 1);
+
+    void *base = mmap(NULL, mapping_length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return -1;
+
+    void *file = mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (file == MAP_FAILED) {
+        munmap(base, mapping_length);
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    src->data = (const char *)base;
+    src->length = size;
+    src->mapping = base;
+    src->mapping_length = mapping_length;
+    return 0;
+}
+
+int source_open(SourceFile *src, const char *path) {
+    memset(src, 0, sizeof(*src));
+
+    if (strcmp(path, "-") == 0) {
+        return source_read_fd(src, STDIN_FILENO, 0);
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    int result = -1;
+    if (fstat(fd, &st) == 0) {
+        if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            result = source_map_fd(src, fd, (size_t)st.st_size);
+        }
+        if (result != 0) {
+            result = source_read_fd(src, fd, S_ISREG(st.st_mode) ? (size_t)st.st_size : 0);
+        }
+    }
+
+    close(fd);
+    return result;
+}
+
+void source_close(SourceFile *src) {
+    if (!src || !src->data) return;
+    if (src->mapping) {
+        munmap(src->mapping, src->mapping_length);
+    } else {
+        free((void *)src->data);
+    }
+    memset(src, 0, sizeof(*src));
+}
@@ -1,44 +1,63 @@
 #include "symbol_table.h"
 
-#include "type_system.h"
-
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-#define INITIAL_SCOPE_CAPACITY 16
+#define INITIAL_SLOT_COUNT     64
+#define INITIAL_BINDING_COUNT  64
+#define INITIAL_SCOPE_DEPTH    16
 
-// Create a new scope
-static Scope *scope_create(Scope *parent) {
-    Scope *scope = malloc(sizeof(Scope));
-    scope->symbols = malloc(INITIAL_SCOPE_CAPACITY * sizeof(Symbol));
-    scope->symbol_count = 0;
-    scope->capacity = INITIAL_SCOPE_CAPACITY;
-    scope->parent = parent;
-    return scope;
+static size_t slot_hash(Atom name, size_t slot_count) {
+    // Fibonacci hashing: multiply by 2^32 / phi and keep the top log2(slot_count)
+    // bits, which spreads the dense atom ids across the table
+    unsigned bits = (unsigned)__builtin_ctzll((unsigned long long)slot_count);
+    return bits == 0 ? 0 : (size_t)((uint32_t)(name * 2654435769u) >> (32 - bits));
 }
 
-// Free a scope and its symbols
-static void scope_free(Scope *scope) {
-    if (!scope) return;
-    
-    // ✅ Free each symbol's copied name
-    for (size_t i = 0; i < scope->symbol_count; i++) {
-        free((void *)scope->symbols[i].name);
-        if (scope->symbols[i].type) {
-            type_free(scope->symbols[i].type);
+// Find the slot for name: either the one holding it or the empty slot where it belongs
+static SymbolSlot *slot_find(SymbolTable *table, Atom name) {
+    size_t mask = table->slot_count - 1;
+    size_t i = slot_hash(name, table->slot_count);
+    while (table->slots[i].name != ATOM_NONE && table->slots[i].name != name) {
+        i = (i + 1) & mask;
+    }
+    return &table->slots[i];
+}
+
+static int slots_grow(SymbolTable *table) {
+    SymbolSlot *old_slots = table->slots;
+    size_t old_count = table->slot_count;
+
+    table->slot_count = old_count * 2;
+    table->slots = calloc(table->slot_count, sizeof(SymbolSlot));
+    if (!table->slots) {
+        table->slots = old_slots;
+        table->slot_count = old_count;
+        return 0;
+    }
+
+    for (size_t i = 0; i < old_count; i++) {
+        if (old_slots[i].name != ATOM_NONE) {
+            *slot_find(table, old_slots[i].name) = old_slots[i];
         }
     }
-    
-    free(scope->symbols);
-    free(scope);
+    free(old_slots);
+    return 1;
 }
 
 // Create symbol table
 SymbolTable *symbol_table_create(void) {
     SymbolTable *table = malloc(sizeof(SymbolTable));
-    table->global_scope = scope_create(NULL);
-    table->current_scope = table->global_scope;
+    table->slot_count = INITIAL_SLOT_COUNT;
+    table->slots_used = 0;
+    table->slots = calloc(table->slot_count, sizeof(SymbolSlot));
+    table->binding_capacity = INITIAL_BINDING_COUNT;
+    table->binding_count = 0;
+    table->bindings = malloc(table->binding_capacity * sizeof(SymbolBinding));
+    table->mark_capacity = INITIAL_SCOPE_DEPTH;
+    table->scope_marks = malloc(table->mark_capacity * sizeof(size_t));
+    table->depth = 0;
     return table;
 }
 
@@ -46,120 +65,113 @@ SymbolTable *symbol_table_create(void) {
 void symbol_table_free(SymbolTable *table) {
     if (!table) return;
     
-    // Free all scopes starting from current
-    while (table->current_scope != table->global_scope) {
-        symbol_table_pop_scope(table);
-    }
-    
-    scope_free(table->global_scope);
+    free(table->slots);
+    free(table->bindings);
+    free(table->scope_marks);
     free(table);
 }
 
-// Push a new scope (entering a block)
+// Push a new scope (entering a block): just remember where it starts
 void symbol_table_push_scope(SymbolTable *table) {
     if (!table) return;
-    Scope *new_scope = scope_create(table->current_scope);
-    table->current_scope = new_scope;
+    if (table->depth == table->mark_capacity) {
+        table->mark_capacity *= 2;
+        table->scope_marks = realloc(table->scope_marks, table->mark_capacity * sizeof(size_t));
+    }
+    table->scope_marks[table->depth++] = table->binding_count;
 }
 
-// Pop a scope (exiting a block)
+// Pop a scope (exiting a block): rewind the bindings added since the push
 void symbol_table_pop_scope(SymbolTable *table) {
-    if (!table || !table->current_scope) {
-        table->current_scope = table->global_scope;
-        return;
-    }
-    
     // Can't pop global scope
-    if (table->current_scope == table->global_scope) {
-        return;
-    }
+    if (!table || table->depth == 0) return;
     
-    Scope *old_scope = table->current_scope;
-    table->current_scope = old_scope->parent;
-    scope_free(old_scope);
+    size_t mark = table->scope_marks[--table->depth];
+    while (table->binding_count > mark) {
+        SymbolBinding *binding = &table->bindings[--table->binding_count];
+        slot_find(table, binding->symbol.name)->binding = binding->shadowed;
+    }
 }
 
 // Add a symbol to the current scope
 // Returns 1 on success, 0 if symbol already exists in current scope
 int symbol_table_add_symbol(SymbolTable *table,
-                            const char *name,
-                            Type *type,
+                            Atom name,
+                            const Type *type,
                             int is_param,
                             int is_mutable,
                             int is_initialized) {
-    if (!table || !table->current_scope || !name || !type) {
+    if (!table || name == ATOM_NONE || !type) {
         return 0;
     }
     
-    // Check for redefinition in current scope only
-    if (symbol_table_is_defined_local(table, name)) {
-        fprintf(stderr, "Error: symbol '%s' already defined in this scope\n", name);
+    // Keep the load factor at or below 1/2
+    if ((table->slots_used + 1) * 2 > table->slot_count && !slots_grow(table)) {
         return 0;
     }
     
-    // Resize if necessary
-    if (table->current_scope->symbol_count >= table->current_scope->capacity) {
-        table->current_scope->capacity *= 2;
-        table->current_scope->symbols = realloc(table->current_scope->symbols,
-                                               table->current_scope->capacity * sizeof(Symbol));
+    SymbolSlot *slot = slot_find(table, name);
+    
+    // Check for redefinition in current scope only
+    if (slot->name != ATOM_NONE && slot->binding >= 0 &&
+        table->bindings[slot->binding].depth == table->depth) {
+        fprintf(stderr, "Error: symbol '%s' already defined in this scope\n", atom_name(name));
+        return 0;
     }
     
-    // Add symbol with copied name
-    size_t idx = table->current_scope->symbol_count;
+    if (table->binding_count == table->binding_capacity) {
+        table->binding_capacity *= 2;
+        table->bindings = realloc(table->bindings, table->binding_capacity * sizeof(SymbolBinding));
+    }
     
-    // ✅ Copy the name string instead of storing pointer
-    if (name) {
-        table->current_scope->symbols[idx].name = malloc(strlen(name) + 1);
-        strcpy((char *)table->current_scope->symbols[idx].name, name);
-    } else {
-        table->current_scope->symbols[idx].name = NULL;
+    if (slot->name == ATOM_NONE) {
+        slot->name = name;
+        slot->binding = -1;
+        table->slots_used++;
     }
     
-    table->current_scope->symbols[idx].type = type;
-    table->current_scope->symbols[idx].is_parameter = is_param;
-    table->current_scope->symbols[idx].is_mutable = is_mutable;
-    table->current_scope->symbols[idx].is_initialized = is_initialized;
-    table->current_scope->symbol_count++;
+    SymbolBinding *binding = &table->bindings[table->binding_count];
+    binding->symbol.name = name;
+    binding->symbol.type = type;
+    binding->symbol.is_parameter = is_param;
+    binding->symbol.is_mutable = is_mutable;
+    binding->symbol.is_initialized = is_initialized;
+    binding->depth = table->depth;
+    binding->shadowed = slot->binding;
+    slot->binding = (int32_t)table->binding_count++;
     
     return 1;
 }
 
-// Lookup symbol (searches current scope and all parent scopes)
-Symbol *symbol_table_lookup(SymbolTable *table, const char *name) {
-    if (!table || !name) return NULL;
+// Lookup symbol (innermost visible binding in any enclosing scope)
+Symbol *symbol_table_lookup(SymbolTable *table, Atom name) {
+    if (!table || name == ATOM_NONE) return NULL;
     
-    Scope *scope = table->current_scope;
-    while (scope) {
-        for (size_t i = 0; i < scope->symbol_count; i++) {
-            if (strcmp(scope->symbols[i].name, name) == 0) {
-                return &scope->symbols[i];
-            }
-        }
-        scope = scope->parent;
+    SymbolSlot *slot = slot_find(table, name);
+    if (slot->name == ATOM_NONE || slot->binding < 0) {
+        return NULL; // Not found in any scope
     }
-    
-    return NULL; // Not found in any scope
+    return &table->bindings[slot->binding].symbol;
 }
 
 // Lookup symbol in current scope only (no parent lookup)
-Symbol *symbol_table_lookup_local(SymbolTable *table, const char *name) {
-    if (!table || !table->current_scope || !name) return NULL;
+Symbol *symbol_table_lookup_local(SymbolTable *table, Atom name) {
+    if (!table || name == ATOM_NONE) return NULL;
     
-    for (size_t i = 0; i < table->current_scope->symbol_count; i++) {
-        if (strcmp(table->current_scope->symbols[i].name, name) == 0) {
-            return &table->current_scope->symbols[i];
-        }
+    SymbolSlot *slot = slot_find(table, name);
+    if (slot->name == ATOM_NONE || slot->binding < 0 ||
+        table->bindings[slot->binding].depth != table->depth) {
+        return NULL; // Not found in current scope
     }
-    
-    return NULL; // Not found in current scope
+    return &table->bindings[slot->binding].symbol;
 }
 
 // Check if symbol is defined in any scope
-int symbol_table_is_defined(SymbolTable *table, const char *name) {
+int symbol_table_is_defined(SymbolTable *table, Atom name) {
     return symbol_table_lookup(table, name) != NULL;
 }
 
 // Check if symbol is defined in current scope only
-int symbol_table_is_defined_local(SymbolTable *table, const char *name) {
+int symbol_table_is_defined_local(SymbolTable *table, Atom name) {
     return symbol_table_lookup_local(table, name) != NULL;
 }
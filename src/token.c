@@ -44,6 +44,8 @@ const char *token_type_name(TokenType type) {
         case TOK_PERIPHERAL: return "PERIPHERAL";
         case TOK_REGISTER: return "REGISTER";
         case TOK_FIELD: return "FIELD";
+        case TOK_CLUSTER: return "CLUSTER";
+        case TOK_STRIDE: return "STRIDE";
         case TOK_RO: return "RO";
         case TOK_WO: return "WO";
         case TOK_RW: return "RW";
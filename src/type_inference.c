@@ -10,7 +10,7 @@ TypeContext *type_context_create(void) {
     TypeContext *ctx = (TypeContext *)malloc(sizeof(TypeContext));
     ctx->symbols = symbol_table_create();
     ctx->error_count = 0;
-    ctx->current_function = NULL;
+    ctx->current_function = ATOM_NONE;
     ctx->expected_return_type = NULL;
     return ctx;
 }
@@ -21,32 +21,34 @@ void type_context_free(TypeContext *ctx) {
         if (ctx->symbols) {
             symbol_table_free(ctx->symbols);
         }
-        if (ctx->expected_return_type) {
-            type_free(ctx->expected_return_type);
-        }
         free(ctx);
     }
 }
 
 // Set current function context
-void type_context_set_function(TypeContext *ctx, const char *name, Type *return_type) {
+void type_context_set_function(TypeContext *ctx, Atom name, const Type *return_type) {
     if (!ctx) return;
     ctx->current_function = name;
-    if (ctx->expected_return_type) {
-        type_free(ctx->expected_return_type);
-    }
-    ctx->expected_return_type = type_clone(return_type);
+    ctx->expected_return_type = return_type;
 }
 
 // Forward declaration
-static Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, Type *left, Type *right);
+static const Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, const Type *left, const Type *right);
 
-// Infer type of an expression
-Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
+// Forward declaration
+static const Type *infer_expr_kind(TypeContext *ctx, ASTExpr *expr);
+
+// Infer type of an expression and record it on the node for later passes
+const Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
     if (!ctx || !expr) {
         return NULL;
     }
     
+    expr->type = infer_expr_kind(ctx, expr);
+    return expr->type;
+}
+
+static const Type *infer_expr_kind(TypeContext *ctx, ASTExpr *expr) {
     switch (expr->kind) {
         case EXPR_NUMBER: {
             // Numbers default to u32
@@ -55,14 +57,14 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
         
         case EXPR_IDENTIFIER: {
             // Look up variable in symbol table
-            const char *name = expr->data.identifier;
+            Atom name = expr->data.identifier;
             Symbol *sym = symbol_table_lookup(ctx->symbols, name);
             if (!sym) {
-                fprintf(stderr, "Error: undefined variable '%s'\n", name);
+                fprintf(stderr, "Error: undefined variable '%s'\n", atom_name(name));
                 ctx->error_count++;
                 return NULL;
             }
-            return type_clone(sym->type);
+            return sym->type;
         }
         
         case EXPR_BOOLEAN: {
@@ -79,7 +81,7 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
         
         case EXPR_UNARY_OP: {
             // Unary operations preserve type
-            Type *operand_type = infer_expr_type(ctx, expr->data.unary.operand);
+            const Type *operand_type = infer_expr_type(ctx, expr->data.unary.operand);
             if (!operand_type) {
                 return NULL;
             }
@@ -90,20 +92,18 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
                 case UOP_NEG:
                     return operand_type;
                 default:
-                    type_free(operand_type);
                     return NULL;
             }
         }
         
         case EXPR_BINARY_OP: {
-            Type *left = infer_expr_type(ctx, expr->data.binary.left);
+            const Type *left = infer_expr_type(ctx, expr->data.binary.left);
             if (!left) {
                 return NULL;
             }
             
-            Type *right = infer_expr_type(ctx, expr->data.binary.right);
+            const Type *right = infer_expr_type(ctx, expr->data.binary.right);
             if (!right) {
-                type_free(left);
                 return NULL;
             }
             
@@ -113,20 +113,16 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
                 fprintf(stderr, " Left type: %s\n", type_to_string(left));
                 fprintf(stderr, " Right type: %s\n", type_to_string(right));
                 ctx->error_count++;
-                type_free(left);
-                type_free(right);
                 return NULL;
             }
             
             // Determine result type
-            Type *result = infer_binary_op_type(ctx, expr->data.binary.op, left, right);
-            type_free(left);
-            type_free(right);
+            const Type *result = infer_binary_op_type(ctx, expr->data.binary.op, left, right);
             return result;
         }
         
         case EXPR_BIT_SLICE: {
-            Type *obj_type = infer_expr_type(ctx, expr->data.bit_slice.expr);
+            const Type *obj_type = infer_expr_type(ctx, expr->data.bit_slice.expr);
             if (!obj_type) {
                 return NULL;
             }
@@ -136,7 +132,6 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
                 fprintf(stderr, "Error: bit slice requires integer type, got %s\n",
                         type_to_string(obj_type));
                 ctx->error_count++;
-                type_free(obj_type);
                 return NULL;
             }
             
@@ -146,12 +141,9 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
                 fprintf(stderr, "Error: invalid bit slice range [%u:%u]\n",
                         expr->data.bit_slice.start, expr->data.bit_slice.end);
                 ctx->error_count++;
-                type_free(obj_type);
                 return NULL;
             }
             
-            type_free(obj_type);
-            
             // Determine smallest type that fits
             if (width <= 8) {
                 return type_from_kind(TYPE_U8);
@@ -188,7 +180,7 @@ Type *infer_expr_type(TypeContext *ctx, ASTExpr *expr) {
 }
 
 // Determine result type of binary operation
-static Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, Type *left, Type *right) {
+static const Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, const Type *left, const Type *right) {
     (void)ctx;
     (void)right;
     
@@ -198,7 +190,7 @@ static Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, Type *left, Typ
         case BOP_MUL:
         case BOP_DIV:
         case BOP_MOD:
-            return type_clone(left);
+            return left;
         
         case BOP_AND:
         case BOP_OR:
@@ -207,7 +199,7 @@ static Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, Type *left, Typ
         case BOP_RSHIFT:
         case BOP_LROTATE:
         case BOP_RROTATE:
-            return type_clone(left);
+            return left;
         
         case BOP_EQ:
         case BOP_NE:
@@ -218,7 +210,7 @@ static Type *infer_binary_op_type(TypeContext *ctx, BinaryOp op, Type *left, Typ
             return type_from_kind(TYPE_U8);
         
         default:
-            return type_clone(left);
+            return left;
     }
 }
 
@@ -244,7 +236,7 @@ int check_stmt_types(TypeContext *ctx, ASTStmt *stmt) {
             
             // 2) If initializer exists, type-check it
             if (stmt->data.var_decl.init) {
-                Type *init_type = infer_expr_type(ctx, stmt->data.var_decl.init);
+                const Type *init_type = infer_expr_type(ctx, stmt->data.var_decl.init);
                 if (!init_type) {
                     ctx->error_count++;
                     return 0;
@@ -256,15 +248,12 @@ int check_stmt_types(TypeContext *ctx, ASTStmt *stmt) {
                     fprintf(stderr, " Variable type: %s\n", type_to_string(stmt->data.var_decl.type));
                     fprintf(stderr, " Initializer type: %s\n", type_to_string(init_type));
                     ctx->error_count++;
-                    type_free(init_type);
                     return 0;
                 }
-                
-                type_free(init_type);
             }
             
             // 3) Add variable to symbol table with correct flags
-            Type *var_type = type_clone(stmt->data.var_decl.type);
+            const Type *var_type = stmt->data.var_decl.type;
             int is_param = 0;
             int is_mutable = stmt->data.var_decl.is_mut;
             int is_initialized = (stmt->data.var_decl.init != NULL);
@@ -276,7 +265,7 @@ int check_stmt_types(TypeContext *ctx, ASTStmt *stmt) {
                                        is_mutable,
                                        is_initialized)) {
                 fprintf(stderr, "Error: symbol '%s' already defined in this scope\n",
-                        stmt->data.var_decl.name);
+                        atom_name(stmt->data.var_decl.name));
                 ctx->error_count++;
                 return 0;
             }
@@ -286,19 +275,18 @@ int check_stmt_types(TypeContext *ctx, ASTStmt *stmt) {
         
         case STMT_EXPR: {
             if (stmt->data.expr_stmt.expr) {
-                Type *expr_type = infer_expr_type(ctx, stmt->data.expr_stmt.expr);
+                const Type *expr_type = infer_expr_type(ctx, stmt->data.expr_stmt.expr);
                 if (!expr_type) {
                     ctx->error_count++;
                     return 0;
                 }
-                type_free(expr_type);
             }
             return 1;
         }
         
         case STMT_RETURN: {
             if (stmt->data.ret.value) {
-                Type *ret_type = infer_expr_type(ctx, stmt->data.ret.value);
+                const Type *ret_type = infer_expr_type(ctx, stmt->data.ret.value);
                 if (!ret_type) {
                     ctx->error_count++;
                     return 0;
@@ -311,12 +299,9 @@ int check_stmt_types(TypeContext *ctx, ASTStmt *stmt) {
                         fprintf(stderr, " Expected: %s\n", type_to_string(ctx->expected_return_type));
                         fprintf(stderr, " Got: %s\n", type_to_string(ret_type));
                         ctx->error_count++;
-                        type_free(ret_type);
                         return 0;
                     }
                 }
-                
-                type_free(ret_type);
             }
             return 1;
         }
@@ -372,14 +357,14 @@ int check_function_types(TypeContext *ctx, ASTFunctionDef *func) {
     
     // Add parameters to symbol table (FIXED: use new API)
     for (size_t i = 0; i < func->param_count; i++) {
-        Type *param_type = type_clone(func->param_types[i]);
+        const Type *param_type = func->param_types[i];
         if (!symbol_table_add_symbol(ctx->symbols,
                                     func->param_names[i],
                                     param_type,
                                     1,                  // is_param = 1
                                     0,                  // is_mutable = 0 (parameters are immutable)
                                     1)) {               // is_initialized = 1
-            fprintf(stderr, "Error: parameter '%s' already defined\n", func->param_names[i]);
+            fprintf(stderr, "Error: parameter '%s' already defined\n", atom_name(func->param_names[i]));
             ctx->error_count++;
             symbol_table_pop_scope(ctx->symbols);
             return 0;
@@ -411,7 +396,7 @@ int check_program_types(TypeContext *ctx, ASTProgram *program) {
     // First pass: register all functions in global scope
     for (size_t i = 0; i < program->function_count; i++) {
         ASTFunctionDef *func = program->functions[i];
-        Type *func_type = type_clone(func->return_type);
+        const Type *func_type = func->return_type;
         
         // Add function to symbol table as a special marker (FIXED: use new API)
         if (!symbol_table_add_symbol(ctx->symbols,
@@ -420,7 +405,7 @@ int check_program_types(TypeContext *ctx, ASTProgram *program) {
                                     0,      // is_param = 0
                                     0,      // is_mutable = 0
                                     1)) {   // is_initialized = 1
-            fprintf(stderr, "Error: function '%s' already defined\n", func->name);
+            fprintf(stderr, "Error: function '%s' already defined\n", atom_name(func->name));
             ctx->error_count++;
             all_ok = 0;
         }
@@ -1,41 +1,38 @@
 #include "type_system.h"
-#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-Type *type_clone(Type *type) {
-    if (!type) return NULL;
-    Type *clone = (Type *)malloc(sizeof(Type));
-    clone->kind = type->kind;
-    return clone;
-}
+// One canonical object per TypeKind, indexed by kind. Composite types
+// (bit-widths, arrays, structs) will be hash-consed into a table alongside
+// these so that pointer equality keeps holding for them too.
+static const Type builtin_types[] = {
+    [TYPE_VOID] = { TYPE_VOID },
+    [TYPE_U8]   = { TYPE_U8 },
+    [TYPE_U16]  = { TYPE_U16 },
+    [TYPE_U32]  = { TYPE_U32 },
+    [TYPE_U64]  = { TYPE_U64 },
+    [TYPE_I8]   = { TYPE_I8 },
+    [TYPE_I16]  = { TYPE_I16 },
+    [TYPE_I32]  = { TYPE_I32 },
+    [TYPE_I64]  = { TYPE_I64 },
+};
 
-void type_free(Type *type) {
-    if (type) {
-        free(type);
-    }
+int type_equal(const Type *a, const Type *b) {
+    return a == b;  // Canonical types (both NULL also counts as equal)
 }
 
-int type_equal(Type *a, Type *b) {
-    if (!a || !b) {
-        return (a == b);  // Both NULL = equal
-    }
-    
-    return a->kind == b->kind;
-}
-
-int type_compatible(Type *target, Type *source) {
+int type_compatible(const Type *target, const Type *source) {
     // For now, types must be exactly equal
     // Future: add implicit conversions (u8 -> u32, etc.)
     return type_equal(target, source);
 }
 
-int type_is_numeric(Type *type) {
+int type_is_numeric(const Type *type) {
     if (!type) return 0;
     return type_is_integer(type);
 }
 
-int type_is_integer(Type *type) {
+int type_is_integer(const Type *type) {
     if (!type) return 0;
     
     switch (type->kind) {
@@ -53,12 +50,12 @@ int type_is_integer(Type *type) {
     }
 }
 
-int type_is_void(Type *type) {
+int type_is_void(const Type *type) {
     if (!type) return 0;
     return type->kind == TYPE_VOID;
 }
 
-int type_is_error(Type *type) {
+int type_is_error(const Type *type) {
     if (!type) return 1;  // NULL is error
     return 0;  // No error type in current system
 }
@@ -78,7 +75,7 @@ const char *type_kind_to_string(TypeKind kind) {
     }
 }
 
-const char *type_to_string(Type *type) {
+const char *type_to_string(const Type *type) {
     if (!type) return "null";
     return type_kind_to_string(type->kind);
 }
@@ -104,10 +101,11 @@ uint64_t type_get_size(TypeKind kind) {
     }
 }
 
-Type *type_from_kind(TypeKind kind) {
-    Type *type = (Type *)malloc(sizeof(Type));
-    type->kind = kind;
-    return type;
+const Type *type_from_kind(TypeKind kind) {
+    if ((size_t)kind >= sizeof(builtin_types) / sizeof(builtin_types[0])) {
+        return NULL;
+    }
+    return &builtin_types[kind];
 }
 
 TypeKind type_kind_from_string(const char *name, int length) {
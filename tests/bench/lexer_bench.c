@@ -0,0 +1,191 @@
+/**
+ * bit(N) lexer micro-benchmark
+ *
+ * Compares keyword recognition in lexer_keyword_type against the original
+ * strncmp chain over every identifier/keyword in the given .bitn files, and
+ * times full tokenization passes. Exits non-zero if the two classifiers ever
+ * disagree, so it doubles as a correctness test.
+ *
+ * Usage: lexer_bench [--iterations N] file.bitn...
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lexer.h"
+
+typedef struct {
+    const char *text;
+    int length;
+} Word;
+
+/* The keyword chain lexer_keyword_type replaced, kept as the baseline. */
+static TokenType reference_keyword_type(const char *word, int length) {
+    if (length == 2 && strncmp(word, "fn", 2) == 0) return TOK_FN;
+    if (length == 3 && strncmp(word, "mut", 3) == 0) return TOK_MUT;
+    if (length == 4 && strncmp(word, "proc", 4) == 0) return TOK_PROC;
+    if (length == 4 && strncmp(word, "func", 4) == 0) return TOK_FUNC;
+    if (length == 3 && strncmp(word, "var", 3) == 0) return TOK_VAR;
+    if (length == 3 && strncmp(word, "let", 3) == 0) return TOK_LET;
+    if (length == 6 && strncmp(word, "return", 6) == 0) return TOK_RETURN;
+    if (length == 2 && strncmp(word, "if", 2) == 0) return TOK_IF;
+    if (length == 4 && strncmp(word, "else", 4) == 0) return TOK_ELSE;
+    if (length == 5 && strncmp(word, "while", 5) == 0) return TOK_WHILE;
+    if (length == 3 && strncmp(word, "for", 3) == 0) return TOK_FOR;
+    if (length == 2 && strncmp(word, "in", 2) == 0) return TOK_IN;
+    if (length == 4 && strncmp(word, "true", 4) == 0) return TOK_TRUE;
+    if (length == 5 && strncmp(word, "false", 5) == 0) return TOK_FALSE;
+    if (length == 2 && strncmp(word, "u8", 2) == 0) return TOK_U8;
+    if (length == 3 && strncmp(word, "u16", 3) == 0) return TOK_U16;
+    if (length == 3 && strncmp(word, "u32", 3) == 0) return TOK_U32;
+    if (length == 3 && strncmp(word, "u64", 3) == 0) return TOK_U64;
+    if (length == 2 && strncmp(word, "i8", 2) == 0) return TOK_I8;
+    if (length == 3 && strncmp(word, "i16", 3) == 0) return TOK_I16;
+    if (length == 3 && strncmp(word, "i32", 3) == 0) return TOK_I32;
+    if (length == 3 && strncmp(word, "i64", 3) == 0) return TOK_I64;
+    if (length == 4 && strncmp(word, "void", 4) == 0) return TOK_VOID;
+    if (length == 10 && strncmp(word, "peripheral", 10) == 0) return TOK_PERIPHERAL;
+    if (length == 8 && strncmp(word, "register", 8) == 0) return TOK_REGISTER;
+    if (length == 5 && strncmp(word, "field", 5) == 0) return TOK_FIELD;
+    if (length == 7 && strncmp(word, "cluster", 7) == 0) return TOK_CLUSTER;
+    if (length == 6 && strncmp(word, "stride", 6) == 0) return TOK_STRIDE;
+    if (length == 2 && strncmp(word, "ro", 2) == 0) return TOK_RO;
+    if (length == 2 && strncmp(word, "wo", 2) == 0) return TOK_WO;
+    if (length == 2 && strncmp(word, "rw", 2) == 0) return TOK_RW;
+    if (length == 3 && strncmp(word, "w1c", 3) == 0) return TOK_W1C;
+    return TOK_IDENTIFIER;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static char *load_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc((size_t)size + 1);
+    if (data) {
+        size_t n = fread(data, 1, (size_t)size, f);
+        data[n] = '\0';
+    }
+    fclose(f);
+    return data;
+}
+
+static int is_word_token(TokenType type) {
+    return type == TOK_IDENTIFIER || (type >= TOK_IF && type <= TOK_W1C) ||
+           type == TOK_FN || type == TOK_MUT;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = 200;
+    char **sources = calloc((size_t)argc, sizeof(char *));
+    int source_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else {
+            char *data = load_file(argv[i]);
+            if (!data) {
+                fprintf(stderr, "lexer_bench: cannot open %s\n", argv[i]);
+                return 1;
+            }
+            sources[source_count++] = data;
+        }
+    }
+
+    if (source_count == 0) {
+        fprintf(stderr, "usage: lexer_bench [--iterations N] file.bitn...\n");
+        return 1;
+    }
+
+    /* Collect every word-like token once so the classifiers can be timed in isolation. */
+    Word *words = NULL;
+    size_t word_count = 0, word_capacity = 0, token_count = 0;
+    for (int s = 0; s < source_count; s++) {
+        Lexer *lexer = lexer_create(sources[s]);
+        Token tok;
+        do {
+            tok = lexer_next_token(lexer);
+            token_count++;
+            if (is_word_token(tok.type)) {
+                if (word_count == word_capacity) {
+                    word_capacity = word_capacity ? word_capacity * 2 : 1024;
+                    words = realloc(words, word_capacity * sizeof(Word));
+                }
+                words[word_count].text = tok.value;
+                words[word_count].length = tok.length;
+                word_count++;
+            }
+        } while (tok.type != TOK_EOF);
+        lexer_free(lexer);
+    }
+
+    for (size_t w = 0; w < word_count; w++) {
+        TokenType expected = reference_keyword_type(words[w].text, words[w].length);
+        TokenType actual = lexer_keyword_type(words[w].text, words[w].length);
+        if (expected != actual) {
+            fprintf(stderr, "lexer_bench: mismatch on '%.*s': %s vs %s\n",
+                    words[w].length, words[w].text,
+                    token_type_name(expected), token_type_name(actual));
+            return 1;
+        }
+    }
+
+    volatile unsigned sink = 0;
+
+    double start = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+        for (size_t w = 0; w < word_count; w++) {
+            sink += reference_keyword_type(words[w].text, words[w].length);
+        }
+    }
+    double reference_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+        for (size_t w = 0; w < word_count; w++) {
+            sink += lexer_keyword_type(words[w].text, words[w].length);
+        }
+    }
+    double keyword_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+        for (int s = 0; s < source_count; s++) {
+            Lexer *lexer = lexer_create(sources[s]);
+            Token tok;
+            do {
+                tok = lexer_next_token(lexer);
+                sink += tok.type;
+            } while (tok.type != TOK_EOF);
+            lexer_free(lexer);
+        }
+    }
+    double lex_time = now_seconds() - start;
+
+    double lookups = (double)word_count * iterations;
+    printf("lexer_bench: %d files, %zu tokens, %zu words, %d iterations\n",
+           source_count, token_count, word_count, iterations);
+    printf("  keyword (strncmp chain):  %8.2f ns/word\n", reference_time * 1e9 / lookups);
+    printf("  keyword (switch table):   %8.2f ns/word  (%.2fx)\n",
+           keyword_time * 1e9 / lookups,
+           keyword_time > 0 ? reference_time / keyword_time : 0.0);
+    printf("  full lex:                 %8.2f ns/token\n",
+           lex_time * 1e9 / ((double)token_count * iterations));
+
+    for (int s = 0; s < source_count; s++) free(sources[s]);
+    free(sources);
+    free(words);
+    return 0;
+}
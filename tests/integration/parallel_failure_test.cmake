@@ -0,0 +1,63 @@
+# Multi-file --compile with one unit that does not parse: the run must fail,
+# report every unit in input order, and print the same reports for any -j.
+# The summary counts the workers that ran, at most one per unit.
+#
+#   cmake -DBITN=<bitN> -DDEVICE=<file.bitn> -DWORK_DIR=<dir> -P parallel_failure_test.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+
+set(units a b c d e f)
+list(LENGTH units unit_count)
+set(reference "")
+foreach(jobs 1 4 8)
+    # A fresh directory each run, so both runs write the same headers
+    set(dir ${WORK_DIR}/j${jobs})
+    file(MAKE_DIRECTORY ${dir})
+    set(inputs "")
+    foreach(unit ${units})
+        if(unit STREQUAL "c")
+            file(WRITE ${dir}/${unit}.bitn "peripheral BAD @ { register\n")
+        else()
+            configure_file(${DEVICE} ${dir}/${unit}.bitn COPYONLY)
+        endif()
+        list(APPEND inputs ${unit}.bitn)
+    endforeach()
+
+    execute_process(
+        COMMAND ${BITN} --compile --no-cache -j ${jobs} ${inputs}
+        WORKING_DIRECTORY ${dir}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE out
+        ERROR_VARIABLE err
+    )
+
+    if(result EQUAL 0)
+        message(FATAL_ERROR "-j ${jobs}: expected a non-zero exit with a unit that does not parse")
+    endif()
+    if(NOT err STREQUAL "❌ c.bitn: parsing failed\n")
+        message(FATAL_ERROR "-j ${jobs}: unexpected diagnostics:\n${err}")
+    endif()
+
+    string(REGEX MATCHALL "Input: [a-z]+\\.bitn" order "${out}")
+    string(REPLACE ";" " " order "${order}")
+    if(NOT order STREQUAL "Input: a.bitn Input: b.bitn Input: c.bitn Input: d.bitn Input: e.bitn Input: f.bitn")
+        message(FATAL_ERROR "-j ${jobs}: reports out of input order: ${order}")
+    endif()
+
+    set(workers ${jobs})
+    if(workers GREATER unit_count)
+        set(workers ${unit_count})
+    endif()
+    string(FIND "${out}" "\n=== " summary_at REVERSE)
+    string(SUBSTRING "${out}" ${summary_at} -1 summary)
+    if(NOT summary STREQUAL "\n=== 5 of 6 inputs compiled (${workers} jobs) ===\n")
+        message(FATAL_ERROR "-j ${jobs}: unexpected summary:\n${summary}")
+    endif()
+
+    string(SUBSTRING "${out}" 0 ${summary_at} reports)
+    if(jobs EQUAL 1)
+        set(reference "${reports}")
+    elseif(NOT reports STREQUAL reference)
+        message(FATAL_ERROR "-j ${jobs}: reports differ from -j 1")
+    endif()
+endforeach()
@@ -0,0 +1,162 @@
+/**
+ * bit(N) RP2040 engine test
+ *
+ * One program - an ALU, load/store and call loop, then a loop that
+ * rewrites the function it calls - must leave the registers and memory
+ * a C model of the same program computes, and every engine must agree
+ * with the stepping core on core 0's registers, flags and instruction
+ * count.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "rp2040_harness.h"
+
+#define SMC_FUNC    0x20000100u     /* addk, alone in its code page */
+#define BYTES       0x20001100u     /* data[i] = i, for i = 1..200 */
+
+static const uint16_t program[] = {
+    /* start: */
+    0x4f16,             /* ldr  r7, =HARNESS_DATA */
+    0x4e17,             /* ldr  r6, =BYTES */
+    0x2000,             /* movs r0, #0 */
+    0x21c8,             /* movs r1, #200 */
+    0x2201,             /* movs r2, #1 */
+    /* loop: */
+    0x1840,             /* adds r0, r0, r1 */
+    0x00c3,             /* lsls r3, r0, #3 */
+    0x4058,             /* eors r0, r3 */
+    0x0943,             /* lsrs r3, r0, #5 */
+    0x18c0,             /* adds r0, r0, r3 */
+    0x4342,             /* muls r2, r0, r2 */
+    0x3201,             /* adds r2, #1 */
+    0x60f8,             /* str  r0, [r7, #12] */
+    0x68fc,             /* ldr  r4, [r7, #12] */
+    0x5471,             /* strb r1, [r6, r1] */
+    0xf000, 0xf807,     /* bl   mix */
+    0x3901,             /* subs r1, #1 */
+    0xd1f1,             /* bne  loop */
+    0x6038,             /* str  r0, [r7, #0] */
+    0x607a,             /* str  r2, [r7, #4] */
+    0xf000, 0xf807,     /* bl   smc */
+    0xbe00,             /* bkpt #0 */
+    /* mix: */
+    0xb530,             /* push {r4, r5, lr} */
+    0x251f,             /* movs r5, #31 */
+    0x4015,             /* ands r5, r2 */
+    0x41e8,             /* rors r0, r5 */
+    0x1b00,             /* subs r0, r0, r4 */
+    0xbd30,             /* pop  {r4, r5, pc} */
+    /* smc: */
+    0xb570,             /* push {r4, r5, r6, lr} */
+    0x4c09,             /* ldr  r4, =SMC_FUNC */
+    0x2501,             /* movs r5, #1 */
+    0x2600,             /* movs r6, #0 */
+    /* 1: */
+    0x2320,             /* movs r3, #0x20 */
+    0x021b,             /* lsls r3, r3, #8 */
+    0x432b,             /* orrs r3, r5 */
+    0x8023,             /* strh r3, [r4]            @ addk: movs r0, #k */
+    0x1c63,             /* adds r3, r4, #1 */
+    0x4798,             /* blx  r3 */
+    0x1836,             /* adds r6, r6, r0 */
+    0x3501,             /* adds r5, #1 */
+    0x2d64,             /* cmp  r5, #100 */
+    0xd9f5,             /* bls  1b */
+    0x60be,             /* str  r6, [r7, #8] */
+    0xbd70,             /* pop  {r4, r5, r6, pc} */
+    /* literal pool */
+    0x1000, 0x2000,     /* HARNESS_DATA */
+    0x1100, 0x2000,     /* BYTES */
+    0x0100, 0x2000,     /* SMC_FUNC */
+};
+
+static const uint16_t addk[] = {
+    0x2000,             /* movs r0, #0 */
+    0x4770,             /* bx   lr */
+};
+
+static uint32_t ror32(uint32_t value, uint32_t shift) {
+    shift &= 31;
+    return shift ? (value >> shift) | (value << (32 - shift)) : value;
+}
+
+/* The system after running the program to its BKPT, checked against the model. */
+static int check_run(rp2040_system_t *sys, const char *what) {
+    uint32_t acc = 0, x = 1;
+    for (uint32_t i = 200; i > 0; i--) {
+        acc += i;
+        acc ^= acc << 3;
+        acc += acc >> 5;
+        x = x * acc + 1;
+        acc = ror32(acc, x) - acc;
+    }
+
+    int failed = 0;
+    failed |= expect_word(what, "acc", rp2040_read_memory(sys, HARNESS_DATA), acc);
+    failed |= expect_word(what, "x", rp2040_read_memory(sys, HARNESS_DATA + 4), x);
+    failed |= expect_word(what, "rewritten sum", rp2040_read_memory(sys, HARNESS_DATA + 8), 5050);
+    failed |= expect_word(what, "addk", rp2040_read_memory(sys, SMC_FUNC), 0x47702064);
+    failed |= expect_word(what, "pc", rp2040_get_register(sys, 0, 15), HARNESS_CODE + 0x2e);
+    failed |= expect_word(what, "sp", rp2040_get_register(sys, 0, 13), HARNESS_STACK);
+    for (uint32_t i = 1; i <= 200; i++) {
+        uint32_t word = rp2040_read_memory(sys, BYTES + (i & ~3u));
+        failed |= expect_word(what, "data[i]", (word >> 8 * (i & 3)) & 0xff, i);
+    }
+    return failed;
+}
+
+/* Run the program in one mode; keep core 0's state for comparing engines. */
+static int run_mode(rp2040_exec_mode_t mode, uint32_t *regs, uint64_t *cycles) {
+    const char *what = harness_mode_names[mode];
+    rp2040_system_t *sys = harness_create(mode, program, sizeof(program) / 2);
+    int failed = !sys || harness_load(sys, SMC_FUNC, addk, sizeof(addk) / 2) < 0;
+
+    if (!failed) failed = harness_run(sys, what) || check_run(sys, what);
+    if (!failed) {
+        for (int reg = 0; reg <= 16; reg++) regs[reg] = rp2040_get_register(sys, 0, reg);
+        *cycles = sys->engines[0].cycles;
+    }
+    if (!failed && mode == RP2040_EXEC_JIT && sys->engines[0].jit->compiled == 0) {
+        fprintf(stderr, "%s: no block was compiled\n", what);
+        failed = 1;
+    }
+
+    rp2040_destroy(sys);
+    return failed;
+}
+
+int main(void) {
+    static const rp2040_exec_mode_t modes[] = {
+        RP2040_EXEC_STEP,
+        RP2040_EXEC_BLOCK,
+#if defined(__x86_64__) && defined(__unix__)
+        RP2040_EXEC_JIT,    /* The only hosts the JIT supports */
+#endif
+    };
+    uint32_t step_regs[17], regs[17];
+    uint64_t step_cycles, cycles;
+
+    int failed = run_mode(RP2040_EXEC_STEP, step_regs, &step_cycles);
+    for (size_t m = 1; !failed && m < sizeof(modes) / sizeof(modes[0]); m++) {
+        const char *what = harness_mode_names[modes[m]];
+        if (run_mode(modes[m], regs, &cycles)) {
+            failed = 1;
+            continue;
+        }
+        for (int reg = 0; reg <= 16; reg++) {
+            char name[8];
+            snprintf(name, sizeof(name), "r%d", reg);
+            failed |= expect_word(what, reg == 16 ? "psr" : name, regs[reg], step_regs[reg]);
+        }
+        if (cycles != step_cycles) {
+            fprintf(stderr, "%s: core 0 retired %llu instructions, stepping retired %llu\n",
+                    what, (unsigned long long)cycles, (unsigned long long)step_cycles);
+            failed = 1;
+        }
+    }
+
+    printf("rp2040_engine_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
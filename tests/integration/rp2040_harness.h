@@ -0,0 +1,79 @@
+/**
+ * bit(N) RP2040 integration tests - loading and running Thumb code
+ *
+ * Test programs are hand-assembled halfword listings (the assembly sits
+ * next to each encoding) loaded into SRAM. Every program ends in BKPT,
+ * which halts the system, so a run that never gets there is a failure.
+ */
+
+#ifndef BITN_RP2040_HARNESS_H
+#define BITN_RP2040_HARNESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "rp2040/rp2040.h"
+
+#define HARNESS_CODE    0x20000000u     /* Program */
+#define HARNESS_DATA    0x20001000u     /* Scratch and results */
+#define HARNESS_STACK   0x20002000u     /* Core 0's initial SP; core 1's sits 0x1000 below */
+#define HARNESS_IDLE    0x20003000u     /* "b ." for a core with nothing to do */
+
+#define HARNESS_CYCLES  10000000u       /* A run this long has hung */
+
+static const char *const harness_mode_names[] = { "step", "block", "jit" };
+
+/* Load a halfword listing at addr. */
+static inline int harness_load(rp2040_system_t *sys, uint32_t addr, const uint16_t *code, size_t count) {
+    uint8_t bytes[1024];
+    if (count * 2 > sizeof(bytes)) return -1;
+
+    for (size_t i = 0; i < count; i++) {
+        bytes[2 * i] = (uint8_t)code[i];
+        bytes[2 * i + 1] = (uint8_t)(code[i] >> 8);
+    }
+    return rp2040_load_binary(sys, addr, bytes, (uint32_t)(count * 2));
+}
+
+/*
+ * A system in the given mode with the program at HARNESS_CODE, core 0
+ * starting on it and core 1 parked on the idle loop. NULL (with a
+ * report) if the mode is not available.
+ */
+static inline rp2040_system_t *harness_create(rp2040_exec_mode_t mode, const uint16_t *code, size_t count) {
+    static const uint16_t idle[] = { 0xe7fe };  /* b . */
+
+    rp2040_system_t *sys = rp2040_create();
+    if (!sys || rp2040_set_exec_mode(sys, mode) < 0 ||
+        harness_load(sys, HARNESS_CODE, code, count) < 0 ||
+        harness_load(sys, HARNESS_IDLE, idle, 1) < 0) {
+        fprintf(stderr, "%s: cannot set up the system\n", harness_mode_names[mode]);
+        rp2040_destroy(sys);
+        return NULL;
+    }
+
+    for (int core = 0; core < RP2040_NUM_CORES; core++) {
+        rp2040_set_register(sys, core, 13, HARNESS_STACK - 0x1000u * (uint32_t)core);
+        rp2040_set_register(sys, core, 15, core == 0 ? HARNESS_CODE : HARNESS_IDLE);
+    }
+    return sys;
+}
+
+/* Run until BKPT halts the system; 1 (with a report) if it does not. */
+static inline int harness_run(rp2040_system_t *sys, const char *what) {
+    if (rp2040_run_cycles(sys, HARNESS_CYCLES) < 0 || !sys->halted) {
+        fprintf(stderr, "%s: did not reach BKPT (core 0 pc 0x%08x)\n", what, rp2040_get_register(sys, 0, 15));
+        return 1;
+    }
+    return 0;
+}
+
+/* Report and count a word that differs from the expected value. */
+static inline int expect_word(const char *what, const char *name, uint32_t actual, uint32_t expected) {
+    if (actual == expected) return 0;
+    fprintf(stderr, "%s: %s is 0x%08x, expected 0x%08x\n", what, name, actual, expected);
+    return 1;
+}
+
+#endif // BITN_RP2040_HARNESS_H
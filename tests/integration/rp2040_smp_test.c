@@ -0,0 +1,140 @@
+/**
+ * bit(N) RP2040 dual-core test
+ *
+ * Both cores increment a shared counter under SIO spinlock 0. Core 1 then
+ * rewrites a function core 0 has already run many times, and tells core 0
+ * through the inter-core FIFO. Core 0 waits for the message and calls the
+ * function again. It must see the new code and the full count. This runs
+ * in every mode, with the cores interleaved on one thread and with each
+ * core on its own thread at a short and a long quantum.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "rp2040_harness.h"
+
+#define CORE1_CODE  (HARNESS_CODE + 0x2a)
+#define GETK        0x20000100u     /* Alone in its code page */
+#define COUNTER     HARNESS_DATA
+#define INCREMENTS  500             /* Per core */
+#define TOKEN       0x5a
+
+static const uint16_t program[] = {
+    /* core0: */
+    0x4c17,             /* ldr  r4, =RP2040_SIO_BASE */
+    0x4d18,             /* ldr  r5, =COUNTER */
+    0x2701,             /* movs r7, #1 */
+    0x023f,             /* lsls r7, r7, #8          @ RP2040_SIO_SPINLOCK0 */
+    0x2100,             /* movs r1, #0 */
+    0x2664,             /* movs r6, #100 */
+    /* warm: */
+    0xf000, 0xf878,     /* bl   getk */
+    0x1809,             /* adds r1, r1, r0 */
+    0x3e01,             /* subs r6, #1 */
+    0xd1fa,             /* bne  warm */
+    0xf000, 0xf816,     /* bl   count */
+    /* wait: */
+    0x6d23,             /* ldr  r3, [r4, #0x50]     @ FIFO_ST */
+    0x085b,             /* lsrs r3, r3, #1          @ VLD */
+    0xd3fc,             /* bcc  wait */
+    0x6da2,             /* ldr  r2, [r4, #0x58]     @ FIFO_RD */
+    0xf000, 0xf86d,     /* bl   getk */
+    0x682b,             /* ldr  r3, [r5] */
+    0xbe00,             /* bkpt #0 */
+    /* core1: */
+    0x4c0d,             /* ldr  r4, =RP2040_SIO_BASE */
+    0x4d0d,             /* ldr  r5, =COUNTER */
+    0x2701,             /* movs r7, #1 */
+    0x023f,             /* lsls r7, r7, #8 */
+    0xf000, 0xf808,     /* bl   count */
+    0x4b0c,             /* ldr  r3, =GETK */
+    0x2220,             /* movs r2, #0x20 */
+    0x0212,             /* lsls r2, r2, #8 */
+    0x322a,             /* adds r2, #42 */
+    0x801a,             /* strh r2, [r3]            @ getk: movs r0, #42 */
+    0x225a,             /* movs r2, #TOKEN */
+    0x6562,             /* str  r2, [r4, #0x54]     @ FIFO_WR */
+    /* idle: */
+    0xe7fe,             /* b    idle */
+    /* count: */
+    0x26fa,             /* movs r6, #250 */
+    0x0076,             /* lsls r6, r6, #1          @ INCREMENTS */
+    /* 1: */
+    0x59e3,             /* ldr  r3, [r4, r7]        @ claim */
+    0x2b00,             /* cmp  r3, #0 */
+    0xd0fc,             /* beq  1b */
+    0x682a,             /* ldr  r2, [r5] */
+    0x3201,             /* adds r2, #1 */
+    0x602a,             /* str  r2, [r5] */
+    0x51e3,             /* str  r3, [r4, r7]        @ release */
+    0x3e01,             /* subs r6, #1 */
+    0xd1f6,             /* bne  1b */
+    0x4770,             /* bx   lr */
+    0x0000,
+    /* literal pool */
+    0x0000, 0xd000,     /* RP2040_SIO_BASE */
+    0x1000, 0x2000,     /* COUNTER */
+    0x0100, 0x2000,     /* GETK */
+};
+
+static const uint16_t getk[] = {
+    0x2000,             /* movs r0, #0 */
+    0x4770,             /* bx   lr */
+};
+
+/* Run the program in one mode: on one thread if quantum is 0, else threaded. */
+static int run_smp(rp2040_exec_mode_t mode, uint32_t quantum) {
+    char what[48];
+    if (quantum) {
+        snprintf(what, sizeof(what), "%s, threaded, quantum %u", harness_mode_names[mode], quantum);
+    } else {
+        snprintf(what, sizeof(what), "%s, one thread", harness_mode_names[mode]);
+    }
+
+    rp2040_system_t *sys = harness_create(mode, program, sizeof(program) / 2);
+    if (!sys) return 1;
+    rp2040_set_register(sys, 1, 15, CORE1_CODE);
+
+    int failed = harness_load(sys, GETK, getk, sizeof(getk) / 2) < 0;
+    if (!failed && quantum) {
+        if (rp2040_run_threaded(sys, HARNESS_CYCLES, quantum) < 0 || !sys->halted) {
+            fprintf(stderr, "%s: did not reach BKPT (core 0 pc 0x%08x)\n", what, rp2040_get_register(sys, 0, 15));
+            failed = 1;
+        }
+    } else if (!failed) {
+        failed = harness_run(sys, what);
+    }
+
+    if (!failed) {
+        failed |= expect_word(what, "getk before", rp2040_get_register(sys, 0, 1), 0);
+        failed |= expect_word(what, "getk after", rp2040_get_register(sys, 0, 0), 42);
+        failed |= expect_word(what, "token", rp2040_get_register(sys, 0, 2), TOKEN);
+        failed |= expect_word(what, "counter", rp2040_get_register(sys, 0, 3), 2 * INCREMENTS);
+        failed |= expect_word(what, "spinlocks held", sys->sio->spinlocks, 0);
+    }
+
+    rp2040_destroy(sys);
+    return failed;
+}
+
+int main(void) {
+    static const rp2040_exec_mode_t modes[] = {
+        RP2040_EXEC_STEP,
+        RP2040_EXEC_BLOCK,
+#if defined(__x86_64__) && defined(__unix__)
+        RP2040_EXEC_JIT,    /* The only hosts the JIT supports */
+#endif
+    };
+    static const uint32_t quanta[] = { 0, 16, 1000 };
+    int failed = 0;
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (size_t q = 0; q < sizeof(quanta) / sizeof(quanta[0]); q++) {
+            failed |= run_smp(modes[m], quanta[q]);
+        }
+    }
+
+    printf("rp2040_smp_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,109 @@
+/**
+ * bit(N) RP2040 watchpoint test
+ *
+ * A write watchpoint and a read watchpoint on an array the program fills
+ * and then sums. In every mode and on either core, each must stop the
+ * core before its access - PC on the instruction, memory untouched - and
+ * report the access. The other kind of access to the same word must not
+ * trigger it. Stepping over the access resumes the run.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "rp2040_harness.h"
+
+#define ARRAY       0x20001100u     /* array[i] = i, for i = 1..100 */
+#define PC_STORE    (HARNESS_CODE + 0x08)
+#define PC_LOAD     (HARNESS_CODE + 0x12)
+
+static const uint16_t program[] = {
+    /* start: */
+    0x4e06,             /* ldr  r6, =ARRAY */
+    0x2100,             /* movs r1, #0 */
+    /* fill: */
+    0x3101,             /* adds r1, #1 */
+    0x008b,             /* lsls r3, r1, #2 */
+    0x50f1,             /* str  r1, [r6, r3]        @ PC_STORE */
+    0x2964,             /* cmp  r1, #100 */
+    0xd1fa,             /* bne  fill */
+    0x2000,             /* movs r0, #0 */
+    /* sum: */
+    0x008b,             /* lsls r3, r1, #2 */
+    0x58f2,             /* ldr  r2, [r6, r3]        @ PC_LOAD */
+    0x1880,             /* adds r0, r0, r2 */
+    0x3901,             /* subs r1, #1 */
+    0xd1fa,             /* bne  sum */
+    0xbe00,             /* bkpt #0 */
+    /* literal pool */
+    0x1100, 0x2000,     /* ARRAY */
+};
+
+/* Run into a watchpoint; check where the core stopped, then step over the access. */
+static int expect_hit(rp2040_system_t *sys, int core, const char *what,
+                      uint32_t pc, uint32_t index, bool write) {
+    int failed = 0;
+
+    if (rp2040_run_cycles(sys, HARNESS_CYCLES) < 0 || !sys->watchpoint_triggered || sys->halted) {
+        fprintf(stderr, "%s: no watchpoint hit at array[%u]\n", what, index);
+        return 1;
+    }
+
+    failed |= expect_word(what, "pc", rp2040_get_register(sys, core, 15), pc);
+    failed |= expect_word(what, "r1", rp2040_get_register(sys, core, 1), index);
+    failed |= expect_word(what, "hit_addr", sys->debug->hit_addr, ARRAY + index * 4);
+    failed |= expect_word(what, "hit_len", sys->debug->hit_len, 4);
+    failed |= expect_word(what, "hit_write", sys->debug->hit_write, write);
+    failed |= expect_word(what, "hit_core", (uint32_t)sys->debug->hit_core, (uint32_t)core);
+    failed |= expect_word(what, "array[i]", rp2040_read_memory(sys, ARRAY + index * 4), write ? 0 : index);
+
+    sys->watchpoint_triggered = false;
+    if (rp2040_step_core(sys, core) < 0) failed = 1;
+    failed |= expect_word(what, "pc after the access", rp2040_get_register(sys, core, 15), pc + 2);
+    return failed;
+}
+
+/* The program on one core, the other idle, in one mode. */
+static int run_watched(rp2040_exec_mode_t mode, int core) {
+    char what[32];
+    snprintf(what, sizeof(what), "%s, core %d", harness_mode_names[mode], core);
+
+    rp2040_system_t *sys = harness_create(mode, program, sizeof(program) / 2);
+    if (!sys) return 1;
+    rp2040_set_register(sys, core, 15, HARNESS_CODE);
+    rp2040_set_register(sys, 1 - core, 15, HARNESS_IDLE);
+
+    int failed = rp2040_add_watchpoint(sys, ARRAY + 80 * 4, 4, RP2040_WATCH_WRITE) < 0 ||
+                 rp2040_add_watchpoint(sys, ARRAY + 90 * 4, 4, RP2040_WATCH_READ) < 0;
+
+    if (!failed) failed = expect_hit(sys, core, what, PC_STORE, 80, true);
+    if (!failed) failed = expect_hit(sys, core, what, PC_LOAD, 90, false);
+    if (!failed) failed = harness_run(sys, what);
+    if (!failed) {
+        failed |= expect_word(what, "sum", rp2040_get_register(sys, core, 0), 5050);
+        failed |= expect_word(what, "array[80]", rp2040_read_memory(sys, ARRAY + 80 * 4), 80);
+    }
+
+    rp2040_destroy(sys);
+    return failed;
+}
+
+int main(void) {
+    static const rp2040_exec_mode_t modes[] = {
+        RP2040_EXEC_STEP,
+        RP2040_EXEC_BLOCK,
+#if defined(__x86_64__) && defined(__unix__)
+        RP2040_EXEC_JIT,    /* The only hosts the JIT supports */
+#endif
+    };
+    int failed = 0;
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (int core = 0; core < RP2040_NUM_CORES; core++) {
+            failed |= run_watched(modes[m], core);
+        }
+    }
+
+    printf("rp2040_watch_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,117 @@
+/**
+ * bit(N) field access kind unit test
+ *
+ * rw fields get read-modify-write setters, w1c fields are acknowledged
+ * with a plain store of their mask, ro fields have no setters and wo
+ * fields no getters.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "codegen.h"
+#include "expect_text.h"
+
+static const char *device =
+    "peripheral TEST @ 0x40000000 {\n"
+    "    register CTRL: u32 @ 0x00 {\n"
+    "        field EN: [0:0] rw;\n"
+    "        field MODE: [3:1] rw;\n"
+    "    }\n"
+    "    register STATUS: u8 @ 0x04 {\n"
+    "        field DONE: [0:0] w1c;\n"
+    "        field BUSY: [1:1] ro;\n"
+    "        field KICK: [2:2] wo;\n"
+    "    }\n"
+    "    register FLAGS: u32 @ 0x08 {\n"
+    "        field W1C: [0:0] rw;\n"
+    "        field ERR: [1:1] w1c;\n"
+    "    }\n"
+    "}\n";
+
+static int check(const char *out, size_t length) {
+    int failed = 0;
+
+    failed |= expect_lines(out, length, "    MMIO_REG8 STATUS; // @ offset 0x4\n", 1);
+
+    /* rw */
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_CTRL_EN_set(uint32_t val) {\n"
+                           "    TEST->CTRL = (TEST->CTRL & ~TEST_CTRL_EN_Msk) | ((val << TEST_CTRL_EN_Pos) & TEST_CTRL_EN_Msk);\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_CTRL_EN_clear(void) {\n"
+                           "    TEST->CTRL &= ~TEST_CTRL_EN_Msk;\n"
+                           "}\n", 1);
+
+    /* w1c: writing 0 to the other bits leaves them alone */
+    failed |= expect_lines(out, length, "#define TEST_STATUS_W1C_MASK 0x00000001U\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline uint8_t TEST_STATUS_DONE_get(void) {\n"
+                           "    return (uint8_t)((TEST->STATUS & TEST_STATUS_DONE_Msk) >> TEST_STATUS_DONE_Pos);\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_STATUS_DONE_clear(void) {\n"
+                           "    TEST->STATUS = TEST_STATUS_DONE_Msk;\n"
+                           "}\n", 1);
+    failed |= expect_absent(out, length, "TEST_STATUS_DONE_set");
+    failed |= expect_absent(out, length, "TEST_STATUS_DONE_SET");
+    failed |= expect_absent(out, length, "TEST_STATUS_DONE_write");
+
+    /* ro */
+    failed |= expect_lines(out, length,
+                           "static inline uint8_t TEST_STATUS_BUSY_get(void) {\n"
+                           "    return (uint8_t)((TEST->STATUS & TEST_STATUS_BUSY_Msk) >> TEST_STATUS_BUSY_Pos);\n"
+                           "}\n", 1);
+    failed |= expect_absent(out, length, "TEST_STATUS_BUSY_set");
+    failed |= expect_absent(out, length, "TEST_STATUS_BUSY_SET");
+    failed |= expect_absent(out, length, "TEST_STATUS_BUSY_write");
+    failed |= expect_absent(out, length, "TEST_STATUS_BUSY_clear");
+
+    /* wo: nothing to read back, so the store does not read first */
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_STATUS_KICK_set(uint8_t val) {\n"
+                           "    TEST->STATUS = (uint8_t)(((uint32_t)val << TEST_STATUS_KICK_Pos) & TEST_STATUS_KICK_Msk);\n"
+                           "}\n", 1);
+    failed |= expect_absent(out, length, "TEST_STATUS_KICK_get");
+    failed |= expect_absent(out, length, "TEST_STATUS_KICK_GET");
+    failed |= expect_absent(out, length, "TEST_STATUS_KICK_read");
+
+    /* A field named W1C keeps its own _Msk; the register's w1c bits are _W1C_MASK */
+    failed |= expect_lines(out, length,
+                           "#define TEST_FLAGS_W1C_Pos 0U\n"
+                           "#define TEST_FLAGS_W1C_Msk 0x00000001U\n"
+                           "#define TEST_FLAGS_ERR_Pos 1U\n"
+                           "#define TEST_FLAGS_ERR_Msk 0x00000002U\n"
+                           "#define TEST_FLAGS_W1C_MASK 0x00000002U\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_FLAGS_W1C_set(uint32_t val) {\n"
+                           "    TEST->FLAGS = (TEST->FLAGS & ~(TEST_FLAGS_W1C_Msk | TEST_FLAGS_W1C_MASK)) | ((val << TEST_FLAGS_W1C_Pos) & TEST_FLAGS_W1C_Msk);\n"
+                           "}\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_FLAGS_ERR_clear(void) {\n"
+                           "    TEST->FLAGS = (TEST->FLAGS & ~TEST_FLAGS_W1C_MASK) | TEST_FLAGS_ERR_Msk;\n"
+                           "}\n", 1);
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(device);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    int failed = !program || parser_has_error(parser);
+
+    if (!failed) {
+        CodegenContext *ctx = codegen_init_buffer("arm-cortex-m0");
+        size_t length = 0;
+        const char *out = ctx && codegen_generate(ctx, program) == 0 ? codegen_buffer(ctx, &length) : NULL;
+        failed = !out || check(out, length);
+        codegen_cleanup(ctx);
+    }
+
+    parser_free(parser);
+    ast_free_program(program);
+    printf("access_kind_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
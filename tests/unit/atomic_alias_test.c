@@ -0,0 +1,102 @@
+/**
+ * bit(N) RP2040 atomic alias unit test
+ *
+ * With the rp2040 target, 32-bit registers of APB/AHB-lite peripherals get
+ * single-store _set/_clr/_xor accessors through the XOR/SET/CLR alias
+ * windows. Narrow registers, SIO and other targets get none.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "codegen.h"
+#include "expect_text.h"
+
+static const char *device =
+    "peripheral TEST @ 0x40000000 {\n"
+    "    register CTRL: u32 @ 0x00 { field EN: [0:0] rw; }\n"
+    "    register STATUS: u8 @ 0x04 { field BUSY: [1:1] ro; }\n"
+    "    cluster CH[2] @ 0x10 stride 0x8 {\n"
+    "        register CFG: u32 @ 0x0 { field MODE: [3:1] rw; }\n"
+    "    }\n"
+    "}\n"
+    "peripheral SIO @ 0xd0000000 {\n"
+    "    register GPIO_OUT: u32 @ 0x10 { field OUT: [29:0] rw; }\n"
+    "}\n";
+
+static int check_rp2040(const char *out, size_t length) {
+    int failed = 0;
+
+    failed |= expect_lines(out, length,
+                           "// Atomic alias views: every store XORs, sets or clears the written bits\n"
+                           "#define TEST_XOR ((volatile TEST_t *)0x40001000)\n"
+                           "#define TEST_SET ((volatile TEST_t *)0x40002000)\n"
+                           "#define TEST_CLR ((volatile TEST_t *)0x40003000)\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_CTRL_set(uint32_t mask) {\n"
+                           "    TEST_SET->CTRL = mask;\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_CTRL_clr(uint32_t mask) {\n"
+                           "    TEST_CLR->CTRL = mask;\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_CTRL_xor(uint32_t mask) {\n"
+                           "    TEST_XOR->CTRL = mask;\n"
+                           "}\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_CH_CFG_set(unsigned n, uint32_t mask) {\n"
+                           "    TEST_SET->CH[n].CFG = mask;\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_CH_CFG_clr(unsigned n, uint32_t mask) {\n"
+                           "    TEST_CLR->CH[n].CFG = mask;\n"
+                           "}\n"
+                           "\n"
+                           "static inline void TEST_CH_CFG_xor(unsigned n, uint32_t mask) {\n"
+                           "    TEST_XOR->CH[n].CFG = mask;\n"
+                           "}\n", 1);
+
+    /* The alias windows only decode full 32-bit writes; SIO has none */
+    failed |= expect_absent(out, length, "TEST_STATUS_set(");
+    failed |= expect_absent(out, length, "SIO_SET");
+    failed |= expect_absent(out, length, "SIO_GPIO_OUT_set(");
+    return failed;
+}
+
+static int check_generic(const char *out, size_t length) {
+    int failed = 0;
+
+    failed |= expect_absent(out, length, "TEST_SET");
+    failed |= expect_absent(out, length, "TEST_CTRL_set(");
+    failed |= expect_absent(out, length, "TEST_CH_CFG_xor(");
+    return failed;
+}
+
+static int generate(ASTProgram *program, const char *target,
+                    int (*check)(const char *out, size_t length)) {
+    CodegenContext *ctx = codegen_init_buffer(target);
+    size_t length = 0;
+    const char *out = ctx && codegen_generate(ctx, program) == 0 ? codegen_buffer(ctx, &length) : NULL;
+    int failed = !out || check(out, length);
+    codegen_cleanup(ctx);
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(device);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    int failed = !program || parser_has_error(parser);
+
+    if (!failed) {
+        failed |= generate(program, "rp2040", check_rp2040);
+        failed |= generate(program, "arm-cortex-m0", check_generic);
+    }
+
+    parser_free(parser);
+    ast_free_program(program);
+    printf("atomic_alias_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
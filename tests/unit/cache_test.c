@@ -0,0 +1,40 @@
+/**
+ * bit(N) incremental compilation cache unit test
+ *
+ * Keys must separate targets and codegen format versions, entries must
+ * round-trip exactly, and file_write_if_changed must leave an identical
+ * output alone.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache.h"
+#include "codegen.h"
+
+int main(void) {
+    const char *dir = "cache_test.cache";
+    const char *source = "peripheral A @ 0x0 {}";
+    const char *header = "#define CACHED 1\n";
+    size_t source_length = strlen(source);
+    char *loaded = NULL;
+    char *stale = NULL;
+    size_t length = 0;
+
+    CacheKey key = cache_key(source, source_length, "rp2040", CODEGEN_FORMAT_VERSION);
+    CacheKey next = cache_key(source, source_length, "rp2040", CODEGEN_FORMAT_VERSION + 1);
+    int failed = key == cache_key(source, source_length, "arm-cortex-m0", CODEGEN_FORMAT_VERSION) ||
+                 cache_store(dir, key, header, strlen(header)) != 0 ||
+                 cache_load(dir, key, &loaded, &length) != 0 ||
+                 length != strlen(header) || memcmp(loaded, header, length) != 0 ||
+                 /* A header stored by another codegen format is a miss */
+                 key == next || cache_load(dir, next, &stale, &length) == 0 ||
+                 file_write_if_changed("cache_test.h", header, strlen(header)) < 0 ||
+                 file_write_if_changed("cache_test.h", header, strlen(header)) != 0;
+
+    free(loaded);
+    free(stale);
+    printf("cache_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,147 @@
+/**
+ * bit(N) codegen unit test
+ *
+ * A header generated to a file must be byte-identical to the same header
+ * generated into memory, and codegen_write must copy long output and deep
+ * indentation without truncating it. Two registers whose accessors would
+ * share a name fail the generation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "source.h"
+#include "codegen.h"
+
+static const char *device =
+    "peripheral TEST @ 0x40000000 {\n"
+    "    register CTRL: u32 @ 0x00 {\n"
+    "        field EN: [0:0] rw;\n"
+    "        field MODE: [3:1] rw;\n"
+    "    }\n"
+    "    register STATUS: u8 @ 0x04 {\n"
+    "        field DONE: [0:0] w1c;\n"
+    "        field BUSY: [1:1] ro;\n"
+    "        field KICK: [2:2] wo;\n"
+    "    }\n"
+    "}\n";
+
+/* The file and buffer outputs of one program, compared byte for byte. */
+static int test_file_matches_buffer(ASTProgram *program) {
+    const char *path = "codegen_test.h";
+
+    CodegenContext *file_ctx = codegen_init(path, "rp2040");
+    int failed = !file_ctx || codegen_generate(file_ctx, program) != 0;
+    codegen_cleanup(file_ctx);
+
+    CodegenContext *ctx = codegen_init_buffer("rp2040");
+    size_t length = 0;
+    const char *buffer = ctx && codegen_generate(ctx, program) == 0 ?
+                         codegen_buffer(ctx, &length) : NULL;
+
+    SourceFile file;
+    if (!failed && buffer && source_open(&file, path) == 0) {
+        failed = file.length != length || memcmp(file.data, buffer, length) != 0;
+        if (failed) fprintf(stderr, "%s differs from the buffered header\n", path);
+        source_close(&file);
+    } else {
+        failed = 1;
+    }
+
+    codegen_cleanup(ctx);
+    return failed;
+}
+
+/* A line longer than any fixed buffer, indented past the run of spaces. */
+static int test_long_line(void) {
+    enum { LINE = 10000, INDENT = 20 * 4 };
+
+    char *line = malloc(LINE + 1);
+    char *expected = malloc(INDENT + LINE + 3);
+    if (!line || !expected) {
+        free(line);
+        free(expected);
+        return 1;
+    }
+    memset(line, 'x', LINE);
+    line[LINE] = '\0';
+    memset(expected, ' ', INDENT);
+    memcpy(expected + INDENT, line, LINE);
+    memcpy(expected + INDENT + LINE, "\n\n", 3);
+
+    CodegenContext *ctx = codegen_init_buffer("arm-cortex-m0");
+    int failed = !ctx;
+    if (!failed) {
+        ctx->indent_level = INDENT / 4;
+        codegen_write(ctx, "%s\n\n", line);
+
+        size_t length = 0;
+        const char *buffer = codegen_buffer(ctx, &length);
+        failed = !buffer || length != INDENT + LINE + 2 || memcmp(buffer, expected, length) != 0;
+    }
+
+    codegen_cleanup(ctx);
+    free(line);
+    free(expected);
+    return failed;
+}
+
+/* Register C_R next to cluster C's R: both would be TEST_C_R_*. */
+static int test_prefix_collision(void) {
+    static const char *colliding =
+        "peripheral TEST @ 0x40000000 {\n"
+        "    register C_R: u32 @ 0x00 {\n"
+        "        field F: [0:0] rw;\n"
+        "    }\n"
+        "    cluster C[2] @ 0x10 stride 0x4 {\n"
+        "        register R: u32 @ 0x00 {\n"
+        "            field F: [0:0] rw;\n"
+        "        }\n"
+        "    }\n"
+        "}\n";
+    static const char *expected =
+        "Codegen error: TEST.C_R and TEST.C[].R both define TEST_C_R accessors\n";
+
+    Parser *parser = parser_create(colliding);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    CodegenContext *ctx = codegen_init_buffer("rp2040");
+    FILE *errors = tmpfile();
+    int failed = !program || parser_has_error(parser) || !ctx || !errors;
+
+    if (!failed) {
+        ctx->errors = errors;
+        failed = codegen_generate(ctx, program) == 0;
+
+        char message[256] = "";
+        rewind(errors);
+        size_t length = fread(message, 1, sizeof(message) - 1, errors);
+        message[length] = '\0';
+        if (strcmp(message, expected) != 0) {
+            fprintf(stderr, "collision reported as:\n%s", message);
+            failed = 1;
+        }
+    }
+
+    if (errors) fclose(errors);
+    codegen_cleanup(ctx);
+    parser_free(parser);
+    ast_free_program(program);
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(device);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    int failed = !program || parser_has_error(parser) || program->peripheral_count != 1;
+
+    if (!failed) failed |= test_file_matches_buffer(program);
+    failed |= test_long_line();
+    failed |= test_prefix_collision();
+
+    parser_free(parser);
+    ast_free_program(program);
+    printf("codegen_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,48 @@
+/**
+ * bit(N) unit tests - exact checks on generated text
+ *
+ * Generated headers are checked a block of whole lines at a time: the block
+ * must start at the beginning of a line and end with a newline, so a
+ * prefix or a fragment of a longer line never counts as a match.
+ */
+
+#ifndef BITN_EXPECT_TEXT_H
+#define BITN_EXPECT_TEXT_H
+
+#include <stdio.h>
+#include <string.h>
+
+/* Whether text[0..length) holds lines, newline-terminated, as whole lines. */
+static inline int text_has_lines(const char *text, size_t length, const char *lines) {
+    size_t want = strlen(lines);
+    if (want == 0 || lines[want - 1] != '\n') return 0;
+
+    for (size_t at = 0; at + want <= length; ) {
+        if (memcmp(text + at, lines, want) == 0) return 1;
+        const char *newline = memchr(text + at, '\n', length - at);
+        if (!newline) break;
+        at = (size_t)(newline - text) + 1;
+    }
+    return 0;
+}
+
+/* Report and count a block of lines that should (or should not) be present. */
+static inline int expect_lines(const char *text, size_t length, const char *lines, int present) {
+    if (text_has_lines(text, length, lines) == present) return 0;
+    fprintf(stderr, "%s:\n%s", present ? "missing lines" : "unexpected lines", lines);
+    return 1;
+}
+
+/* Report and count an identifier that must not appear anywhere. */
+static inline int expect_absent(const char *text, size_t length, const char *name) {
+    size_t name_length = strlen(name);
+    for (size_t at = 0; at + name_length <= length; at++) {
+        if (memcmp(text + at, name, name_length) == 0) {
+            fprintf(stderr, "unexpected: %s\n", name);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif // BITN_EXPECT_TEXT_H
@@ -0,0 +1,40 @@
+/**
+ * bit(N) linker script generator unit test
+ *
+ * Generates a two-region script and checks its MEMORY block line for line.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "source.h"
+#include "linker_gen.h"
+#include "expect_text.h"
+
+int main(void) {
+    const char *path = "linker_test.ld";
+
+    LinkerContext *ctx = linker_init(path, "arm-cortex-m0");
+    int failed = !ctx ||
+                 linker_add_region(ctx, "FLASH", 0x10000000, 0x200000, "rx") != 0 ||
+                 linker_add_region(ctx, "RAM", 0x20000000, 0x42000, "rwx") != 0 ||
+                 linker_generate(ctx) != 0;
+    linker_cleanup(ctx);
+
+    SourceFile file;
+    if (!failed && source_open(&file, path) == 0) {
+        failed = expect_lines(file.data, file.length,
+                              "MEMORY\n"
+                              "{\n"
+                              "  FLASH (rx  ) : ORIGIN = 0x10000000, LENGTH = 0x200000\n"
+                              "  RAM (rwx ) : ORIGIN = 0x20000000, LENGTH = 0x42000\n"
+                              "}\n", 1);
+        source_close(&file);
+    } else {
+        failed = 1;
+    }
+
+    printf("linker_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
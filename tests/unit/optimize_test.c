@@ -0,0 +1,176 @@
+/**
+ * bit(N) optimizer unit test
+ *
+ * Runs the folding, strength reduction and rotate passes and compares each
+ * optimized return expression, printed fully parenthesized, with the exact
+ * expected text.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "intern.h"
+#include "optimize.h"
+#include "type_inference.h"
+#include "type_system.h"
+
+static const char *source =
+    "fn fold() -> u32 { return 0xFFFFFFFF + 2; }\n"
+    "fn scale() -> u32 { let x: u32 = 7; return (x * 8) / 4 + x % 16; }\n"
+    "fn rotl() -> u32 { let x: u32 = 7; return (x << 5) | (x >> 27); }\n"
+    "fn rotr() -> u32 { let x: u32 = 7; let n: u32 = 3; return (x << (32 - n)) | (x >> n); }\n"
+    "fn keep() -> u32 { return 1 / 0; }\n";
+
+static const char *binary_names[] = {
+    [BOP_ADD] = "+", [BOP_SUB] = "-", [BOP_MUL] = "*", [BOP_DIV] = "/", [BOP_MOD] = "%",
+    [BOP_AND] = "&", [BOP_OR] = "|", [BOP_XOR] = "^",
+    [BOP_LSHIFT] = "<<", [BOP_RSHIFT] = ">>", [BOP_LROTATE] = "rotl", [BOP_RROTATE] = "rotr",
+    [BOP_EQ] = "==", [BOP_NE] = "!=", [BOP_LT] = "<", [BOP_GT] = ">", [BOP_LE] = "<=", [BOP_GE] = ">=",
+};
+
+static const char *unary_names[] = { [UOP_NOT] = "!", [UOP_BIT_NOT] = "~", [UOP_NEG] = "-" };
+
+/* Print expr into out, every operation in parentheses. */
+static void render(const ASTExpr *expr, char *out, size_t size) {
+    size_t used = strlen(out);
+    if (used >= size - 1) return;
+
+    switch (expr->kind) {
+        case EXPR_NUMBER:
+            snprintf(out + used, size - used, "%llu", (unsigned long long)expr->data.number_value);
+            break;
+        case EXPR_IDENTIFIER:
+            snprintf(out + used, size - used, "%s", atom_name(expr->data.identifier));
+            break;
+        case EXPR_UNARY_OP:
+            snprintf(out + used, size - used, "(%s", unary_names[expr->data.unary.op]);
+            render(expr->data.unary.operand, out, size);
+            strncat(out, ")", size - strlen(out) - 1);
+            break;
+        case EXPR_BINARY_OP:
+            strncat(out, "(", size - used - 1);
+            render(expr->data.binary.left, out, size);
+            used = strlen(out);
+            snprintf(out + used, size - used, " %s ", binary_names[expr->data.binary.op]);
+            render(expr->data.binary.right, out, size);
+            strncat(out, ")", size - strlen(out) - 1);
+            break;
+        default:
+            strncat(out, "?", size - used - 1);
+            break;
+    }
+}
+
+static int expect_expr(const char *name, const ASTExpr *expr, const char *expected) {
+    char text[256] = "";
+    render(expr, text, sizeof(text));
+    if (strcmp(text, expected) == 0) return 0;
+    fprintf(stderr, "%s: got %s, expected %s\n", name, text, expected);
+    return 1;
+}
+
+static ASTExpr *typed_expr(ASTExpr *expr, const Type *type) {
+    expr->type = type;
+    return expr;
+}
+
+/*
+ * Narrow and signed widths, annotated by hand since the checker only
+ * accepts literals as u32: i8 127 + 1 wraps to -128, i8 -7 / 2 rounds
+ * toward zero, and i8 x / 2 is not a shift.
+ */
+static int test_narrow(Optimizer *opt, Arena *arena) {
+    const Type *i8 = type_from_kind(TYPE_I8);
+    ASTExpr *exprs[3] = {
+        typed_expr(ast_expr_binary_op(arena, BOP_ADD,
+                                      typed_expr(ast_expr_number(arena, 127, TYPE_I8), i8),
+                                      typed_expr(ast_expr_number(arena, 1, TYPE_I8), i8)), i8),
+        typed_expr(ast_expr_binary_op(arena, BOP_DIV,
+                                      typed_expr(ast_expr_number(arena, 0xF9, TYPE_I8), i8),
+                                      typed_expr(ast_expr_number(arena, 2, TYPE_I8), i8)), i8),
+        typed_expr(ast_expr_binary_op(arena, BOP_DIV,
+                                      typed_expr(ast_expr_identifier(arena, intern_cstr("x")), i8),
+                                      typed_expr(ast_expr_number(arena, 2, TYPE_I8), i8)), i8),
+    };
+    ASTStmt *stmts[3];
+    for (int e = 0; e < 3; e++) {
+        stmts[e] = ast_stmt_return(arena, exprs[e]);
+    }
+    ASTFunctionDef *func = ast_function_def(arena, intern_cstr("narrow"), i8, NULL, NULL, 0,
+                                            ast_stmt_block(arena, stmts, 3));
+    optimize_function(opt, func);
+
+    int failed = 0;
+    failed |= expect_expr("i8 127 + 1", stmts[0]->data.ret.value, "128");
+    failed |= expect_expr("i8 -7 / 2", stmts[1]->data.ret.value, "253");
+    failed |= expect_expr("i8 x / 2", stmts[2]->data.ret.value, "(x / 2)");
+    return failed;
+}
+
+/*
+ * Unary folds wrap the operand to its width first, as the binary folds do:
+ * a u8 literal 0x100 is 0, so !0x100 is 1, ~0x10F is 0xF0 and -0x101 is 0xFF.
+ */
+static int test_unary(Optimizer *opt, Arena *arena) {
+    const Type *u8 = type_from_kind(TYPE_U8);
+    static const UnaryOp ops[3] = { UOP_NOT, UOP_BIT_NOT, UOP_NEG };
+    static const uint64_t operands[3] = { 0x100, 0x10F, 0x101 };
+    ASTStmt *stmts[3];
+    for (int e = 0; e < 3; e++) {
+        ASTExpr *operand = typed_expr(ast_expr_number(arena, operands[e], TYPE_U8), u8);
+        stmts[e] = ast_stmt_return(arena, typed_expr(ast_expr_unary_op(arena, ops[e], operand), u8));
+    }
+    ASTFunctionDef *func = ast_function_def(arena, intern_cstr("unary"), u8, NULL, NULL, 0,
+                                            ast_stmt_block(arena, stmts, 3));
+    optimize_function(opt, func);
+
+    int failed = 0;
+    failed |= expect_expr("u8 !0x100", stmts[0]->data.ret.value, "1");
+    failed |= expect_expr("u8 ~0x10F", stmts[1]->data.ret.value, "240");
+    failed |= expect_expr("u8 -0x101", stmts[2]->data.ret.value, "255");
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(source);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    TypeContext *types = type_context_create();
+    int failed = !program || parser_has_error(parser) || program->function_count != 5 ||
+                 !check_program_types(types, program);
+
+    Optimizer opt;
+    if (!failed) {
+        optimizer_init(&opt, program->arena);
+        optimize_program(&opt, program);
+
+        static const char *expected[5] = {
+            "1",
+            "(((x << 3) >> 2) + (x & 15))",
+            "(x rotl 5)",
+            "(x rotr n)",
+            "(1 / 0)",
+        };
+        for (size_t f = 0; f < 5; f++) {
+            ASTFunctionDef *func = program->functions[f];
+            ASTStmt *body = func->body;
+            ASTExpr *ret = body->data.block.statements[body->data.block.count - 1]->data.ret.value;
+            failed |= expect_expr(atom_name(func->name), ret, expected[f]);
+        }
+
+        failed |= opt.passes[OPT_PASS_FOLD].rewritten != 1 ||
+                  opt.passes[OPT_PASS_STRENGTH].rewritten != 3 ||
+                  opt.passes[OPT_PASS_ROTATE].rewritten != 2;
+        if (failed) optimizer_print_stats(&opt, stderr);
+
+        failed |= test_narrow(&opt, program->arena);
+        failed |= test_unary(&opt, program->arena);
+    }
+
+    type_context_free(types);
+    parser_free(parser);
+    ast_free_program(program);
+    printf("optimize_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,106 @@
+/**
+ * bit(N) Thumb-1 backend unit test
+ *
+ * Compiles three functions and compares the machine code, the call
+ * relocation and the ELF header with exact bytes: a leaf, a function that
+ * calls the EABI divide helper, and one with enough live values to spill
+ * and a constant that needs the literal pool.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "type_inference.h"
+#include "thumb.h"
+
+static const char *source =
+    "fn leaf() -> u32 { return 42; }\n"
+    "fn divide() -> u32 { let x: u32 = 6; return x * 7 + x / 3; }\n"
+    "fn pressure() -> u32 {\n"
+    "    let a: u32 = 1; let b: u32 = a + 2; let c: u32 = b * 3; let d: u32 = c ^ 4;\n"
+    "    let e: u32 = d + a; let f: u32 = e * b; let g: u32 = f - c; let h: u32 = g | d;\n"
+    "    let i: u32 = h + e; let j: u32 = i * f; let k: u32 = j + 0x12345678;\n"
+    "    return a + b + c + d + e + f + g + h + i + j + k;\n"
+    "}\n";
+
+static const uint8_t leaf_code[] = {
+    0x2A, 0x20,                 /* movs r0, #42 */
+    0x70, 0x47,                 /* bx lr */
+};
+
+static const uint8_t divide_code[] = {
+    0x10, 0xB5,                 /* push {r4, lr} */
+    0x06, 0x20,                 /* movs r0, #6 */
+    0x07, 0x21,                 /* movs r1, #7 */
+    0x04, 0x00,                 /* movs r4, r0 */
+    0x4C, 0x43,                 /* muls r4, r1, r4 */
+    0x03, 0x21,                 /* movs r1, #3 */
+    0xFF, 0xF7, 0xFE, 0xFF,     /* bl __aeabi_uidiv (R_ARM_THM_CALL) */
+    0x24, 0x18,                 /* adds r4, r4, r0 */
+    0x20, 0x00,                 /* movs r0, r4 */
+    0x10, 0xBD,                 /* pop {r4, pc} */
+};
+
+/* ELF32 little-endian ARM relocatable, EABI v5, 8 sections at 0x1cc */
+static const uint8_t elf_header[52] = {
+    0x7F, 0x45, 0x4C, 0x46, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x28, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCC, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x05, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00,
+    0x08, 0x00, 0x07, 0x00,
+};
+
+static int expect_code(const ThumbFunction *func, const uint8_t *code, size_t size) {
+    if (func->size == size && memcmp(func->code, code, size) == 0) return 0;
+    fprintf(stderr, "%s:", func->name);
+    for (size_t b = 0; b < func->size; b++) {
+        fprintf(stderr, " %02x", func->code[b]);
+    }
+    fprintf(stderr, "\n");
+    return 1;
+}
+
+static int check(const ThumbContext *ctx, const uint8_t *image, size_t length) {
+    const ThumbFunction *divide = &ctx->functions[1];
+    const ThumbFunction *pressure = &ctx->functions[2];
+    static const uint8_t pool[] = { 0x78, 0x56, 0x34, 0x12 };
+    int failed = 0;
+
+    failed |= expect_code(&ctx->functions[0], leaf_code, sizeof(leaf_code));
+    failed |= expect_code(divide, divide_code, sizeof(divide_code));
+    failed |= divide->reloc_count != 1 || divide->relocs[0].offset != 12 ||
+              strcmp(divide->relocs[0].symbol, "__aeabi_uidiv") != 0;
+
+    /* More live values than r0-r7: some live on the stack */
+    failed |= pressure->spills == 0;
+    failed |= pressure->pool_offset % 4 != 0 || pressure->size != pressure->pool_offset + sizeof(pool) ||
+              memcmp(pressure->code + pressure->pool_offset, pool, sizeof(pool)) != 0;
+
+    /* The section headers end the file */
+    failed |= length != 0x1CC + 8 * 40 || memcmp(image, elf_header, sizeof(elf_header)) != 0;
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(source);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    TypeContext *types = type_context_create();
+    ThumbContext *ctx = thumb_init("arm-cortex-m0");
+    uint8_t *image = NULL;
+    size_t length = 0;
+    int failed = !program || parser_has_error(parser) || !check_program_types(types, program) ||
+                 !ctx || thumb_compile_program(ctx, program) != 0 ||
+                 thumb_object(ctx, &image, &length) != 0 || ctx->function_count != 3;
+
+    if (!failed) failed = check(ctx, image, length);
+
+    free(image);
+    thumb_cleanup(ctx);
+    type_context_free(types);
+    parser_free(parser);
+    ast_free_program(program);
+    printf("thumb_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
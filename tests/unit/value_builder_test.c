@@ -0,0 +1,97 @@
+/**
+ * bit(N) register value builder unit test
+ *
+ * Registers with writable fields get a fields struct, _pack() and _VALUE().
+ * Registers with rw fields also get _write_fields(), which never writes 1
+ * back to a w1c flag. Registers with nothing writable get neither.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "codegen.h"
+#include "expect_text.h"
+
+static const char *device =
+    "peripheral TEST @ 0x40000000 {\n"
+    "    register CTRL: u32 @ 0x00 {\n"
+    "        field EN: [0:0] rw;\n"
+    "        field MODE: [3:1] rw;\n"
+    "    }\n"
+    "    register STATUS: u8 @ 0x04 {\n"
+    "        field DONE: [0:0] w1c;\n"
+    "        field BUSY: [1:1] ro;\n"
+    "        field KICK: [2:2] wo;\n"
+    "    }\n"
+    "    register INTR: u16 @ 0x08 {\n"
+    "        field IE: [0:0] rw;\n"
+    "        field FLAG: [8:8] w1c;\n"
+    "    }\n"
+    "    register ID: u32 @ 0x0C {\n"
+    "        field REV: [7:0] ro;\n"
+    "    }\n"
+    "}\n";
+
+static int check(const char *out, size_t length) {
+    int failed = 0;
+
+    failed |= expect_lines(out, length,
+                           "typedef struct {\n"
+                           "    uint32_t EN;\n"
+                           "    uint32_t MODE;\n"
+                           "} TEST_CTRL_fields_t;\n"
+                           "\n"
+                           "static inline uint32_t TEST_CTRL_pack(TEST_CTRL_fields_t f) {\n"
+                           "    return ((f.EN << TEST_CTRL_EN_Pos) & TEST_CTRL_EN_Msk) |\n"
+                           "           ((f.MODE << TEST_CTRL_MODE_Pos) & TEST_CTRL_MODE_Msk);\n"
+                           "}\n"
+                           "\n"
+                           "#define TEST_CTRL_VALUE(...) TEST_CTRL_pack((TEST_CTRL_fields_t){ __VA_ARGS__ })\n"
+                           "\n"
+                           "static inline void TEST_CTRL_write_fields(uint32_t mask, uint32_t value) {\n"
+                           "    TEST->CTRL = (TEST->CTRL & ~mask) | (value & mask);\n"
+                           "}\n", 1);
+
+    /* A wo field can be built, but there is nothing to read back and merge */
+    failed |= expect_lines(out, length,
+                           "static inline uint8_t TEST_STATUS_pack(TEST_STATUS_fields_t f) {\n"
+                           "    return (uint8_t)(((f.KICK << TEST_STATUS_KICK_Pos) & TEST_STATUS_KICK_Msk));\n"
+                           "}\n", 1);
+    failed |= expect_absent(out, length, "TEST_STATUS_write_fields");
+
+    /* Only rw fields go in the struct; the w1c flag is written as 0 */
+    failed |= expect_lines(out, length,
+                           "typedef struct {\n"
+                           "    uint32_t IE;\n"
+                           "} TEST_INTR_fields_t;\n", 1);
+    failed |= expect_lines(out, length,
+                           "static inline void TEST_INTR_write_fields(uint16_t mask, uint16_t value) {\n"
+                           "    TEST->INTR = (uint16_t)((TEST->INTR & ~(mask | TEST_INTR_W1C_MASK)) | (value & mask));\n"
+                           "}\n", 1);
+
+    failed |= expect_absent(out, length, "TEST_ID_fields_t");
+    failed |= expect_absent(out, length, "TEST_ID_VALUE");
+    failed |= expect_absent(out, length, "TEST_ID_write_fields");
+    return failed;
+}
+
+int main(void) {
+    Parser *parser = parser_create(device);
+    ASTProgram *program = parser ? parser_parse_program(parser) : NULL;
+    int failed = !program || parser_has_error(parser);
+
+    if (!failed) {
+        CodegenContext *ctx = codegen_init_buffer("arm-cortex-m0");
+        size_t length = 0;
+        const char *out = ctx && codegen_generate(ctx, program) == 0 ? codegen_buffer(ctx, &length) : NULL;
+        failed = !out || check(out, length);
+        codegen_cleanup(ctx);
+    }
+
+    parser_free(parser);
+    ast_free_program(program);
+    printf("value_builder_test: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}